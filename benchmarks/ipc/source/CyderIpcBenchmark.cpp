@@ -0,0 +1,384 @@
+/******************************************************************************
+ * Cyder — Hot-Reloading Audio Plugin Wrapper
+ *
+ * @file     CyderIpcBenchmark.cpp
+ *
+ * @author   Adam Shield
+ * @date     2026-10-19
+ *
+ * @copyright (c) 2026 Adam Shield
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * See LICENSE.txt for license terms.
+ ******************************************************************************/
+
+// IPC benchmark: times the round trip of a block through the shared memory that hosts
+// plugins out of process (see CyderBridgeChannel), to a child process and back.
+//
+// Usage:
+//   Cyder_IpcBenchmark [--iterations=5000] [--block-sizes=32,64,128,256,512,1024,2048]
+//                      [--channels=1,2,4,8,16] [--signals=spin,futex,eventfd]
+//
+// The child negates every sample in place, as a plugin processing would touch them.
+// Reports p50, p99 and p99.9 round trip and jitter (standard deviation) in microseconds,
+// and p99.9 as a share of the block's duration at 48 kHz. Linux only.
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_core/juce_core.h>
+
+#include "CyderBridgeChannel.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+#include <csignal>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+//==============================================================================
+
+enum class Signal
+{
+    spin,    // both sides busy-wait on the sequence words
+    futex,   // both sides sleep on the sequence words, as CyderProcessBridge does
+    eventfd, // both sides sleep on an eventfd each, the sequence words only order the data
+};
+
+static constexpr int warmUpIterations = 100;
+static constexpr int replyTimeoutMs   = 1000;
+static constexpr double referenceSampleRate = 48000.0;
+
+[[nodiscard]] static const char* getName(Signal signal) noexcept
+{
+    switch (signal)
+    {
+        case Signal::spin:    return "spin";
+        case Signal::futex:   return "futex";
+        case Signal::eventfd: return "eventfd";
+    }
+    return "";
+}
+
+static inline void pause() noexcept
+{
+   #if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+   #elif defined(__aarch64__)
+    asm volatile("yield");
+   #endif
+}
+
+//==============================================================================
+
+/** An eventfd for each direction, inherited by the child. */
+struct EventFds
+{
+    int toChild  = -1;
+    int toParent = -1;
+
+    void close() noexcept
+    {
+        if (toChild >= 0)  ::close(toChild);
+        if (toParent >= 0) ::close(toParent);
+        toChild = toParent = -1;
+    }
+};
+
+static void notify(int fd) noexcept
+{
+    const uint64_t one = 1;
+    [[maybe_unused]] const auto written = write(fd, &one, sizeof(one));
+}
+
+/** @returns false if nothing came within the timeout */
+[[nodiscard]] static bool waitForEvent(int fd, int timeoutMs) noexcept
+{
+    pollfd pollFd { fd, POLLIN, 0 };
+    if (poll(&pollFd, 1, timeoutMs) <= 0)
+        return false;
+
+    uint64_t count = 0;
+    return read(fd, &count, sizeof(count)) == sizeof(count);
+}
+
+/** @returns false if the word still holds expected after the timeout */
+[[nodiscard]] static bool waitForChange(std::atomic<uint32_t>& word, uint32_t expected, Signal signal, int eventFd)
+{
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(replyTimeoutMs);
+    while (word.load(std::memory_order_acquire) == expected)
+    {
+        if (std::chrono::steady_clock::now() > deadline)
+            return false;
+
+        switch (signal)
+        {
+            case Signal::spin:
+                pause();
+                break;
+            case Signal::futex:
+                CyderBridgeChannel::wait(word, expected, juce::int64(replyTimeoutMs) * 1000000);
+                break;
+            case Signal::eventfd:
+                if (! waitForEvent(eventFd, replyTimeoutMs))
+                    return false;
+                break;
+        }
+    }
+    return true;
+}
+
+static void signalChange(std::atomic<uint32_t>& word, Signal signal, int eventFd) noexcept
+{
+    if (signal == Signal::futex)
+        CyderBridgeChannel::wake(word);
+    else if (signal == Signal::eventfd)
+        notify(eventFd);
+}
+
+//==============================================================================
+
+/** The child's side: processes blocks in place until told to exit. Never returns. */
+[[noreturn]] static void runChild(CyderBridgeChannel& channel, Signal signal, const EventFds& fds, int numChannels)
+{
+    auto& header = channel.getHeader();
+    auto handled = header.responseSequence.load();
+
+    for (;;)
+    {
+        if (! waitForChange(header.requestSequence, handled, signal, fds.toChild))
+        {
+            if (getppid() == 1)
+                _exit(1); // parent is gone
+            continue;
+        }
+
+        if (header.shouldExit.load() != 0)
+            _exit(0); // skips destructors, the parent owns the shared memory
+
+        const auto requested = header.requestSequence.load(std::memory_order_acquire);
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto* samples = channel.getChannel(ch);
+            for (int i = 0; i < header.numSamples; ++i)
+                samples[i] = -samples[i];
+        }
+
+        handled = requested;
+        header.responseSequence.store(requested, std::memory_order_release);
+        signalChange(header.responseSequence, signal, fds.toParent);
+    }
+}
+
+//==============================================================================
+
+struct Result
+{
+    double p50Us = 0.0;
+    double p99Us = 0.0;
+    double p999Us = 0.0;
+    double jitterUs = 0.0;
+};
+
+[[nodiscard]] static double getPercentile(const std::vector<double>& sorted, double fraction)
+{
+    const auto index = std::min(sorted.size() - 1, static_cast<size_t>(fraction * static_cast<double>(sorted.size())));
+    return sorted[index];
+}
+
+[[nodiscard]] static Result summarise(std::vector<double> roundTripsUs)
+{
+    std::sort(roundTripsUs.begin(), roundTripsUs.end());
+
+    const auto count = static_cast<double>(roundTripsUs.size());
+    const auto mean = std::accumulate(roundTripsUs.begin(), roundTripsUs.end(), 0.0) / count;
+    auto variance = 0.0;
+    for (const auto value : roundTripsUs)
+        variance += (value - mean) * (value - mean);
+
+    Result result;
+    result.p50Us    = getPercentile(roundTripsUs, 0.5);
+    result.p99Us    = getPercentile(roundTripsUs, 0.99);
+    result.p999Us   = getPercentile(roundTripsUs, 0.999);
+    result.jitterUs = std::sqrt(variance / count);
+    return result;
+}
+
+/** Forks a child, and times numIterations round trips to it. @returns false if it stopped answering */
+[[nodiscard]] static bool measure(Signal signal, int blockSize, int numChannels, int numIterations, Result& result)
+{
+    auto channel = CyderBridgeChannel::create(blockSize);
+    if (channel == nullptr)
+    {
+        std::cerr << "Failed to create shared memory" << std::endl;
+        return false;
+    }
+
+    EventFds fds;
+    if (signal == Signal::eventfd)
+    {
+        fds.toChild  = eventfd(0, 0);
+        fds.toParent = eventfd(0, 0);
+        if (fds.toChild < 0 || fds.toParent < 0)
+        {
+            fds.close();
+            std::cerr << "Failed to create eventfds" << std::endl;
+            return false;
+        }
+    }
+
+    auto& header = channel->getHeader();
+    header.numChannels = numChannels;
+    header.numSamples  = blockSize;
+
+    const auto childId = fork();
+    if (childId < 0)
+    {
+        fds.close();
+        std::cerr << "Failed to fork" << std::endl;
+        return false;
+    }
+    if (childId == 0)
+        runChild(*channel, signal, fds, numChannels);
+
+    // Something to send, and somewhere to take it back to
+    juce::AudioBuffer<float> block(numChannels, blockSize);
+    for (int ch = 0; ch < numChannels; ++ch)
+        for (int i = 0; i < blockSize; ++i)
+            block.setSample(ch, i, std::sin(0.01f * static_cast<float>(i + ch)));
+
+    const auto numBytes = static_cast<size_t>(blockSize) * sizeof(float);
+    std::vector<double> roundTripsUs;
+    roundTripsUs.reserve(static_cast<size_t>(numIterations));
+
+    bool answered = true;
+    auto sequence = header.requestSequence.load();
+    for (int i = 0; i < warmUpIterations + numIterations && answered; ++i)
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            std::memcpy(channel->getChannel(ch), block.getReadPointer(ch), numBytes);
+
+        header.requestSequence.store(++sequence, std::memory_order_release);
+        signalChange(header.requestSequence, signal, fds.toChild);
+
+        answered = waitForChange(header.responseSequence, sequence - 1, signal, fds.toParent);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            std::memcpy(block.getWritePointer(ch), channel->getChannel(ch), numBytes);
+
+        const auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        if (i >= warmUpIterations)
+            roundTripsUs.push_back(elapsed);
+    }
+
+    // Tell the child to exit
+    header.shouldExit.store(1);
+    header.requestSequence.store(++sequence, std::memory_order_release);
+    signalChange(header.requestSequence, signal, fds.toChild);
+    if (! answered)
+        kill(childId, SIGKILL);
+    waitpid(childId, nullptr, 0);
+    fds.close();
+
+    if (! answered || roundTripsUs.empty())
+    {
+        std::cerr << getName(signal) << ": child stopped answering" << std::endl;
+        return false;
+    }
+
+    result = summarise(std::move(roundTripsUs));
+    return true;
+}
+
+//==============================================================================
+
+[[nodiscard]] static std::vector<int> parseList(const juce::ArgumentList& args, const juce::String& option, std::vector<int> defaults)
+{
+    if (! args.containsOption(option))
+        return defaults;
+
+    std::vector<int> values;
+    for (const auto& token : juce::StringArray::fromTokens(args.getValueForOption(option), ",", {}))
+        if (const auto value = token.getIntValue(); value > 0)
+            values.push_back(value);
+    return values;
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ArgumentList args(argc, argv);
+
+    const auto numIterations = args.containsOption("--iterations")
+                             ? std::max(1, args.getValueForOption("--iterations").getIntValue())
+                             : 5000;
+    const auto blockSizes = parseList(args, "--block-sizes", { 32, 64, 128, 256, 512, 1024, 2048 });
+    auto channelCounts    = parseList(args, "--channels", { 1, 2, 4, 8, 16 });
+    for (auto& numChannels : channelCounts)
+        numChannels = std::min(numChannels, CyderBridgeChannel::maxNumChannels);
+
+    std::vector<Signal> signals;
+    const auto signalNames = args.containsOption("--signals")
+                           ? juce::StringArray::fromTokens(args.getValueForOption("--signals"), ",", {})
+                           : juce::StringArray { "spin", "futex", "eventfd" };
+    for (const auto signal : { Signal::spin, Signal::futex, Signal::eventfd })
+        if (signalNames.contains(getName(signal)))
+            signals.push_back(signal);
+
+    // Two spinning processes on one core only take turns at the scheduler's pace
+    if (juce::SystemStats::getNumCpus() < 2)
+    {
+        signals.erase(std::remove(signals.begin(), signals.end(), Signal::spin), signals.end());
+        std::cout << "Only one CPU, skipping spin-wait\n";
+    }
+
+    std::cout << "Iterations: " << numIterations << " per configuration\n" << std::endl;
+    std::cout << std::left  << std::setw(9) << "signal"
+              << std::right << std::setw(7) << "block"
+              << std::setw(5)  << "ch"
+              << std::setw(11) << "p50 us"
+              << std::setw(11) << "p99 us"
+              << std::setw(11) << "p99.9 us"
+              << std::setw(11) << "jitter us"
+              << std::setw(14) << "p99.9/block" << '\n';
+
+    bool passed = true;
+    for (const auto signal : signals)
+    {
+        for (const auto blockSize : blockSizes)
+        {
+            for (const auto numChannels : channelCounts)
+            {
+                Result result;
+                if (! measure(signal, blockSize, numChannels, numIterations, result))
+                {
+                    passed = false;
+                    continue;
+                }
+
+                const auto blockUs = blockSize / referenceSampleRate * 1.0e6;
+                std::cout << std::left  << std::setw(9) << getName(signal)
+                          << std::right << std::setw(7) << blockSize
+                          << std::setw(5) << numChannels
+                          << std::fixed << std::setprecision(1)
+                          << std::setw(11) << result.p50Us
+                          << std::setw(11) << result.p99Us
+                          << std::setw(11) << result.p999Us
+                          << std::setw(11) << result.jitterUs
+                          << std::setw(12) << 100.0 * result.p999Us / blockUs << " %\n";
+            }
+        }
+        std::cout << std::endl;
+    }
+
+    return passed ? 0 : 1;
+}
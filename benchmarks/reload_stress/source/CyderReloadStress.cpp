@@ -0,0 +1,307 @@
+/******************************************************************************
+ * Cyder — Hot-Reloading Audio Plugin Wrapper
+ *
+ * @file     CyderReloadStress.cpp
+ *
+ * @author   Adam Shield
+ * @date     2026-10-19
+ *
+ * @copyright (c) 2026 Adam Shield
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * See LICENSE.txt for license terms.
+ ******************************************************************************/
+
+// Reload stress test: hot reloads ExamplePlugin over and over, by touching its
+// binary, while a simulated real-time audio thread keeps calling processBlock.
+//
+// Usage:
+//   Cyder_ReloadStress [--reloads=200] [--block-size=256] [--sample-rate=48000]
+//                      [--plugin=path/to/ExamplePlugin.vst3] [--max-deadline-misses=N]
+//
+// Reports deadline misses, the longest block, leaked temp copies and resident
+// memory growth. Exits non-zero if a reload failed, a temp copy leaked, or more
+// deadlines were missed than allowed.
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <juce_core/juce_core.h>
+#include <juce_events/juce_events.h>
+
+#include "CyderAudioProcessor.hpp"
+#include "CyderTempJanitor.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+
+#if JUCE_MAC
+#include <mach/mach.h>
+#elif JUCE_LINUX
+#include <unistd.h>
+#elif JUCE_WINDOWS
+#define WIN32_LEAN_AND_MEAN // speed up compilation, prevent namespace pollution
+#include <Windows.h>
+#include <Psapi.h>
+#endif
+
+//==============================================================================
+
+/** @returns resident memory of this process in bytes, or 0 if unknown */
+[[nodiscard]] static juce::int64 getResidentSetSizeBytes() noexcept
+{
+   #if JUCE_MAC
+    mach_task_basic_info info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO, reinterpret_cast<task_info_t>(&info), &count) == KERN_SUCCESS)
+        return static_cast<juce::int64>(info.resident_size);
+    return 0;
+   #elif JUCE_LINUX
+    const auto statm = juce::File("/proc/self/statm").loadFileAsString();
+    const auto residentPages = juce::StringArray::fromTokens(statm, false)[1].getLargeIntValue();
+    return residentPages * static_cast<juce::int64>(sysconf(_SC_PAGESIZE));
+   #elif JUCE_WINDOWS
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return static_cast<juce::int64>(counters.WorkingSetSize);
+    return 0;
+   #else
+    return 0;
+   #endif
+}
+
+/** Number of plugin copies currently sitting in this process's temp session folders. */
+[[nodiscard]] static int countTempPluginCopies(const CyderTempJanitor& janitor)
+{
+    int numCopies = 0;
+    for (const auto& sessionDir : janitor.getSessionDirectories())
+        if (sessionDir.isDirectory())
+            numCopies += sessionDir.getNumberOfChildFiles(juce::File::findDirectories);
+    return numCopies;
+}
+
+//==============================================================================
+
+/**
+ Calls processBlock once per block period, like a host's audio callback,
+ holding the callback lock just like a plugin wrapper does.
+ */
+class SimulatedAudioThread final : public juce::Thread
+{
+public:
+    SimulatedAudioThread(CyderAudioProcessor& _processor, double _sampleRate, int _blockSize)
+    : juce::Thread("Simulated Audio Thread")
+    , processor(_processor)
+    , sampleRate(_sampleRate)
+    , blockSize(_blockSize)
+    , buffer(2, _blockSize)
+    {
+        const auto options = juce::Thread::RealtimeOptions{}.withApproximateAudioProcessingTime(blockSize, sampleRate);
+        if (! startRealtimeThread(options))
+            startThread(juce::Thread::Priority::highest);
+    }
+
+    ~SimulatedAudioThread() override
+    {
+        stopThread(2000);
+    }
+
+    std::atomic<juce::int64> numBlocks { 0 };
+    std::atomic<juce::int64> numDeadlineMisses { 0 };
+    std::atomic<double> maxBlockTimeMs { 0.0 };
+
+    [[nodiscard]] double getBlockPeriodMs() const noexcept { return 1000.0 * blockSize / sampleRate; }
+
+private:
+    CyderAudioProcessor& processor;
+    const double sampleRate;
+    const int blockSize;
+
+    juce::AudioBuffer<float> buffer;
+    juce::MidiBuffer midi;
+    juce::Random random;
+
+    void run() override
+    {
+        const auto periodMs = getBlockPeriodMs();
+        auto blockStart = juce::Time::getMillisecondCounterHiRes();
+
+        while (! threadShouldExit())
+        {
+            const auto deadline = blockStart + periodMs;
+
+            for (int channel = 0; channel < buffer.getNumChannels(); ++channel)
+                for (int i = 0; i < blockSize; ++i)
+                    buffer.setSample(channel, i, random.nextFloat() * 2.0f - 1.0f);
+
+            const auto start = juce::Time::getMillisecondCounterHiRes();
+            {
+                const juce::ScopedLock lock(processor.getCallbackLock());
+                processor.processBlock(buffer, midi);
+            }
+            const auto end = juce::Time::getMillisecondCounterHiRes();
+            midi.clear();
+
+            ++numBlocks;
+            if (end > deadline)
+                ++numDeadlineMisses;
+            if (end - start > maxBlockTimeMs.load())
+                maxBlockTimeMs = end - start;
+
+            // Next callback is due one period after this one, or straight away if we are running late
+            blockStart = std::max(deadline, end);
+            for (auto now = end; now < blockStart && ! threadShouldExit(); now = juce::Time::getMillisecondCounterHiRes())
+            {
+                if (blockStart - now > 2.0)
+                    juce::Thread::sleep(static_cast<int>(blockStart - now) - 1);
+                else
+                    juce::Thread::yield();
+            }
+        }
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SimulatedAudioThread)
+};
+
+//==============================================================================
+
+/** Bumps the modification time of every file in the bundle, like a rebuild would. */
+static void touchPlugin(const juce::File& pluginFile, juce::Time& lastTouch)
+{
+    // Always move forward by at least a second, filesystems with coarse timestamps would miss it otherwise
+    const auto touchTime = std::max(juce::Time::getCurrentTime(), lastTouch + juce::RelativeTime::seconds(1.0));
+    lastTouch = touchTime;
+
+    pluginFile.setLastModificationTime(touchTime);
+    for (const auto& entry : juce::RangedDirectoryIterator(pluginFile, true, "*", juce::File::findFiles))
+        entry.getFile().setLastModificationTime(touchTime);
+}
+
+/** Runs the message loop until the processor reports the outcome of a reload. */
+[[nodiscard]] static bool waitForReload(CyderAudioProcessor& processor, int timeoutMs)
+{
+    const auto giveUpTime = juce::Time::getMillisecondCounter() + static_cast<juce::uint32>(timeoutMs);
+
+    while (juce::Time::getMillisecondCounter() < giveUpTime)
+    {
+        juce::MessageManager::getInstance()->runDispatchLoopUntil(20);
+
+        const auto status = processor.getCurrentStatus();
+        if (status == CyderStatus::successfullyReloadedPlugin)
+            return true;
+        if (status == CyderStatus::failedToReloadPlugin)
+            return false;
+    }
+
+    return false;
+}
+
+//==============================================================================
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser; // plugins expect a message thread
+
+    juce::ArgumentList args(argc, argv);
+
+    auto getIntOption = [&args](const juce::String& option, int defaultValue)
+    {
+        return args.containsOption(option) ? args.getValueForOption(option).getIntValue() : defaultValue;
+    };
+
+    const auto numReloads        = std::max(1, getIntOption("--reloads", 200));
+    const auto blockSize         = std::max(16, getIntOption("--block-size", 256));
+    const auto sampleRate        = static_cast<double>(std::max(8000, getIntOption("--sample-rate", 48000)));
+    const auto maxDeadlineMisses = getIntOption("--max-deadline-misses", std::numeric_limits<int>::max());
+
+    // ExamplePlugin.vst3 is copied into the root directory when it is built
+    auto pluginFile = juce::File(__FILE__).getParentDirectory() // "source"
+                                          .getParentDirectory() // "reload_stress"
+                                          .getParentDirectory() // "benchmarks"
+                                          .getParentDirectory() // root dir
+                                          .getChildFile("ExamplePlugin")
+                                          .withFileExtension("vst3");
+    if (args.containsOption("--plugin"))
+        pluginFile = juce::File::getCurrentWorkingDirectory().getChildFile(args.getValueForOption("--plugin"));
+
+    if (! pluginFile.exists())
+    {
+        std::cerr << "Plugin not found: " << pluginFile.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    // Held here so it outlives the processor, letting us see what it failed to delete
+    juce::SharedResourcePointer<CyderTempJanitor> janitor;
+    const auto tempCopiesBefore = countTempPluginCopies(*janitor);
+
+    int numFailedReloads = 0;
+    juce::int64 residentBytesAfterWarmUp = 0;
+    juce::int64 residentBytesAtEnd = 0;
+    juce::int64 numBlocks = 0;
+    juce::int64 numDeadlineMisses = 0;
+    double maxBlockTimeMs = 0.0;
+    double blockPeriodMs = 0.0;
+
+    {
+        CyderAudioProcessor processor;
+        processor.setPlayConfigDetails(2, 2, sampleRate, blockSize);
+        processor.prepareToPlay(sampleRate, blockSize);
+
+        if (! processor.loadPlugin(pluginFile.getFullPathName()))
+        {
+            std::cerr << "Failed to load plugin: " << pluginFile.getFullPathName() << std::endl;
+            return 1;
+        }
+
+        SimulatedAudioThread audioThread(processor, sampleRate, blockSize);
+        blockPeriodMs = audioThread.getBlockPeriodMs();
+
+        juce::Time lastTouch;
+        for (int i = 0; i < numReloads; ++i)
+        {
+            processor.getCurrentStatusAndClear();
+            touchPlugin(pluginFile, lastTouch);
+
+            if (! waitForReload(processor, /*timeoutMs*/ 10000))
+            {
+                ++numFailedReloads;
+                std::cerr << "Reload " << i + 1 << " failed or timed out" << std::endl;
+            }
+
+            // Measure growth from after the first reload, once everything lazily allocated exists
+            if (i == 0)
+                residentBytesAfterWarmUp = getResidentSetSizeBytes();
+
+            if ((i + 1) % 25 == 0)
+                std::cout << "Reloaded " << i + 1 << "/" << numReloads << std::endl;
+        }
+
+        residentBytesAtEnd = getResidentSetSizeBytes();
+
+        audioThread.stopThread(2000);
+        numBlocks         = audioThread.numBlocks.load();
+        numDeadlineMisses = audioThread.numDeadlineMisses.load();
+        maxBlockTimeMs    = audioThread.maxBlockTimeMs.load();
+
+        processor.unloadPlugin();
+        processor.releaseResources();
+    }
+
+    // Give the janitor a chance to delete everything retired, retrying while the OS holds on to modules
+    janitor->waitUntilIdle(10000);
+    const auto leakedTempCopies = std::max(0, countTempPluginCopies(*janitor) - tempCopiesBefore);
+
+    std::cout << "Reloads:             " << numReloads - numFailedReloads << "/" << numReloads << " succeeded\n"
+              << "Blocks processed:    " << numBlocks << " (" << blockSize << " samples @ " << sampleRate << " Hz)\n"
+              << "Deadline misses:     " << numDeadlineMisses << "\n"
+              << "Max block time:      " << maxBlockTimeMs << " ms (budget " << blockPeriodMs << " ms)\n"
+              << "Leaked temp copies:  " << leakedTempCopies << "\n"
+              << "Resident growth:     " << (residentBytesAtEnd - residentBytesAfterWarmUp) / 1024 << " KiB"
+              << " over " << numReloads - 1 << " reloads" << std::endl;
+
+    const bool passed = numFailedReloads == 0
+                     && leakedTempCopies == 0
+                     && numDeadlineMisses <= maxDeadlineMisses;
+    return passed ? 0 : 1;
+}
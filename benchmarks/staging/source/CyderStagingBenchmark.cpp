@@ -0,0 +1,177 @@
+/******************************************************************************
+ * Cyder — Hot-Reloading Audio Plugin Wrapper
+ *
+ * @file     CyderStagingBenchmark.cpp
+ *
+ * @author   Adam Shield
+ * @date     2026-10-19
+ *
+ * @copyright (c) 2026 Adam Shield
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * See LICENSE.txt for license terms.
+ ******************************************************************************/
+
+// Staging benchmark: times the steps of a reload (copy the bundle, scan it, create
+// an instance) with copies staged on disk and, where available, in RAM, and on
+// Linux with the module served from a memfd.
+//
+// Usage:
+//   Cyder_StagingBenchmark [--iterations=20] [--plugin=path/to/ExamplePlugin.vst3]
+//
+// Reports median and worst times for each step, per staging location.
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <juce_core/juce_core.h>
+#include <juce_events/juce_events.h>
+
+#include "CyderTempJanitor.hpp"
+#include "Utilities.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+//==============================================================================
+
+struct StepTimes
+{
+    std::vector<double> copyMs;
+    std::vector<double> scanMs;
+    std::vector<double> instantiateMs;
+    std::vector<double> totalMs;
+};
+
+[[nodiscard]] static double getMedian(std::vector<double> values)
+{
+    if (values.empty())
+        return 0.0;
+
+    std::sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+[[nodiscard]] static double getWorst(const std::vector<double>& values)
+{
+    return values.empty() ? 0.0 : *std::max_element(values.begin(), values.end());
+}
+
+static void printStep(const char* name, const std::vector<double>& valuesMs)
+{
+    std::cout << "  " << std::left << std::setw(13) << name << std::right << std::fixed << std::setprecision(2)
+              << "median " << std::setw(8) << getMedian(valuesMs) << " ms"
+              << "   worst " << std::setw(8) << getWorst(valuesMs) << " ms\n";
+}
+
+/** Reloads the plugin the way CyderAudioProcessor::loadPlugin() does, timing each step. */
+[[nodiscard]] static bool runIterations(const juce::File& pluginFile, int numIterations, StepTimes& times)
+{
+    juce::AudioPluginFormatManager formatManager;
+    formatManager.addDefaultFormats();
+
+    for (int i = 0; i < numIterations; ++i)
+    {
+        try
+        {
+            const auto start = juce::Time::getMillisecondCounterHiRes();
+            const auto pluginCopy = Utilities::copyPluginToTemp(pluginFile);
+            const auto copied = juce::Time::getMillisecondCounterHiRes();
+
+            auto description = Utilities::findPluginDescription(pluginCopy, formatManager);
+            const auto scanned = juce::Time::getMillisecondCounterHiRes();
+
+            auto instance = Utilities::createInstance(description, formatManager, 48000.0, 256);
+            const auto instantiated = juce::Time::getMillisecondCounterHiRes();
+
+            times.copyMs.push_back(copied - start);
+            times.scanMs.push_back(scanned - copied);
+            times.instantiateMs.push_back(instantiated - scanned);
+            times.totalMs.push_back(instantiated - start);
+
+            instance.reset();
+            Utilities::deleteStalePlugin(pluginCopy);
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "Reload " << i + 1 << " failed: " << e.what() << std::endl;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//==============================================================================
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser; // plugins expect a message thread
+    juce::SharedResourcePointer<CyderTempJanitor> janitor;
+
+    juce::ArgumentList args(argc, argv);
+
+    const auto numIterations = args.containsOption("--iterations")
+                             ? std::max(1, args.getValueForOption("--iterations").getIntValue())
+                             : 20;
+
+    // ExamplePlugin.vst3 is copied into the root directory when it is built
+    auto pluginFile = juce::File(__FILE__).getParentDirectory() // "source"
+                                          .getParentDirectory() // "staging"
+                                          .getParentDirectory() // "benchmarks"
+                                          .getParentDirectory() // root dir
+                                          .getChildFile("ExamplePlugin")
+                                          .withFileExtension("vst3");
+    if (args.containsOption("--plugin"))
+        pluginFile = juce::File::getCurrentWorkingDirectory().getChildFile(args.getValueForOption("--plugin"));
+
+    if (! pluginFile.exists())
+    {
+        std::cerr << "Plugin not found: " << pluginFile.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    const auto bundleBytes = CyderTempJanitor::getSizeOnDisk(pluginFile);
+    std::cout << "Plugin: " << pluginFile.getFullPathName()
+              << " (" << juce::File::descriptionOfSizeInBytes(bundleBytes) << ")\n"
+              << "Iterations: " << numIterations << "\n" << std::endl;
+
+    struct Location
+    {
+        const char* name;
+        CyderTempJanitor::StagingLocation location;
+        juce::File root;
+    };
+
+    std::vector<Location> locations { { "disk", CyderTempJanitor::StagingLocation::disk, CyderTempJanitor::getTempRoot() } };
+    if (CyderTempJanitor::canStageInRam(bundleBytes))
+        locations.push_back({ "ram", CyderTempJanitor::StagingLocation::ram, CyderTempJanitor::getRamRoot() });
+    else
+        std::cout << "RAM staging unavailable on this machine, benchmarking disk only\n" << std::endl;
+
+   #if JUCE_LINUX
+    // Only the links around the memfd are written to a folder
+    locations.push_back({ "memory", CyderTempJanitor::StagingLocation::memory,
+                          CyderTempJanitor::canStageInRam(0) ? CyderTempJanitor::getRamRoot() : CyderTempJanitor::getTempRoot() });
+   #endif
+
+    bool passed = true;
+    for (const auto& location : locations)
+    {
+        janitor->setStagingLocation(location.location);
+
+        StepTimes times;
+        passed = runIterations(pluginFile, numIterations, times) && passed;
+
+        std::cout << location.name << " (" << location.root.getFullPathName() << ")\n";
+        printStep("copy", times.copyMs);
+        printStep("scan", times.scanMs);
+        printStep("instantiate", times.instantiateMs);
+        printStep("total", times.totalMs);
+        std::cout << std::endl;
+
+        janitor->waitUntilIdle(10000);
+    }
+
+    return passed ? 0 : 1;
+}
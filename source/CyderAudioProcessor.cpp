@@ -16,77 +16,27 @@
 
 #include "CyderAudioProcessorEditor.hpp"
 #include "CyderAssert.hpp"
+#include "CyderChannelMap.hpp"
+#include "CyderDelayLine.hpp"
 #include "HotReloadThread.hpp"
 #include "Utilities.hpp"
 
+#include <algorithm>
 #include <atomic>
-#include <limits>
 #include <memory>
+#include <stdexcept>
 #include <utility>
 
 //==============================================================================
 
-//#if JUCE_WINDOWS
 static std::atomic<int> numInstances = 0;
 
-/** */
-void deleteCyderPluginsTempDirectoryAfterShutdown() noexcept
-{
-    // Cleanup entire fold
-    auto cyderTempParentFolder = juce::File::getSpecialLocation(juce::File::tempDirectory).getChildFile("CyderPlugins");
-    if (! cyderTempParentFolder.exists())
-        return;
-
-    auto folderToDeleteAsString = cyderTempParentFolder.getFullPathName();
-
-    // Build a cmd line that:
-    //   1) Waits a couple of seconds (so the parent process has *really* exited).
-    //   2) Then deletes the directory tree.
-    // The Windows “timeout” command will sleep without needing extra tools:
-    auto cmd = juce::String("cmd /C timeout /T 2 /NOBREAK >nul && ")
-        + "rmdir /S /Q \"" + folderToDeleteAsString + "\"";
-
-    juce::ChildProcess deleter;
-    // By default JUCE’s ChildProcess uses CreateProcess with bInheritHandles = FALSE,
-    // so the child won’t inherit *any* of your open handles.
-    deleter.start(cmd);
-}
-//#endif  JUCE_WINDOWS
-
-/**
-  FYI - Must pass by value instead of const ref to ensure thread does not have dangling ref...
-*/
-void deleteStalePlugin(juce::File pluginToDelete) noexcept
-{
-    // Cleanup: Delete copied plugin
-    if (pluginToDelete.exists())
-    {
-        #if JUCE_WINDOWS
-        // Windows requires a pause before deleting the copied plugin so we 
-        // can do that in another thread to not hold up main thread
-        std::thread cleanupWorkerThread([=]
-        {
-            juce::Thread::sleep(1000);
-        #endif
+/** What plugins are instantiated with before the host has ever prepared us. */
+static constexpr double defaultSampleRate = 44100.0;
+static constexpr int    defaultBlockSize  = 512;
 
-            bool didCleanUp = pluginToDelete.deleteRecursively();
-            if (didCleanUp)
-                DBG("Successfully deleted unloaded plugin copy");
-            else
-            {
-                DBG("Failed to delete unloaded plugin copy");
-                #if JUCE_MAC 
-                // we cannot guarantee immediate cleanup on PC, so we'll try again later on shutdown
-                CYDER_ASSERT_FALSE;
-                #endif
-            }
-
-        #if JUCE_WINDOWS
-        });
-        cleanupWorkerThread.detach(); // Don't wait for it to finish
-        #endif
-    }
-}
+/** Room for the state of every note, plus a generous block of incoming MIDI. */
+static constexpr size_t takeoverMidiBytes = CyderMidiState::maxStateBytes + 16 * 1024;
 
 //==============================================================================
 CyderAudioProcessor::CyderAudioProcessor()
@@ -95,55 +45,124 @@ CyderAudioProcessor::CyderAudioProcessor()
  #if ! JucePlugin_IsMidiEffect
  #if ! JucePlugin_IsSynth
         .withInput ("Input", juce::AudioChannelSet::stereo(), true)
+        .withInput ("Sidechain", juce::AudioChannelSet::stereo(), false)
  #endif
         .withOutput ("Output", juce::AudioChannelSet::stereo(), true)
  #endif
      )
 #endif
 {
-//#if JUCE_WINDOWS
     ++numInstances;
     jassert(numInstances==1);
-//#endif
+    
+    addParameter(bypassParameter = new juce::AudioParameterBool(juce::ParameterID("bypass", 1), "Bypass", false));
+    dryDelay = std::make_unique<CyderDelayLine>();
+    
+    pluginChain.onLatencyChanged = [this] { updateLatencySamples(); };
+    pluginGraph.onLatencyChanged = [this] { updateLatencySamples(); };
+    pluginChain.setRealtimeGuard(&realtimeGuard);
+    pluginGraph.setRealtimeGuard(&realtimeGuard);
+    
+    watchdog.onTripped = [this](const CyderWatchdog::Event& event)
+    {
+        // Takes effect as soon as the audio thread gets out of the plugin, if it ever does
+        setBypassed(true);
+        juce::Logger::writeToLog("Wrapped plugin " + event.describe() + ", bypassed Cyder"
+                                 + (event.stackSample.isNotEmpty() ? "\n" + event.stackSample : juce::String()));
+        
+        juce::MessageManager::callAsync([safeThis = juce::WeakReference<CyderAudioProcessor>(this)]
+        {
+            if (! safeThis.wasObjectDeleted())
+                safeThis->currentStatus = CyderStatus::wrappedPluginOverran;
+        });
+    };
 }
 
 CyderAudioProcessor::~CyderAudioProcessor()
 {
+    watchdog.stop();
     if (hotReloadThread != nullptr)
-        hotReloadThread->stopThread(1500);
+        hotReloadThread->stop();
+    cancelNullTest();
     unloadPlugin();
+    
+    pluginChain.onLatencyChanged = nullptr;
+    pluginChain.clear();
+    pluginGraph.onLatencyChanged = nullptr;
+    pluginGraph.clear();
 
     --numInstances;
-#if JUCE_WINDOWS
-    if (--numInstances <= 0)
-        deleteCyderPluginsTempDirectoryAfterShutdown();
-#endif
 }
 
 void CyderAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
-    if (wrappedPlugin == nullptr)
-        return;
+    isPreparedToPlay = true;
+    if (sampleRate > 0.0 && samplesPerBlock > 0)
+    {
+        lastValidSampleRate = sampleRate;
+        lastValidBlockSize  = samplesPerBlock;
+    }
     
-    // Wrapped plugin can only be mono or stereo
-    // If Cyder is mono-to-stereo, then wrapped plugin must be stereo
-    bool isStereo = getTotalNumOutputChannels();
-    bool wrappedPluginIsStereo = wrappedPlugin->getTotalNumOutputChannels();
-    auto numChannels = isStereo ? 2 : 1;
+    const auto numChannels = std::max(1, getMainBusNumOutputChannels());
     
-    if (isStereo != wrappedPluginIsStereo)
+    // Preallocate so the audio thread never has to
+    monoToStereoBuffer.setSize(/*numChannels*/2,
+                               /*numSamples*/samplesPerBlock,
+                               /*keepExistingContent*/false,
+                               /*clearExtraSpace*/false,
+                               /*avoidReallocating*/true);
+    dryBuffer.setSize(numChannels,
+                      samplesPerBlock,
+                      /*keepExistingContent*/false,
+                      /*clearExtraSpace*/false,
+                      /*avoidReallocating*/true);
+    dryDelay->prepare(numChannels,
+                      std::max(getLatencyCeilingSamples(), static_cast<int>(sampleRate)), // a second of latency
+                      samplesPerBlock);
+    dryMix.reset(sampleRate, bypassFadeSeconds);
+    updateWatchdog();
+    const bool nothingLoaded = wrappedPlugin == nullptr && processBridge == nullptr && pluginChain.isEmpty() && pluginGraph.isEmpty();
+    dryMix.setCurrentAndTargetValue(nothingLoaded || isBypassed() ? 1.0f : 0.0f);
+    
+    {
+        const juce::ScopedLock lock(getCallbackLock());
+        takeoverMidi.ensureSize(takeoverMidiBytes);
+        midiState.reset(); // hosts stop all notes around prepareToPlay
+    }
+    
+    pluginChain.prepareToPlay(numChannels, sampleRate, samplesPerBlock);
+    pluginGraph.prepareToPlay(numChannels, sampleRate, samplesPerBlock);
+    prepareLatencyPadding(samplesPerBlock);
+    
+    if (processBridge != nullptr)
     {
-        wrappedPlugin->setPlayConfigDetails(numChannels, // input
-                                            numChannels, // output
-                                            sampleRate,
-                                            samplesPerBlock);
+        processBridge->prepare(sampleRate, samplesPerBlock); // relaunches the child, if the settings changed
+        updateLatencySamples();
     }
     
+    if (wrappedPlugin == nullptr)
+        return;
+    
+    // The host may have changed our layout since the plugin was loaded
+    mirrorBusesLayout(*wrappedPlugin, sampleRate, samplesPerBlock);
     wrappedPlugin->prepareToPlay(sampleRate, samplesPerBlock);
+    
+    auto newChannelMap = std::make_unique<CyderChannelMap>();
+    newChannelMap->prepare(*this, *wrappedPlugin, samplesPerBlock);
+    {
+        const juce::ScopedLock lock(getCallbackLock());
+        std::swap(wrappedChannelMap, newChannelMap);
+    }
 }
 
 void CyderAudioProcessor::releaseResources()
 {
+    isPreparedToPlay = false;
+    updateWatchdog();
+    
+    pluginChain.releaseResources();
+    pluginGraph.releaseResources();
+    
     if (wrappedPlugin == nullptr)
         return;
     
@@ -155,9 +174,8 @@ bool CyderAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) co
     // Get the main output bus layout
     auto mainOut = layouts.getMainOutputChannelSet();
 
-    // Only allow mono or stereo
-    if (mainOut != juce::AudioChannelSet::mono()
-        && mainOut != juce::AudioChannelSet::stereo())
+    // Anything from mono up to 7.1.4. Whatever we host is mirrored to it, or mapped onto it by speaker.
+    if (mainOut.isDisabled() || mainOut.size() > maxNumMainChannels)
         return false;
 
     // Require input layout to match output
@@ -165,18 +183,82 @@ bool CyderAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) co
     if (mainIn != mainOut)
         return false;
 
+    // Sidechain is optional, and never wider than the main bus
+    if (layouts.inputBuses.size() > 1)
+    {
+        const auto sidechain = layouts.getChannelSet(/*isInput*/ true, /*busIndex*/ 1);
+        if (! sidechain.isDisabled() && sidechain.size() > mainOut.size())
+            return false;
+    }
+
     return true;
 }
 
 void CyderAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
-    if (wrappedPlugin == nullptr)
+    const CyderRealtimeGuard::ScopedBlock realtimeGuardBlock(realtimeGuard);
+    
+    const auto numSamples = buffer.getNumSamples();
+    const bool nothingLoaded = wrappedPlugin == nullptr && processBridge == nullptr && pluginChain.isEmpty() && pluginGraph.isEmpty();
+    
+    if (numSamples > dryBuffer.getNumSamples()) // not prepared for this, no dry signal to fall back on
+    {
+        processHostedPlugins(buffer, midiMessages);
+        return;
+    }
+    
+    // Keep the dry signal flowing, lined up with the latency the host compensates for
+    const auto numDryChannels = std::min(buffer.getNumChannels(), dryBuffer.getNumChannels());
+    for (int channel = 0; channel < numDryChannels; ++channel)
+        dryBuffer.copyFrom(channel, 0, buffer, channel, 0, numSamples);
+    {
+        juce::AudioBuffer<float> dryBlock(dryBuffer.getArrayOfWritePointers(), numDryChannels, numSamples);
+        dryDelay->process(dryBlock);
+    }
+    
+    dryMix.setTargetValue(nothingLoaded || isBypassed() ? 1.0f : 0.0f);
+    
+    // Fully dry: nothing we host needs to run
+    if (! dryMix.isSmoothing() && dryMix.getCurrentValue() >= 1.0f)
+    {
+        midiState.process(midiMessages); // still following the notes, for when processing resumes
+        for (int channel = 0; channel < numDryChannels; ++channel)
+            buffer.copyFrom(channel, 0, dryBuffer, channel, 0, numSamples);
+        return;
+    }
+    
+    processHostedPlugins(buffer, midiMessages);
+    
+    if (! dryMix.isSmoothing())
+        return;
+    
+    // Crossfade between processed and dry
+    auto* const* processed = buffer.getArrayOfWritePointers();
+    const auto* const* dry = dryBuffer.getArrayOfReadPointers();
+    for (int i = 0; i < numSamples; ++i)
+    {
+        const auto dryGain = dryMix.getNextValue();
+        for (int channel = 0; channel < numDryChannels; ++channel)
+            processed[channel][i] += dryGain * (dry[channel][i] - processed[channel][i]);
+    }
+}
+
+void CyderAudioProcessor::processHostedPlugins(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    if (wrappedPlugin == nullptr && processBridge == nullptr && ! pendingRestore.has_value() && pluginChain.isEmpty() && pluginGraph.isEmpty())
         return;
     
     auto playhead = getPlayHead();
-    wrappedPlugin->setPlayHead(playhead);
+    if (wrappedPlugin != nullptr)
+        wrappedPlugin->setPlayHead(playhead);
+    pluginChain.setPlayHead(playhead);
+    pluginGraph.setPlayHead(playhead);
     
-    const bool wrappedPluginIsStereo = (2 == wrappedPlugin->getTotalNumOutputChannels());
+    const auto wrappedNumChannels = wrappedPlugin != nullptr ? wrappedPlugin->getMainBusNumOutputChannels()
+                                  : processBridge != nullptr ? processBridge->getNumChannels()
+                                                             : (pluginChain.isEmpty() ? pluginGraph.getNumChannels()
+                                                                                      : pluginChain.getNumChannels());
+    const bool wrappedPluginIsStereo = (2 == wrappedNumChannels);
     const auto numChannels = buffer.getNumChannels();
     const bool monoBufferGivenToStereoPlugin = (wrappedPluginIsStereo && numChannels==1);
     
@@ -184,7 +266,61 @@ void CyderAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::
     if (monoBufferGivenToStereoPlugin)
         processUsingMonoToStereoBuffer(buffer, midiMessages);
     else
-        wrappedPlugin->processBlock(buffer, midiMessages);
+        processWrappedPlugins(buffer, midiMessages);
+}
+
+void CyderAudioProcessor::processWrappedPlugins(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    // Automation from the host lands before the plugin processes
+    parameterProxies.processPendingHostChanges();
+    
+    if (wrappedPlugin != nullptr || processBridge != nullptr)
+    {
+        // Handed over as-is unless the plugin's channel order differs from the host's.
+        // The mono-to-stereo buffer is already laid out the way the plugin wants it.
+        auto& wrappedBuffer = (wrappedChannelMap != nullptr && &buffer != &monoToStereoBuffer) ? wrappedChannelMap->map(buffer)
+                                                                                               : buffer;
+        
+        // Out of process, a block the child misses is left dry
+        auto processWrappedPlugin = [&](juce::MidiBuffer& midi)
+        {
+            const CyderWatchdog::ScopedProcess watchdogScope(watchdog, wrappedBuffer.getNumSamples());
+            
+            // Only what happens in here is blamed on the plugin we host
+            const CyderRealtimeGuard::ScopedScope wrappedScope(realtimeGuard, CyderRealtimeGuard::Scope::wrappedPlugin);
+            if (wrappedPlugin != nullptr)
+                wrappedPlugin->processBlock(wrappedBuffer, midi);
+            else
+                processBridge->process(wrappedBuffer, midi);
+        };
+        
+        if (std::exchange(midiTakeoverPending, false))
+        {
+            // New instance takes over with the notes the previous one was playing, then this block's events
+            takeoverMidi.clear();
+            midiState.addStateTo(takeoverMidi, /*samplePosition*/ 0);
+            takeoverMidi.addEvents(midiMessages, 0, -1, 0);
+            midiState.process(midiMessages);
+            
+            processWrappedPlugin(takeoverMidi);
+            midiMessages.swapWith(takeoverMidi); // whatever it produced carries on down the chain
+        }
+        else
+        {
+            midiState.process(midiMessages);
+            processWrappedPlugin(midiMessages);
+        }
+    }
+    
+    // Each chained plugin picks up where the previous one left off, in the same buffer
+    pluginChain.processBlock(buffer, midiMessages);
+    
+    // Then split into parallel branches and mix them back together
+    pluginGraph.processBlock(buffer, midiMessages);
+    
+    // Pad up to the fixed latency the host was told about
+    if (latencyPadding != nullptr)
+        latencyPadding->process(buffer);
 }
 
 void CyderAudioProcessor::processUsingMonoToStereoBuffer(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
@@ -197,7 +333,7 @@ void CyderAudioProcessor::processUsingMonoToStereoBuffer(juce::AudioBuffer<float
     monoToStereoBuffer.copyFrom(0, 0, buffer, 0, 0, buffer.getNumSamples());
     monoToStereoBuffer.copyFrom(1, 0, buffer, 0, 0, buffer.getNumSamples());
     
-    wrappedPlugin->processBlock(monoToStereoBuffer, midiMessages);
+    processWrappedPlugins(monoToStereoBuffer, midiMessages);
     
     buffer.copyFrom(0, 0, monoToStereoBuffer, 0, 0, buffer.getNumSamples());
 }
@@ -234,7 +370,35 @@ bool CyderAudioProcessor::isMidiEffect() const
 
 double CyderAudioProcessor::getTailLengthSeconds() const
 {
-    return std::numeric_limits<double>::infinity();
+    // Hosts ask from any thread, while plugins are swapped in and out under this lock
+    const juce::ScopedLock lock(getCallbackLock());
+    
+    auto tailSeconds = wrappedPlugin != nullptr ? wrappedPlugin->getTailLengthSeconds()
+                     : processBridge != nullptr ? processBridge->getTailLengthSeconds()
+                                                : 0.0;
+    tailSeconds += pluginChain.getTotalTailLengthSeconds();
+    tailSeconds += pluginGraph.getTailLengthSeconds();
+    
+    // Output keeps coming for as long as we delay it
+    if (const auto sampleRate = getSampleRate(); sampleRate > 0.0)
+        tailSeconds += getLatencySamples() / sampleRate;
+    
+    return tailSeconds;
+}
+
+juce::AudioProcessorParameter* CyderAudioProcessor::getBypassParameter() const
+{
+    return bypassParameter;
+}
+
+void CyderAudioProcessor::setBypassed(bool shouldBeBypassed)
+{
+    bypassParameter->setValueNotifyingHost(shouldBeBypassed ? 1.0f : 0.0f);
+}
+
+bool CyderAudioProcessor::isBypassed() const noexcept
+{
+    return bypassParameter->get();
 }
 
 int CyderAudioProcessor::getNumPrograms()
@@ -262,22 +426,62 @@ void CyderAudioProcessor::changeProgramName (int /*index*/, const juce::String&
 
 void CyderAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
-    if (wrappedPlugin == nullptr)
+    if (wrappedPlugin == nullptr && processBridge == nullptr && pluginChain.isEmpty() && pluginGraph.isEmpty()
+        && ! isRestoringState())
         return;
 
     // Build XML root element
     auto xml = std::make_unique<juce::XmlElement>(JucePlugin_Name);
     xml->setAttribute("version", JucePlugin_VersionString);
-    xml->setAttribute("pluginFilePath", currentPluginFileOriginal.getFullPathName());
+    
+    if (const auto ceiling = getLatencyCeilingSamples(); ceiling > 0)
+        xml->setAttribute("latencyCeilingSamples", ceiling);
+    
+    if (outOfProcessHosting)
+        xml->setAttribute("outOfProcessHosting", true);
+    
+    if (const auto& savedBuildSettings = unconfirmedBuildSettings.value_or(buildSettings); savedBuildSettings.command.isNotEmpty())
+    {
+        auto* buildElem = xml->createNewChildElement("Build");
+        buildElem->setAttribute("sourceDirectory", savedBuildSettings.sourceDirectory.getFullPathName());
+        buildElem->setAttribute("command", savedBuildSettings.command);
+        if (savedBuildSettings.logFile != juce::File())
+            buildElem->setAttribute("logFile", savedBuildSettings.logFile.getFullPathName());
+    }
 
-    // Serialize wrapped plugin state
-    juce::MemoryBlock pluginData;
-    wrappedPlugin->getStateInformation(pluginData);
-    auto base64Data = juce::Base64::toBase64(pluginData.getData(), pluginData.getSize());
+    if (wrappedPlugin != nullptr || processBridge != nullptr)
+    {
+        xml->setAttribute("pluginFilePath", currentPluginFileOriginal.getFullPathName());
 
-    // Embed the base64-encoded state
-    auto* stateElem = xml->createNewChildElement("WrappedPluginState");
-    stateElem->addTextElement(base64Data);
+        // Serialize wrapped plugin state
+        juce::MemoryBlock pluginData;
+        getWrappedPluginState(pluginData);
+        auto base64Data = juce::Base64::toBase64(pluginData.getData(), pluginData.getSize());
+
+        // Embed the base64-encoded state
+        auto* stateElem = xml->createNewChildElement("WrappedPluginState");
+        stateElem->addTextElement(base64Data);
+    }
+    else if (pendingRestore.has_value())
+    {
+        // Still being restored, so saved exactly as it was restored
+        xml->setAttribute("pluginFilePath", pendingRestore->pluginFile.getFullPathName());
+        
+        if (const auto& pluginData = pendingRestore->wrappedState; pluginData.has_value())
+        {
+            auto* stateElem = xml->createNewChildElement("WrappedPluginState");
+            stateElem->addTextElement(juce::Base64::toBase64(pluginData->getData(), pluginData->getSize()));
+        }
+    }
+
+    // Serialize parameter mapping
+    parameterProxies.saveState(*xml);
+    
+    // Serialize plugin chain
+    pluginChain.saveState(*xml);
+    
+    // Serialize plugin graph
+    pluginGraph.saveState(*xml);
 
     // Convert XML to UTF-8 and write into destData
     auto xmlString = xml->toString();
@@ -294,29 +498,84 @@ void CyderAudioProcessor::setStateInformation (const void* data, int sizeInBytes
     if (xml == nullptr || ! xml->hasTagName("Cyder"))
         return;
     
-    // Restore plugin file path
+    // Restore latency ceiling first, so plugins loaded below never change reported latency
+    setLatencyCeilingSamples(xml->getIntAttribute("latencyCeilingSamples", 0));
+    
+    // Restore build settings before loading, so the plugin is watched for source changes right away.
+    // A session may come from anyone, so a command we aren't already running waits to be confirmed.
     {
-        auto savedPathString = xml->getStringAttribute("pluginFilePath");
-        unloadPlugin();
-        loadPlugin(savedPathString);
+        CyderBuildSettings restoredBuildSettings;
+        if (auto* buildElem = xml->getChildByName("Build"))
+        {
+            restoredBuildSettings.sourceDirectory = juce::File(buildElem->getStringAttribute("sourceDirectory"));
+            restoredBuildSettings.command         = buildElem->getStringAttribute("command");
+            if (const auto logPath = buildElem->getStringAttribute("logFile"); juce::File::isAbsolutePath(logPath))
+                restoredBuildSettings.logFile = juce::File(logPath);
+        }
+        
+        const bool isAlreadyInUse = restoredBuildSettings.sourceDirectory == buildSettings.sourceDirectory
+                                    && restoredBuildSettings.command == buildSettings.command
+                                    && restoredBuildSettings.logFile == buildSettings.logFile;
+        if (restoredBuildSettings.command.isEmpty() || isAlreadyInUse)
+        {
+            buildSettings = restoredBuildSettings;
+            unconfirmedBuildSettings.reset();
+        }
+        else
+        {
+            buildSettings = {};
+            unconfirmedBuildSettings = restoredBuildSettings;
+        }
     }
     
-    if (wrappedPlugin == nullptr) // something went wrong when loading wrapped plugin from saved state
+    // Restore parameter mapping before loading, so the plugin is mapped the way it was saved
+    parameterProxies.restoreState(*xml);
+    
+    // Restore plugin chain and graph. Their plugins are prepared in the background too, passing audio through until they are in.
+    pluginChain.restoreState(*xml);
+    pluginGraph.restoreState(*xml);
+    
+    // Restore hosting mode before loading, so the plugin is loaded the way it was saved
+    outOfProcessHosting = xml->getBoolAttribute("outOfProcessHosting", false) && CyderProcessBridge::isSupported();
+    
+    // Restore wrapped plugin. Copying and scanning it happens in the background, so a session full of
+    // Cyders restores in parallel. Audio passes through dry until the plugin is in, see finishRestore().
+    unloadPlugin(); // also drops a restore still in progress
+    
+    const auto savedPathString = xml->getStringAttribute("pluginFilePath");
+    if (savedPathString.isEmpty())
         return;
-
-    // Decode and restore wrapped plugin state
+    
+    PendingRestore restore;
+    restore.pluginFile = juce::File(savedPathString);
+    
+    // Decode wrapped plugin state
     if (auto* stateElem = xml->getChildByName("WrappedPluginState"))
     {
-        auto base64Data = stateElem->getAllSubText();
         juce::MemoryBlock pluginData;
         {
             juce::MemoryOutputStream stream(pluginData, false);
-            juce::Base64::convertFromBase64(stream, base64Data);
+            juce::Base64::convertFromBase64(stream, stateElem->getAllSubText());
         }
-        if (wrappedPlugin != nullptr)
-            wrappedPlugin->setStateInformation(pluginData.getData(),
-                                               static_cast<int>(pluginData.getSize()));
+        restore.wrappedState = std::move(pluginData);
     }
+    
+    pendingRestore = std::move(restore);
+    currentStatus = CyderStatus::loading;
+    
+    pluginLoader->prepareAsync(pendingRestore->pluginFile,
+                               [safeThis = juce::WeakReference<CyderAudioProcessor>(this),
+                                generation = ++restoreGeneration](const CyderPluginLoader::PreparedPlugin& prepared)
+    {
+        if (safeThis.wasObjectDeleted() || safeThis->restoreGeneration != generation)
+        {
+            if (prepared.copiedPlugin != juce::File())
+                Utilities::deleteStalePlugin(prepared.copiedPlugin); // restore was dropped in the meantime
+            return;
+        }
+        
+        safeThis->finishRestore(prepared);
+    }, /*forOtherProcesses*/ outOfProcessHosting);
 }
 
 bool CyderAudioProcessor::loadPlugin(const juce::String& pluginPath)
@@ -324,49 +583,95 @@ bool CyderAudioProcessor::loadPlugin(const juce::String& pluginPath)
     // CFBundle does not like it if we attempt to load a dll outside the message thread
     jassert(juce::MessageManager::getInstance()->isThisTheMessageThread());
     
-    std::unique_ptr<juce::AudioPluginInstance> newInstance;
-    juce::File incomingCopiedPlugin;
+    cancelPendingRestore(); // superseded by this plugin
     
-    juce::AudioPluginFormatManager formatManager;
-    formatManager.addDefaultFormats();
+    if (hotReloadThread != nullptr)
+        hotReloadThread->stop(); // don't hot reload while we're loading
     
-    juce::File pluginFile(pluginPath);
-    const bool reloadingSamePlugin = pluginFile == currentPluginFileOriginal;
+    const juce::File pluginFile(pluginPath);
     
+    CyderPluginLoader::PreparedPlugin prepared;
+    try
+    {
+        prepared = pluginLoader->prepare(pluginFile, /*forOtherProcesses*/ outOfProcessHosting);
+    }
+    catch(const std::exception& e) // failed to copy or scan plugin
     {
-        [[maybe_unused]] const auto inputChannels = getTotalNumInputChannels();
-        [[maybe_unused]] const auto outputChannels = getTotalNumOutputChannels();
-        jassert(inputChannels == outputChannels); // only support basic mono or stereo I/O
+        prepared.originalFile = pluginFile;
+        prepared.errorMessage = e.what();
+        if (prepared.errorMessage.isEmpty())
+            prepared.errorMessage = "Failed to load plugin: " + pluginFile.getFullPathName();
     }
     
-    // Wrapped plugin can only be mono or stereo
-    // If Cyder is mono-to-stereo, then wrapped plugin must be stereo
-    const bool isStereo    = getTotalNumOutputChannels() == 2;
-    const auto numChannels = isStereo ? 2 : 1;
-    const auto sampleRate  = getSampleRate();
-    const auto blockSize   = getBlockSize();
+    return loadPreparedPlugin(prepared);
+}
+
+bool CyderAudioProcessor::isRestoringState() const noexcept
+{
+    return pendingRestore.has_value() || pluginChain.isRestoringState() || pluginGraph.isRestoringState();
+}
+
+bool CyderAudioProcessor::loadPreparedPlugin(const CyderPluginLoader::PreparedPlugin& prepared,
+                                             const juce::MemoryBlock* stateToRestore)
+{
+    // CFBundle does not like it if we attempt to load a dll outside the message thread
+    jassert(juce::MessageManager::getInstance()->isThisTheMessageThread());
     
-    if (hotReloadThread != nullptr)
-        hotReloadThread->stopThread(1500); // don't hot reload while we're loading
+    if (outOfProcessHosting)
+        return loadPreparedPluginOutOfProcess(prepared, stateToRestore);
+    
+    jassert(processBridge == nullptr); // switching modes unloads first, see setOutOfProcessHosting()
+    
+    std::unique_ptr<juce::AudioPluginInstance> newInstance;
+    std::unique_ptr<juce::AudioPluginInstance> nullTestInstance; // second instance of new build, for testing offline
+    
+    const auto& pluginFile = prepared.originalFile;
+    const bool reloadingSamePlugin = pluginFile == currentPluginFileOriginal;
+    
+    // Main buses always match, see isBusesLayoutSupported()
+    jassert(getMainBusNumInputChannels() == getMainBusNumOutputChannels());
+    
+    const auto numChannels = std::max(1, getMainBusNumOutputChannels());
+    
+    // Until the host prepares us, plugins are only instantiated (with the last valid settings, if any).
+    // Our own prepareToPlay() prepares them, so sessions full of Cyders load without preparing anything twice.
+    const bool shouldPrepare = isPreparedToPlay && getSampleRate() > 0.0 && getBlockSize() > 0;
+    const auto sampleRate    = shouldPrepare ? getSampleRate() : (lastValidSampleRate > 0.0 ? lastValidSampleRate : defaultSampleRate);
+    const auto blockSize     = shouldPrepare ? getBlockSize()  : (lastValidBlockSize > 0 ? lastValidBlockSize : defaultBlockSize);
+    
+    const bool shouldNullTest = nullTestOnReload
+                                && reloadingSamePlugin
+                                && wrappedPlugin != nullptr
+                                && shouldPrepare
+                                && stateToRestore == nullptr; // a rollback's state differs, nothing to compare
     
     // Load incoming plugin (without yet removing ours)
     try
     {
-        // Copy plugin to temp with a random hash appended
-        incomingCopiedPlugin = Utilities::copyPluginToTemp(pluginFile);
-
+        if (! prepared.wasSuccessful())
+            throw std::runtime_error(prepared.errorMessage.toStdString());
+        
+        juce::AudioPluginFormatManager formatManager;
+        formatManager.addDefaultFormats();
+        
         // Only supporting VST3
         juce::AudioProcessor::setTypeOfNextNewPlugin(wrapperType_VST3);
 
-        auto description = Utilities::findPluginDescription(incomingCopiedPlugin, formatManager);
+        auto description = prepared.description;
         description.numInputChannels  = numChannels;
         description.numOutputChannels = numChannels;
         
         newInstance = Utilities::createInstance(description, formatManager, sampleRate, blockSize);
+        
+        if (shouldNullTest)
+            nullTestInstance = Utilities::createInstance(description, formatManager, sampleRate, blockSize);
     }
     catch(const std::exception& e) // failed to load plugin
     {
         juce::Logger::writeToLog(e.what());
+        if (prepared.copiedPlugin != juce::File())
+            Utilities::deleteStalePlugin(prepared.copiedPlugin);
+        
         currentStatus = reloadingSamePlugin ? CyderStatus::failedToReloadPlugin
                                             : CyderStatus::failedToLoadPlugin;
         CYDER_ASSERT_FALSE;
@@ -380,21 +685,41 @@ bool CyderAudioProcessor::loadPlugin(const juce::String& pluginPath)
     // Make sure nothing above threw exception before swapping out current plugin with new plugin
     
     // Configure incoming plugin
-    newInstance->setPlayConfigDetails(numChannels,
-                                      numChannels,
-                                      sampleRate,
-                                      blockSize);
-    newInstance->prepareToPlay(sampleRate, blockSize);
-    if (reloadingSamePlugin)
+    mirrorBusesLayout(*newInstance, sampleRate, blockSize);
+    if (shouldPrepare)
+        newInstance->prepareToPlay(sampleRate, blockSize);
+    if (stateToRestore != nullptr)
+        newInstance->setStateInformation(stateToRestore->getData(), static_cast<int>(stateToRestore->getSize()));
+    else if (reloadingSamePlugin)
         transferPluginState(*newInstance);
     
-    // Unload editor
+    auto newChannelMap = std::make_unique<CyderChannelMap>();
+    newChannelMap->prepare(*this, *newInstance, blockSize);
+    
+    if (nullTestInstance != nullptr)
+    {
+        mirrorBusesLayout(*nullTestInstance, sampleRate, blockSize);
+        nullTestInstance->prepareToPlay(sampleRate, blockSize);
+        transferPluginState(*nullTestInstance); // same starting point as the previous build
+    }
+    
+    // Unload editor, painting a snapshot of it in its place until the new editor is up
     {
         auto* cyderEditor = dynamic_cast<CyderAudioProcessorEditor*>(getActiveEditor());
         if (cyderEditor != nullptr)
-            cyderEditor->unloadWrappedEditor(getWrappedPluginEditor(),
-                                             /*shouldCacheSize*/ reloadingSamePlugin);
-        wrappedPluginEditor.reset();
+        {
+            if (reloadingSamePlugin)
+                cyderEditor->holdReloadSnapshot(getWrappedPluginEditor());
+            cyderEditor->unloadWrappedEditor(getWrappedPluginEditor());
+        }
+        
+        if (reloadingSamePlugin)
+            releaseWrappedEditor(); // remember its size for the next build
+        else
+        {
+            wrappedPluginEditor.reset();
+            wrappedEditorSize.reset();
+        }
     }
     
     // Remove processor listener
@@ -402,86 +727,356 @@ bool CyderAudioProcessor::loadPlugin(const juce::String& pluginPath)
         wrappedPlugin->removeListener(this);
     
     // Swap out processor
+    std::unique_ptr<juce::AudioPluginInstance> previousInstance;
     {
         juce::ScopedLock lock(getCallbackLock()); // lock audio thread
-        wrappedPlugin.reset(newInstance.release());
-        setLatencySamples(wrappedPlugin->getLatencySamples());
+        previousInstance = std::exchange(wrappedPlugin, std::move(newInstance));
+        std::swap(wrappedChannelMap, newChannelMap);
+        midiTakeoverPending = true;
+        takeoverMidi.ensureSize(takeoverMidiBytes); // only grows if the last takeover handed its storage to the host
+        updateLatencySamples();
     }
     
     // Add processor listener
     wrappedPlugin->addListener(this);
     
-    // Cleanup: Delete copied plugin
-    deleteStalePlugin(currentPluginFileCopy);
-    currentPluginFileCopy = juce::File(); // reset
+    updateWatchdog();
+    
+    // A rebuild keeps its mapping, a different plugin starts over with its own parameters.
+    // Done while the previous instance is still alive, since the audio thread may still point at its parameters.
+    if (! reloadingSamePlugin && previousInstance != nullptr)
+        parameterProxies.clearMapping();
+    parameterProxies.setWrappedPlugin(wrappedPlugin.get());
+    
+    // The build being replaced is kept, along with its state, so it can be rolled back to
+    if (reloadingSamePlugin && previousInstance != nullptr && currentPluginFileCopy != juce::File())
+    {
+        juce::MemoryBlock previousState;
+        previousInstance->getStateInformation(previousState);
+        buildHistory.push(currentPluginFileOriginal,
+                          std::exchange(currentPluginFileCopy, juce::File()),
+                          currentPluginDescription,
+                          previousState);
+    }
+    else if (! reloadingSamePlugin)
+    {
+        buildHistory.clear(); // builds of another plugin
+    }
+    
+    // Only one null test at a time, the latest build is the one worth testing
+    cancelNullTest();
+    
+    if (nullTestInstance != nullptr && previousInstance != nullptr)
+    {
+        // Previous build lives on until the test is done with it, its copy is in the build history
+        const auto numNullTestChannels = std::max(nullTestInstance->getTotalNumInputChannels(),
+                                                  nullTestInstance->getTotalNumOutputChannels());
+        nullTest = std::make_unique<CyderNullTest>(std::move(previousInstance),
+                                                   std::move(nullTestInstance),
+                                                   numNullTestChannels,
+                                                   sampleRate,
+                                                   blockSize);
+        nullTest->onComplete = [this](const CyderNullTestResult& result)
+        {
+            lastNullTestResult = result;
+            currentStatus = result.isBitExact ? CyderStatus::nullTestBitExact
+                                              : CyderStatus::nullTestDiffers;
+            cancelNullTest(); // done with previous build
+        };
+    }
+    else
+    {
+        // Cleanup: Delete copied plugin
+        previousInstance.reset();
+        Utilities::deleteStalePlugin(currentPluginFileCopy);
+        currentPluginFileCopy = juce::File(); // reset
+    }
 
     // Update refs
     currentPluginFileOriginal = pluginFile;
-    currentPluginFileCopy = incomingCopiedPlugin;
+    currentPluginFileCopy = prepared.copiedPlugin;
+    currentPluginDescription = prepared.description;
     
-    // Create new editor
+    // Create new editor once the audio handover is complete, so UI construction never delays it.
+    // If our window is closed, the editor is instead created when it is next opened.
+    juce::MessageManager::callAsync([safeThis = juce::WeakReference<CyderAudioProcessor>(this)]
     {
-        auto editor = wrappedPlugin->createEditor();
-        CYDER_ASSERT(editor != nullptr);
-        wrappedPluginEditor.reset(editor);
+        if (safeThis.wasObjectDeleted())
+            return;
         
-        auto* cyderEditor = dynamic_cast<CyderAudioProcessorEditor*>(getActiveEditor());
-        if (cyderEditor != nullptr)
-            cyderEditor->loadWrappedEditor(getWrappedPluginEditor());
-    }
+        safeThis->showWrappedEditorInActiveEditor();
+    });
     
     // Restart HotReloadThread
-    hotReloadThread = std::make_unique<HotReloadThread>(pluginFile); // auto starts thread
-    hotReloadThread->onPluginChangeDetected = [&]
+    startHotReloadThread(pluginFile);
+    
+    // Update Status
+    if (stateToRestore != nullptr)
+        currentStatus = CyderStatus::rolledBack;
+    else
+        currentStatus = reloadingSamePlugin ? CyderStatus::successfullyReloadedPlugin
+                                            : CyderStatus::successfullyLoadedPlugin;
+    return true;
+}
+
+bool CyderAudioProcessor::loadPreparedPluginOutOfProcess(const CyderPluginLoader::PreparedPlugin& prepared,
+                                                         const juce::MemoryBlock* stateToRestore)
+{
+    const auto& pluginFile = prepared.originalFile;
+    const bool reloadingSamePlugin = pluginFile == currentPluginFileOriginal;
+    
+    const auto numChannels = std::max(1, getMainBusNumOutputChannels());
+    
+    // The child is always prepared, with the last valid settings until the host prepares us
+    const bool isPrepared = isPreparedToPlay && getSampleRate() > 0.0 && getBlockSize() > 0;
+    const auto sampleRate = isPrepared ? getSampleRate() : (lastValidSampleRate > 0.0 ? lastValidSampleRate : defaultSampleRate);
+    const auto blockSize  = isPrepared ? getBlockSize()  : (lastValidBlockSize > 0 ? lastValidBlockSize : defaultBlockSize);
+    
+    // A copy staged in memory links to our own file descriptor, which the child can't open. Copied again
+    // from that copy rather than the original, which may be a newer build by now (e.g. when rolling back).
+    auto copiedPlugin = prepared.copiedPlugin;
+    if (prepared.wasSuccessful() && Utilities::isStagedInMemory(copiedPlugin))
     {
-        juce::MessageManager::callAsync([safeThis = juce::WeakReference<CyderAudioProcessor>(this)]
+        try
         {
-            if (safeThis.wasObjectDeleted())
-                return;
-            
-            safeThis->loadPlugin(safeThis->hotReloadThread->getFullPluginPath());
+            const auto restagedPlugin = Utilities::copyPluginToTemp(copiedPlugin, /*forOtherProcesses*/ true);
+            Utilities::deleteStalePlugin(std::exchange(copiedPlugin, restagedPlugin));
+        }
+        catch (const std::exception& e)
+        {
+            juce::Logger::writeToLog("Failed to stage plugin for its child process: " + juce::String(e.what()));
+        }
+    }
+    
+    // Launch a child hosting the incoming plugin (without yet removing ours)
+    auto newBridge = std::make_unique<CyderProcessBridge>();
+    if (! prepared.wasSuccessful() || ! newBridge->start(copiedPlugin, numChannels, sampleRate, blockSize))
+    {
+        juce::Logger::writeToLog(prepared.wasSuccessful() ? "Failed to host plugin out of process: " + pluginFile.getFullPathName()
+                                                          : prepared.errorMessage);
+        if (copiedPlugin != juce::File())
+            Utilities::deleteStalePlugin(copiedPlugin);
+        
+        currentStatus = reloadingSamePlugin ? CyderStatus::failedToReloadPlugin
+                                            : CyderStatus::failedToLoadPlugin;
+        CYDER_ASSERT_FALSE;
+        
+        if (hotReloadThread != nullptr)
+            hotReloadThread->startThread(); // restart HotReloadThread
+        
+        return false;
+    }
+    
+    // A rebuild takes on the previous build's state
+    juce::MemoryBlock previousState;
+    const bool hasPreviousState = processBridge != nullptr && processBridge->getState(previousState);
+    if (stateToRestore != nullptr)
+        newBridge->setState(*stateToRestore);
+    else if (reloadingSamePlugin && hasPreviousState)
+        newBridge->setState(previousState);
+    
+    newBridge->onCrashed = [safeThis = juce::WeakReference<CyderAudioProcessor>(this)]
+    {
+        juce::MessageManager::callAsync([safeThis]
+        {
+            if (! safeThis.wasObjectDeleted())
+                safeThis->currentStatus = CyderStatus::wrappedPluginCrashed;
         });
     };
     
+    // Swap out child process
+    std::unique_ptr<CyderProcessBridge> previousBridge;
+    {
+        juce::ScopedLock lock(getCallbackLock()); // lock audio thread
+        previousBridge = std::exchange(processBridge, std::move(newBridge));
+        midiTakeoverPending = true;
+        takeoverMidi.ensureSize(takeoverMidiBytes); // only grows if the last takeover handed its storage to the host
+        updateLatencySamples();
+    }
+    
+    // The previous child exits outside of the lock, letting go of its copy
+    previousBridge.reset();
+    
+    updateWatchdog();
+    
+    // The build being replaced is kept, along with its state, so it can be rolled back to
+    if (reloadingSamePlugin && hasPreviousState && currentPluginFileCopy != juce::File())
+    {
+        buildHistory.push(currentPluginFileOriginal,
+                          std::exchange(currentPluginFileCopy, juce::File()),
+                          currentPluginDescription,
+                          previousState);
+    }
+    else if (! reloadingSamePlugin)
+    {
+        buildHistory.clear(); // builds of another plugin
+    }
+    
+    // Cleanup: Delete copied plugin
+    Utilities::deleteStalePlugin(currentPluginFileCopy);
+    
+    // Update refs
+    currentPluginFileOriginal = pluginFile;
+    currentPluginFileCopy = copiedPlugin;
+    currentPluginDescription = prepared.description;
+    
+    // Restart HotReloadThread
+    startHotReloadThread(pluginFile);
+    
     // Update Status
-    currentStatus = reloadingSamePlugin ? CyderStatus::successfullyReloadedPlugin
-                                        : CyderStatus::successfullyLoadedPlugin;
+    if (stateToRestore != nullptr)
+        currentStatus = CyderStatus::rolledBack;
+    else
+        currentStatus = reloadingSamePlugin ? CyderStatus::successfullyReloadedPlugin
+                                            : CyderStatus::successfullyLoadedPlugin;
     return true;
 }
 
+bool CyderAudioProcessor::rollBack(int snapshotIndex)
+{
+    jassert(juce::MessageManager::getInstance()->isThisTheMessageThread());
+    
+    if (wrappedPlugin == nullptr && processBridge == nullptr)
+        return false;
+    
+    auto snapshot = buildHistory.take(snapshotIndex);
+    if (! snapshot.has_value())
+        return false;
+    
+    // History is cleared whenever a different plugin is loaded
+    jassert(snapshot->originalFile == currentPluginFileOriginal);
+    
+    cancelPendingRestore();
+    if (hotReloadThread != nullptr)
+        hotReloadThread->stop(); // don't hot reload while we're loading
+    
+    // Already copied and scanned, so this costs no more than the swap of a hot reload
+    CyderPluginLoader::PreparedPlugin prepared;
+    prepared.originalFile = snapshot->originalFile;
+    prepared.copiedPlugin = snapshot->copiedPlugin;
+    prepared.description  = snapshot->description;
+    
+    const auto state = snapshot->getState();
+    return loadPreparedPlugin(prepared, &state); // the build rolled away from goes into the history in its place
+}
+
+CyderBuildHistory& CyderAudioProcessor::getBuildHistory() noexcept
+{
+    return buildHistory;
+}
+
+bool CyderAudioProcessor::setOutOfProcessHosting(bool shouldHostOutOfProcess)
+{
+    jassert(juce::MessageManager::getInstance()->isThisTheMessageThread());
+    
+    if (shouldHostOutOfProcess && ! CyderProcessBridge::isSupported())
+        return false;
+    
+    if (outOfProcessHosting == shouldHostOutOfProcess)
+        return true;
+    
+    // Nothing loaded yet, or a restore still on its way, which loads in the new mode
+    if (wrappedPlugin == nullptr && processBridge == nullptr)
+    {
+        outOfProcessHosting = shouldHostOutOfProcess;
+        return true;
+    }
+    
+    // Reload what is loaded in the new mode, keeping its state
+    const auto pluginFile = currentPluginFileOriginal;
+    juce::MemoryBlock state;
+    const bool hasState = getWrappedPluginState(state);
+    
+    unloadPlugin();
+    outOfProcessHosting = shouldHostOutOfProcess;
+    
+    if (! loadPlugin(pluginFile.getFullPathName()))
+        return false;
+    
+    if (hasState)
+        setWrappedPluginState(state);
+    return true;
+}
+
+bool CyderAudioProcessor::isOutOfProcessHostingEnabled() const noexcept
+{
+    return outOfProcessHosting;
+}
+
+CyderProcessBridge* CyderAudioProcessor::getProcessBridge() const noexcept
+{
+    return processBridge.get();
+}
+
+void CyderAudioProcessor::finishRestore(const CyderPluginLoader::PreparedPlugin& prepared)
+{
+    jassert(pendingRestore.has_value());
+    const auto restore = std::exchange(pendingRestore, std::nullopt);
+    
+    if (! loadPreparedPlugin(prepared)) // something went wrong when loading wrapped plugin from saved state
+        return;
+    
+    // Restore wrapped plugin state
+    if (restore.has_value() && restore->wrappedState.has_value())
+        setWrappedPluginState(*restore->wrappedState);
+}
+
+void CyderAudioProcessor::cancelPendingRestore() noexcept
+{
+    pendingRestore.reset();
+    ++restoreGeneration; // its copy is retired when it arrives
+}
+
 void CyderAudioProcessor::unloadPlugin()
 {
-    if (wrappedPlugin == nullptr)
+    cancelPendingRestore();
+    
+    if (wrappedPlugin == nullptr && processBridge == nullptr)
         return;
     
+    cancelNullTest();
+    
     // Stop and reset hot reload thread first so we don't reload after unloading
     if (hotReloadThread != nullptr)
     {
-        hotReloadThread->stopThread(1500);
+        hotReloadThread->stop();
         hotReloadThread.reset();
     }
     
     // Remove processor listener
-    wrappedPlugin->removeListener(this);
+    if (wrappedPlugin != nullptr)
+        wrappedPlugin->removeListener(this);
+    parameterProxies.setWrappedPlugin(nullptr); // mapping is kept, for the next plugin loaded
     
     // Unload wrapped editor
     if (auto* cyderEditor = dynamic_cast<CyderAudioProcessorEditor*>(getActiveEditor()))
-        cyderEditor->unloadWrappedEditor(getWrappedPluginEditor(),
-                                         /*shouldCacheSize*/ false);
+    {
+        cyderEditor->unloadWrappedEditor(getWrappedPluginEditor());
+        cyderEditor->releaseReloadSnapshot();
+    }
     wrappedPluginEditor.reset();
+    wrappedEditorSize.reset();
     
     // Unload wrapped processor
+    std::unique_ptr<CyderProcessBridge> previousBridge;
     {
         juce::ScopedLock lock(getCallbackLock()); // lock audio thread
         wrappedPlugin.reset();
+        wrappedChannelMap.reset();
+        previousBridge = std::move(processBridge);
     }
+    previousBridge.reset(); // child process exits outside of the lock
     
-    // Cleanup: Delete copied plugin
+    updateWatchdog(); // nothing left to watch
+    
+    // Cleanup: Delete copied plugin, and every build kept for rolling back
     currentPluginFileOriginal = juce::File(); // reset
-    deleteStalePlugin(currentPluginFileCopy);
+    currentPluginDescription = juce::PluginDescription();
+    Utilities::deleteStalePlugin(currentPluginFileCopy);
+    buildHistory.clear();
     
     // Update latency
-    setLatencySamples(0);
+    updateLatencySamples();
     
     // Update status
     currentStatus = CyderStatus::idle;
@@ -507,6 +1102,138 @@ juce::AudioProcessorEditor* CyderAudioProcessor::getWrappedPluginEditor() const
     return wrappedPluginEditor.get();
 }
 
+void CyderAudioProcessor::setLatencyCeilingSamples(int ceilingSamples)
+{
+    jassert(juce::MessageManager::getInstance()->isThisTheMessageThread());
+    
+    ceilingSamples = std::max(0, ceilingSamples);
+    if (latencyCeilingSamples.exchange(ceilingSamples) == ceilingSamples)
+        return;
+    
+    prepareLatencyPadding(getBlockSize());
+}
+
+int CyderAudioProcessor::getLatencyCeilingSamples() const noexcept
+{
+    return latencyCeilingSamples.load();
+}
+
+int CyderAudioProcessor::getLatencyPaddingSamples() const noexcept
+{
+    return latencyPadding != nullptr ? latencyPadding->getDelay() : 0;
+}
+
+void CyderAudioProcessor::setBuildSettings(const CyderBuildSettings& newSettings)
+{
+    buildSettings = newSettings;
+    unconfirmedBuildSettings.reset();
+    
+    // Watch with the new settings right away
+    if (wrappedPlugin != nullptr || processBridge != nullptr)
+        startHotReloadThread(currentPluginFileOriginal);
+}
+
+const CyderBuildSettings& CyderAudioProcessor::getBuildSettings() const noexcept
+{
+    return buildSettings;
+}
+
+const std::optional<CyderBuildSettings>& CyderAudioProcessor::getUnconfirmedBuildSettings() const noexcept
+{
+    return unconfirmedBuildSettings;
+}
+
+void CyderAudioProcessor::confirmBuildSettings()
+{
+    if (const auto restored = unconfirmedBuildSettings)
+        setBuildSettings(*restored);
+}
+
+void CyderAudioProcessor::startHotReloadThread(const juce::File& pluginFile)
+{
+    if (hotReloadThread != nullptr)
+        hotReloadThread->stop();
+    
+    hotReloadThread = std::make_unique<HotReloadThread>(pluginFile, buildSettings); // auto starts thread
+    hotReloadThread->onPluginChangeDetected = [&]
+    {
+        juce::MessageManager::callAsync([safeThis = juce::WeakReference<CyderAudioProcessor>(this)]
+        {
+            if (safeThis.wasObjectDeleted())
+                return;
+            
+            safeThis->loadPlugin(safeThis->hotReloadThread->getFullPluginPath());
+        });
+    };
+    hotReloadThread->onBuildStarted = [&]
+    {
+        juce::MessageManager::callAsync([safeThis = juce::WeakReference<CyderAudioProcessor>(this)]
+        {
+            if (! safeThis.wasObjectDeleted())
+                safeThis->currentStatus = CyderStatus::building;
+        });
+    };
+    hotReloadThread->onBuildFinished = [&](bool succeeded)
+    {
+        if (succeeded)
+            return; // reloading next, which reports its own status
+        
+        juce::MessageManager::callAsync([safeThis = juce::WeakReference<CyderAudioProcessor>(this)]
+        {
+            if (! safeThis.wasObjectDeleted())
+                safeThis->currentStatus = CyderStatus::buildFailed;
+        });
+    };
+}
+
+void CyderAudioProcessor::setNullTestOnReload(bool shouldNullTest) noexcept
+{
+    nullTestOnReload = shouldNullTest;
+}
+
+bool CyderAudioProcessor::isNullTestOnReloadEnabled() const noexcept
+{
+    return nullTestOnReload;
+}
+
+bool CyderAudioProcessor::isNullTestRunning() const noexcept
+{
+    return nullTest != nullptr;
+}
+
+std::optional<CyderNullTestResult> CyderAudioProcessor::getLastNullTestResult() const noexcept
+{
+    return lastNullTestResult;
+}
+
+void CyderAudioProcessor::cancelNullTest()
+{
+    if (nullTest == nullptr)
+        return;
+    
+    nullTest.reset(); // destroys previous build, whose copy is left to the build history
+}
+
+double CyderAudioProcessor::getLastValidSampleRate() const noexcept
+{
+    return lastValidSampleRate;
+}
+
+int CyderAudioProcessor::getLastValidBlockSize() const noexcept
+{
+    return lastValidBlockSize;
+}
+
+CyderRealtimeGuard& CyderAudioProcessor::getRealtimeGuard() noexcept
+{
+    return realtimeGuard;
+}
+
+CyderWatchdog& CyderAudioProcessor::getWatchdog() noexcept
+{
+    return watchdog;
+}
+
 juce::File CyderAudioProcessor::getCurrentWrappedPluginPathCopy() const noexcept
 {
     return currentPluginFileCopy;
@@ -522,6 +1249,92 @@ juce::Thread* CyderAudioProcessor::getHotReloadThread() const noexcept
     return hotReloadThread.get();
 }
 
+juce::AudioProcessorEditor* CyderAudioProcessor::createWrappedEditorIfNeeded()
+{
+    if (wrappedPlugin == nullptr)
+        return nullptr;
+    
+    if (wrappedPluginEditor == nullptr)
+    {
+        auto* editor = wrappedPlugin->createEditor();
+        CYDER_ASSERT(editor != nullptr);
+        wrappedPluginEditor.reset(editor);
+        
+        // Restore the size the previous editor was left at
+        if (editor != nullptr && wrappedEditorSize.has_value())
+            editor->setSize(wrappedEditorSize->getWidth(),
+                            wrappedEditorSize->getHeight());
+    }
+    
+    return wrappedPluginEditor.get();
+}
+
+void CyderAudioProcessor::releaseWrappedEditor() noexcept
+{
+    if (wrappedPluginEditor == nullptr)
+        return;
+    
+    wrappedEditorSize = wrappedPluginEditor->getBounds().withZeroOrigin();
+    wrappedPluginEditor.reset();
+}
+
+void CyderAudioProcessor::showWrappedEditorInActiveEditor()
+{
+    auto* cyderEditor = dynamic_cast<CyderAudioProcessorEditor*>(getActiveEditor());
+    if (cyderEditor == nullptr)
+        return; // window is closed, don't spend resources on an editor nobody can see
+    
+    if (auto* editor = createWrappedEditorIfNeeded())
+        cyderEditor->loadWrappedEditor(editor);
+    else
+        cyderEditor->releaseReloadSnapshot(); // nothing is coming to replace it
+}
+
+CyderPluginChain& CyderAudioProcessor::getPluginChain() noexcept
+{
+    return pluginChain;
+}
+
+CyderPluginGraph& CyderAudioProcessor::getPluginGraph() noexcept
+{
+    return pluginGraph;
+}
+
+CyderParameterProxies& CyderAudioProcessor::getParameterProxies() noexcept
+{
+    return parameterProxies;
+}
+
+void CyderAudioProcessor::mirrorBusesLayout(juce::AudioProcessor& instance, double sampleRate, int blockSize) const
+{
+    // Our layout, bus for bus, as far as the plugin has buses
+    const auto ours = getBusesLayout();
+    auto mirrored = instance.getBusesLayout();
+    for (int i = 0; i < mirrored.inputBuses.size(); ++i)
+        mirrored.inputBuses.getReference(i) = i < ours.inputBuses.size() ? ours.inputBuses[i] : juce::AudioChannelSet::disabled();
+    for (int i = 0; i < mirrored.outputBuses.size(); ++i)
+        mirrored.outputBuses.getReference(i) = i < ours.outputBuses.size() ? ours.outputBuses[i] : juce::AudioChannelSet::disabled();
+    
+    // Failing that, just the main buses
+    auto mainOnly = mirrored;
+    for (int i = 1; i < mainOnly.inputBuses.size(); ++i)
+        mainOnly.inputBuses.getReference(i) = juce::AudioChannelSet::disabled();
+    for (int i = 1; i < mainOnly.outputBuses.size(); ++i)
+        mainOnly.outputBuses.getReference(i) = juce::AudioChannelSet::disabled();
+    
+    const bool mirroredLayout = instance.getBusesLayout() == mirrored
+                             || instance.setBusesLayout(mirrored)
+                             || instance.setBusesLayout(mainOnly);
+    
+    if (mirroredLayout)
+        instance.setRateAndBufferSizeDetails(sampleRate, blockSize);
+    else // whatever the plugin settles on is mapped onto our channels by speaker, see CyderChannelMap
+        instance.setPlayConfigDetails(std::max(1, getMainBusNumInputChannels()),
+                                      std::max(1, getMainBusNumOutputChannels()),
+                                      sampleRate,
+                                      blockSize);
+}
+
 void CyderAudioProcessor::transferPluginState(juce::AudioProcessor& destinationProcessor) noexcept
 {
     if (wrappedPlugin == nullptr)
@@ -533,14 +1346,122 @@ void CyderAudioProcessor::transferPluginState(juce::AudioProcessor& destinationP
                                              static_cast<int>(memoryBlock.getSize()));
 }
 
+bool CyderAudioProcessor::getWrappedPluginState(juce::MemoryBlock& destData)
+{
+    if (wrappedPlugin != nullptr)
+    {
+        wrappedPlugin->getStateInformation(destData);
+        return true;
+    }
+    
+    return processBridge != nullptr && processBridge->getState(destData);
+}
+
+void CyderAudioProcessor::setWrappedPluginState(const juce::MemoryBlock& state)
+{
+    if (wrappedPlugin != nullptr)
+    {
+        wrappedPlugin->setStateInformation(state.getData(), static_cast<int>(state.getSize()));
+        
+        // Proxies take on the restored values
+        parameterProxies.setWrappedPlugin(wrappedPlugin.get());
+    }
+    else if (processBridge != nullptr)
+    {
+        processBridge->setState(state);
+        updateLatencySamples();
+    }
+}
+
+void CyderAudioProcessor::audioProcessorParameterChanged (juce::AudioProcessor* processor,
+                                                          int parameterIndex,
+                                                          float newValue)
+{
+    // May be the audio thread, so the host is only told later, by the proxies' timer
+    if (processor == wrappedPlugin.get())
+        parameterProxies.parameterChangedByPlugin(parameterIndex, newValue);
+}
+
+void CyderAudioProcessor::audioProcessorParameterChangeGestureBegin (juce::AudioProcessor* processor,
+                                                                     int parameterIndex)
+{
+    if (processor == wrappedPlugin.get())
+        parameterProxies.gestureChangedByPlugin(parameterIndex, /*gestureIsStarting*/ true);
+}
+
+void CyderAudioProcessor::audioProcessorParameterChangeGestureEnd (juce::AudioProcessor* processor,
+                                                                   int parameterIndex)
+{
+    if (processor == wrappedPlugin.get())
+        parameterProxies.gestureChangedByPlugin(parameterIndex, /*gestureIsStarting*/ false);
+}
+
 void CyderAudioProcessor::audioProcessorChanged (juce::AudioProcessor* processor,
                                                  const AudioProcessorListener::ChangeDetails& details)
 {
-    if (processor != wrappedPlugin.get())
+    if (! details.latencyChanged)
         return;
     
-    if (details.latencyChanged)
-        setLatencySamples(wrappedPlugin->getLatencySamples());
+    // Any thread the plugin likes, so not while the message thread swaps it out
+    const juce::ScopedLock lock(getCallbackLock());
+    if (processor == wrappedPlugin.get())
+        updateLatencySamples();
+}
+
+void CyderAudioProcessor::updateWatchdog()
+{
+    const bool isHosting = wrappedPlugin != nullptr || processBridge != nullptr;
+    if (isPreparedToPlay && isHosting && lastValidSampleRate > 0.0 && lastValidBlockSize > 0)
+        watchdog.prepare(lastValidSampleRate, lastValidBlockSize);
+    else
+        watchdog.stop();
+}
+
+void CyderAudioProcessor::updateLatencySamples()
+{
+    // Chains, graph and padding are only swapped under this lock, and may be reported from any thread
+    const juce::ScopedLock lock(getCallbackLock());
+    
+    const auto wrappedLatency = wrappedPlugin != nullptr ? wrappedPlugin->getLatencySamples()
+                              : processBridge != nullptr ? processBridge->getLatencySamples()
+                                                         : 0;
+    const auto actualLatency  = wrappedLatency
+                              + pluginChain.getTotalLatencySamples()
+                              + pluginGraph.getLatencySamples();
+    
+    auto reportedLatency = actualLatency;
+    
+    const auto ceiling = latencyCeilingSamples.load();
+    if (ceiling > 0 && latencyPadding != nullptr)
+    {
+        // If we're over the ceiling, we can't pad by a negative amount, host has to re-align after all
+        latencyPadding->setDelay(std::max(0, ceiling - actualLatency));
+        reportedLatency = std::max(ceiling, actualLatency);
+    }
+    
+    setLatencySamples(reportedLatency); // only notifies the host if it actually changed
+    dryDelay->setDelay(std::min(reportedLatency, dryDelay->getMaximumDelay()));
+}
+
+void CyderAudioProcessor::prepareLatencyPadding(int maximumBlockSize)
+{
+    // Allocate outside of the lock
+    std::unique_ptr<CyderDelayLine> newPadding;
+    if (const auto ceiling = latencyCeilingSamples.load(); ceiling > 0)
+    {
+        newPadding = std::make_unique<CyderDelayLine>();
+        newPadding->prepare(/*numChannels*/std::max(2, getMainBusNumOutputChannels()), // covers mono-to-stereo buffer
+                            ceiling,
+                            std::max(1, maximumBlockSize));
+    }
+    
+    {
+        juce::ScopedLock lock(getCallbackLock()); // lock audio thread
+        std::swap(latencyPadding, newPadding);
+        updateLatencySamples();
+    }
+    
+    // Old padding (if any) is freed outside of the lock
 }
 
 //==============================================================================
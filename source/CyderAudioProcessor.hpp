@@ -16,7 +16,22 @@
 
 #include <juce_audio_processors/juce_audio_processors.h>
 
+#include "CyderBuildHistory.hpp"
+#include "CyderMidiState.hpp"
+#include "CyderNullTest.hpp"
+#include "CyderParameterProxies.hpp"
+#include "CyderPluginChain.hpp"
+#include "CyderPluginGraph.hpp"
+#include "CyderPluginLoader.hpp"
+#include "CyderProcessBridge.hpp"
+#include "CyderRealtimeGuard.hpp"
+#include "CyderTempJanitor.hpp"
+#include "CyderWatchdog.hpp"
+#include "HotReloadThread.hpp"
+
+#include <atomic>
 #include <memory>
+#include <optional>
 
 //==============================================================================
 
@@ -29,9 +44,17 @@ enum class CyderStatus
     successfullyReloadedPlugin,
     failedToLoadPlugin,
     failedToReloadPlugin,
+    nullTestBitExact,
+    nullTestDiffers,
+    building,
+    buildFailed,
+    rolledBack,
+    wrappedPluginCrashed,
+    wrappedPluginOverran,
 };
 
-class HotReloadThread;
+class CyderChannelMap;
+class CyderDelayLine;
 
 //==============================================================================
 
@@ -43,6 +66,11 @@ public:
     CyderAudioProcessor();
     ~CyderAudioProcessor() override;
     
+    /** Widest main bus we accept, i.e. 7.1.4. */
+    static constexpr int maxNumMainChannels = 12;
+    /** How long bypassing (and loading into an empty Cyder) crossfades for. */
+    static constexpr double bypassFadeSeconds = 0.02;
+    
     //==============================================================================
     
     /** */
@@ -50,6 +78,41 @@ public:
     /** */
     void unloadPlugin();
     
+    /**
+     @returns true while the wrapped plugin, or the chain's or graph's plugins, from a restored state are
+     still being copied and scanned in the background. Audio passes through each of them until it is in,
+     and getStateInformation() keeps reporting those plugins and their state as they were restored.
+     @see setStateInformation()
+     */
+    bool isRestoringState() const noexcept;
+    
+    /**
+     Swaps back to a build kept in the build history, restoring the state the plugin had when that
+     build was replaced. Nothing is rebuilt or copied, so it is as quick as a hot reload. The build
+     rolled away from takes its place in the history, so a rollback can itself be undone.
+     Message thread only.
+     @param snapshotIndex 0 for the build before the current one
+     @returns false if there is no such build, or it failed to load
+     */
+    bool rollBack(int snapshotIndex = 0);
+    /** @returns previous builds of the wrapped plugin, most recent first */
+    CyderBuildHistory& getBuildHistory() noexcept;
+    
+    /**
+     Hosts the wrapped plugin in a child process of its own, so a build that crashes leaves the DAW
+     (and us) running: audio passes through dry until the child has been relaunched, which reports
+     CyderStatus::wrappedPluginCrashed. Hot reloads replace the child. Whatever is loaded is reloaded
+     in the new mode, keeping its state. Out of process, the plugin has no editor and no sidechain.
+     Saved with our state. Message thread only.
+     @returns false if out-of-process hosting is not supported on this platform
+     @see CyderProcessBridge
+     */
+    bool setOutOfProcessHosting(bool shouldHostOutOfProcess);
+    /** */
+    bool isOutOfProcessHostingEnabled() const noexcept;
+    /** @returns bridge to the child process hosting the wrapped plugin, or nullptr if it is hosted in process */
+    CyderProcessBridge* getProcessBridge() const noexcept;
+    
     /**
      Get current status without resetting it to Idle.
      @returns current CyderStatus
@@ -68,9 +131,111 @@ public:
     /** */
     juce::AudioProcessorEditor* getWrappedPluginEditor() const noexcept;
     
+    /**
+     Creates the wrapped plugin's editor if it does not exist yet.
+     Called when our editor opens so that closed windows cost nothing.
+     @returns wrapped plugin's editor, or nullptr if no plugin is loaded
+     @see releaseWrappedEditor()
+     */
+    juce::AudioProcessorEditor* createWrappedEditorIfNeeded();
+    /**
+     Destroys the wrapped plugin's editor, remembering its size for the next one.
+     Called when our editor closes.
+     @see createWrappedEditorIfNeeded()
+     */
+    void releaseWrappedEditor() noexcept;
+    
     /** */
     juce::Thread* getHotReloadThread() const noexcept;
     
+    /**
+     Rebuilds the wrapped plugin whenever a file in the source directory is saved, running
+     the build command and reloading as soon as it succeeds. Reports CyderStatus::building
+     and CyderStatus::buildFailed along the way. Pass default settings to turn it off again.
+     Message thread only.
+     */
+    void setBuildSettings(const CyderBuildSettings& newSettings);
+    /** */
+    const CyderBuildSettings& getBuildSettings() const noexcept;
+    
+    /**
+     Build settings restored with a session are never run straight away, since a session may come from
+     anyone. They wait here until confirmed, unless they are the ones already in use.
+     @returns settings restored by setStateInformation() and not yet confirmed, if any
+     */
+    const std::optional<CyderBuildSettings>& getUnconfirmedBuildSettings() const noexcept;
+    /** Starts building with the restored settings, as if they had been passed to setBuildSettings(). Message thread only. */
+    void confirmBuildSettings();
+    
+    /** @returns the chain of plugins processed in series after the main wrapped plugin */
+    CyderPluginChain& getPluginChain() noexcept;
+    /** @returns the parallel branches processed after the plugin chain */
+    CyderPluginGraph& getPluginGraph() noexcept;
+    
+    /**
+     @returns the parameters we publish to the host, each standing in for one of the wrapped plugin's.
+     Their mapping is kept across reloads and saved with our state.
+     */
+    CyderParameterProxies& getParameterProxies() noexcept;
+    
+    /**
+     Keeps the latency reported to the host fixed at the given ceiling. Whatever we
+     host is padded up to it with a delay, so a reload that changes the wrapped
+     plugin's latency never makes the host re-align in the middle of playback.
+     If the actual latency ever exceeds the ceiling, it is reported as-is.
+     Pass 0 to report the actual latency again. Message thread only.
+     */
+    void setLatencyCeilingSamples(int ceilingSamples);
+    /** @returns fixed latency reported to the host, or 0 if the actual latency is reported */
+    int getLatencyCeilingSamples() const noexcept;
+    /** @returns delay currently padding our actual latency up to the ceiling */
+    int getLatencyPaddingSamples() const noexcept;
+    
+    /**
+     When enabled, every reload of the same plugin keeps the previous build alive
+     until a fixed test signal has been run through it and the new build offline,
+     and reports whether their output differs.
+     @see getLastNullTestResult()
+     */
+    void setNullTestOnReload(bool shouldNullTest) noexcept;
+    /** */
+    bool isNullTestOnReloadEnabled() const noexcept;
+    /** */
+    bool isNullTestRunning() const noexcept;
+    /** @returns result of the most recently completed null test, if any */
+    std::optional<CyderNullTestResult> getLastNullTestResult() const noexcept;
+    
+    /**
+     @returns allocation and lock counts from the audio thread, for Cyder and the plugins it wraps
+     @see CyderRealtimeGuard
+     */
+    CyderRealtimeGuard& getRealtimeGuard() noexcept;
+    
+    /**
+     Times every block the wrapped plugin processes (in or out of process). When it keeps taking
+     longer than its block's duration allows, or hangs, we are bypassed and report
+     CyderStatus::wrappedPluginOverran. Set the thresholds on it, and find what tripped it there.
+     @see CyderWatchdog
+     */
+    CyderWatchdog& getWatchdog() noexcept;
+    
+    /**
+     Bypassing crossfades to the dry input, delayed by the latency reported to the host, so
+     nothing jumps in time either way. While fully bypassed, nothing we host is processed.
+     Hosts see this as their bypass parameter. Any thread.
+     */
+    void setBypassed(bool shouldBeBypassed);
+    /** */
+    bool isBypassed() const noexcept;
+    
+    /**
+     @returns sample rate of the last prepareToPlay() that had a valid one, or 0 if there was none yet.
+     Plugins loaded while we aren't prepared are only instantiated, and prepared along with us.
+     */
+    double getLastValidSampleRate() const noexcept;
+    /** @returns block size of the last prepareToPlay() that had a valid one, or 0 if there was none yet */
+    int getLastValidBlockSize() const noexcept;
+    
     /** */
     juce::File getCurrentWrappedPluginPathCopy() const noexcept;
     /** */
@@ -101,35 +266,138 @@ public:
     const juce::String getProgramName (int index) override;
     void changeProgramName (int index, const juce::String& newName) override;
 
+    juce::AudioProcessorParameter* getBypassParameter() const override;
+
     void getStateInformation (juce::MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
     
     //==============================================================================
     
-    void audioProcessorParameterChanged (juce::AudioProcessor* /*processor*/,
-                                         int /*parameterIndex*/,
-                                         float /*newValue*/) override {}
+    void audioProcessorParameterChanged (juce::AudioProcessor* processor,
+                                         int parameterIndex,
+                                         float newValue) override;
+    void audioProcessorParameterChangeGestureBegin (juce::AudioProcessor* processor,
+                                                    int parameterIndex) override;
+    void audioProcessorParameterChangeGestureEnd (juce::AudioProcessor* processor,
+                                                  int parameterIndex) override;
     void audioProcessorChanged (juce::AudioProcessor* processor,
                                 const AudioProcessorListener::ChangeDetails& details) override;
     
     //==============================================================================
     
 private:
+    // Declared first so it outlives every plugin copy it may be asked to delete
+    juce::SharedResourcePointer<CyderTempJanitor> tempJanitor;
+    juce::SharedResourcePointer<CyderPluginLoader> pluginLoader;
+    
     CyderStatus currentStatus = CyderStatus::idle;
     
+    bool isPreparedToPlay = false; // between prepareToPlay() and releaseResources()
+    double lastValidSampleRate = 0.0;
+    int lastValidBlockSize = 0;
+    
     juce::File currentPluginFileOriginal;
     juce::File currentPluginFileCopy;
+    juce::PluginDescription currentPluginDescription; // refers to currentPluginFileCopy
+    
+    CyderBuildHistory buildHistory; // previous builds' copies, retired as they fall out of it
     
     std::unique_ptr<juce::AudioPluginInstance>  wrappedPlugin;
+    std::unique_ptr<CyderChannelMap>            wrappedChannelMap; // swapped along with the plugin
     std::unique_ptr<juce::AudioProcessorEditor> wrappedPluginEditor;
+    std::optional<juce::Rectangle<int>> wrappedEditorSize; // survives reloads and closed windows
+    
+    bool outOfProcessHosting = false;
+    std::unique_ptr<CyderProcessBridge> processBridge; // instead of wrappedPlugin, when hosting out of process
     
     std::unique_ptr<HotReloadThread> hotReloadThread;
     
+    // Restored state waiting for its wrapped plugin to be prepared in the background, see setStateInformation()
+    struct PendingRestore
+    {
+        juce::File pluginFile;
+        std::optional<juce::MemoryBlock> wrappedState; // decoded, for the plugin once it is in
+    };
+    std::optional<PendingRestore> pendingRestore;
+    int restoreGeneration = 0; // bumped whenever a restore is started or cancelled, so stale ones are dropped
+    CyderBuildSettings buildSettings;
+    std::optional<CyderBuildSettings> unconfirmedBuildSettings; // restored, but not run until confirmed, saved as they were
+    
+    CyderPluginChain pluginChain { getCallbackLock() };
+    CyderPluginGraph pluginGraph { getCallbackLock() };
+    
+    CyderParameterProxies parameterProxies { *this, getCallbackLock() };
+    
     juce::AudioBuffer<float> monoToStereoBuffer;
     
+    // Held notes and pedals, handed to every new instance of the wrapped plugin when it takes over
+    CyderMidiState midiState;
+    juce::MidiBuffer takeoverMidi;       // preallocated, so seeding never allocates on the audio thread
+    bool midiTakeoverPending = false;    // set under the callback lock when a new instance is swapped in
+    
+    CyderRealtimeGuard realtimeGuard;
+    CyderWatchdog watchdog; // bypasses us from its own thread, stopped before anything else is torn down
+    
+    bool nullTestOnReload = false;
+    std::unique_ptr<CyderNullTest> nullTest;
+    std::optional<CyderNullTestResult> lastNullTestResult;
+    
+    std::atomic<int> latencyCeilingSamples { 0 };
+    std::unique_ptr<CyderDelayLine> latencyPadding; // only exists while a ceiling is set
+    
+    // Dry signal, for bypassing and for when nothing is loaded, delayed by the latency we report
+    juce::AudioParameterBool* bypassParameter = nullptr; // owned by juce::AudioProcessor
+    juce::AudioBuffer<float> dryBuffer;
+    std::unique_ptr<CyderDelayLine> dryDelay;
+    juce::SmoothedValue<float> dryMix; // 0 = processed, 1 = dry
+    
     void transferPluginState(juce::AudioProcessor& destinationProcessor) noexcept;
+    /** Saves the wrapped plugin's state, wherever it is hosted. @returns false if nothing is loaded */
+    bool getWrappedPluginState(juce::MemoryBlock& destData);
+    /** Restores the wrapped plugin's state, wherever it is hosted. */
+    void setWrappedPluginState(const juce::MemoryBlock& state);
+    
+    /**
+     Instantiates a plugin already copied and scanned, and swaps it in. Message thread only.
+     @param stateToRestore state to give the plugin, otherwise a rebuild takes on the current state
+     */
+    bool loadPreparedPlugin(const CyderPluginLoader::PreparedPlugin& prepared,
+                            const juce::MemoryBlock* stateToRestore = nullptr);
+    /** Launches a child process hosting a plugin already copied and scanned, and swaps it in. Message thread only. */
+    bool loadPreparedPluginOutOfProcess(const CyderPluginLoader::PreparedPlugin& prepared,
+                                        const juce::MemoryBlock* stateToRestore);
+    /** Loads the plugin prepared for the pending restore, and gives it its state. */
+    void finishRestore(const CyderPluginLoader::PreparedPlugin& prepared);
+    /** Drops the pending restore (if any). Its copy is retired once it has been prepared. */
+    void cancelPendingRestore() noexcept;
+    
+    /**
+     Sets the plugin to our bus layout (including the sidechain) if it supports it, otherwise
+     to our main buses only, otherwise to whatever it accepts. Channels are lined up by CyderChannelMap.
+     */
+    void mirrorBusesLayout(juce::AudioProcessor& instance, double sampleRate, int blockSize) const;
     
+    /** (Re)starts watching the given plugin, and its source if a build is set up. */
+    void startHotReloadThread(const juce::File& pluginFile);
+    
+    /** Stops a null test in progress (if any), releasing the previous build. */
+    void cancelNullTest();
+    
+    /** Creates the wrapped plugin's editor and hands it to our editor, only if our editor is open. */
+    void showWrappedEditorInActiveEditor();
+    
+    /** Runs everything we host, unless there is nothing to run. */
+    void processHostedPlugins(juce::AudioBuffer<float>&, juce::MidiBuffer&);
     void processUsingMonoToStereoBuffer(juce::AudioBuffer<float>&, juce::MidiBuffer&);
+    /** Runs the main wrapped plugin, the plugin chain, then the plugin graph, in place. */
+    void processWrappedPlugins(juce::AudioBuffer<float>&, juce::MidiBuffer&);
+    
+    /** Reports the combined latency of everything we host to the host, or the ceiling if one is set. Any thread, takes the callback lock. */
+    void updateLatencySamples();
+    /** Allocates the padding delay for the current ceiling and swaps it in. */
+    void prepareLatencyPadding(int maximumBlockSize);
+    /** Runs the watchdog only while the host has us prepared and a wrapped plugin is loaded. Message thread. */
+    void updateWatchdog();
     
     JUCE_DECLARE_WEAK_REFERENCEABLE (CyderAudioProcessor)
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CyderAudioProcessor)
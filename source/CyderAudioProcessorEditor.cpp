@@ -21,6 +21,9 @@
 
 static constexpr int headerBarHeight = 22;
 
+/** Number of display frames the new wrapped editor gets to draw before its snapshot is removed. */
+static constexpr int numFramesToHoldReloadSnapshot = 2;
+
 //==============================================================================
 
 CyderAudioProcessorEditor::CyderAudioProcessorEditor(CyderAudioProcessor& p)
@@ -30,14 +33,22 @@ CyderAudioProcessorEditor::CyderAudioProcessorEditor(CyderAudioProcessor& p)
     headerBar = std::make_unique<CyderHeaderBar>(processor);
     addAndMakeVisible(headerBar.get());
     
+    reloadSnapshot.setImagePlacement(juce::RectanglePlacement::stretchToFit);
+    reloadSnapshot.setInterceptsMouseClicks(false, false);
+    addChildComponent(reloadSnapshot);
+    
+    vBlankAttachment = std::make_unique<juce::VBlankAttachment>(this, [this] { onVBlank(); });
+    
     setSize(400, 300);
     
-    loadWrappedEditor(processor.getWrappedPluginEditor());
+    // Wrapped editor only exists while our window is open
+    loadWrappedEditor(processor.createWrappedEditorIfNeeded());
 }
 
 CyderAudioProcessorEditor::~CyderAudioProcessorEditor()
 {
     unloadWrappedEditor(processor.getWrappedPluginEditor());
+    processor.releaseWrappedEditor();
 }
 
 void CyderAudioProcessorEditor::paint(juce::Graphics& g)
@@ -71,15 +82,23 @@ bool CyderAudioProcessorEditor::isInterestedInFileDrag(const juce::StringArray&
 
 void CyderAudioProcessorEditor::filesDropped(const juce::StringArray& files, int /*x*/, int /*y*/)
 {
-    unloadWrappedEditor(processor.getWrappedPluginEditor());
-    
     fileDraggingOverEditor = false;
     
     const auto& pluginString = files[0];
+    
+    // Shift-drop appends to the plugin chain instead of replacing the main plugin
+    const bool appendToChain = juce::ModifierKeys::currentModifiers.isShiftDown()
+                               && processor.getWrappedPluginProcessor() != nullptr;
+    if (appendToChain)
+    {
+        [[maybe_unused]] auto result = processor.getPluginChain().appendPlugin(juce::File(pluginString));
+        jassert(result);
+        return;
+    }
+    
+    // Processor swaps out our wrapped editor itself once the new plugin is running
     [[maybe_unused]] auto result = processor.loadPlugin(pluginString);
     jassert(result);
-    
-    loadWrappedEditor(processor.getWrappedPluginEditor());
 }
 
 void CyderAudioProcessorEditor::fileDragEnter(const juce::StringArray& /*files*/, int /*x*/, int /*y*/)
@@ -94,16 +113,10 @@ void CyderAudioProcessorEditor::fileDragExit(const juce::StringArray& /*files*/)
     repaint();
 }
 
-void CyderAudioProcessorEditor::unloadWrappedEditor(juce::AudioProcessorEditor* editor, bool shouldCacheSize)
+void CyderAudioProcessorEditor::unloadWrappedEditor(juce::AudioProcessorEditor* editor)
 {
     if (editor != nullptr)
     {
-        if (shouldCacheSize)
-        {
-            cachedWidth = editor->getWidth();
-            cachedHeight = editor->getHeight();
-        }
-        
         editor->removeComponentListener(this);
         removeChildComponent(editor);
         removeChildComponent(headerBar.get());
@@ -116,24 +129,63 @@ void CyderAudioProcessorEditor::loadWrappedEditor(juce::AudioProcessorEditor* ed
     {
         addAndMakeVisible(editor);
         
-        if (cachedWidth.has_value() && cachedHeight.has_value())
-        {
-            const auto width  = std::exchange(cachedWidth,  std::nullopt).value();
-            const auto height = std::exchange(cachedHeight,  std::nullopt).value();
-            editor->setSize(width, height);
-        }
-        else
-            setSize(editor->getWidth(),
-                    editor->getHeight() + headerBarHeight);
+        setSize(editor->getWidth(),
+                editor->getHeight() + headerBarHeight);
         
         addChildComponent(headerBar.get());
         headerBar->setBounds(0, 0, getWidth(), headerBarHeight);
         
         editor->setTopLeftPosition(0, headerBarHeight);
         editor->addComponentListener(this);
+        
+        // Keep painting the old editor on top until the new one has had a chance to draw
+        if (isShowingReloadSnapshot())
+        {
+            reloadSnapshot.toFront(false);
+            framesUntilSnapshotReleased = numFramesToHoldReloadSnapshot;
+        }
     }
 }
 
+void CyderAudioProcessorEditor::holdReloadSnapshot(juce::AudioProcessorEditor* editor)
+{
+    if (editor == nullptr || editor->getWidth() <= 0 || editor->getHeight() <= 0)
+        return;
+    
+    const auto scaleFactor = juce::Component::getApproximateScaleFactorForComponent(editor);
+    auto image = editor->createComponentSnapshot(editor->getLocalBounds(),
+                                                 /*clipImageToComponentBounds*/true,
+                                                 scaleFactor);
+    
+    reloadSnapshot.setImage(image);
+    reloadSnapshot.setBounds(editor->getBoundsInParent());
+    reloadSnapshot.setVisible(true);
+    reloadSnapshot.toFront(false);
+    
+    framesUntilSnapshotReleased = 0; // wait until the next editor is loaded
+}
+
+void CyderAudioProcessorEditor::releaseReloadSnapshot()
+{
+    framesUntilSnapshotReleased = 0;
+    reloadSnapshot.setVisible(false);
+    reloadSnapshot.setImage(juce::Image()); // free the image memory
+}
+
+bool CyderAudioProcessorEditor::isShowingReloadSnapshot() const noexcept
+{
+    return reloadSnapshot.isVisible();
+}
+
+void CyderAudioProcessorEditor::onVBlank()
+{
+    if (framesUntilSnapshotReleased <= 0)
+        return;
+    
+    if (--framesUntilSnapshotReleased == 0)
+        releaseReloadSnapshot();
+}
+
 void CyderAudioProcessorEditor::componentMovedOrResized(juce::Component& /*component*/,
                                                         bool /*wasMoved*/,
                                                         bool wasResized)
@@ -186,8 +238,6 @@ void CyderAudioProcessorEditor::mouseDoubleClick(const juce::MouseEvent&)
         [[maybe_unused]] bool loadResult = safePtr->processor.loadPlugin(selectedFile.getFullPathName());
         jassert(loadResult);
         
-        safePtr->loadWrappedEditor(safePtr->processor.getWrappedPluginEditor());
-        
         safePtr->fileChooser.reset(); // delete file browser
     });
 }
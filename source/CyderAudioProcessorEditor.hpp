@@ -38,10 +38,21 @@ public:
     void resized() override;
     
     /** */
-    void unloadWrappedEditor(juce::AudioProcessorEditor* editor, bool shouldCacheSize = false);
-    /** */
+    void unloadWrappedEditor(juce::AudioProcessorEditor* editor);
+    /** Shows the editor at whatever size it has, which the processor keeps across reloads. */
     void loadWrappedEditor(juce::AudioProcessorEditor* editor);
     
+    /**
+     Captures an image of the wrapped editor and paints it in the editor's place
+     until the next wrapped editor has been loaded and rendered its first frame.
+     Call before unloading the outgoing editor during a reload.
+     */
+    void holdReloadSnapshot(juce::AudioProcessorEditor* editor);
+    /** Removes the reload snapshot, if any, revealing whatever is underneath. */
+    void releaseReloadSnapshot();
+    /** @returns true while a snapshot of the previous wrapped editor is being painted. */
+    [[nodiscard]] bool isShowingReloadSnapshot() const noexcept;
+    
     /** */
     [[nodiscard]] bool isFileDraggingOverEditor() const noexcept;
     
@@ -57,8 +68,9 @@ private:
     
     std::unique_ptr<juce::FileChooser> fileChooser;
     
-    std::optional<int> cachedWidth;
-    std::optional<int> cachedHeight;
+    juce::ImageComponent reloadSnapshot;
+    std::unique_ptr<juce::VBlankAttachment> vBlankAttachment;
+    int framesUntilSnapshotReleased = 0;
     
     bool fileDraggingOverEditor = false;
     
@@ -74,6 +86,8 @@ private:
                                  bool wasResized) override;
     
     void mouseDoubleClick(const juce::MouseEvent& event) override;
+    
+    void onVBlank();
 
     JUCE_DECLARE_WEAK_REFERENCEABLE (CyderAudioProcessorEditor)
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CyderAudioProcessorEditor)
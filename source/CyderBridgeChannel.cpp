@@ -0,0 +1,249 @@
+/******************************************************************************
+ * Cyder — Hot-Reloading Audio Plugin Wrapper
+ *
+ * @file     CyderBridgeChannel.cpp
+ *
+ * @author   Adam Shield
+ * @date     2026-10-19
+ *
+ * @copyright (c) 2026 Adam Shield
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * See LICENSE.txt for license terms.
+ ******************************************************************************/
+
+#include "CyderBridgeChannel.hpp"
+
+#include <cstring>
+#include <new>
+
+#if JUCE_LINUX
+#include <ctime>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+//==============================================================================
+
+// Futexes work on the word itself, so it must never hide behind a lock
+static_assert(std::atomic<uint32_t>::is_always_lock_free);
+static_assert(std::atomic<double>::is_always_lock_free);
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t));
+
+/** Bytes each event is prefixed with: sample position and size. */
+static constexpr int midiEventHeaderBytes = 6;
+
+//==============================================================================
+
+std::unique_ptr<CyderBridgeChannel> CyderBridgeChannel::create(int maxBlockSize)
+{
+#if JUCE_LINUX
+    jassert(maxBlockSize > 0);
+
+    const auto name = "/cyder-" + juce::String(static_cast<int>(getpid())) + "-" + juce::Uuid().toDashedString();
+    const auto fd = shm_open(name.toRawUTF8(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0)
+        return nullptr;
+
+    const auto size = getTotalSize(maxBlockSize);
+    void* data = MAP_FAILED;
+    if (ftruncate(fd, static_cast<off_t>(size)) == 0)
+        data = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd); // the mapping keeps it alive
+
+    if (data == MAP_FAILED)
+    {
+        shm_unlink(name.toRawUTF8());
+        return nullptr;
+    }
+
+    auto* header = new (data) Header();
+    header->magic        = magic;
+    header->version      = protocolVersion;
+    header->maxBlockSize = maxBlockSize;
+
+    return std::unique_ptr<CyderBridgeChannel>(new CyderBridgeChannel(name, data, size, /*owned*/ true));
+#else
+    juce::ignoreUnused(maxBlockSize);
+    return nullptr;
+#endif
+}
+
+std::unique_ptr<CyderBridgeChannel> CyderBridgeChannel::open(const juce::String& name)
+{
+#if JUCE_LINUX
+    const auto fd = shm_open(name.toRawUTF8(), O_RDWR, 0600);
+    if (fd < 0)
+        return nullptr;
+
+    struct stat info {};
+    void* data = MAP_FAILED;
+    if (fstat(fd, &info) == 0 && static_cast<size_t>(info.st_size) >= sizeof(Header))
+        data = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (data == MAP_FAILED)
+        return nullptr;
+
+    std::unique_ptr<CyderBridgeChannel> channel(new CyderBridgeChannel(name, data, static_cast<size_t>(info.st_size), /*owned*/ false));
+
+    // Built by another Cyder, or not finished being set up
+    const auto& header = channel->getHeader();
+    if (header.magic != magic
+        || header.version != protocolVersion
+        || header.maxBlockSize <= 0
+        || getTotalSize(header.maxBlockSize) > channel->size)
+        return nullptr;
+
+    return channel;
+#else
+    juce::ignoreUnused(name);
+    return nullptr;
+#endif
+}
+
+CyderBridgeChannel::CyderBridgeChannel(const juce::String& nameToUse, void* dataToUse, size_t sizeToUse, bool isOwned) noexcept
+: name(nameToUse)
+, data(dataToUse)
+, size(sizeToUse)
+, owned(isOwned)
+{
+}
+
+CyderBridgeChannel::~CyderBridgeChannel()
+{
+#if JUCE_LINUX
+    munmap(data, size);
+    if (owned)
+        shm_unlink(name.toRawUTF8());
+#endif
+}
+
+bool CyderBridgeChannel::isSupported() noexcept
+{
+#if JUCE_LINUX
+    return true;
+#else
+    return false;
+#endif
+}
+
+const juce::String& CyderBridgeChannel::getName() const noexcept
+{
+    return name;
+}
+
+CyderBridgeChannel::Header& CyderBridgeChannel::getHeader() noexcept
+{
+    return *static_cast<Header*>(data);
+}
+
+float* CyderBridgeChannel::getChannel(int channel) noexcept
+{
+    jassert(juce::isPositiveAndBelow(channel, maxNumChannels));
+    const auto channelBytes = static_cast<size_t>(getHeader().maxBlockSize) * sizeof(float);
+    return reinterpret_cast<float*>(static_cast<uint8_t*>(data) + getAudioOffset() + static_cast<size_t>(channel) * channelBytes);
+}
+
+uint8_t* CyderBridgeChannel::getMidiData() noexcept
+{
+    const auto audioBytes = static_cast<size_t>(maxNumChannels) * static_cast<size_t>(getHeader().maxBlockSize) * sizeof(float);
+    return static_cast<uint8_t*>(data) + getAudioOffset() + audioBytes;
+}
+
+uint8_t* CyderBridgeChannel::getPayloadData() noexcept
+{
+    return getMidiData() + maxMidiBytes;
+}
+
+//==============================================================================
+
+int CyderBridgeChannel::writeMidi(const juce::MidiBuffer& source, uint8_t* dest, int maxBytes) noexcept
+{
+    int numBytes = 0;
+    for (const auto metadata : source)
+    {
+        const auto eventBytes = midiEventHeaderBytes + metadata.numBytes;
+        if (metadata.numBytes > 0xffff || numBytes + eventBytes > maxBytes)
+            break; // out of room, later events are dropped
+
+        const auto samplePosition = static_cast<int32_t>(metadata.samplePosition);
+        const auto eventSize      = static_cast<uint16_t>(metadata.numBytes);
+        std::memcpy(dest + numBytes,     &samplePosition, sizeof(samplePosition));
+        std::memcpy(dest + numBytes + 4, &eventSize,      sizeof(eventSize));
+        std::memcpy(dest + numBytes + midiEventHeaderBytes, metadata.data, static_cast<size_t>(metadata.numBytes));
+        numBytes += eventBytes;
+    }
+    return numBytes;
+}
+
+void CyderBridgeChannel::readMidi(const uint8_t* source, int numBytes, juce::MidiBuffer& dest)
+{
+    int position = 0;
+    while (position + midiEventHeaderBytes <= numBytes)
+    {
+        int32_t samplePosition = 0;
+        uint16_t eventSize = 0;
+        std::memcpy(&samplePosition, source + position,     sizeof(samplePosition));
+        std::memcpy(&eventSize,      source + position + 4, sizeof(eventSize));
+        position += midiEventHeaderBytes;
+
+        if (position + eventSize > numBytes)
+            break; // torn, never written by writeMidi()
+
+        dest.addEvent(source + position, eventSize, samplePosition);
+        position += eventSize;
+    }
+}
+
+//==============================================================================
+
+bool CyderBridgeChannel::wait(std::atomic<uint32_t>& word, uint32_t expected, juce::int64 timeoutNanos) noexcept
+{
+#if JUCE_LINUX
+    if (word.load(std::memory_order_acquire) != expected)
+        return true;
+    if (timeoutNanos <= 0)
+        return false;
+
+    timespec timeout {};
+    timeout.tv_sec  = static_cast<time_t>(timeoutNanos / 1000000000);
+    timeout.tv_nsec = static_cast<long>(timeoutNanos % 1000000000);
+
+    // Not FUTEX_PRIVATE_FLAG, the other side is another process. Wakes early on signals, the caller loops.
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT, expected, &timeout, nullptr, 0);
+    return word.load(std::memory_order_acquire) != expected;
+#else
+    juce::ignoreUnused(timeoutNanos);
+    return word.load(std::memory_order_acquire) != expected;
+#endif
+}
+
+void CyderBridgeChannel::wake(std::atomic<uint32_t>& word) noexcept
+{
+#if JUCE_LINUX
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE, INT32_MAX, nullptr, nullptr, 0);
+#else
+    juce::ignoreUnused(word);
+#endif
+}
+
+//==============================================================================
+
+size_t CyderBridgeChannel::getAudioOffset() noexcept
+{
+    constexpr size_t pageSize = 4096; // audio starts on a page of its own
+    return (sizeof(Header) + pageSize - 1) / pageSize * pageSize;
+}
+
+size_t CyderBridgeChannel::getTotalSize(int maxBlockSize) noexcept
+{
+    return getAudioOffset()
+         + static_cast<size_t>(maxNumChannels) * static_cast<size_t>(maxBlockSize) * sizeof(float)
+         + static_cast<size_t>(maxMidiBytes)
+         + static_cast<size_t>(maxPayloadBytes);
+}
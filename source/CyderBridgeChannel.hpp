@@ -0,0 +1,142 @@
+/******************************************************************************
+ * Cyder — Hot-Reloading Audio Plugin Wrapper
+ *
+ * @file     CyderBridgeChannel.hpp
+ *
+ * @author   Adam Shield
+ * @date     2026-10-19
+ *
+ * @copyright (c) 2026 Adam Shield
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * See LICENSE.txt for license terms.
+ ******************************************************************************/
+
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+//==============================================================================
+
+/**
+ Shared memory between Cyder and Cyder_PluginHost, the child process hosting the
+ wrapped plugin out of process (see CyderProcessBridge).
+
+ One block is in flight at a time: Cyder writes audio and MIDI, then bumps
+ requestSequence. The host processes them in place, then bumps responseSequence.
+ Neither side takes a lock. Both sides sleep and wake on the sequence words
+ themselves (futexes shared across processes). Commands such as saving and
+ restoring state have sequence words of their own, and a separate payload area,
+ so they never touch the audio.
+
+ Linux only for now, elsewhere create() and open() return nullptr.
+ */
+class CyderBridgeChannel final
+{
+public:
+    static constexpr uint32_t magic           = 0x43594442; // 'CYDB'
+    static constexpr uint32_t protocolVersion = 1;
+
+    static constexpr int maxNumChannels  = 32;
+    static constexpr int maxMidiBytes    = 64 * 1024;
+    static constexpr int maxPayloadBytes = 16 * 1024 * 1024;
+
+    enum class HostState : uint32_t
+    {
+        starting,
+        ready,
+        failed,
+    };
+
+    enum class Command : uint32_t
+    {
+        none,
+        getState,
+        setState,
+    };
+
+    /** Lives at the start of the shared memory. The sequence words get cache lines of their own. */
+    struct Header
+    {
+        // Written by Cyder before the host is launched
+        uint32_t magic = 0;
+        uint32_t version = 0;
+        int32_t  numChannels = 0;
+        int32_t  maxBlockSize = 0;
+        double   sampleRate = 0.0;
+
+        std::atomic<uint32_t> hostState { static_cast<uint32_t>(HostState::starting) };
+        std::atomic<uint32_t> shouldExit { 0 };
+        std::atomic<int32_t>  hostProcessId { 0 };     // reported by the host
+        std::atomic<int32_t>  latencySamples { 0 };
+        std::atomic<double>   tailLengthSeconds { 0.0 };
+
+        // Audio
+        alignas(64) std::atomic<uint32_t> requestSequence { 0 };
+        alignas(64) std::atomic<uint32_t> responseSequence { 0 };
+        int32_t numSamples = 0;
+        int32_t numMidiBytes = 0;
+
+        // Commands
+        alignas(64) std::atomic<uint32_t> commandSequence { 0 };
+        alignas(64) std::atomic<uint32_t> commandDoneSequence { 0 };
+        uint32_t command = 0;
+        uint32_t commandSucceeded = 0;
+        uint64_t payloadBytes = 0;
+    };
+
+    /** Creates new shared memory, for Cyder's side. It is unlinked again when this is destroyed. */
+    [[nodiscard]] static std::unique_ptr<CyderBridgeChannel> create(int maxBlockSize);
+    /** Opens shared memory created by Cyder, for the host's side. */
+    [[nodiscard]] static std::unique_ptr<CyderBridgeChannel> open(const juce::String& name);
+
+    ~CyderBridgeChannel();
+
+    /** @returns false where there are no shared memory futexes to signal with */
+    [[nodiscard]] static bool isSupported() noexcept;
+
+    /** @returns name to open() this by, in the host */
+    [[nodiscard]] const juce::String& getName() const noexcept;
+
+    /** */
+    [[nodiscard]] Header& getHeader() noexcept;
+    /** @returns room for header.maxBlockSize samples */
+    [[nodiscard]] float* getChannel(int channel) noexcept;
+    /** @returns MIDI going to the host, overwritten with the MIDI coming back */
+    [[nodiscard]] uint8_t* getMidiData() noexcept;
+    /** @returns room for the payload of a command */
+    [[nodiscard]] uint8_t* getPayloadData() noexcept;
+
+    /**
+     Writes as many events as fit, each as sample position, size and bytes. Never allocates.
+     @returns number of bytes written
+     */
+    static int writeMidi(const juce::MidiBuffer& source, uint8_t* dest, int maxBytes) noexcept;
+    /** Adds events written by writeMidi() to dest, which only allocates if it is out of room. */
+    static void readMidi(const uint8_t* source, int numBytes, juce::MidiBuffer& dest);
+
+    /**
+     Sleeps until word no longer holds expected, or until the timeout. Works across processes.
+     @returns false if it still holds expected
+     */
+    static bool wait(std::atomic<uint32_t>& word, uint32_t expected, juce::int64 timeoutNanos) noexcept;
+    /** Wakes everyone waiting on word, in any process. */
+    static void wake(std::atomic<uint32_t>& word) noexcept;
+
+private:
+    CyderBridgeChannel(const juce::String& name, void* data, size_t size, bool owned) noexcept;
+
+    juce::String name;
+    void* data = nullptr;
+    size_t size = 0;
+    bool owned = false; // unlinked on destruction
+
+    [[nodiscard]] static size_t getAudioOffset() noexcept;
+    [[nodiscard]] static size_t getTotalSize(int maxBlockSize) noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CyderBridgeChannel)
+};
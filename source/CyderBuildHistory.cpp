@@ -0,0 +1,146 @@
+/******************************************************************************
+ * Cyder — Hot-Reloading Audio Plugin Wrapper
+ *
+ * @file     CyderBuildHistory.cpp
+ *
+ * @author   Adam Shield
+ * @date     2026-10-19
+ *
+ * @copyright (c) 2026 Adam Shield
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * See LICENSE.txt for license terms.
+ ******************************************************************************/
+
+#include "CyderBuildHistory.hpp"
+
+#include "CyderTempJanitor.hpp"
+#include "Utilities.hpp"
+
+#include <algorithm>
+#include <utility>
+
+//==============================================================================
+
+juce::MemoryBlock CyderBuildHistory::Snapshot::getState() const
+{
+    juce::MemoryBlock state;
+    juce::MemoryInputStream compressed(compressedState, false);
+    juce::GZIPDecompressorInputStream decompressor(compressed);
+    juce::MemoryOutputStream(state, false).writeFromInputStream(decompressor, -1);
+    return state;
+}
+
+//==============================================================================
+
+CyderBuildHistory::~CyderBuildHistory()
+{
+    clear();
+}
+
+void CyderBuildHistory::push(const juce::File& originalFile,
+                             const juce::File& copiedPlugin,
+                             const juce::PluginDescription& description,
+                             const juce::MemoryBlock& state)
+{
+    Snapshot snapshot;
+    snapshot.originalFile = originalFile;
+    snapshot.copiedPlugin = copiedPlugin;
+    snapshot.description  = description;
+    snapshot.time         = juce::Time::getCurrentTime();
+
+    {
+        juce::MemoryOutputStream compressed(snapshot.compressedState, false);
+        juce::GZIPCompressorOutputStream compressor(compressed);
+        compressor.write(state.getData(), state.getSize());
+    }
+
+    // Counting the memfd a copy staged in memory is served from, which takes up no folder's space
+    juce::SharedResourcePointer<CyderTempJanitor> janitor;
+    snapshot.sizeBytes = janitor->getStagedSize(copiedPlugin)
+                       + static_cast<juce::int64>(snapshot.compressedState.getSize());
+
+    totalSizeBytes += snapshot.sizeBytes;
+    snapshots.push_front(std::move(snapshot));
+
+    retireOldestUntilWithinLimits();
+}
+
+std::optional<CyderBuildHistory::Snapshot> CyderBuildHistory::take(int index)
+{
+    if (! juce::isPositiveAndBelow(index, getNumSnapshots()))
+        return std::nullopt;
+
+    const auto it = snapshots.begin() + index;
+    auto snapshot = std::move(*it);
+    snapshots.erase(it);
+    totalSizeBytes -= snapshot.sizeBytes;
+    return snapshot;
+}
+
+void CyderBuildHistory::clear()
+{
+    for (const auto& snapshot : snapshots)
+        Utilities::deleteStalePlugin(snapshot.copiedPlugin);
+
+    snapshots.clear();
+    totalSizeBytes = 0;
+}
+
+int CyderBuildHistory::getNumSnapshots() const noexcept
+{
+    return static_cast<int>(snapshots.size());
+}
+
+const CyderBuildHistory::Snapshot* CyderBuildHistory::getSnapshot(int index) const noexcept
+{
+    return juce::isPositiveAndBelow(index, getNumSnapshots()) ? &snapshots[static_cast<size_t>(index)]
+                                                              : nullptr;
+}
+
+juce::int64 CyderBuildHistory::getTotalSizeBytes() const noexcept
+{
+    return totalSizeBytes;
+}
+
+void CyderBuildHistory::setLimits(int newMaxNumSnapshots, juce::int64 newMemoryBudgetBytes)
+{
+    jassert(newMaxNumSnapshots >= 0 && newMemoryBudgetBytes >= 0);
+    maxNumSnapshots   = std::max(0, newMaxNumSnapshots);
+    memoryBudgetBytes = std::max(juce::int64(0), newMemoryBudgetBytes);
+
+    retireOldestUntilWithinLimits();
+}
+
+int CyderBuildHistory::getMaxNumSnapshots() const noexcept
+{
+    return maxNumSnapshots;
+}
+
+juce::int64 CyderBuildHistory::getMemoryBudgetBytes() const noexcept
+{
+    return memoryBudgetBytes;
+}
+
+//==============================================================================
+
+void CyderBuildHistory::retireOldestUntilWithinLimits()
+{
+    auto isOverLimits = [this]
+    {
+        const auto numSnapshots = getNumSnapshots();
+        if (numSnapshots > maxNumSnapshots)
+            return true;
+
+        // The most recent build is worth keeping whatever it costs
+        return numSnapshots > 1 && totalSizeBytes > memoryBudgetBytes;
+    };
+
+    while (isOverLimits())
+    {
+        const auto& oldest = snapshots.back();
+        Utilities::deleteStalePlugin(oldest.copiedPlugin);
+        totalSizeBytes -= oldest.sizeBytes;
+        snapshots.pop_back();
+    }
+}
@@ -0,0 +1,98 @@
+/******************************************************************************
+ * Cyder — Hot-Reloading Audio Plugin Wrapper
+ *
+ * @file     CyderBuildHistory.hpp
+ *
+ * @author   Adam Shield
+ * @date     2026-10-19
+ *
+ * @copyright (c) 2026 Adam Shield
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * See LICENSE.txt for license terms.
+ ******************************************************************************/
+
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+
+#include <deque>
+#include <optional>
+
+//==============================================================================
+
+/**
+ The last few builds of the wrapped plugin, each kept as its staged copy along
+ with the plugin's state (compressed) from when it was replaced, so any of them
+ can be swapped back in without rebuilding or copying anything.
+
+ The history is bounded both in number of builds and in memory, counting copies
+ (usually staged in RAM) along with states. The oldest builds are retired first,
+ though the most recent one is always kept, whatever its size.
+
+ Message thread only.
+ */
+class CyderBuildHistory final
+{
+public:
+    static constexpr int defaultMaxNumSnapshots = 8;
+    static constexpr juce::int64 defaultMemoryBudgetBytes = juce::int64(512) * 1024 * 1024;
+
+    /** One build, as it was when it was replaced. */
+    struct Snapshot
+    {
+        juce::File originalFile;
+        juce::File copiedPlugin;             // owned by the history, until taken
+        juce::PluginDescription description; // refers to copiedPlugin
+        juce::MemoryBlock compressedState;
+        juce::Time time;
+        juce::int64 sizeBytes = 0;           // copy and compressed state
+
+        /** @returns the plugin's state, decompressed */
+        [[nodiscard]] juce::MemoryBlock getState() const;
+    };
+
+    CyderBuildHistory() = default;
+    /** Retires every copy still in the history. */
+    ~CyderBuildHistory();
+
+    /** Adds a build, taking over its copy. Retires the oldest builds to stay within limits. */
+    void push(const juce::File& originalFile,
+              const juce::File& copiedPlugin,
+              const juce::PluginDescription& description,
+              const juce::MemoryBlock& state);
+
+    /**
+     Removes a build from the history, handing its copy over to the caller.
+     @param index 0 for the most recent build
+     */
+    [[nodiscard]] std::optional<Snapshot> take(int index);
+
+    /** Retires every build. */
+    void clear();
+
+    /** */
+    [[nodiscard]] int getNumSnapshots() const noexcept;
+    /** @param index 0 for the most recent build @returns nullptr if out of range */
+    [[nodiscard]] const Snapshot* getSnapshot(int index) const noexcept;
+    /** */
+    [[nodiscard]] juce::int64 getTotalSizeBytes() const noexcept;
+
+    /** */
+    void setLimits(int maxNumSnapshots, juce::int64 memoryBudgetBytes);
+    /** */
+    [[nodiscard]] int getMaxNumSnapshots() const noexcept;
+    /** */
+    [[nodiscard]] juce::int64 getMemoryBudgetBytes() const noexcept;
+
+private:
+    std::deque<Snapshot> snapshots; // most recent first
+    juce::int64 totalSizeBytes = 0;
+
+    int maxNumSnapshots = defaultMaxNumSnapshots;
+    juce::int64 memoryBudgetBytes = defaultMemoryBudgetBytes;
+
+    void retireOldestUntilWithinLimits();
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CyderBuildHistory)
+};
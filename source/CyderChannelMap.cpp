@@ -0,0 +1,118 @@
+/******************************************************************************
+ * Cyder — Hot-Reloading Audio Plugin Wrapper
+ *
+ * @file     CyderChannelMap.cpp
+ *
+ * @author   Adam Shield
+ * @date     2026-10-19
+ *
+ * @copyright (c) 2026 Adam Shield
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * See LICENSE.txt for license terms.
+ ******************************************************************************/
+
+#include "CyderChannelMap.hpp"
+
+#include <algorithm>
+
+//==============================================================================
+
+void CyderChannelMap::prepare(const juce::AudioProcessor& host, const juce::AudioProcessor& wrapped, int maximumBlockSize)
+{
+    const auto numWrappedInputs = wrapped.getTotalNumInputChannels();
+    const auto numWrappedChannels = std::max(numWrappedInputs, wrapped.getTotalNumOutputChannels());
+    jassert(numWrappedChannels <= maxNumChannels);
+
+    hostChannels.assign(static_cast<size_t>(numWrappedChannels), -1);
+    identity = true;
+
+    for (int channel = 0; channel < numWrappedChannels; ++channel)
+    {
+        // Inputs and outputs share one buffer. Main buses are always the same layout in and out,
+        // so a channel is looked up as an input for as long as there are inputs.
+        const bool isInput = channel < numWrappedInputs;
+        int busIndex = 0;
+        const auto channelInBus = wrapped.getOffsetInBusBufferForAbsoluteChannelIndex(isInput, channel, busIndex);
+
+        const auto hostChannel = findHostChannel(host, wrapped, isInput, busIndex, channelInBus);
+        hostChannels[static_cast<size_t>(channel)] = hostChannel;
+        identity = identity && hostChannel == channel;
+    }
+
+    channelPointers.assign(static_cast<size_t>(numWrappedChannels), nullptr);
+
+    // Every missing channel gets its own silence, since the plugin is free to write to its inputs
+    const auto numMissing = static_cast<int>(std::count(hostChannels.begin(), hostChannels.end(), -1));
+    silence.setSize(std::max(1, numMissing), std::max(1, maximumBlockSize));
+    silence.clear();
+}
+
+bool CyderChannelMap::isIdentity() const noexcept
+{
+    return identity;
+}
+
+int CyderChannelMap::getHostChannel(int wrappedChannel) const noexcept
+{
+    return juce::isPositiveAndBelow(wrappedChannel, static_cast<int>(hostChannels.size()))
+               ? hostChannels[static_cast<size_t>(wrappedChannel)]
+               : -1;
+}
+
+juce::AudioBuffer<float>& CyderChannelMap::map(juce::AudioBuffer<float>& hostBuffer) noexcept
+{
+    const auto numSamples = hostBuffer.getNumSamples();
+
+    if (identity || numSamples > silence.getNumSamples())
+    {
+        jassert(identity); // host sent a bigger block than it prepared us for
+        return hostBuffer;
+    }
+
+    int silentChannel = 0;
+    for (size_t channel = 0; channel < hostChannels.size(); ++channel)
+    {
+        const auto hostChannel = hostChannels[channel];
+        if (juce::isPositiveAndBelow(hostChannel, hostBuffer.getNumChannels()))
+        {
+            channelPointers[channel] = hostBuffer.getWritePointer(hostChannel);
+        }
+        else
+        {
+            const auto index = std::min(silentChannel++, silence.getNumChannels() - 1);
+            silence.clear(index, 0, numSamples);
+            channelPointers[channel] = silence.getWritePointer(index);
+        }
+    }
+
+    mappedBuffer.setDataToReferTo(channelPointers.data(), static_cast<int>(channelPointers.size()), numSamples);
+    return mappedBuffer;
+}
+
+//==============================================================================
+
+int CyderChannelMap::findHostChannel(const juce::AudioProcessor& host,
+                                     const juce::AudioProcessor& wrapped,
+                                     bool isInput,
+                                     int busIndex,
+                                     int channelInBus)
+{
+    const auto* hostBus = host.getBus(isInput, busIndex);
+    if (hostBus == nullptr || ! hostBus->isEnabled())
+        return -1;
+
+    const auto hostLayout    = hostBus->getCurrentLayout();
+    const auto wrappedLayout = wrapped.getChannelLayoutOfBus(isInput, busIndex);
+
+    auto hostChannelInBus = hostLayout.getChannelIndexForType(wrappedLayout.getTypeOfChannel(channelInBus));
+
+    // Discrete layouts have no speaker types to go by, so same-sized buses are taken in order
+    if (hostChannelInBus < 0 && hostLayout.size() == wrappedLayout.size())
+        hostChannelInBus = channelInBus;
+
+    if (hostChannelInBus < 0)
+        return -1;
+
+    return host.getChannelIndexInProcessBlockBuffer(isInput, busIndex, hostChannelInBus);
+}
@@ -0,0 +1,77 @@
+/******************************************************************************
+ * Cyder — Hot-Reloading Audio Plugin Wrapper
+ *
+ * @file     CyderChannelMap.hpp
+ *
+ * @author   Adam Shield
+ * @date     2026-10-19
+ *
+ * @copyright (c) 2026 Adam Shield
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * See LICENSE.txt for license terms.
+ ******************************************************************************/
+
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+
+#include <vector>
+
+//==============================================================================
+
+/**
+ Lines up the channels of the buffer the host gives us with the channels the
+ wrapped plugin expects, bus by bus, matching them by speaker type.
+
+ Nothing is ever copied. When every channel is already where the plugin
+ expects it (by far the most common case), the host's buffer is handed over
+ as-is. Otherwise the plugin gets a buffer referring to the host's channels in
+ its own order. Channels the host doesn't have (e.g. a sidechain it left
+ disconnected) refer to a silent scratch channel instead.
+ */
+class CyderChannelMap final
+{
+public:
+    /** Upper bound on channels in either buffer, so the mapped buffer never allocates its channel list. */
+    static constexpr int maxNumChannels = 32;
+
+    CyderChannelMap() = default;
+    ~CyderChannelMap() = default;
+
+    /**
+     Works out which of the host's channels each of the wrapped processor's channels refers to. Not real-time safe.
+     @param host             processor whose buffer process() will be given (i.e. CyderAudioProcessor)
+     @param wrapped          processor the mapped buffer is for, already set to the layout it will run with
+     @param maximumBlockSize largest block that will be passed to process()
+     */
+    void prepare(const juce::AudioProcessor& host, const juce::AudioProcessor& wrapped, int maximumBlockSize);
+
+    /** @returns true if the host's buffer can be given to the wrapped processor as-is */
+    [[nodiscard]] bool isIdentity() const noexcept;
+    /** @returns host channel the wrapped processor's channel refers to, or -1 for silence */
+    [[nodiscard]] int getHostChannel(int wrappedChannel) const noexcept;
+
+    /**
+     Audio thread. Real-time safe.
+     @returns the host's buffer if the channel order already matches, otherwise a buffer referring to its channels
+     */
+    [[nodiscard]] juce::AudioBuffer<float>& map(juce::AudioBuffer<float>& hostBuffer) noexcept;
+
+private:
+    std::vector<int> hostChannels; // indexed by wrapped channel
+    bool identity = true;
+
+    std::vector<float*> channelPointers;
+    juce::AudioBuffer<float> mappedBuffer;
+    juce::AudioBuffer<float> silence; // one channel, for everything the host doesn't provide
+
+    /** @returns channel in the host's buffer for the given channel of the wrapped processor's bus, or -1 */
+    [[nodiscard]] static int findHostChannel(const juce::AudioProcessor& host,
+                                             const juce::AudioProcessor& wrapped,
+                                             bool isInput,
+                                             int busIndex,
+                                             int channelInBus);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CyderChannelMap)
+};
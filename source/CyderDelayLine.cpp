@@ -0,0 +1,93 @@
+/******************************************************************************
+ * Cyder — Hot-Reloading Audio Plugin Wrapper
+ *
+ * @file     CyderDelayLine.cpp
+ *
+ * @author   Adam Shield
+ * @date     2026-10-19
+ *
+ * @copyright (c) 2026 Adam Shield
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * See LICENSE.txt for license terms.
+ ******************************************************************************/
+
+#include "CyderDelayLine.hpp"
+
+#include "CyderAssert.hpp"
+
+#include <algorithm>
+
+//==============================================================================
+
+void CyderDelayLine::prepare(int numChannels, int maximumDelaySamples, int maximumBlockSize)
+{
+    maxDelay     = std::max(0, maximumDelaySamples);
+    maxBlockSize = std::max(1, maximumBlockSize);
+
+    // Room for the longest delay plus one block of new input
+    ring.setSize(std::max(1, numChannels), maxDelay + maxBlockSize);
+    ring.clear();
+    writePosition = 0;
+
+    setDelay(getDelay()); // re-clamp to new maximum
+}
+
+void CyderDelayLine::setDelay(int delaySamples) noexcept
+{
+    CYDER_ASSERT(delaySamples <= maxDelay); // compensation will be incomplete
+    delay.store(juce::jlimit(0, maxDelay, delaySamples), std::memory_order_relaxed);
+}
+
+int CyderDelayLine::getDelay() const noexcept
+{
+    return delay.load(std::memory_order_relaxed);
+}
+
+int CyderDelayLine::getMaximumDelay() const noexcept
+{
+    return maxDelay;
+}
+
+void CyderDelayLine::process(juce::AudioBuffer<float>& buffer) noexcept
+{
+    const auto delaySamples = getDelay();
+    const auto numSamples   = buffer.getNumSamples();
+
+    // Keep writing even with no delay so audio is already in place when a delay is set
+    for (int start = 0; start < numSamples; start += maxBlockSize)
+        processChunk(buffer, start, std::min(maxBlockSize, numSamples - start), delaySamples);
+}
+
+void CyderDelayLine::reset() noexcept
+{
+    ring.clear();
+    writePosition = 0;
+}
+
+void CyderDelayLine::processChunk(juce::AudioBuffer<float>& buffer,
+                                  int startSample,
+                                  int numSamples,
+                                  int delaySamples) noexcept
+{
+    const auto ringSize    = ring.getNumSamples();
+    const auto numChannels = std::min(buffer.getNumChannels(), ring.getNumChannels());
+    const auto readPosition = (writePosition - delaySamples + ringSize) % ringSize;
+
+    // Split each copy in two wherever it wraps around the end of the ring
+    const auto firstWrite = std::min(numSamples, ringSize - writePosition);
+    const auto firstRead  = std::min(numSamples, ringSize - readPosition);
+
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        ring.copyFrom(channel, writePosition, buffer, channel, startSample, firstWrite);
+        if (firstWrite < numSamples)
+            ring.copyFrom(channel, 0, buffer, channel, startSample + firstWrite, numSamples - firstWrite);
+
+        buffer.copyFrom(channel, startSample, ring, channel, readPosition, firstRead);
+        if (firstRead < numSamples)
+            buffer.copyFrom(channel, startSample + firstRead, ring, channel, 0, numSamples - firstRead);
+    }
+
+    writePosition = (writePosition + numSamples) % ringSize;
+}
@@ -0,0 +1,65 @@
+/******************************************************************************
+ * Cyder — Hot-Reloading Audio Plugin Wrapper
+ *
+ * @file     CyderDelayLine.hpp
+ *
+ * @author   Adam Shield
+ * @date     2026-10-19
+ *
+ * @copyright (c) 2026 Adam Shield
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * See LICENSE.txt for license terms.
+ ******************************************************************************/
+
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include <atomic>
+
+//==============================================================================
+
+/**
+ A multichannel integer-sample delay used for latency compensation.
+ All memory is allocated in prepare(), so process() is real-time safe, and
+ the delay may be changed from any thread while audio is running.
+ */
+class CyderDelayLine final
+{
+public:
+    CyderDelayLine() = default;
+    ~CyderDelayLine() = default;
+
+    /**
+     Allocates storage. Not real-time safe.
+     @param numChannels         channels that will be passed to process()
+     @param maximumDelaySamples largest delay setDelay() will accept
+     @param maximumBlockSize    largest block that will be passed to process()
+     */
+    void prepare(int numChannels, int maximumDelaySamples, int maximumBlockSize);
+
+    /** Sets the delay, clamped to the maximum given to prepare(). Thread safe. */
+    void setDelay(int delaySamples) noexcept;
+    /** */
+    [[nodiscard]] int getDelay() const noexcept;
+    /** */
+    [[nodiscard]] int getMaximumDelay() const noexcept;
+
+    /** Delays the buffer in place. Real-time safe. */
+    void process(juce::AudioBuffer<float>& buffer) noexcept;
+
+    /** Clears any audio still held in the delay. */
+    void reset() noexcept;
+
+private:
+    juce::AudioBuffer<float> ring;
+    int writePosition = 0;
+    int maxDelay = 0;
+    int maxBlockSize = 0;
+    std::atomic<int> delay { 0 };
+
+    void processChunk(juce::AudioBuffer<float>& buffer, int startSample, int numSamples, int delaySamples) noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CyderDelayLine)
+};
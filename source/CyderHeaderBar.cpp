@@ -46,6 +46,31 @@ CyderHeaderBar::CyderHeaderBar(CyderAudioProcessor& _processor)
     addAndMakeVisible(unloadPluginButton);
     unloadPluginButton.addListener(this);
     
+    nullTestButton.setButtonText("Null Test");
+    nullTestButton.setTooltip("Compare each rebuild's output against the previous build");
+    nullTestButton.setClickingTogglesState(true);
+    nullTestButton.setToggleState(processor.isNullTestOnReloadEnabled(), juce::dontSendNotification);
+    addAndMakeVisible(nullTestButton);
+    nullTestButton.addListener(this);
+    
+    rollBackButton.setButtonText("Roll Back");
+    rollBackButton.setTooltip("Swap back to the previous build, as it was when it was replaced");
+    rollBackButton.setEnabled(processor.getBuildHistory().getNumSnapshots() > 0);
+    addAndMakeVisible(rollBackButton);
+    rollBackButton.addListener(this);
+    
+    isolateButton.setButtonText("Isolate");
+    isolateButton.setTooltip("Host the plugin in a process of its own, so a crash can't take the DAW down with it");
+    isolateButton.setClickingTogglesState(true);
+    isolateButton.setToggleState(processor.isOutOfProcessHostingEnabled(), juce::dontSendNotification);
+    isolateButton.setEnabled(CyderProcessBridge::isSupported());
+    addAndMakeVisible(isolateButton);
+    isolateButton.addListener(this);
+    
+    allowBuildButton.setButtonText("Allow Build");
+    addChildComponent(allowBuildButton); // only while a restored session's build command waits to be confirmed
+    allowBuildButton.addListener(this);
+    
     startReportingStatus();
 }
 
@@ -66,6 +91,13 @@ const char* CyderHeaderBar::getStatusAsString(CyderStatus status) const noexcept
         case CyderStatus::successfullyReloadedPlugin : return "Successfully reloaded plugin";
         case CyderStatus::failedToLoadPlugin         : return "Failed to load plugin...";
         case CyderStatus::failedToReloadPlugin       : return "Failed to reload plugin...";
+        case CyderStatus::nullTestBitExact           : return "Null test: output is bit-exact";
+        case CyderStatus::nullTestDiffers            : return "Null test: output differs";
+        case CyderStatus::building                   : return "Building...";
+        case CyderStatus::buildFailed                : return "Build failed, see log";
+        case CyderStatus::rolledBack                 : return "Rolled back to previous build";
+        case CyderStatus::wrappedPluginCrashed       : return "Plugin crashed, restarting it...";
+        case CyderStatus::wrappedPluginOverran       : return "Plugin overran the audio thread, bypassed";
     };
 }
 
@@ -84,6 +116,14 @@ void CyderHeaderBar::resized()
     auto bounds = getLocalBounds();
     bounds.removeFromLeft(margin);
     unloadPluginButton.setBounds(bounds.removeFromLeft(100));
+    bounds.removeFromLeft(margin);
+    nullTestButton.setBounds(bounds.removeFromLeft(80));
+    bounds.removeFromLeft(margin);
+    rollBackButton.setBounds(bounds.removeFromLeft(80));
+    bounds.removeFromLeft(margin);
+    isolateButton.setBounds(bounds.removeFromLeft(80));
+    bounds.removeFromLeft(margin);
+    allowBuildButton.setBounds(bounds.removeFromLeft(80));
 }
 
 void CyderHeaderBar::buttonClicked(juce::Button* button)
@@ -92,6 +132,24 @@ void CyderHeaderBar::buttonClicked(juce::Button* button)
     {
         processor.unloadPlugin();
     }
+    else if (button == &nullTestButton)
+    {
+        processor.setNullTestOnReload(nullTestButton.getToggleState());
+    }
+    else if (button == &rollBackButton)
+    {
+        processor.rollBack();
+    }
+    else if (button == &isolateButton)
+    {
+        if (! processor.setOutOfProcessHosting(isolateButton.getToggleState()))
+            isolateButton.setToggleState(processor.isOutOfProcessHostingEnabled(), juce::dontSendNotification);
+    }
+    else if (button == &allowBuildButton)
+    {
+        processor.confirmBuildSettings();
+        allowBuildButton.setVisible(false);
+    }
 }
 
 void CyderHeaderBar::timerCallback()
@@ -117,6 +175,43 @@ void CyderHeaderBar::timerCallback()
     {
         currentStatus = status;
         currentStatusString = getStatusAsString(currentStatus);
+        
+        const auto nullTestResult = processor.getLastNullTestResult();
+        if (currentStatus == CyderStatus::nullTestDiffers && nullTestResult.has_value())
+            currentStatusString << " (max "
+                                << juce::Decibels::toString(juce::Decibels::gainToDecibels(nullTestResult->maxAbsDifference))
+                                << ", RMS "
+                                << juce::Decibels::toString(juce::Decibels::gainToDecibels(nullTestResult->rmsDifference))
+                                << ")";
+        
+        if (currentStatus == CyderStatus::buildFailed)
+            currentStatusString << " (" << processor.getBuildSettings().getLogFileOrDefault().getFullPathName() << ")";
+        
+        // The stack sample goes to the log
+        if (const auto event = processor.getWatchdog().getLastEvent(); currentStatus == CyderStatus::wrappedPluginOverran && event.has_value())
+            currentStatusString << " (" << event->describe() << ")";
+        
+        timeSinceStatusReportedMs = 0;
+        repaint();
+    }
+    
+    rollBackButton.setEnabled(processor.getBuildHistory().getNumSnapshots() > 0);
+    isolateButton.setToggleState(processor.isOutOfProcessHostingEnabled(), juce::dontSendNotification); // restored with a session
+    
+    // Shows what would run, since the session may not be ours
+    const auto& unconfirmedBuildSettings = processor.getUnconfirmedBuildSettings();
+    allowBuildButton.setVisible(unconfirmedBuildSettings.has_value());
+    if (unconfirmedBuildSettings.has_value())
+        allowBuildButton.setTooltip("This session runs \"" + unconfirmedBuildSettings->command + "\" in "
+                                    + unconfirmedBuildSettings->sourceDirectory.getFullPathName()
+                                    + " on every save. Allow it?");
+    
+    // Audio thread allocated or locked since we last looked
+    auto& realtimeGuard = processor.getRealtimeGuard();
+    if (const auto numViolations = realtimeGuard.getTotalViolations(); numViolations > numRealtimeViolationsReported)
+    {
+        numRealtimeViolationsReported = numViolations;
+        currentStatusString = realtimeGuard.getSummary();
         timeSinceStatusReportedMs = 0;
         repaint();
     }
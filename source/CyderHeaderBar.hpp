@@ -65,7 +65,13 @@ private:
     static constexpr int lengthOfTimeToDisplayStatusMs = 2000;
     int timeSinceStatusReportedMs = 0;
     
+    juce::uint64 numRealtimeViolationsReported = 0;
+    
     juce::TextButton unloadPluginButton;
+    juce::TextButton nullTestButton;
+    juce::TextButton rollBackButton;
+    juce::TextButton isolateButton;
+    juce::TextButton allowBuildButton;
     std::unique_ptr<juce::LookAndFeel> lookAndFeel;
     
     void paint(juce::Graphics& g) override;
@@ -0,0 +1,145 @@
+/******************************************************************************
+ * Cyder — Hot-Reloading Audio Plugin Wrapper
+ *
+ * @file     CyderMidiState.cpp
+ *
+ * @author   Adam Shield
+ * @date     2026-10-19
+ *
+ * @copyright (c) 2026 Adam Shield
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * See LICENSE.txt for license terms.
+ ******************************************************************************/
+
+#include "CyderMidiState.hpp"
+
+//==============================================================================
+
+void CyderMidiState::reset() noexcept
+{
+    for (int channelIndex = 0; channelIndex < 16; ++channelIndex)
+        releaseChannel(channelIndex);
+    sustainOn.fill(false);
+}
+
+void CyderMidiState::process(const juce::MidiBuffer& midiMessages) noexcept
+{
+    for (const auto metadata : midiMessages)
+        if (metadata.numBytes <= 3) // channel messages only, a long sysex would need the heap to become a MidiMessage
+            process(metadata.getMessage());
+}
+
+void CyderMidiState::process(const juce::MidiMessage& message) noexcept
+{
+    const auto channelIndex = message.getChannel() - 1;
+    if (! juce::isPositiveAndBelow(channelIndex, 16))
+        return; // sysex etc.
+
+    auto& held      = heldVelocities[static_cast<size_t>(channelIndex)];
+    auto& sustained = sustainedVelocities[static_cast<size_t>(channelIndex)];
+
+    if (message.isNoteOn())
+    {
+        const auto note = static_cast<size_t>(message.getNoteNumber());
+        held[note]      = message.getVelocity();
+        sustained[note] = 0; // struck again, held for real now
+    }
+    else if (message.isNoteOff()) // includes note-ons with velocity 0
+    {
+        const auto note = static_cast<size_t>(message.getNoteNumber());
+        if (sustainOn[static_cast<size_t>(channelIndex)] && held[note] > 0)
+            sustained[note] = held[note];
+        held[note] = 0;
+    }
+    else if (message.isSustainPedalOn())
+    {
+        sustainOn[static_cast<size_t>(channelIndex)] = true;
+    }
+    else if (message.isSustainPedalOff())
+    {
+        sustainOn[static_cast<size_t>(channelIndex)] = false;
+        sustained.fill(0);
+    }
+    else if (message.isAllNotesOff() || message.isAllSoundOff())
+    {
+        releaseChannel(channelIndex);
+    }
+    else if (message.isResetAllControllers())
+    {
+        sustainOn[static_cast<size_t>(channelIndex)] = false;
+        sustained.fill(0);
+    }
+}
+
+void CyderMidiState::addStateTo(juce::MidiBuffer& destination, int samplePosition) const noexcept
+{
+    for (int channelIndex = 0; channelIndex < 16; ++channelIndex)
+    {
+        const auto channelBits = static_cast<juce::uint8>(channelIndex);
+        const auto& held       = heldVelocities[static_cast<size_t>(channelIndex)];
+        const auto& sustained  = sustainedVelocities[static_cast<size_t>(channelIndex)];
+
+        // Pedal first, so notes released below keep sounding until it comes up
+        if (sustainOn[static_cast<size_t>(channelIndex)])
+        {
+            const juce::uint8 pedal[] { static_cast<juce::uint8>(0xb0 | channelBits), 64, 127 };
+            destination.addEvent(pedal, 3, samplePosition);
+        }
+
+        for (juce::uint8 note = 0; note < 128; ++note)
+        {
+            const auto velocity = static_cast<juce::uint8>(held[note] > 0 ? held[note] : sustained[note]);
+            if (velocity == 0)
+                continue;
+
+            const juce::uint8 noteOn[] { static_cast<juce::uint8>(0x90 | channelBits), note, velocity };
+            destination.addEvent(noteOn, 3, samplePosition);
+
+            if (held[note] == 0) // only the pedal keeps it sounding
+            {
+                const juce::uint8 noteOff[] { static_cast<juce::uint8>(0x80 | channelBits), note, 0 };
+                destination.addEvent(noteOff, 3, samplePosition);
+            }
+        }
+    }
+}
+
+//==============================================================================
+
+bool CyderMidiState::isNoteHeld(int channel, int noteNumber) const noexcept
+{
+    return juce::isPositiveAndBelow(channel - 1, 16)
+        && juce::isPositiveAndBelow(noteNumber, 128)
+        && heldVelocities[static_cast<size_t>(channel - 1)][static_cast<size_t>(noteNumber)] > 0;
+}
+
+bool CyderMidiState::isNoteSustained(int channel, int noteNumber) const noexcept
+{
+    return juce::isPositiveAndBelow(channel - 1, 16)
+        && juce::isPositiveAndBelow(noteNumber, 128)
+        && sustainedVelocities[static_cast<size_t>(channel - 1)][static_cast<size_t>(noteNumber)] > 0;
+}
+
+bool CyderMidiState::isSustainOn(int channel) const noexcept
+{
+    return juce::isPositiveAndBelow(channel - 1, 16) && sustainOn[static_cast<size_t>(channel - 1)];
+}
+
+int CyderMidiState::getNumActiveNotes() const noexcept
+{
+    int numActive = 0;
+    for (size_t channelIndex = 0; channelIndex < 16; ++channelIndex)
+        for (size_t note = 0; note < 128; ++note)
+            if (heldVelocities[channelIndex][note] > 0 || sustainedVelocities[channelIndex][note] > 0)
+                ++numActive;
+    return numActive;
+}
+
+//==============================================================================
+
+void CyderMidiState::releaseChannel(int channelIndex) noexcept
+{
+    heldVelocities[static_cast<size_t>(channelIndex)].fill(0);
+    sustainedVelocities[static_cast<size_t>(channelIndex)].fill(0);
+}
@@ -0,0 +1,79 @@
+/******************************************************************************
+ * Cyder — Hot-Reloading Audio Plugin Wrapper
+ *
+ * @file     CyderMidiState.hpp
+ *
+ * @author   Adam Shield
+ * @date     2026-10-19
+ *
+ * @copyright (c) 2026 Adam Shield
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * See LICENSE.txt for license terms.
+ ******************************************************************************/
+
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include <array>
+#include <cstdint>
+
+//==============================================================================
+
+/**
+ Keeps track of which notes are held and which channels are sustained, from the
+ MIDI a plugin has been sent so far, so a freshly loaded instance can be brought
+ to the same state. Otherwise a reload in the middle of a chord leaves the new
+ instance silent, and the note-offs that follow reach a plugin that never saw
+ the note-ons.
+
+ All state lives in fixed-size arrays, so tracking and seeding never allocate.
+ */
+class CyderMidiState final
+{
+public:
+    /** Most events addStateTo() can ever add: sustain, plus a note-on and a note-off for every note, on every channel. */
+    static constexpr int maxNumStateEvents = 16 * (1 + 128 * 2);
+
+    /** Bytes a MidiBuffer needs to hold that many events without growing. */
+    static constexpr size_t maxStateBytes = static_cast<size_t>(maxNumStateEvents) * 16;
+
+    CyderMidiState() = default;
+    ~CyderMidiState() = default;
+
+    /** Forgets every held note and sustain pedal. */
+    void reset() noexcept;
+
+    /** Audio thread. Updates the state with every event in the buffer, in order. */
+    void process(const juce::MidiBuffer& midiMessages) noexcept;
+    /** Audio thread. Updates the state with one event. */
+    void process(const juce::MidiMessage& message) noexcept;
+
+    /**
+     Audio thread. Adds the events that bring a fresh instance to the current state, all at the given sample:
+     sustain pedals first, then a note-on for every sounding note. Notes only sounding because of the
+     pedal are released straight away, so they end along with the pedal, just like in the previous instance.
+     Never allocates as long as the destination has room for maxStateBytes more.
+     */
+    void addStateTo(juce::MidiBuffer& destination, int samplePosition) const noexcept;
+
+    /** */
+    [[nodiscard]] bool isNoteHeld(int channel, int noteNumber) const noexcept;
+    /** @returns true if the note was released while the pedal was down, so it is still sounding */
+    [[nodiscard]] bool isNoteSustained(int channel, int noteNumber) const noexcept;
+    /** */
+    [[nodiscard]] bool isSustainOn(int channel) const noexcept;
+    /** @returns number of notes sounding, held or sustained, across all channels */
+    [[nodiscard]] int getNumActiveNotes() const noexcept;
+
+private:
+    // Indexed by 0-based channel, then note number. Velocity 0 means the note isn't held (or sustained).
+    std::array<std::array<std::uint8_t, 128>, 16> heldVelocities {};
+    std::array<std::array<std::uint8_t, 128>, 16> sustainedVelocities {};
+    std::array<bool, 16> sustainOn {};
+
+    void releaseChannel(int channelIndex) noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CyderMidiState)
+};
@@ -0,0 +1,174 @@
+/******************************************************************************
+ * Cyder — Hot-Reloading Audio Plugin Wrapper
+ *
+ * @file     CyderNullTest.cpp
+ *
+ * @author   Adam Shield
+ * @date     2026-10-19
+ *
+ * @copyright (c) 2026 Adam Shield
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * See LICENSE.txt for license terms.
+ ******************************************************************************/
+
+#include "CyderNullTest.hpp"
+
+#include "CyderAssert.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <utility>
+
+//==============================================================================
+
+/** Fixed so that every run produces exactly the same test signal. */
+static constexpr juce::int64 testSignalSeed = 0x0c1de5;
+
+CyderNullTest::CyderNullTest(std::unique_ptr<juce::AudioPluginInstance> _previousBuild,
+                             std::unique_ptr<juce::AudioPluginInstance> _newBuild,
+                             int _numChannels,
+                             double _sampleRate,
+                             int _blockSize)
+: juce::Thread("Cyder Null Test")
+, previousBuild(std::move(_previousBuild))
+, newBuild(std::move(_newBuild))
+, numChannels(_numChannels)
+, sampleRate(_sampleRate)
+, blockSize(_blockSize)
+{
+    CYDER_ASSERT(previousBuild != nullptr && newBuild != nullptr);
+    startThread(juce::Thread::Priority::low);
+}
+
+CyderNullTest::~CyderNullTest()
+{
+    stopThread(5000);
+
+    // Instances are destroyed here, on the message thread
+    previousBuild.reset();
+    newBuild.reset();
+}
+
+juce::AudioBuffer<float> CyderNullTest::createTestSignal(int numChannels, double sampleRate)
+{
+    const auto numSamples = juce::roundToInt(testSignalSeconds * sampleRate);
+    juce::AudioBuffer<float> signal(std::max(1, numChannels), std::max(0, numSamples));
+    signal.clear();
+
+    if (numSamples <= 0)
+        return signal;
+
+    // Impulse, then a log sweep over the first half, then noise, then silence for tails to ring out
+    const auto sweepStart  = 1;
+    const auto sweepLength = numSamples / 2;
+    const auto noiseStart  = sweepStart + sweepLength;
+    const auto noiseLength = numSamples / 4;
+
+    const auto startFrequency = 20.0;
+    const auto endFrequency   = std::min(20000.0, sampleRate * 0.45);
+    const auto sweepRate      = std::log(endFrequency / startFrequency);
+    const auto sweepSeconds   = sweepLength / sampleRate;
+
+    for (int channel = 0; channel < signal.getNumChannels(); ++channel)
+    {
+        auto* data = signal.getWritePointer(channel);
+        data[0] = 1.0f;
+
+        for (int i = 0; i < sweepLength && sweepStart + i < numSamples; ++i)
+        {
+            const auto t = i / sampleRate;
+            const auto phase = juce::MathConstants<double>::twoPi * startFrequency * sweepSeconds / sweepRate
+                             * (std::exp(t * sweepRate / sweepSeconds) - 1.0);
+            data[sweepStart + i] = 0.5f * static_cast<float>(std::sin(phase));
+        }
+
+        juce::Random random(testSignalSeed + channel);
+        for (int i = 0; i < noiseLength && noiseStart + i < numSamples; ++i)
+            data[noiseStart + i] = 0.25f * (random.nextFloat() * 2.0f - 1.0f);
+    }
+
+    return signal;
+}
+
+CyderNullTestResult CyderNullTest::compare(const juce::AudioBuffer<float>& a,
+                                           const juce::AudioBuffer<float>& b) noexcept
+{
+    CyderNullTestResult result;
+
+    const auto numChannels = std::min(a.getNumChannels(), b.getNumChannels());
+    const auto numSamples  = std::min(a.getNumSamples(),  b.getNumSamples());
+    result.isBitExact = a.getNumChannels() == b.getNumChannels()
+                     && a.getNumSamples()  == b.getNumSamples();
+
+    double sumOfSquares = 0.0;
+    for (int channel = 0; channel < numChannels; ++channel)
+    {
+        const auto* dataA = a.getReadPointer(channel);
+        const auto* dataB = b.getReadPointer(channel);
+
+        if (std::memcmp(dataA, dataB, sizeof(float) * static_cast<size_t>(numSamples)) != 0)
+            result.isBitExact = false;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            const auto difference = std::abs(dataA[i] - dataB[i]);
+            result.maxAbsDifference = std::max(result.maxAbsDifference, difference);
+            sumOfSquares += static_cast<double>(difference) * difference;
+        }
+    }
+
+    result.numSamplesCompared = numChannels * numSamples;
+    if (result.numSamplesCompared > 0)
+        result.rmsDifference = static_cast<float>(std::sqrt(sumOfSquares / result.numSamplesCompared));
+
+    return result;
+}
+
+void CyderNullTest::run()
+{
+    const auto testSignal = createTestSignal(numChannels, sampleRate);
+
+    // Both builds start from a clean slate, so only their code can tell them apart
+    auto previousOutput = testSignal;
+    auto newOutput      = testSignal;
+    previousBuild->reset();
+    newBuild->reset();
+
+    if (! render(*previousBuild, previousOutput) || ! render(*newBuild, newOutput))
+        return; // cancelled
+
+    const auto result = compare(previousOutput, newOutput);
+
+    juce::MessageManager::callAsync([safeThis = juce::WeakReference<CyderNullTest>(this), result]
+    {
+        if (safeThis.wasObjectDeleted())
+            return;
+
+        // Copy, in case the callback deletes us
+        if (auto callback = safeThis->onComplete)
+            callback(result);
+    });
+}
+
+bool CyderNullTest::render(juce::AudioPluginInstance& instance, juce::AudioBuffer<float>& buffer)
+{
+    juce::MidiBuffer midi;
+    const auto numSamples = buffer.getNumSamples();
+
+    for (int start = 0; start < numSamples; start += blockSize)
+    {
+        if (threadShouldExit())
+            return false;
+
+        juce::AudioBuffer<float> block(buffer.getArrayOfWritePointers(),
+                                       buffer.getNumChannels(),
+                                       start,
+                                       std::min(blockSize, numSamples - start));
+        instance.processBlock(block, midi);
+        midi.clear();
+    }
+
+    return true;
+}
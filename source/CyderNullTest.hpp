@@ -0,0 +1,86 @@
+/******************************************************************************
+ * Cyder — Hot-Reloading Audio Plugin Wrapper
+ *
+ * @file     CyderNullTest.hpp
+ *
+ * @author   Adam Shield
+ * @date     2026-10-19
+ *
+ * @copyright (c) 2026 Adam Shield
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * See LICENSE.txt for license terms.
+ ******************************************************************************/
+
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <juce_core/juce_core.h>
+
+#include <functional>
+#include <memory>
+
+//==============================================================================
+
+/** Difference between the output of two builds for the same input. */
+struct CyderNullTestResult
+{
+    float maxAbsDifference = 0.0f;
+    float rmsDifference    = 0.0f;
+    bool  isBitExact       = true;
+    int   numSamplesCompared = 0;
+};
+
+//==============================================================================
+
+/**
+ Renders a fixed test signal through the previous and the new build of a plugin
+ offline, on its own thread, and compares the two outputs.
+ Both instances are owned by the test and destroyed with it, on the message thread.
+ */
+class CyderNullTest final : private juce::Thread
+{
+public:
+    /** Length of the test signal. */
+    static constexpr double testSignalSeconds = 1.0;
+
+    /**
+     Starts the test immediately.
+     Both instances must already be prepared with the given configuration and hold the same state.
+     */
+    CyderNullTest(std::unique_ptr<juce::AudioPluginInstance> previousBuild,
+                  std::unique_ptr<juce::AudioPluginInstance> newBuild,
+                  int numChannels,
+                  double sampleRate,
+                  int blockSize);
+    /** Waits for a test in progress to stop, then destroys both instances. Message thread only. */
+    ~CyderNullTest() override;
+
+    /** Called on the message thread once the test has finished. It is safe to delete the test from here. */
+    std::function<void(const CyderNullTestResult&)> onComplete = nullptr;
+
+    //==============================================================================
+
+    /** @returns the deterministic signal every build is tested with: an impulse, a sine sweep and noise */
+    [[nodiscard]] static juce::AudioBuffer<float> createTestSignal(int numChannels, double sampleRate);
+
+    /** Compares two buffers of the same size sample by sample. */
+    [[nodiscard]] static CyderNullTestResult compare(const juce::AudioBuffer<float>& a,
+                                                     const juce::AudioBuffer<float>& b) noexcept;
+
+private:
+    std::unique_ptr<juce::AudioPluginInstance> previousBuild;
+    std::unique_ptr<juce::AudioPluginInstance> newBuild;
+
+    const int numChannels;
+    const double sampleRate;
+    const int blockSize;
+
+    void run() override;
+
+    /** @returns false if the test was cancelled part way through */
+    bool render(juce::AudioPluginInstance& instance, juce::AudioBuffer<float>& buffer);
+
+    JUCE_DECLARE_WEAK_REFERENCEABLE (CyderNullTest)
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CyderNullTest)
+};
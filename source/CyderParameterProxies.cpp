@@ -0,0 +1,406 @@
+/******************************************************************************
+ * Cyder — Hot-Reloading Audio Plugin Wrapper
+ *
+ * @file     CyderParameterProxies.cpp
+ *
+ * @author   Adam Shield
+ * @date     2026-10-19
+ *
+ * @copyright (c) 2026 Adam Shield
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * See LICENSE.txt for license terms.
+ ******************************************************************************/
+
+#include "CyderParameterProxies.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <memory>
+#include <utility>
+
+//==============================================================================
+
+[[nodiscard]] static constexpr std::uint64_t getBit(int index) noexcept
+{
+    return std::uint64_t { 1 } << index;
+}
+
+/** Calls fn with the index of every bit set in the mask, lowest first. */
+template <typename Fn>
+static void forEachSetBit(std::uint64_t mask, Fn&& fn)
+{
+    while (mask != 0)
+    {
+        fn(std::countr_zero(mask));
+        mask &= mask - 1;
+    }
+}
+
+//==============================================================================
+
+class CyderParameterProxies::Proxy final : public juce::AudioProcessorParameterWithID
+{
+public:
+    Proxy(CyderParameterProxies& _owner, int _index)
+    : juce::AudioProcessorParameterWithID(juce::ParameterID("proxy" + juce::String(_index + 1), /*versionHint*/ 1),
+                                          getUnmappedName(_index))
+    , owner(_owner)
+    , index(_index)
+    , displayName(getUnmappedName(_index))
+    {
+    }
+
+    //==============================================================================
+
+    /** Host, any thread. Forwarded to the wrapped plugin at the start of the next block. */
+    void setValue(float newValue) override
+    {
+        value.store(newValue, std::memory_order_relaxed);
+        owner.pendingForPlugin.fetch_or(getBit(index), std::memory_order_release);
+    }
+
+    float getValue() const override               { return value.load(std::memory_order_relaxed); }
+    float getDefaultValue() const override        { return defaultValue.load(std::memory_order_relaxed); }
+    juce::String getName(int maximumLength) const override { return displayName.substring(0, maximumLength); }
+    juce::String getLabel() const override        { return target != nullptr ? target->getLabel() : juce::String(); }
+
+    juce::String getText(float normalisedValue, int maximumLength) const override
+    {
+        return target != nullptr ? target->getText(normalisedValue, maximumLength)
+                                 : juce::AudioProcessorParameterWithID::getText(normalisedValue, maximumLength);
+    }
+
+    float getValueForText(const juce::String& text) const override
+    {
+        return target != nullptr ? target->getValueForText(text) : text.getFloatValue();
+    }
+
+    //==============================================================================
+
+    /** Takes on the wrapped plugin's value without sending it back to it. */
+    void setValueFromPlugin(float newValue) noexcept
+    {
+        value.store(newValue, std::memory_order_relaxed);
+    }
+
+    /** Message thread. Points the proxy at the wrapped parameter it now stands for, or nullptr. */
+    void setTarget(juce::AudioProcessorParameter* newTarget)
+    {
+        target = newTarget;
+        displayName = target != nullptr ? target->getName(128) : getUnmappedName(index);
+        defaultValue.store(target != nullptr ? target->getDefaultValue() : 0.0f, std::memory_order_relaxed);
+    }
+
+    juce::String mappedParameterID; // message thread only
+
+private:
+    CyderParameterProxies& owner;
+    const int index;
+
+    std::atomic<float> value { 0.0f };
+    std::atomic<float> defaultValue { 0.0f };
+
+    // Message thread only, like the host's calls for names and text
+    juce::AudioProcessorParameter* target = nullptr;
+    juce::String displayName;
+
+    [[nodiscard]] static juce::String getUnmappedName(int index)
+    {
+        return "Proxy " + juce::String(index + 1);
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Proxy)
+};
+
+//==============================================================================
+
+CyderParameterProxies::CyderParameterProxies(juce::AudioProcessor& _owner, const juce::CriticalSection& audioCallbackLock)
+: owner(_owner)
+, callbackLock(audioCallbackLock)
+{
+    for (int i = 0; i < numProxies; ++i)
+    {
+        targetIndices[static_cast<size_t>(i)].store(-1, std::memory_order_relaxed); // unmapped
+
+        auto proxy = std::make_unique<Proxy>(*this, i);
+        proxies[static_cast<size_t>(i)] = proxy.get();
+        owner.addParameter(proxy.release()); // owner takes ownership
+    }
+
+    startTimerHz(30);
+}
+
+CyderParameterProxies::~CyderParameterProxies()
+{
+    stopTimer();
+}
+
+//==============================================================================
+
+void CyderParameterProxies::setWrappedPlugin(juce::AudioProcessor* plugin)
+{
+    jassert(juce::MessageManager::getInstance()->isThisTheMessageThread());
+
+    wrappedPlugin = plugin;
+
+    if (wrappedPlugin != nullptr)
+    {
+        const auto& parameters = wrappedPlugin->getParameters();
+
+        const bool anyMappingResolves = std::any_of(proxies.begin(), proxies.end(), [&](const Proxy* proxy)
+        {
+            return std::any_of(parameters.begin(), parameters.end(), [&](const juce::AudioProcessorParameter* parameter)
+            {
+                return proxy->mappedParameterID.isNotEmpty() && getParameterID(*parameter) == proxy->mappedParameterID;
+            });
+        });
+
+        // Nothing carried over, e.g. a plugin we have never seen: start with its first parameters in order
+        if (! anyMappingResolves)
+            for (int i = 0; i < numProxies; ++i)
+                proxies[static_cast<size_t>(i)]->mappedParameterID = i < parameters.size() ? getParameterID(*parameters[i])
+                                                                                            : juce::String();
+    }
+
+    resolveTargets();
+
+    // Whatever the host sent to the previous instance is superseded by the state it handed over
+    pendingForPlugin.store(0, std::memory_order_relaxed);
+    pendingForHost.store(0, std::memory_order_relaxed);
+
+    // Show the host what the new instance is actually doing
+    for (size_t i = 0; i < proxies.size(); ++i)
+    {
+        if (auto* target = targets[i])
+        {
+            const auto value = target->getValue();
+            proxies[i]->setValueFromPlugin(value);
+            proxies[i]->sendValueChangedMessageToListeners(value);
+        }
+    }
+
+    notifyHostOfMappingChange();
+}
+
+void CyderParameterProxies::map(int proxyIndex, const juce::String& parameterID)
+{
+    jassert(juce::MessageManager::getInstance()->isThisTheMessageThread());
+
+    if (! juce::isPositiveAndBelow(proxyIndex, numProxies))
+        return;
+
+    auto* proxy = proxies[static_cast<size_t>(proxyIndex)];
+    proxy->mappedParameterID = parameterID;
+    resolveTargets();
+
+    if (auto* target = targets[static_cast<size_t>(proxyIndex)])
+    {
+        proxy->setValueFromPlugin(target->getValue());
+        proxy->sendValueChangedMessageToListeners(target->getValue());
+    }
+
+    notifyHostOfMappingChange();
+}
+
+void CyderParameterProxies::unmap(int proxyIndex)
+{
+    map(proxyIndex, {});
+}
+
+void CyderParameterProxies::clearMapping()
+{
+    jassert(juce::MessageManager::getInstance()->isThisTheMessageThread());
+
+    for (auto* proxy : proxies)
+        proxy->mappedParameterID = {};
+
+    resolveTargets();
+    notifyHostOfMappingChange();
+}
+
+juce::String CyderParameterProxies::getMappedParameterID(int proxyIndex) const
+{
+    return juce::isPositiveAndBelow(proxyIndex, numProxies) ? proxies[static_cast<size_t>(proxyIndex)]->mappedParameterID
+                                                             : juce::String();
+}
+
+juce::AudioProcessorParameter* CyderParameterProxies::getProxy(int proxyIndex) const noexcept
+{
+    return juce::isPositiveAndBelow(proxyIndex, numProxies) ? proxies[static_cast<size_t>(proxyIndex)] : nullptr;
+}
+
+juce::String CyderParameterProxies::getParameterID(const juce::AudioProcessorParameter& parameter)
+{
+    if (auto* hosted = dynamic_cast<const juce::HostedAudioProcessorParameter*>(&parameter))
+        return hosted->getParameterID();
+    if (auto* withID = dynamic_cast<const juce::AudioProcessorParameterWithID*>(&parameter))
+        return withID->paramID;
+    return juce::String(parameter.getParameterIndex());
+}
+
+//==============================================================================
+
+void CyderParameterProxies::processPendingHostChanges() noexcept
+{
+    const auto pending = pendingForPlugin.exchange(0, std::memory_order_acquire);
+
+    forEachSetBit(pending, [this](int index)
+    {
+        if (auto* target = targets[static_cast<size_t>(index)])
+            target->setValue(proxies[static_cast<size_t>(index)]->getValue());
+    });
+}
+
+void CyderParameterProxies::parameterChangedByPlugin(int parameterIndex, float newValue) noexcept
+{
+    const auto index = getProxyForParameter(parameterIndex);
+    if (index < 0)
+        return;
+
+    // Our own forwarding echoing back, the host already knows
+    if (juce::exactlyEqual(proxies[static_cast<size_t>(index)]->getValue(), newValue))
+        return;
+
+    valuesFromPlugin[static_cast<size_t>(index)].store(newValue, std::memory_order_relaxed);
+    pendingForHost.fetch_or(getBit(index), std::memory_order_release);
+}
+
+void CyderParameterProxies::gestureChangedByPlugin(int parameterIndex, bool gestureIsStarting) noexcept
+{
+    const auto index = getProxyForParameter(parameterIndex);
+    if (index < 0)
+        return;
+
+    auto& pending = gestureIsStarting ? pendingGestureStarts : pendingGestureEnds;
+    pending.fetch_or(getBit(index), std::memory_order_release);
+}
+
+void CyderParameterProxies::dispatchPendingPluginChanges()
+{
+    // Ends are taken last, so a gesture that ends after its final value never ends before it
+    const auto starts  = pendingGestureStarts.exchange(0, std::memory_order_acquire);
+    const auto changes = pendingForHost.exchange(0, std::memory_order_acquire);
+    const auto ends    = pendingGestureEnds.exchange(0, std::memory_order_acquire);
+
+    forEachSetBit(starts, [this](int index)
+    {
+        proxies[static_cast<size_t>(index)]->beginChangeGesture();
+    });
+
+    forEachSetBit(changes, [this](int index)
+    {
+        const auto value = valuesFromPlugin[static_cast<size_t>(index)].load(std::memory_order_relaxed);
+        auto* proxy = proxies[static_cast<size_t>(index)];
+        proxy->setValueFromPlugin(value);
+        proxy->sendValueChangedMessageToListeners(value);
+    });
+
+    forEachSetBit(ends, [this](int index)
+    {
+        proxies[static_cast<size_t>(index)]->endChangeGesture();
+    });
+}
+
+//==============================================================================
+
+void CyderParameterProxies::saveState(juce::XmlElement& parentElement) const
+{
+    auto* proxiesElem = parentElement.createNewChildElement("ParameterProxies");
+
+    for (int i = 0; i < numProxies; ++i)
+    {
+        const auto& parameterID = proxies[static_cast<size_t>(i)]->mappedParameterID;
+        if (parameterID.isEmpty())
+            continue;
+
+        auto* proxyElem = proxiesElem->createNewChildElement("Proxy");
+        proxyElem->setAttribute("index", i);
+        proxyElem->setAttribute("parameterID", parameterID);
+    }
+}
+
+void CyderParameterProxies::restoreState(const juce::XmlElement& parentElement)
+{
+    jassert(juce::MessageManager::getInstance()->isThisTheMessageThread());
+
+    for (auto* proxy : proxies)
+        proxy->mappedParameterID = {};
+
+    if (auto* proxiesElem = parentElement.getChildByName("ParameterProxies"))
+    {
+        for (auto* proxyElem : proxiesElem->getChildWithTagNameIterator("Proxy"))
+        {
+            const auto index = proxyElem->getIntAttribute("index", -1);
+            if (juce::isPositiveAndBelow(index, numProxies))
+                proxies[static_cast<size_t>(index)]->mappedParameterID = proxyElem->getStringAttribute("parameterID");
+        }
+    }
+
+    resolveTargets();
+    notifyHostOfMappingChange();
+}
+
+//==============================================================================
+
+void CyderParameterProxies::resolveTargets()
+{
+    std::array<juce::AudioProcessorParameter*, numProxies> newTargets {};
+    std::array<int, numProxies> newTargetIndices;
+    newTargetIndices.fill(-1);
+
+    if (wrappedPlugin != nullptr)
+    {
+        const auto& parameters = wrappedPlugin->getParameters();
+
+        for (int i = 0; i < numProxies; ++i)
+        {
+            const auto& parameterID = proxies[static_cast<size_t>(i)]->mappedParameterID;
+            if (parameterID.isEmpty())
+                continue;
+
+            for (int p = 0; p < parameters.size(); ++p)
+            {
+                if (getParameterID(*parameters[p]) != parameterID)
+                    continue;
+
+                newTargets[static_cast<size_t>(i)] = parameters[p];
+                newTargetIndices[static_cast<size_t>(i)] = p;
+                break;
+            }
+        }
+    }
+
+    for (size_t i = 0; i < proxies.size(); ++i)
+        proxies[i]->setTarget(newTargets[i]);
+
+    {
+        const juce::ScopedLock lock(callbackLock); // audio thread sees the old mapping or the new one, never half of each
+        targets = newTargets;
+
+        // Plugin threads may see a mix of old and new while this runs, at worst reporting one change to a proxy being remapped
+        for (size_t i = 0; i < targetIndices.size(); ++i)
+            targetIndices[i].store(newTargetIndices[i], std::memory_order_relaxed);
+    }
+}
+
+void CyderParameterProxies::notifyHostOfMappingChange()
+{
+    owner.updateHostDisplay(juce::AudioProcessorListener::ChangeDetails().withParameterInfoChanged(true));
+}
+
+int CyderParameterProxies::getProxyForParameter(int parameterIndex) const noexcept
+{
+    if (parameterIndex < 0)
+        return -1;
+
+    for (int i = 0; i < numProxies; ++i)
+        if (targetIndices[static_cast<size_t>(i)].load(std::memory_order_relaxed) == parameterIndex)
+            return i;
+    return -1;
+}
+
+void CyderParameterProxies::timerCallback()
+{
+    dispatchPendingPluginChanges();
+}
@@ -0,0 +1,135 @@
+/******************************************************************************
+ * Cyder — Hot-Reloading Audio Plugin Wrapper
+ *
+ * @file     CyderParameterProxies.hpp
+ *
+ * @author   Adam Shield
+ * @date     2026-10-19
+ *
+ * @copyright (c) 2026 Adam Shield
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * See LICENSE.txt for license terms.
+ ******************************************************************************/
+
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <juce_core/juce_core.h>
+#include <juce_events/juce_events.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+//==============================================================================
+
+/**
+ A fixed pool of parameters Cyder publishes to the host, each of which can be
+ mapped to one of the wrapped plugin's parameters. Hosts never see the list
+ change, so automation written against a proxy keeps working across reloads
+ and even across plugins.
+
+ Mappings are kept by parameter ID, so a rebuilt plugin picks them up again
+ even if its parameters moved around.
+
+ Neither direction calls into anyone synchronously:
+ - host -> plugin: proxies store their value and flag it pending, and the
+   audio thread forwards every pending value at the start of the next block.
+ - plugin -> host: changes are flagged pending from whichever thread the plugin
+   reports them on, and a timer on the message thread notifies the host.
+ Pending flags are one bit per proxy, so bursts of changes are coalesced into
+ a single update per block (or per timer tick) without allocating or locking.
+ */
+class CyderParameterProxies final : private juce::Timer
+{
+public:
+    /** Number of proxies published to the host. Hosts cache the list, so it can never change. */
+    static constexpr int numProxies = 64;
+    static_assert(numProxies <= 64, "pending changes are tracked in one 64-bit mask");
+
+    /**
+     Adds the proxies to the given processor. Must be called from its constructor, before the host sees it.
+     @param owner             processor publishing the proxies (i.e. CyderAudioProcessor)
+     @param audioCallbackLock lock held by the audio thread while processing (i.e. AudioProcessor::getCallbackLock())
+     */
+    CyderParameterProxies(juce::AudioProcessor& owner, const juce::CriticalSection& audioCallbackLock);
+    ~CyderParameterProxies() override;
+
+    //==============================================================================
+
+    /**
+     Points the proxies at a new plugin instance, or nullptr. Message thread only.
+     Mapped IDs are looked up in the new instance, and proxies take on its current values.
+     If none of the mapped IDs exist in it, its first parameters are mapped in order instead.
+     */
+    void setWrappedPlugin(juce::AudioProcessor* plugin);
+
+    /** Maps a proxy to the wrapped plugin's parameter with the given ID. Message thread only. */
+    void map(int proxyIndex, const juce::String& parameterID);
+    /** Leaves a proxy unmapped. Message thread only. */
+    void unmap(int proxyIndex);
+    /** Leaves every proxy unmapped. Message thread only. */
+    void clearMapping();
+
+    /** @returns ID of the wrapped parameter the proxy is mapped to, or an empty string */
+    [[nodiscard]] juce::String getMappedParameterID(int proxyIndex) const;
+    /** @returns the proxy published to the host at the given index */
+    [[nodiscard]] juce::AudioProcessorParameter* getProxy(int proxyIndex) const noexcept;
+
+    /** @returns ID of a wrapped plugin's parameter, falling back to its index for plugins that give none */
+    [[nodiscard]] static juce::String getParameterID(const juce::AudioProcessorParameter& parameter);
+
+    //==============================================================================
+
+    /** Audio thread, under the callback lock. Forwards values the host changed since the last block. */
+    void processPendingHostChanges() noexcept;
+
+    /** Any thread. Called when the wrapped plugin changes one of its parameters. */
+    void parameterChangedByPlugin(int parameterIndex, float newValue) noexcept;
+    /** Any thread. Called when the wrapped plugin starts or ends a gesture on one of its parameters. */
+    void gestureChangedByPlugin(int parameterIndex, bool gestureIsStarting) noexcept;
+
+    /** Message thread. Notifies the host of everything the plugin changed. Called regularly by a timer. */
+    void dispatchPendingPluginChanges();
+
+    //==============================================================================
+
+    /** Stores the mapping. */
+    void saveState(juce::XmlElement& parentElement) const;
+    /** Replaces the mapping with the one stored by saveState(). Call before the plugin is loaded. Message thread only. */
+    void restoreState(const juce::XmlElement& parentElement);
+
+private:
+    class Proxy;
+
+    juce::AudioProcessor& owner;
+    const juce::CriticalSection& callbackLock;
+    std::array<Proxy*, numProxies> proxies {}; // owned by the processor
+
+    // Only ever swapped under the callback lock, so the audio thread sees a consistent mapping
+    std::array<juce::AudioProcessorParameter*, numProxies> targets {};
+
+    // Proxy index -> wrapped parameter index, or -1. Read from any thread without the lock,
+    // so it is fixed in size and never reallocated.
+    std::array<std::atomic<int>, numProxies> targetIndices;
+
+    juce::AudioProcessor* wrappedPlugin = nullptr;
+
+    std::atomic<std::uint64_t> pendingForPlugin { 0 };
+    std::atomic<std::uint64_t> pendingForHost { 0 };
+    std::atomic<std::uint64_t> pendingGestureStarts { 0 };
+    std::atomic<std::uint64_t> pendingGestureEnds { 0 };
+    std::array<std::atomic<float>, numProxies> valuesFromPlugin {};
+
+    /** Looks up every mapped ID in the wrapped plugin, and swaps the result in for the audio thread. */
+    void resolveTargets();
+    /** Reports name and range changes to the host. */
+    void notifyHostOfMappingChange();
+
+    [[nodiscard]] int getProxyForParameter(int parameterIndex) const noexcept;
+
+    void timerCallback() override;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CyderParameterProxies)
+};
@@ -0,0 +1,208 @@
+/******************************************************************************
+ * Cyder — Hot-Reloading Audio Plugin Wrapper
+ *
+ * @file     CyderPluginCache.cpp
+ *
+ * @author   Adam Shield
+ * @date     2026-10-19
+ *
+ * @copyright (c) 2026 Adam Shield
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * See LICENSE.txt for license terms.
+ ******************************************************************************/
+
+#include "CyderPluginCache.hpp"
+
+#include "Utilities.hpp"
+
+#include <memory>
+
+//==============================================================================
+
+static constexpr const char* rootTag  = "CyderPluginCache";
+static constexpr const char* entryTag = "Plugin";
+static constexpr int formatVersion    = 1;
+
+static constexpr int processLockTimeoutMs = 2000;
+
+/** FNV-1a, fast enough to run over a whole module and only meant to tell builds apart. */
+[[nodiscard]] static juce::uint64 hashBytes(const void* data, size_t numBytes) noexcept
+{
+    auto hash = static_cast<juce::uint64>(0xcbf29ce484222325ull);
+    const auto* bytes = static_cast<const juce::uint8*>(data);
+    for (size_t i = 0; i < numBytes; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+//==============================================================================
+
+bool CyderPluginCache::Key::isSameBuildAs(const Key& other) const noexcept
+{
+    return path == other.path
+        && moduleSize == other.moduleSize
+        && moduleModificationTime == other.moduleModificationTime
+        && moduleHash == other.moduleHash;
+}
+
+//==============================================================================
+
+CyderPluginCache::CyderPluginCache(const juce::File& file)
+: cacheFile(file)
+, processLock("CyderPluginCache")
+{
+}
+
+juce::File CyderPluginCache::getDefaultCacheFile()
+{
+    return juce::File::getSpecialLocation(juce::File::userApplicationDataDirectory)
+               .getChildFile("Cyder")
+               .getChildFile("PluginCache.xml");
+}
+
+CyderPluginCache::Key CyderPluginCache::makeKey(const juce::File& pluginFile)
+{
+    auto module = Utilities::getModuleInBundle(pluginFile);
+    if (! module.existsAsFile())
+        module = pluginFile;
+
+    Key key;
+    key.path = pluginFile.getFullPathName();
+
+    if (! module.existsAsFile())
+        return key;
+
+    key.moduleSize             = module.getSize();
+    key.moduleModificationTime = module.getLastModificationTime().toMilliseconds();
+
+    const juce::MemoryMappedFile mappedModule(module, juce::MemoryMappedFile::readOnly);
+    if (mappedModule.getData() != nullptr)
+        key.moduleHash = hashBytes(mappedModule.getData(), mappedModule.getSize());
+
+    return key;
+}
+
+std::optional<juce::PluginDescription> CyderPluginCache::find(const Key& key)
+{
+    if (key.moduleSize <= 0)
+        return std::nullopt;
+
+    const juce::ScopedLock scopedLock(lock);
+    reloadIfChanged();
+
+    if (auto it = entries.find(key.path); it != entries.end() && it->second.key.isSameBuildAs(key))
+        return it->second.description;
+
+    return std::nullopt;
+}
+
+void CyderPluginCache::store(const Key& key, const juce::PluginDescription& description)
+{
+    if (key.moduleSize <= 0)
+        return;
+
+    const juce::ScopedLock scopedLock(lock);
+    const juce::InterProcessLock::ScopedLockType processScopedLock(processLock);
+
+    reloadIfChanged(); // keep what other processes stored in the meantime
+    entries[key.path] = Entry { key, description };
+
+    if (processScopedLock.isLocked())
+        save();
+    else
+        DBG("Plugin cache is busy, not saved: " << cacheFile.getFullPathName());
+}
+
+int CyderPluginCache::getNumEntries() const
+{
+    const juce::ScopedLock scopedLock(lock);
+    return static_cast<int>(entries.size());
+}
+
+const juce::File& CyderPluginCache::getCacheFile() const noexcept
+{
+    return cacheFile;
+}
+
+//==============================================================================
+
+void CyderPluginCache::reloadIfChanged()
+{
+    if (! cacheFile.existsAsFile())
+        return;
+
+    const auto modificationTime = cacheFile.getLastModificationTime();
+    if (modificationTime == loadedModificationTime)
+        return;
+
+    // Saves replace the file as a whole, so whatever is mapped here is always complete
+    const juce::MemoryMappedFile mappedCache(cacheFile, juce::MemoryMappedFile::readOnly);
+    if (mappedCache.getData() == nullptr)
+        return;
+
+    loadedModificationTime = modificationTime;
+
+    const auto xmlString = juce::String::fromUTF8(static_cast<const char*>(mappedCache.getData()),
+                                                  static_cast<int>(mappedCache.getSize()));
+    const std::unique_ptr<juce::XmlElement> xml { juce::XmlDocument::parse(xmlString) };
+
+    if (xml == nullptr || ! xml->hasTagName(rootTag) || xml->getIntAttribute("version") != formatVersion)
+        return; // overwritten on the next save
+
+    for (auto* entryElem : xml->getChildWithTagNameIterator(entryTag))
+    {
+        Entry entry;
+        entry.key.path                   = entryElem->getStringAttribute("path");
+        entry.key.moduleSize             = entryElem->getStringAttribute("size").getLargeIntValue();
+        entry.key.moduleModificationTime = entryElem->getStringAttribute("modified").getLargeIntValue();
+        entry.key.moduleHash             = static_cast<juce::uint64>(entryElem->getStringAttribute("hash").getHexValue64());
+
+        auto* descriptionElem = entryElem->getFirstChildElement();
+        if (entry.key.path.isEmpty() || descriptionElem == nullptr || ! entry.description.loadFromXml(*descriptionElem))
+            continue;
+
+        entries[entry.key.path] = std::move(entry);
+    }
+}
+
+void CyderPluginCache::save()
+{
+    juce::XmlElement xml(rootTag);
+    xml.setAttribute("version", formatVersion);
+
+    for (auto it = entries.begin(); it != entries.end();)
+    {
+        // Plugins that are gone would only ever grow the cache
+        if (! juce::File(it->first).exists())
+        {
+            it = entries.erase(it);
+            continue;
+        }
+
+        const auto& key = it->second.key;
+        auto* entryElem = xml.createNewChildElement(entryTag);
+        entryElem->setAttribute("path", key.path);
+        entryElem->setAttribute("size", juce::String(key.moduleSize));
+        entryElem->setAttribute("modified", juce::String(key.moduleModificationTime));
+        entryElem->setAttribute("hash", juce::String::toHexString(static_cast<juce::int64>(key.moduleHash)));
+        entryElem->addChildElement(it->second.description.createXml().release());
+        ++it;
+    }
+
+    if (! cacheFile.getParentDirectory().createDirectory())
+        return;
+
+    // Written next to the cache and moved over it, so nobody ever reads half a file
+    juce::TemporaryFile tempFile(cacheFile);
+    if (! tempFile.getFile().replaceWithText(xml.toString()) || ! tempFile.overwriteTargetFileWithTemporary())
+    {
+        DBG("Failed to save plugin cache: " << cacheFile.getFullPathName());
+        return;
+    }
+
+    loadedModificationTime = cacheFile.getLastModificationTime(); // nothing new to read back
+}
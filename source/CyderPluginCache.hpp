@@ -0,0 +1,96 @@
+/******************************************************************************
+ * Cyder — Hot-Reloading Audio Plugin Wrapper
+ *
+ * @file     CyderPluginCache.hpp
+ *
+ * @author   Adam Shield
+ * @date     2026-10-19
+ *
+ * @copyright (c) 2026 Adam Shield
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * See LICENSE.txt for license terms.
+ ******************************************************************************/
+
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+
+#include <map>
+#include <optional>
+
+//==============================================================================
+
+/**
+ Remembers the description of every plugin build scanned so far, on disk, so a
+ cold session load can skip scanning plugins that haven't changed since.
+
+ A build is identified by its bundle path, and its module's size, modification
+ time and hash. Only the latest build of each path is kept, and paths that no
+ longer exist are dropped whenever the cache is saved.
+
+ The cache file is shared by every Cyder process. It is read through a memory
+ map, and written by replacing it with a complete temporary file, under an
+ inter-process lock, merging in whatever other processes stored in the meantime.
+ */
+class CyderPluginCache final
+{
+public:
+    /** Identifies one build of a plugin. */
+    struct Key
+    {
+        juce::String path;         // original bundle, not the copy that was scanned
+        juce::int64 moduleSize = 0;
+        juce::int64 moduleModificationTime = 0; // ms since epoch
+        juce::uint64 moduleHash = 0;
+
+        [[nodiscard]] bool isSameBuildAs(const Key& other) const noexcept;
+    };
+
+    explicit CyderPluginCache(const juce::File& cacheFile = getDefaultCacheFile());
+    ~CyderPluginCache() = default;
+
+    /** @returns Cyder/PluginCache.xml in the user's application data folder */
+    [[nodiscard]] static juce::File getDefaultCacheFile();
+
+    /**
+     Reads the module of the given bundle (or the file itself, if it isn't one) to identify its build.
+     @returns key with a zero size if there is nothing to read
+     */
+    [[nodiscard]] static Key makeKey(const juce::File& pluginFile);
+
+    /**
+     Looks the build up, reloading the cache file first if another process has changed it. Any thread.
+     @returns description stored for exactly this build, if any. Its fileOrIdentifier is whatever was scanned.
+     */
+    [[nodiscard]] std::optional<juce::PluginDescription> find(const Key& key);
+
+    /** Stores the description of the build, and saves the cache file. Any thread. */
+    void store(const Key& key, const juce::PluginDescription& description);
+
+    /** */
+    [[nodiscard]] int getNumEntries() const;
+    /** */
+    [[nodiscard]] const juce::File& getCacheFile() const noexcept;
+
+private:
+    struct Entry
+    {
+        Key key;
+        juce::PluginDescription description;
+    };
+
+    const juce::File cacheFile;
+    juce::InterProcessLock processLock;
+
+    juce::CriticalSection lock;
+    std::map<juce::String, Entry> entries; // by path
+    juce::Time loadedModificationTime;     // of the cache file, when it was last read
+
+    /** Merges in the cache file if it has changed since it was last read. Call with lock held. */
+    void reloadIfChanged();
+    /** Writes every entry whose plugin still exists. Call with both locks held. */
+    void save();
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CyderPluginCache)
+};
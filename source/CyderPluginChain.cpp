@@ -0,0 +1,503 @@
+/******************************************************************************
+ * Cyder — Hot-Reloading Audio Plugin Wrapper
+ *
+ * @file     CyderPluginChain.cpp
+ *
+ * @author   Adam Shield
+ * @date     2026-10-19
+ *
+ * @copyright (c) 2026 Adam Shield
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * See LICENSE.txt for license terms.
+ ******************************************************************************/
+
+#include "CyderPluginChain.hpp"
+
+#include "CyderAssert.hpp"
+#include "CyderRealtimeGuard.hpp"
+#include "HotReloadThread.hpp"
+#include "Utilities.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+//==============================================================================
+
+struct CyderPluginChain::Entry
+{
+    int id = 0; // unique within the chain, unlike the entry's address once it has been freed
+
+    juce::File originalFile;
+    juce::File copiedFile;
+
+    std::unique_ptr<juce::AudioPluginInstance> instance;
+    std::unique_ptr<HotReloadThread> hotReloadThread;
+};
+
+//==============================================================================
+
+CyderPluginChain::CyderPluginChain(const juce::CriticalSection& audioCallbackLock)
+: callbackLock(audioCallbackLock)
+{
+    // Never reallocate while the audio thread is locked out
+    entries.reserve(static_cast<size_t>(maxNumPlugins));
+}
+
+CyderPluginChain::~CyderPluginChain()
+{
+    onLatencyChanged = nullptr;
+    onPluginReloaded = nullptr;
+    clear();
+}
+
+bool CyderPluginChain::appendPlugin(const juce::File& pluginFile)
+{
+    // CFBundle does not like it if we attempt to load a dll outside the message thread
+    jassert(juce::MessageManager::getInstance()->isThisTheMessageThread());
+
+    if (getNumPlugins() >= maxNumPlugins)
+    {
+        CYDER_ASSERT_FALSE;
+        return false;
+    }
+
+    CyderPluginLoader::PreparedPlugin prepared;
+    try
+    {
+        prepared = pluginLoader->prepare(pluginFile); // scanned once per build, like the main plugin
+    }
+    catch(const std::exception& e) // failed to copy or scan plugin
+    {
+        prepared.originalFile = pluginFile;
+        prepared.errorMessage = e.what();
+        if (prepared.errorMessage.isEmpty())
+            prepared.errorMessage = "Failed to load plugin: " + pluginFile.getFullPathName();
+    }
+
+    return appendPreparedPlugin(prepared);
+}
+
+bool CyderPluginChain::appendPreparedPlugin(const CyderPluginLoader::PreparedPlugin& prepared,
+                                            const juce::MemoryBlock* stateToRestore)
+{
+    jassert(juce::MessageManager::getInstance()->isThisTheMessageThread());
+
+    auto entry = std::make_unique<Entry>();
+    entry->id = nextEntryId++;
+    entry->originalFile = prepared.originalFile;
+    entry->copiedFile   = prepared.copiedPlugin;
+
+    try
+    {
+        if (! prepared.wasSuccessful())
+            throw std::runtime_error(prepared.errorMessage.toStdString());
+
+        if (getNumPlugins() >= maxNumPlugins)
+            throw std::runtime_error("Chain is full, could not add: " + prepared.originalFile.getFullPathName().toStdString());
+
+        entry->instance = createPreparedInstance(prepared.description, numChannels, sampleRate, blockSize, isPreparedToPlay);
+    }
+    catch(const std::exception& e) // failed to load plugin
+    {
+        juce::Logger::writeToLog(e.what());
+        CYDER_ASSERT_FALSE;
+        if (entry->copiedFile != juce::File())
+            Utilities::deleteStalePlugin(entry->copiedFile);
+        return false;
+    }
+
+    if (stateToRestore != nullptr)
+        entry->instance->setStateInformation(stateToRestore->getData(), static_cast<int>(stateToRestore->getSize()));
+
+    entry->instance->addListener(this);
+
+    auto& addedEntry = *entry;
+    {
+        juce::ScopedLock lock(callbackLock); // lock audio thread
+        entries.push_back(std::move(entry)); // capacity is reserved, does not allocate
+    }
+
+    startWatching(addedEntry);
+
+    if (onLatencyChanged != nullptr)
+        onLatencyChanged();
+
+    return true;
+}
+
+bool CyderPluginChain::reloadPlugin(int index)
+{
+    jassert(juce::MessageManager::getInstance()->isThisTheMessageThread());
+
+    if (! juce::isPositiveAndBelow(index, getNumPlugins()))
+        return false;
+
+    auto& entry = *entries[static_cast<size_t>(index)];
+
+    if (entry.hotReloadThread != nullptr)
+        entry.hotReloadThread->stop(); // don't hot reload while we're loading
+
+    std::unique_ptr<juce::AudioPluginInstance> newInstance;
+    juce::File incomingCopiedPlugin;
+
+    try
+    {
+        const auto prepared = pluginLoader->prepare(entry.originalFile);
+        incomingCopiedPlugin = prepared.copiedPlugin;
+        newInstance = createPreparedInstance(prepared.description, numChannels, sampleRate, blockSize, isPreparedToPlay);
+    }
+    catch(const std::exception& e) // failed to reload plugin
+    {
+        juce::Logger::writeToLog(e.what());
+        CYDER_ASSERT_FALSE;
+        Utilities::deleteStalePlugin(incomingCopiedPlugin);
+
+        startWatching(entry); // keep watching so the next build gets a chance
+
+        if (onPluginReloaded != nullptr)
+            onPluginReloaded(index, false);
+        return false;
+    }
+
+    // Carry state over to the new build
+    {
+        juce::MemoryBlock state;
+        entry.instance->getStateInformation(state);
+        newInstance->setStateInformation(state.getData(), static_cast<int>(state.getSize()));
+    }
+
+    entry.instance->removeListener(this);
+    newInstance->addListener(this);
+
+    // Swap out processor
+    std::unique_ptr<juce::AudioPluginInstance> outgoingInstance;
+    {
+        juce::ScopedLock lock(callbackLock); // lock audio thread
+        outgoingInstance = std::exchange(entry.instance, std::move(newInstance));
+    }
+    outgoingInstance.reset(); // destroy outside of the lock
+
+    // Cleanup: Delete copied plugin
+    Utilities::deleteStalePlugin(std::exchange(entry.copiedFile, incomingCopiedPlugin));
+
+    startWatching(entry);
+
+    if (onLatencyChanged != nullptr)
+        onLatencyChanged();
+    if (onPluginReloaded != nullptr)
+        onPluginReloaded(index, true);
+
+    return true;
+}
+
+void CyderPluginChain::removePlugin(int index)
+{
+    jassert(juce::MessageManager::getInstance()->isThisTheMessageThread());
+
+    if (! juce::isPositiveAndBelow(index, getNumPlugins()))
+        return;
+
+    const auto position = entries.begin() + index;
+
+    // Stop watching first so we don't reload after removing
+    if (auto& thread = (*position)->hotReloadThread; thread != nullptr)
+        thread->stop();
+
+    (*position)->instance->removeListener(this);
+
+    std::unique_ptr<Entry> removedEntry;
+    {
+        juce::ScopedLock lock(callbackLock); // lock audio thread
+        removedEntry = std::move(*position);
+        entries.erase(position);
+    }
+
+    // Destroy outside of the lock, then clean up its copy
+    removedEntry->hotReloadThread.reset();
+    removedEntry->instance.reset();
+    Utilities::deleteStalePlugin(removedEntry->copiedFile);
+
+    if (onLatencyChanged != nullptr)
+        onLatencyChanged();
+}
+
+void CyderPluginChain::clear()
+{
+    cancelPendingRestore();
+
+    while (! isEmpty())
+        removePlugin(getNumPlugins() - 1);
+}
+
+int CyderPluginChain::getNumPlugins() const noexcept
+{
+    return static_cast<int>(entries.size());
+}
+
+bool CyderPluginChain::isEmpty() const noexcept
+{
+    return entries.empty();
+}
+
+bool CyderPluginChain::isRestoringState() const noexcept
+{
+    return ! pendingRestore.empty();
+}
+
+juce::AudioProcessor* CyderPluginChain::getPlugin(int index) const noexcept
+{
+    if (! juce::isPositiveAndBelow(index, getNumPlugins()))
+        return nullptr;
+
+    return entries[static_cast<size_t>(index)]->instance.get();
+}
+
+juce::File CyderPluginChain::getPluginFileOriginal(int index) const noexcept
+{
+    if (! juce::isPositiveAndBelow(index, getNumPlugins()))
+        return {};
+
+    return entries[static_cast<size_t>(index)]->originalFile;
+}
+
+juce::File CyderPluginChain::getPluginFileCopy(int index) const noexcept
+{
+    if (! juce::isPositiveAndBelow(index, getNumPlugins()))
+        return {};
+
+    return entries[static_cast<size_t>(index)]->copiedFile;
+}
+
+juce::Thread* CyderPluginChain::getHotReloadThread(int index) const noexcept
+{
+    if (! juce::isPositiveAndBelow(index, getNumPlugins()))
+        return nullptr;
+
+    return entries[static_cast<size_t>(index)]->hotReloadThread.get();
+}
+
+int CyderPluginChain::getTotalLatencySamples() const noexcept
+{
+    int totalLatency = 0;
+    for (const auto& entry : entries)
+        totalLatency += entry->instance->getLatencySamples();
+    return totalLatency;
+}
+
+double CyderPluginChain::getTotalTailLengthSeconds() const
+{
+    double totalTail = 0.0;
+    for (const auto& entry : entries)
+        totalTail += entry->instance->getTailLengthSeconds();
+    return totalTail;
+}
+
+int CyderPluginChain::getNumChannels() const noexcept
+{
+    return numChannels;
+}
+
+void CyderPluginChain::prepareToPlay(int _numChannels, double _sampleRate, int samplesPerBlock)
+{
+    numChannels = _numChannels;
+    sampleRate  = _sampleRate;
+    blockSize   = samplesPerBlock;
+    isPreparedToPlay = true;
+
+    for (auto& entry : entries)
+    {
+        auto& instance = *entry->instance;
+        if (instance.getTotalNumOutputChannels() != numChannels)
+            instance.setPlayConfigDetails(numChannels, numChannels, sampleRate, blockSize);
+
+        instance.prepareToPlay(sampleRate, blockSize);
+    }
+}
+
+void CyderPluginChain::releaseResources()
+{
+    isPreparedToPlay = false;
+
+    for (auto& entry : entries)
+        entry->instance->releaseResources();
+}
+
+void CyderPluginChain::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    for (auto& entry : entries)
+    {
+        if (realtimeGuard != nullptr)
+        {
+            const CyderRealtimeGuard::ScopedScope wrappedScope(*realtimeGuard, CyderRealtimeGuard::Scope::wrappedPlugin);
+            entry->instance->processBlock(buffer, midiMessages);
+        }
+        else
+            entry->instance->processBlock(buffer, midiMessages);
+    }
+}
+
+void CyderPluginChain::setPlayHead(juce::AudioPlayHead* playHead) noexcept
+{
+    for (auto& entry : entries)
+        entry->instance->setPlayHead(playHead);
+}
+
+void CyderPluginChain::setRealtimeGuard(CyderRealtimeGuard* guard) noexcept
+{
+    realtimeGuard = guard;
+}
+
+void CyderPluginChain::saveState(juce::XmlElement& parentElement) const
+{
+    auto* chainElem = parentElement.createNewChildElement("PluginChain");
+
+    for (const auto& entry : entries)
+    {
+        auto* pluginElem = chainElem->createNewChildElement("ChainedPlugin");
+        pluginElem->setAttribute("pluginFilePath", entry->originalFile.getFullPathName());
+
+        juce::MemoryBlock pluginData;
+        entry->instance->getStateInformation(pluginData);
+        pluginElem->addTextElement(juce::Base64::toBase64(pluginData.getData(), pluginData.getSize()));
+    }
+
+    // Still being restored, so saved exactly as they were restored
+    for (const auto& pending : pendingRestore)
+    {
+        auto* pluginElem = chainElem->createNewChildElement("ChainedPlugin");
+        pluginElem->setAttribute("pluginFilePath", pending.pluginFile.getFullPathName());
+        pluginElem->addTextElement(juce::Base64::toBase64(pending.state.getData(), pending.state.getSize()));
+    }
+}
+
+void CyderPluginChain::restoreState(const juce::XmlElement& parentElement)
+{
+    clear(); // also drops a restore still in progress
+
+    auto* chainElem = parentElement.getChildByName("PluginChain");
+    if (chainElem == nullptr)
+        return;
+
+    for (auto* pluginElem : chainElem->getChildWithTagNameIterator("ChainedPlugin"))
+    {
+        PendingPlugin pending;
+        pending.pluginFile = juce::File(pluginElem->getStringAttribute("pluginFilePath"));
+        {
+            juce::MemoryOutputStream stream(pending.state, false);
+            juce::Base64::convertFromBase64(stream, pluginElem->getAllSubText());
+        }
+        pendingRestore.push_back(std::move(pending));
+    }
+
+    // Copied and scanned in the background, like the main plugin. Audio passes through the chain until they are all in.
+    const auto generation = ++restoreGeneration;
+    for (size_t i = 0; i < pendingRestore.size(); ++i)
+    {
+        pluginLoader->prepareAsync(pendingRestore[i].pluginFile,
+                                   [safeThis = juce::WeakReference<CyderPluginChain>(this),
+                                    generation, i](const CyderPluginLoader::PreparedPlugin& prepared)
+        {
+            if (safeThis.wasObjectDeleted() || safeThis->restoreGeneration != generation)
+            {
+                if (prepared.copiedPlugin != juce::File())
+                    Utilities::deleteStalePlugin(prepared.copiedPlugin); // restore was dropped in the meantime
+                return;
+            }
+
+            safeThis->pendingRestore[i].prepared = prepared;
+            safeThis->finishRestoreIfComplete();
+        });
+    }
+}
+
+std::unique_ptr<juce::AudioPluginInstance> CyderPluginChain::createPreparedInstance(const juce::PluginDescription& scannedDescription,
+                                                                                    int numChannels,
+                                                                                    double sampleRate,
+                                                                                    int blockSize,
+                                                                                    bool shouldPrepare) noexcept(false)
+{
+    juce::AudioPluginFormatManager formatManager;
+    formatManager.addDefaultFormats();
+
+    // Only supporting VST3
+    juce::AudioProcessor::setTypeOfNextNewPlugin(juce::AudioProcessor::wrapperType_VST3);
+
+    auto description = scannedDescription;
+    description.numInputChannels  = numChannels;
+    description.numOutputChannels = numChannels;
+
+    auto instance = Utilities::createInstance(description, formatManager, sampleRate, blockSize);
+    instance->setPlayConfigDetails(numChannels,
+                                   numChannels,
+                                   sampleRate,
+                                   blockSize);
+
+    // Until then, prepareToPlay() prepares it along with the rest of the chain
+    if (shouldPrepare)
+        instance->prepareToPlay(sampleRate, blockSize);
+
+    return instance;
+}
+
+void CyderPluginChain::finishRestoreIfComplete()
+{
+    if (! std::all_of(pendingRestore.begin(), pendingRestore.end(),
+                      [](const PendingPlugin& pending) { return pending.prepared.has_value(); }))
+        return;
+
+    // Added in saved order, whichever order they arrived in
+    const auto restored = std::exchange(pendingRestore, {});
+    for (const auto& pending : restored)
+        appendPreparedPlugin(*pending.prepared, &pending.state); // skipped if something went wrong loading it
+}
+
+void CyderPluginChain::cancelPendingRestore() noexcept
+{
+    pendingRestore.clear();
+    ++restoreGeneration; // their copies are retired when they arrive
+}
+
+void CyderPluginChain::startWatching(Entry& entry)
+{
+    if (entry.hotReloadThread != nullptr)
+        entry.hotReloadThread->stop();
+
+    entry.hotReloadThread = std::make_unique<HotReloadThread>(entry.originalFile); // auto starts thread
+    entry.hotReloadThread->onPluginChangeDetected = [safeThis = juce::WeakReference<CyderPluginChain>(this),
+                                                     entryId = entry.id]
+    {
+        juce::MessageManager::callAsync([safeThis, entryId]
+        {
+            if (safeThis.wasObjectDeleted())
+                return;
+
+            // Entry may have been removed while this call was pending
+            const auto index = safeThis->indexOf(entryId);
+            if (index >= 0)
+                safeThis->reloadPlugin(index);
+        });
+    };
+}
+
+int CyderPluginChain::indexOf(int entryId) const noexcept
+{
+    for (size_t i = 0; i < entries.size(); ++i)
+        if (entries[i]->id == entryId)
+            return static_cast<int>(i);
+    return -1;
+}
+
+void CyderPluginChain::audioProcessorChanged(juce::AudioProcessor* /*processor*/,
+                                             const AudioProcessorListener::ChangeDetails& details)
+{
+    if (! details.latencyChanged)
+        return;
+
+    // Any thread the plugin likes, so not while the message thread adds or removes entries
+    const juce::ScopedLock lock(callbackLock);
+    if (onLatencyChanged != nullptr)
+        onLatencyChanged();
+}
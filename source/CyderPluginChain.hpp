@@ -0,0 +1,169 @@
+/******************************************************************************
+ * Cyder — Hot-Reloading Audio Plugin Wrapper
+ *
+ * @file     CyderPluginChain.hpp
+ *
+ * @author   Adam Shield
+ * @date     2026-10-19
+ *
+ * @copyright (c) 2026 Adam Shield
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * See LICENSE.txt for license terms.
+ ******************************************************************************/
+
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <juce_core/juce_core.h>
+
+#include "CyderPluginLoader.hpp"
+
+#include <functional>
+#include <memory>
+#include <optional>
+#include <vector>
+
+//==============================================================================
+
+class CyderRealtimeGuard;
+class HotReloadThread;
+
+//==============================================================================
+
+/**
+ An ordered chain of wrapped plugins processed in series after Cyder's main
+ wrapped plugin. Every plugin in the chain has its own HotReloadThread and is
+ reloaded independently of the others.
+
+ Processing happens in place on whichever buffer is handed to processBlock(),
+ so the chain adds no buffer copies of its own.
+ */
+class CyderPluginChain final : private juce::AudioProcessorListener
+{
+public:
+    /** Maximum number of plugins in a chain. Storage is reserved up front. */
+    static constexpr int maxNumPlugins = 16;
+
+    /** @param audioCallbackLock lock held by the audio thread while processing (i.e. AudioProcessor::getCallbackLock()) */
+    explicit CyderPluginChain(const juce::CriticalSection& audioCallbackLock);
+    ~CyderPluginChain() override;
+
+    //==============================================================================
+
+    /**
+     Loads a plugin and appends it to the end of the chain. Message thread only.
+     @returns true if the plugin was loaded
+     */
+    bool appendPlugin(const juce::File& pluginFile);
+    /**
+     Rebuilds the plugin at the given index from its original file, carrying over its state.
+     Called automatically by that plugin's HotReloadThread. Message thread only.
+     @returns true if the plugin was reloaded
+     */
+    bool reloadPlugin(int index);
+    /** Removes and unloads the plugin at the given index. Message thread only. */
+    void removePlugin(int index);
+    /** Removes and unloads every plugin in the chain. Message thread only. */
+    void clear();
+
+    /** */
+    [[nodiscard]] int getNumPlugins() const noexcept;
+    /** */
+    [[nodiscard]] bool isEmpty() const noexcept;
+    /**
+     @returns true while the plugins of a restored state are still being copied and scanned in the background.
+     Audio passes through the chain until they are all in, and saveState() keeps them as they were restored.
+     */
+    [[nodiscard]] bool isRestoringState() const noexcept;
+    /** */
+    [[nodiscard]] juce::AudioProcessor* getPlugin(int index) const noexcept;
+    /** */
+    [[nodiscard]] juce::File getPluginFileOriginal(int index) const noexcept;
+    /** */
+    [[nodiscard]] juce::File getPluginFileCopy(int index) const noexcept;
+    /** */
+    [[nodiscard]] juce::Thread* getHotReloadThread(int index) const noexcept;
+
+    /** @returns sum of the latencies of every plugin in the chain */
+    [[nodiscard]] int getTotalLatencySamples() const noexcept;
+    /** @returns sum of the tails of every plugin in the chain. Message thread. */
+    [[nodiscard]] double getTotalTailLengthSeconds() const;
+
+    /** @returns channel count every plugin in the chain is configured for */
+    [[nodiscard]] int getNumChannels() const noexcept;
+
+    //==============================================================================
+
+    /** Prepares every plugin in the chain, and any plugin added to it until releaseResources(). */
+    void prepareToPlay(int numChannels, double sampleRate, int samplesPerBlock);
+    /** */
+    void releaseResources();
+    /** Audio thread. Processes the buffer in place through each plugin in order. */
+    void processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages);
+    /** Audio thread. */
+    void setPlayHead(juce::AudioPlayHead* playHead) noexcept;
+
+    /** Counts whatever each plugin's processBlock() does against the wrapped plugin scope. Before processing starts. */
+    void setRealtimeGuard(CyderRealtimeGuard* guard) noexcept;
+
+    //==============================================================================
+
+    /** Stores the file path and state of each plugin in the chain. */
+    void saveState(juce::XmlElement& parentElement) const;
+    /** Replaces the chain with the plugins described by saveState(), once they have been prepared in the background. Message thread only. */
+    void restoreState(const juce::XmlElement& parentElement);
+
+    //==============================================================================
+
+    /** Called whenever the chain's total latency may have changed, on whichever thread reported it, holding the callback lock unless on the message thread. */
+    std::function<void()> onLatencyChanged = nullptr;
+    /** Called on the message thread after a plugin in the chain has been hot reloaded. */
+    std::function<void(int index, bool success)> onPluginReloaded = nullptr;
+
+private:
+    struct Entry;
+
+    const juce::CriticalSection& callbackLock;
+    CyderRealtimeGuard* realtimeGuard = nullptr;
+    juce::SharedResourcePointer<CyderPluginLoader> pluginLoader; // shares scans with every other Cyder in the process
+    std::vector<std::unique_ptr<Entry>> entries;
+    int nextEntryId = 0;
+
+    // Restored plugins waiting to be prepared in the background, in saved order, see restoreState()
+    struct PendingPlugin
+    {
+        juce::File pluginFile;
+        juce::MemoryBlock state; // decoded, for the plugin once it is in
+        std::optional<CyderPluginLoader::PreparedPlugin> prepared; // once it has arrived
+    };
+    std::vector<PendingPlugin> pendingRestore;
+    int restoreGeneration = 0; // bumped whenever a restore is started or cancelled, so stale ones are dropped
+
+    int numChannels = 2;
+    double sampleRate = 44100.0;
+    int blockSize = 512;
+    bool isPreparedToPlay = false; // between prepareToPlay() and releaseResources()
+
+    [[nodiscard]] static std::unique_ptr<juce::AudioPluginInstance> createPreparedInstance(const juce::PluginDescription& scannedDescription,
+                                                                                           int numChannels,
+                                                                                           double sampleRate,
+                                                                                           int blockSize,
+                                                                                           bool shouldPrepare) noexcept(false);
+    bool appendPreparedPlugin(const CyderPluginLoader::PreparedPlugin& prepared,
+                              const juce::MemoryBlock* stateToRestore = nullptr);
+    void finishRestoreIfComplete();
+    void cancelPendingRestore() noexcept;
+    void startWatching(Entry& entry);
+    /** @returns index of the entry with the given id, or -1 if it has been removed */
+    [[nodiscard]] int indexOf(int entryId) const noexcept;
+
+    void audioProcessorParameterChanged(juce::AudioProcessor* /*processor*/,
+                                        int /*parameterIndex*/,
+                                        float /*newValue*/) override {}
+    void audioProcessorChanged(juce::AudioProcessor* processor,
+                               const AudioProcessorListener::ChangeDetails& details) override;
+
+    JUCE_DECLARE_WEAK_REFERENCEABLE (CyderPluginChain)
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CyderPluginChain)
+};
@@ -0,0 +1,361 @@
+/******************************************************************************
+ * Cyder — Hot-Reloading Audio Plugin Wrapper
+ *
+ * @file     CyderPluginGraph.cpp
+ *
+ * @author   Adam Shield
+ * @date     2026-10-19
+ *
+ * @copyright (c) 2026 Adam Shield
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * See LICENSE.txt for license terms.
+ ******************************************************************************/
+
+#include "CyderPluginGraph.hpp"
+
+#include "CyderAssert.hpp"
+#include "CyderDelayLine.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+//==============================================================================
+
+/** Enough room for a dense block of MIDI without the audio thread allocating. Anything beyond it is dropped. */
+static constexpr int midiBufferBytesPerBranch = 4096;
+/** What juce::MidiBuffer stores ahead of each event's bytes: its sample position and size. */
+static constexpr int midiEventHeaderBytes = static_cast<int>(sizeof(juce::int32) + sizeof(juce::uint16));
+
+struct CyderPluginGraph::Branch
+{
+    explicit Branch(const juce::CriticalSection& audioCallbackLock)
+    : chain(audioCallbackLock)
+    {
+    }
+
+    CyderPluginChain chain;
+
+    juce::AudioBuffer<float> buffer;
+    juce::MidiBuffer midi;
+    CyderDelayLine compensationDelay;
+
+    std::atomic<float> gain { 1.0f };
+};
+
+//==============================================================================
+
+CyderPluginGraph::CyderPluginGraph(const juce::CriticalSection& audioCallbackLock)
+: callbackLock(audioCallbackLock)
+, processBranchTask([this](int index) { processBranch(index); })
+{
+    // Never reallocate while the audio thread is locked out
+    branches.reserve(static_cast<size_t>(maxNumBranches));
+}
+
+CyderPluginGraph::~CyderPluginGraph()
+{
+    onLatencyChanged = nullptr;
+    clear();
+    workerPool.reset();
+}
+
+int CyderPluginGraph::addBranch()
+{
+    jassert(juce::MessageManager::getInstance()->isThisTheMessageThread());
+
+    if (getNumBranches() >= maxNumBranches)
+    {
+        CYDER_ASSERT_FALSE;
+        return -1;
+    }
+
+    auto branch = std::make_unique<Branch>(callbackLock);
+    branch->chain.setRealtimeGuard(realtimeGuard);
+    prepareBranch(*branch);
+    if (! isPreparedToPlay)
+        branch->chain.releaseResources(); // still empty, so this only leaves its plugins for prepareToPlay() to prepare
+    branch->chain.onLatencyChanged = [this] { updateLatencyCompensation(); };
+
+    // Start worker threads as soon as there is something to run in parallel
+    std::unique_ptr<CyderWorkerPool> newWorkerPool;
+    if (workerPool == nullptr && getNumBranches() >= 1)
+        newWorkerPool = std::make_unique<CyderWorkerPool>(CyderWorkerPool::getDefaultNumWorkers(maxNumBranches - 1), realtimeGuard);
+
+    {
+        juce::ScopedLock lock(callbackLock); // lock audio thread
+        branches.push_back(std::move(branch)); // capacity is reserved, does not allocate
+        if (newWorkerPool != nullptr)
+            workerPool = std::move(newWorkerPool);
+    }
+
+    updateLatencyCompensation();
+
+    return getNumBranches() - 1;
+}
+
+void CyderPluginGraph::removeBranch(int index)
+{
+    jassert(juce::MessageManager::getInstance()->isThisTheMessageThread());
+
+    if (! juce::isPositiveAndBelow(index, getNumBranches()))
+        return;
+
+    std::unique_ptr<Branch> removedBranch;
+    {
+        juce::ScopedLock lock(callbackLock); // lock audio thread
+        const auto position = branches.begin() + index;
+        removedBranch = std::move(*position);
+        branches.erase(position);
+    }
+
+    // Unload its plugins outside of the lock
+    removedBranch->chain.onLatencyChanged = nullptr;
+    removedBranch.reset();
+
+    updateLatencyCompensation();
+}
+
+void CyderPluginGraph::clear()
+{
+    while (! isEmpty())
+        removeBranch(getNumBranches() - 1);
+}
+
+int CyderPluginGraph::getNumBranches() const noexcept
+{
+    return static_cast<int>(branches.size());
+}
+
+bool CyderPluginGraph::isEmpty() const noexcept
+{
+    return branches.empty();
+}
+
+bool CyderPluginGraph::isRestoringState() const noexcept
+{
+    return std::any_of(branches.begin(), branches.end(),
+                       [](const std::unique_ptr<Branch>& branch) { return branch->chain.isRestoringState(); });
+}
+
+CyderPluginChain& CyderPluginGraph::getBranch(int index) noexcept
+{
+    jassert(juce::isPositiveAndBelow(index, getNumBranches()));
+    return branches[static_cast<size_t>(index)]->chain;
+}
+
+void CyderPluginGraph::setBranchGain(int index, float gain) noexcept
+{
+    if (juce::isPositiveAndBelow(index, getNumBranches()))
+        branches[static_cast<size_t>(index)]->gain.store(gain, std::memory_order_relaxed);
+}
+
+float CyderPluginGraph::getBranchGain(int index) const noexcept
+{
+    if (! juce::isPositiveAndBelow(index, getNumBranches()))
+        return 0.0f;
+
+    return branches[static_cast<size_t>(index)]->gain.load(std::memory_order_relaxed);
+}
+
+int CyderPluginGraph::getLatencySamples() const noexcept
+{
+    return latencySamples.load(std::memory_order_relaxed);
+}
+
+double CyderPluginGraph::getTailLengthSeconds() const
+{
+    double longestTail = 0.0;
+    for (const auto& branch : branches)
+        longestTail = std::max(longestTail, branch->chain.getTotalTailLengthSeconds());
+    return longestTail;
+}
+
+int CyderPluginGraph::getCompensationDelaySamples(int index) const noexcept
+{
+    if (! juce::isPositiveAndBelow(index, getNumBranches()))
+        return 0;
+
+    return branches[static_cast<size_t>(index)]->compensationDelay.getDelay();
+}
+
+int CyderPluginGraph::getNumChannels() const noexcept
+{
+    return numChannels;
+}
+
+int CyderPluginGraph::getNumWorkerThreads() const noexcept
+{
+    return workerPool != nullptr ? workerPool->getNumWorkers() : 0;
+}
+
+juce::uint64 CyderPluginGraph::getNumDroppedMidiEvents() const noexcept
+{
+    return numDroppedMidiEvents.load(std::memory_order_relaxed);
+}
+
+void CyderPluginGraph::prepareToPlay(int _numChannels, double _sampleRate, int samplesPerBlock)
+{
+    numChannels = _numChannels;
+    sampleRate  = _sampleRate;
+    blockSize   = samplesPerBlock;
+    isPreparedToPlay = true;
+
+    for (auto& branch : branches)
+        prepareBranch(*branch);
+
+    updateLatencyCompensation();
+}
+
+void CyderPluginGraph::releaseResources()
+{
+    isPreparedToPlay = false;
+
+    for (auto& branch : branches)
+        branch->chain.releaseResources();
+}
+
+void CyderPluginGraph::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    const auto numBranches = getNumBranches();
+    if (numBranches == 0)
+        return;
+
+    currentInput       = &buffer;
+    currentMidi        = &midiMessages;
+    currentNumChannels = std::min(buffer.getNumChannels(), numChannels);
+
+    // A host may exceed the block size it prepared us with, which is all the branches have room for
+    const auto numSamples = buffer.getNumSamples();
+    for (int start = 0; start < numSamples; start += blockSize)
+    {
+        currentStartSample = start;
+        currentNumSamples  = std::min(blockSize, numSamples - start);
+
+        // Fork, then join once every branch is done
+        if (workerPool != nullptr && numBranches > 1)
+            workerPool->run(numBranches, processBranchTask);
+        else
+            for (int i = 0; i < numBranches; ++i)
+                processBranch(i);
+
+        // Mix branches into the output, over the input they have all finished reading
+        for (int channel = 0; channel < currentNumChannels; ++channel)
+            buffer.clear(channel, start, currentNumSamples);
+
+        for (auto& branch : branches)
+        {
+            const auto gain = branch->gain.load(std::memory_order_relaxed);
+            for (int channel = 0; channel < currentNumChannels; ++channel)
+                buffer.addFrom(channel, start, branch->buffer, channel, 0, currentNumSamples, gain);
+        }
+    }
+
+    currentInput = nullptr;
+    currentMidi  = nullptr;
+}
+
+void CyderPluginGraph::setPlayHead(juce::AudioPlayHead* playHead) noexcept
+{
+    for (auto& branch : branches)
+        branch->chain.setPlayHead(playHead);
+}
+
+void CyderPluginGraph::setRealtimeGuard(CyderRealtimeGuard* guard) noexcept
+{
+    jassert(workerPool == nullptr); // only picked up by a worker pool when it is created
+    realtimeGuard = guard;
+}
+
+void CyderPluginGraph::saveState(juce::XmlElement& parentElement) const
+{
+    auto* graphElem = parentElement.createNewChildElement("PluginGraph");
+
+    for (const auto& branch : branches)
+    {
+        auto* branchElem = graphElem->createNewChildElement("Branch");
+        branchElem->setAttribute("gain", static_cast<double>(branch->gain.load(std::memory_order_relaxed)));
+        branch->chain.saveState(*branchElem);
+    }
+}
+
+void CyderPluginGraph::restoreState(const juce::XmlElement& parentElement)
+{
+    clear();
+
+    auto* graphElem = parentElement.getChildByName("PluginGraph");
+    if (graphElem == nullptr)
+        return;
+
+    for (auto* branchElem : graphElem->getChildWithTagNameIterator("Branch"))
+    {
+        const auto index = addBranch();
+        if (index < 0)
+            break;
+
+        setBranchGain(index, static_cast<float>(branchElem->getDoubleAttribute("gain", 1.0)));
+        getBranch(index).restoreState(*branchElem);
+    }
+}
+
+void CyderPluginGraph::prepareBranch(Branch& branch) const
+{
+    branch.chain.prepareToPlay(numChannels, sampleRate, blockSize);
+
+    branch.buffer.setSize(numChannels, blockSize);
+    branch.midi.ensureSize(midiBufferBytesPerBranch);
+    branch.compensationDelay.prepare(numChannels,
+                                     juce::roundToInt(maxCompensationSeconds * sampleRate),
+                                     blockSize);
+}
+
+void CyderPluginGraph::processBranch(int index) noexcept
+{
+    auto& branch = *branches[static_cast<size_t>(index)];
+
+    // Every branch works on its own copy of the input
+    for (int channel = 0; channel < currentNumChannels; ++channel)
+        branch.buffer.copyFrom(channel, 0, *currentInput, channel, currentStartSample, currentNumSamples);
+
+    // This chunk's events, copied only as far as the branch's reserve goes, so the worker never allocates
+    branch.midi.clear();
+    const auto endSample = currentStartSample + currentNumSamples;
+    for (auto it = currentMidi->findNextSamplePosition(currentStartSample); it != currentMidi->cend(); ++it)
+    {
+        const auto metadata = *it;
+        if (metadata.samplePosition >= endSample)
+            break;
+
+        if (branch.midi.data.size() + midiEventHeaderBytes + metadata.numBytes > midiBufferBytesPerBranch)
+        {
+            numDroppedMidiEvents.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+        branch.midi.addEvent(metadata.data, metadata.numBytes, metadata.samplePosition - currentStartSample);
+    }
+
+    // Refers to the branch's preallocated memory, trimmed to this block
+    juce::AudioBuffer<float> block(branch.buffer.getArrayOfWritePointers(),
+                                   currentNumChannels,
+                                   currentNumSamples);
+
+    branch.chain.processBlock(block, branch.midi);
+    branch.compensationDelay.process(block);
+}
+
+void CyderPluginGraph::updateLatencyCompensation()
+{
+    int maxLatency = 0;
+    for (const auto& branch : branches)
+        maxLatency = std::max(maxLatency, branch->chain.getTotalLatencySamples());
+
+    // Delay every branch to line up with the slowest one
+    for (auto& branch : branches)
+        branch->compensationDelay.setDelay(maxLatency - branch->chain.getTotalLatencySamples());
+
+    latencySamples.store(maxLatency, std::memory_order_relaxed);
+
+    if (onLatencyChanged != nullptr)
+        onLatencyChanged();
+}
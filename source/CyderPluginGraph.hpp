@@ -0,0 +1,157 @@
+/******************************************************************************
+ * Cyder — Hot-Reloading Audio Plugin Wrapper
+ *
+ * @file     CyderPluginGraph.hpp
+ *
+ * @author   Adam Shield
+ * @date     2026-10-19
+ *
+ * @copyright (c) 2026 Adam Shield
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * See LICENSE.txt for license terms.
+ ******************************************************************************/
+
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <juce_core/juce_core.h>
+
+#include "CyderPluginChain.hpp"
+#include "CyderWorkerPool.hpp"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+//==============================================================================
+
+/**
+ A graph of wrapped plugins arranged as parallel branches, e.g. a dry/wet split
+ or one branch per band of a multiband processor.
+
+ Every branch receives a copy of the input and runs its own CyderPluginChain.
+ Independent branches are processed in parallel on a CyderWorkerPool, joined,
+ delayed so that every branch lines up with the slowest one, then summed
+ (each with its own gain) into the output.
+ An empty branch is a plain, latency-compensated dry path.
+ */
+class CyderPluginGraph final
+{
+public:
+    /** Maximum number of parallel branches. Storage is reserved up front. */
+    static constexpr int maxNumBranches = 8;
+    /** Longest latency difference between branches that can be compensated. */
+    static constexpr double maxCompensationSeconds = 2.0;
+
+    /** @param audioCallbackLock lock held by the audio thread while processing (i.e. AudioProcessor::getCallbackLock()) */
+    explicit CyderPluginGraph(const juce::CriticalSection& audioCallbackLock);
+    ~CyderPluginGraph();
+
+    //==============================================================================
+
+    /**
+     Adds an empty branch, which passes the input through until plugins are added to it.
+     Message thread only.
+     @returns index of the new branch, or -1 if there is no room for another
+     */
+    int addBranch();
+    /** Removes the branch at the given index along with all of its plugins. Message thread only. */
+    void removeBranch(int index);
+    /** Removes every branch. Message thread only. */
+    void clear();
+
+    /** */
+    [[nodiscard]] int getNumBranches() const noexcept;
+    /** */
+    [[nodiscard]] bool isEmpty() const noexcept;
+    /** @returns true while any branch is still restoring its plugins, see CyderPluginChain::isRestoringState() */
+    [[nodiscard]] bool isRestoringState() const noexcept;
+    /** Use the returned chain to add, remove or reload plugins in that branch. */
+    [[nodiscard]] CyderPluginChain& getBranch(int index) noexcept;
+
+    /** Sets the linear gain the branch is mixed into the output with. Thread safe. */
+    void setBranchGain(int index, float gain) noexcept;
+    /** */
+    [[nodiscard]] float getBranchGain(int index) const noexcept;
+
+    /** @returns latency of the slowest branch, which every other branch is delayed to match */
+    [[nodiscard]] int getLatencySamples() const noexcept;
+    /** @returns longest tail of any branch. Message thread. */
+    [[nodiscard]] double getTailLengthSeconds() const;
+    /** @returns delay added to the given branch to line it up with the slowest branch */
+    [[nodiscard]] int getCompensationDelaySamples(int index) const noexcept;
+
+    /** @returns number of channels every branch was prepared with */
+    [[nodiscard]] int getNumChannels() const noexcept;
+
+    /** @returns number of worker threads branches are spread across, excluding the audio thread */
+    [[nodiscard]] int getNumWorkerThreads() const noexcept;
+
+    /** @returns MIDI events a branch had no room left for, and dropped rather than allocate, since construction */
+    [[nodiscard]] juce::uint64 getNumDroppedMidiEvents() const noexcept;
+
+    //==============================================================================
+
+    /** Allocates every branch's buffers for the given configuration. */
+    void prepareToPlay(int numChannels, double sampleRate, int samplesPerBlock);
+    /** */
+    void releaseResources();
+    /** Audio thread. Replaces the buffer's contents with the mix of all branches, blockSize samples at a time. */
+    void processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages);
+    /** Audio thread. */
+    void setPlayHead(juce::AudioPlayHead* playHead) noexcept;
+
+    /**
+     Counts whatever the branches' plugins do against the wrapped plugin scope, including on worker threads.
+     Before any branch is added.
+     */
+    void setRealtimeGuard(CyderRealtimeGuard* guard) noexcept;
+
+    //==============================================================================
+
+    /** Stores every branch, its gain and its plugins. */
+    void saveState(juce::XmlElement& parentElement) const;
+    /**
+     Replaces the graph with the branches described by saveState(). Their plugins are prepared in the background,
+     each branch passing audio through until its own are in. Message thread only.
+     */
+    void restoreState(const juce::XmlElement& parentElement);
+
+    //==============================================================================
+
+    /** Called whenever the graph's latency may have changed, on whichever thread reported it, holding the callback lock unless on the message thread. */
+    std::function<void()> onLatencyChanged = nullptr;
+
+private:
+    struct Branch;
+
+    const juce::CriticalSection& callbackLock;
+    CyderRealtimeGuard* realtimeGuard = nullptr;
+    std::vector<std::unique_ptr<Branch>> branches;
+    std::unique_ptr<CyderWorkerPool> workerPool;
+
+    /** Runs one branch. Called from the worker pool with the branch index. */
+    const CyderWorkerPool::Task processBranchTask;
+
+    int numChannels = 2;
+    double sampleRate = 44100.0;
+    int blockSize = 512;
+    bool isPreparedToPlay = false; // between prepareToPlay() and releaseResources()
+
+    // Handed from processBlock() to the branch tasks, only valid during processBlock()
+    const juce::AudioBuffer<float>* currentInput = nullptr;
+    const juce::MidiBuffer* currentMidi = nullptr;
+    int currentNumChannels = 0;
+    int currentStartSample = 0; // blocks longer than blockSize are processed in chunks
+    int currentNumSamples = 0;
+
+    std::atomic<int> latencySamples { 0 };
+    std::atomic<juce::uint64> numDroppedMidiEvents { 0 };
+
+    void prepareBranch(Branch& branch) const;
+    void processBranch(int index) noexcept;
+    void updateLatencyCompensation();
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CyderPluginGraph)
+};
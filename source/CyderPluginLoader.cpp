@@ -0,0 +1,183 @@
+/******************************************************************************
+ * Cyder — Hot-Reloading Audio Plugin Wrapper
+ *
+ * @file     CyderPluginLoader.cpp
+ *
+ * @author   Adam Shield
+ * @date     2026-10-19
+ *
+ * @copyright (c) 2026 Adam Shield
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * See LICENSE.txt for license terms.
+ ******************************************************************************/
+
+#include "CyderPluginLoader.hpp"
+
+#include "Utilities.hpp"
+
+#include <exception>
+#include <stdexcept>
+#include <utility>
+
+//==============================================================================
+
+/** Copying is mostly I/O, so a few threads go a long way. */
+static constexpr int maxNumThreads = 4;
+
+static constexpr int shutdownTimeoutMs = 30000;
+
+//==============================================================================
+
+CyderPluginLoader::CyderPluginLoader(const juce::File& cacheFile)
+: cache(cacheFile)
+, pool(juce::ThreadPoolOptions{}.withThreadName("Cyder Plugin Loader")
+                                .withNumberOfThreads(getDefaultNumThreads())
+                                .withDesiredThreadPriority(juce::Thread::Priority::background))
+{
+}
+
+CyderPluginLoader::~CyderPluginLoader()
+{
+    pool.removeAllJobs(/*interruptRunningJobs*/ true, shutdownTimeoutMs);
+}
+
+CyderPluginLoader::PreparedPlugin CyderPluginLoader::prepare(const juce::File& pluginFile, bool forOtherProcesses) noexcept(false)
+{
+    PreparedPlugin prepared;
+    prepared.originalFile = pluginFile;
+
+    // Copy plugin to temp with a random hash appended
+    prepared.copiedPlugin = Utilities::copyPluginToTemp(pluginFile, forOtherProcesses);
+
+    try
+    {
+        prepared.description = findDescription(pluginFile, prepared.copiedPlugin);
+    }
+    catch (...)
+    {
+        Utilities::deleteStalePlugin(prepared.copiedPlugin);
+        throw;
+    }
+
+    return prepared;
+}
+
+void CyderPluginLoader::prepareAsync(const juce::File& pluginFile, Callback onPrepared, bool forOtherProcesses)
+{
+    jassert(onPrepared != nullptr);
+
+    pool.addJob([this, pluginFile, onPrepared, forOtherProcesses]
+    {
+        PreparedPlugin prepared;
+        try
+        {
+            prepared = prepare(pluginFile, forOtherProcesses);
+        }
+        catch (const std::exception& e)
+        {
+            prepared.originalFile = pluginFile;
+            prepared.errorMessage = e.what();
+            if (prepared.errorMessage.isEmpty())
+                prepared.errorMessage = "Failed to load plugin: " + pluginFile.getFullPathName();
+        }
+
+        juce::MessageManager::callAsync([onPrepared, prepared]
+        {
+            onPrepared(prepared);
+        });
+    });
+}
+
+int CyderPluginLoader::getNumJobs() const
+{
+    return pool.getNumJobs();
+}
+
+int CyderPluginLoader::getNumScansPerformed() const noexcept
+{
+    return numScansPerformed.load();
+}
+
+CyderPluginCache& CyderPluginLoader::getCache() noexcept
+{
+    return cache;
+}
+
+int CyderPluginLoader::getDefaultNumThreads() noexcept
+{
+    return juce::jlimit(1, maxNumThreads, juce::SystemStats::getNumCpus() - 1);
+}
+
+//==============================================================================
+
+juce::PluginDescription CyderPluginLoader::findDescription(const juce::File& originalFile,
+                                                           const juce::File& copiedPlugin) noexcept(false)
+{
+    // Bundles are folders whose own timestamp says little, so a build is told apart by its module
+    auto module = Utilities::getModuleInBundle(originalFile);
+    if (module == juce::File())
+        module = originalFile;
+
+    const auto moduleSize             = module.getSize();
+    const auto moduleModificationTime = module.getLastModificationTime();
+    const auto key                    = originalFile.getFullPathName();
+
+    std::promise<juce::PluginDescription> promise;
+    std::shared_future<juce::PluginDescription> description;
+    bool shouldScan = false;
+    {
+        const juce::ScopedLock lock(scansLock);
+        auto it = scans.find(key);
+        if (it != scans.end()
+            && it->second.moduleSize == moduleSize
+            && it->second.moduleModificationTime == moduleModificationTime)
+        {
+            description = it->second.description;
+        }
+        else
+        {
+            description = promise.get_future().share();
+            scans[key] = Scan { moduleSize, moduleModificationTime, description };
+            shouldScan = true;
+        }
+    }
+
+    if (shouldScan)
+    {
+        try
+        {
+            // Hashing the module costs far less than loading it to scan
+            const auto cacheKey = CyderPluginCache::makeKey(originalFile);
+            if (auto cached = cache.find(cacheKey))
+            {
+                promise.set_value(*cached);
+            }
+            else
+            {
+                juce::AudioPluginFormatManager formatManager;
+                formatManager.addDefaultFormats();
+
+                ++numScansPerformed;
+                auto scanned = Utilities::findPluginDescription(copiedPlugin, formatManager);
+                cache.store(cacheKey, scanned);
+                promise.set_value(std::move(scanned));
+            }
+        }
+        catch (...)
+        {
+            promise.set_exception(std::current_exception());
+
+            // Forget the failure, so the next attempt scans again
+            const juce::ScopedLock lock(scansLock);
+            if (auto it = scans.find(key); it != scans.end()
+                                           && it->second.moduleSize == moduleSize
+                                           && it->second.moduleModificationTime == moduleModificationTime)
+                scans.erase(it);
+        }
+    }
+
+    auto result = description.get(); // rethrows if the scan failed
+    result.fileOrIdentifier = copiedPlugin.getFullPathName(); // the scan may have been of someone else's copy
+    return result;
+}
@@ -0,0 +1,113 @@
+/******************************************************************************
+ * Cyder — Hot-Reloading Audio Plugin Wrapper
+ *
+ * @file     CyderPluginLoader.hpp
+ *
+ * @author   Adam Shield
+ * @date     2026-10-19
+ *
+ * @copyright (c) 2026 Adam Shield
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * See LICENSE.txt for license terms.
+ ******************************************************************************/
+
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+
+#include "CyderPluginCache.hpp"
+
+#include <atomic>
+#include <functional>
+#include <future>
+#include <map>
+
+//==============================================================================
+
+/**
+ Copies plugins to temp and scans them, on a pool of background threads shared by
+ every Cyder in the process. A session full of Cyders therefore restores in parallel,
+ rather than one plugin after another on the message thread.
+
+ Scanning loads the plugin's module, so it is only done once per build of a plugin:
+ whoever asks first scans, and everyone else loading the same build gets that result
+ (waiting for it if it is still in progress). Each still gets a copy of its own,
+ since each hot reloads on its own. Scans are also kept in CyderPluginCache, so
+ builds scanned by an earlier process are never scanned again.
+
+ Instantiation is left to the caller, on the message thread (see CyderAudioProcessor::loadPlugin()).
+
+ Share one instance per process with juce::SharedResourcePointer<CyderPluginLoader>.
+ */
+class CyderPluginLoader final
+{
+public:
+    /** A plugin copied to temp and scanned, ready to be instantiated. */
+    struct PreparedPlugin
+    {
+        juce::File originalFile;
+        juce::File copiedPlugin;             // retired with Utilities::deleteStalePlugin() by whoever receives it
+        juce::PluginDescription description; // refers to copiedPlugin
+        juce::String errorMessage;           // empty on success
+
+        [[nodiscard]] bool wasSuccessful() const noexcept { return errorMessage.isEmpty(); }
+    };
+
+    /** Called on the message thread with the outcome of prepareAsync(). */
+    using Callback = std::function<void(PreparedPlugin)>;
+
+    explicit CyderPluginLoader(const juce::File& cacheFile = CyderPluginCache::getDefaultCacheFile());
+    /** Cancels jobs that haven't started and waits for the rest. Their results are never delivered. */
+    ~CyderPluginLoader();
+
+    /**
+     Copies and scans the plugin on the calling thread, sharing the scan with any background job.
+     @param forOtherProcesses copy it where another process can load it, see Utilities::copyPluginToTemp()
+     @throws std::runtime_error if the plugin could not be copied or scanned
+     */
+    [[nodiscard]] PreparedPlugin prepare(const juce::File& pluginFile, bool forOtherProcesses = false) noexcept(false);
+
+    /**
+     Queues the plugin to be copied and scanned in the background. Any thread.
+     A copy made for a callback that no longer wants it must still be retired by the callback.
+     */
+    void prepareAsync(const juce::File& pluginFile, Callback onPrepared, bool forOtherProcesses = false);
+
+    /** @returns number of jobs queued or in progress */
+    [[nodiscard]] int getNumJobs() const;
+    /** @returns number of scans actually performed, i.e. not shared with an earlier one nor found in the cache */
+    [[nodiscard]] int getNumScansPerformed() const noexcept;
+    /** */
+    [[nodiscard]] CyderPluginCache& getCache() noexcept;
+
+    /** @returns a thread count suited to copying, leaving a core free for the host */
+    [[nodiscard]] static int getDefaultNumThreads() noexcept;
+
+private:
+    /** One build of a plugin, as scanned, or being scanned. */
+    struct Scan
+    {
+        juce::int64 moduleSize = 0;
+        juce::Time moduleModificationTime;
+        std::shared_future<juce::PluginDescription> description;
+    };
+
+    juce::CriticalSection scansLock;
+    std::map<juce::String, Scan> scans; // keyed by original bundle path, only the latest build of each is kept
+
+    std::atomic<int> numScansPerformed { 0 };
+
+    CyderPluginCache cache;
+
+    juce::ThreadPool pool; // last, so no job outlives what it uses
+
+    /**
+     Scans the copy, unless the same build has been (or is being) scanned already.
+     @returns description referring to the given copy
+     */
+    [[nodiscard]] juce::PluginDescription findDescription(const juce::File& originalFile,
+                                                          const juce::File& copiedPlugin) noexcept(false);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CyderPluginLoader)
+};
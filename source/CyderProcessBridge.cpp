@@ -0,0 +1,469 @@
+/******************************************************************************
+ * Cyder — Hot-Reloading Audio Plugin Wrapper
+ *
+ * @file     CyderProcessBridge.cpp
+ *
+ * @author   Adam Shield
+ * @date     2026-10-19
+ *
+ * @copyright (c) 2026 Adam Shield
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * See LICENSE.txt for license terms.
+ ******************************************************************************/
+
+#include "CyderProcessBridge.hpp"
+#include "Utilities.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#if JUCE_LINUX
+#include <unistd.h>
+#endif
+
+//==============================================================================
+
+static constexpr const char* hostExecutableName = "Cyder_PluginHost";
+
+/** Loading a plugin may take a while, scanning it takes longer still. */
+static constexpr int launchTimeoutMs  = 30000;
+static constexpr int commandTimeoutMs = 5000;
+static constexpr int exitTimeoutMs    = 2000;
+
+static constexpr int watchdogPollMs      = 20;
+static constexpr int minRestartDelayMs   = 100;
+static constexpr int maxRestartDelayMs   = 5000;
+/** A child that stays up this long is considered healthy again, resetting the restart delay. */
+static constexpr int healthyUptimeMs     = 10000;
+
+/** Busy-waiting this long first catches most blocks without paying for a context switch. */
+static constexpr juce::int64 spinNanos = 20000;
+
+using Clock = std::chrono::steady_clock;
+
+[[nodiscard]] static juce::int64 getNanosSince(Clock::time_point start) noexcept
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+}
+
+//==============================================================================
+
+CyderProcessBridge::CyderProcessBridge()
+: juce::Thread("Cyder Process Bridge")
+{
+}
+
+CyderProcessBridge::~CyderProcessBridge()
+{
+    stop();
+}
+
+bool CyderProcessBridge::isSupported() noexcept
+{
+    return CyderBridgeChannel::isSupported();
+}
+
+juce::File CyderProcessBridge::findHostExecutable()
+{
+    if (const auto fromEnvironment = juce::SystemStats::getEnvironmentVariable("CYDER_PLUGIN_HOST", {});
+        fromEnvironment.isNotEmpty())
+        return juce::File(fromEnvironment);
+
+    const auto ourBinary = juce::File::getSpecialLocation(juce::File::currentExecutableFile);
+    if (const auto sibling = ourBinary.getSiblingFile(hostExecutableName); sibling.existsAsFile())
+        return sibling;
+
+    // Inside Cyder.vst3/Contents/<architecture>/, look next to the bundle
+    for (auto folder = ourBinary.getParentDirectory(); folder != folder.getParentDirectory(); folder = folder.getParentDirectory())
+        if (folder.hasFileExtension(".vst3"))
+            return folder.getSiblingFile(hostExecutableName);
+
+    return ourBinary.getSiblingFile(hostExecutableName);
+}
+
+bool CyderProcessBridge::start(const juce::File& pluginFileToHost, int numChannelsToUse, double sampleRateToUse, int maxBlockSize)
+{
+    stop();
+
+    if (! isSupported() || sampleRateToUse <= 0.0 || maxBlockSize <= 0)
+        return false;
+
+    jassert(! Utilities::isStagedInMemory(pluginFileToHost)); // its module links to our /proc/self/fd, not the child's
+
+    const juce::ScopedLock lock(processLock);
+
+    channel = CyderBridgeChannel::create(maxBlockSize);
+    if (channel == nullptr)
+        return false;
+
+    pluginFile  = pluginFileToHost;
+    numChannels = juce::jlimit(1, CyderBridgeChannel::maxNumChannels, numChannelsToUse);
+    sampleRate  = sampleRateToUse;
+
+    auto& header = channel->getHeader();
+    header.numChannels = numChannels;
+    header.sampleRate  = sampleRate;
+
+    if (! launchHost())
+    {
+        stopHost();
+        channel.reset();
+        return false;
+    }
+
+    startThread(juce::Thread::Priority::low);
+    return true;
+}
+
+void CyderProcessBridge::stop()
+{
+    // First, so a child told to exit isn't taken for a crash. May have to see a relaunch's command through.
+    stopThread(commandTimeoutMs + exitTimeoutMs);
+
+    const juce::ScopedLock lock(processLock);
+    stopHost();
+    channel.reset();
+}
+
+bool CyderProcessBridge::prepare(double newSampleRate, int maxBlockSize)
+{
+    if (channel == nullptr)
+        return false;
+
+    if (newSampleRate == sampleRate && maxBlockSize <= channel->getHeader().maxBlockSize)
+        return true;
+
+    juce::MemoryBlock state;
+    const bool hasState = getState(state);
+
+    if (! start(pluginFile, numChannels, newSampleRate, maxBlockSize))
+        return false;
+
+    return ! hasState || setState(state);
+}
+
+//==============================================================================
+
+bool CyderProcessBridge::process(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages) noexcept
+{
+    if (channel == nullptr)
+        return false;
+
+    auto& header = channel->getHeader();
+    if (header.hostState.load(std::memory_order_acquire) != static_cast<uint32_t>(CyderBridgeChannel::HostState::ready))
+        return false;
+
+    const auto numSamples = buffer.getNumSamples();
+    const auto sequence   = header.requestSequence.load(std::memory_order_relaxed);
+    if (numSamples > header.maxBlockSize
+        || header.responseSequence.load(std::memory_order_acquire) != sequence) // still on a block it missed
+    {
+        ++numMissedBlocks;
+        return false;
+    }
+
+    // Hand the block over
+    const auto numBufferChannels = std::min(buffer.getNumChannels(), numChannels);
+    const auto numBytes = static_cast<size_t>(numSamples) * sizeof(float);
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        if (ch < numBufferChannels)
+            std::memcpy(channel->getChannel(ch), buffer.getReadPointer(ch), numBytes);
+        else
+            std::memset(channel->getChannel(ch), 0, numBytes);
+    }
+    header.numSamples   = numSamples;
+    header.numMidiBytes = CyderBridgeChannel::writeMidi(midiMessages, channel->getMidiData(), CyderBridgeChannel::maxMidiBytes);
+
+    const auto start = Clock::now();
+    header.requestSequence.store(sequence + 1, std::memory_order_release);
+    CyderBridgeChannel::wake(header.requestSequence);
+
+    // Wait for it until the deadline
+    const auto deadlineNanos = static_cast<juce::int64>(deadlineFraction.load() * numSamples / sampleRate * 1.0e9);
+    bool isDone = false;
+    while (! isDone)
+    {
+        const auto elapsedNanos = getNanosSince(start);
+        if (elapsedNanos >= deadlineNanos)
+            break;
+
+        if (elapsedNanos < spinNanos)
+            isDone = header.responseSequence.load(std::memory_order_acquire) != sequence;
+        else
+            isDone = CyderBridgeChannel::wait(header.responseSequence, sequence, deadlineNanos - elapsedNanos);
+    }
+
+    if (! isDone)
+    {
+        ++numMissedBlocks; // left dry, the child finishes it in its own time
+        return false;
+    }
+
+    // Take it back
+    for (int ch = 0; ch < numBufferChannels; ++ch)
+        std::memcpy(buffer.getWritePointer(ch), channel->getChannel(ch), numBytes);
+
+    midiMessages.clear();
+    CyderBridgeChannel::readMidi(channel->getMidiData(), header.numMidiBytes, midiMessages);
+    return true;
+}
+
+//==============================================================================
+
+bool CyderProcessBridge::getState(juce::MemoryBlock& destData)
+{
+    // Down, or being relaunched: saved as it was last known, without waiting on a relaunch in progress
+    const auto getLastKnownState = [&]
+    {
+        const juce::ScopedLock stateScopedLock(stateLock);
+        if (hasKnownState)
+            destData = lastKnownState;
+        return hasKnownState;
+    };
+
+    if (! isRunning())
+        return getLastKnownState();
+
+    const juce::ScopedLock lock(processLock);
+
+    if (! runCommand(CyderBridgeChannel::Command::getState))
+        return getLastKnownState();
+
+    const auto& header = channel->getHeader();
+    destData.replaceAll(channel->getPayloadData(), static_cast<size_t>(header.payloadBytes));
+
+    const juce::ScopedLock stateScopedLock(stateLock);
+    lastKnownState = destData; // what the child is relaunched with, should it crash
+    hasKnownState = true;
+    return true;
+}
+
+bool CyderProcessBridge::setState(const juce::MemoryBlock& state)
+{
+    if (state.getSize() > static_cast<size_t>(CyderBridgeChannel::maxPayloadBytes))
+        return false;
+
+    const juce::ScopedLock lock(processLock);
+
+    {
+        const juce::ScopedLock stateScopedLock(stateLock);
+        lastKnownState = state;
+        hasKnownState = true;
+    }
+
+    if (channel == nullptr)
+        return false;
+
+    std::memcpy(channel->getPayloadData(), state.getData(), state.getSize());
+    channel->getHeader().payloadBytes = state.getSize();
+    return runCommand(CyderBridgeChannel::Command::setState);
+}
+
+bool CyderProcessBridge::isRunning() const noexcept
+{
+    return channel != nullptr
+        && channel->getHeader().hostState.load() == static_cast<uint32_t>(CyderBridgeChannel::HostState::ready);
+}
+
+int CyderProcessBridge::getHostProcessId() const noexcept
+{
+    return isRunning() ? channel->getHeader().hostProcessId.load() : 0;
+}
+
+int CyderProcessBridge::getNumChannels() const noexcept
+{
+    return numChannels;
+}
+
+int CyderProcessBridge::getLatencySamples() const noexcept
+{
+    return channel != nullptr ? channel->getHeader().latencySamples.load() : 0;
+}
+
+double CyderProcessBridge::getTailLengthSeconds() const noexcept
+{
+    return channel != nullptr ? channel->getHeader().tailLengthSeconds.load() : 0.0;
+}
+
+void CyderProcessBridge::setDeadlineFraction(double fractionOfBlock) noexcept
+{
+    jassert(fractionOfBlock > 0.0);
+    deadlineFraction = std::max(0.0, fractionOfBlock);
+}
+
+int CyderProcessBridge::getNumMissedBlocks() const noexcept
+{
+    return numMissedBlocks.load();
+}
+
+int CyderProcessBridge::getNumCrashes() const noexcept
+{
+    return numCrashes.load();
+}
+
+//==============================================================================
+
+bool CyderProcessBridge::launchHost()
+{
+    jassert(channel != nullptr);
+
+    auto& header = channel->getHeader();
+    header.hostState.store(static_cast<uint32_t>(CyderBridgeChannel::HostState::starting));
+    header.shouldExit.store(0);
+
+    const auto hostExecutable = findHostExecutable();
+    if (! hostExecutable.existsAsFile())
+    {
+        juce::Logger::writeToLog("Cyder_PluginHost not found: " + hostExecutable.getFullPathName());
+        return false;
+    }
+
+    juce::StringArray arguments { hostExecutable.getFullPathName(),
+                                  "--channel=" + channel->getName(),
+                                  "--plugin=" + pluginFile.getFullPathName() };
+   #if JUCE_LINUX
+    arguments.add("--parent=" + juce::String(static_cast<int>(getpid())));
+   #endif
+
+    // Only stop() replaces it, and that stops the watchdog first, so it can be waited on outside the lock.
+    // Kept even if it fails to start, so the watchdog tries again.
+    auto newChild = std::make_unique<juce::ChildProcess>();
+    auto& launchedChild = *newChild;
+    {
+        const juce::ScopedLock lock(processLock);
+        child = std::move(newChild);
+    }
+
+    if (! launchedChild.start(arguments, /*streamFlags*/ 0)) // output isn't read, so it must not fill a pipe
+        return false;
+
+    // Wait until it has loaded the plugin, or given up
+    const auto start = Clock::now();
+    const auto starting = static_cast<uint32_t>(CyderBridgeChannel::HostState::starting);
+    while (header.hostState.load() == starting)
+    {
+        const auto remainingNanos = juce::int64(launchTimeoutMs) * 1000000 - getNanosSince(start);
+        if (remainingNanos <= 0 || ! launchedChild.isRunning())
+            break;
+        if (juce::Thread::getCurrentThread() == this && threadShouldExit())
+            break; // relaunching from the watchdog, which is being stopped
+
+        CyderBridgeChannel::wait(header.hostState, starting, std::min(remainingNanos, juce::int64(watchdogPollMs) * 1000000));
+    }
+
+    return header.hostState.load() == static_cast<uint32_t>(CyderBridgeChannel::HostState::ready);
+}
+
+void CyderProcessBridge::stopHost()
+{
+    if (child == nullptr)
+        return;
+
+    if (channel != nullptr)
+    {
+        auto& header = channel->getHeader();
+        header.shouldExit.store(1);
+        CyderBridgeChannel::wake(header.requestSequence);
+    }
+
+    if (! child->waitForProcessToFinish(exitTimeoutMs))
+        child->kill();
+
+    child.reset();
+}
+
+bool CyderProcessBridge::runCommand(CyderBridgeChannel::Command command)
+{
+    if (channel == nullptr || child == nullptr)
+        return false;
+
+    auto& header = channel->getHeader();
+    if (header.hostState.load() != static_cast<uint32_t>(CyderBridgeChannel::HostState::ready))
+        return false;
+
+    header.command = static_cast<uint32_t>(command);
+    header.commandSucceeded = 0;
+
+    const auto sequence = header.commandSequence.load() + 1;
+    header.commandSequence.store(sequence, std::memory_order_release);
+    CyderBridgeChannel::wake(header.requestSequence); // the child sleeps on the audio, see Cyder_PluginHost
+
+    const auto start = Clock::now();
+    while (header.commandDoneSequence.load(std::memory_order_acquire) != sequence)
+    {
+        const auto remainingNanos = juce::int64(commandTimeoutMs) * 1000000 - getNanosSince(start);
+        if (remainingNanos <= 0 || ! child->isRunning())
+            return false;
+
+        CyderBridgeChannel::wait(header.commandDoneSequence, sequence - 1, std::min(remainingNanos, juce::int64(watchdogPollMs) * 1000000));
+    }
+
+    return header.commandSucceeded != 0;
+}
+
+void CyderProcessBridge::run()
+{
+    auto restartDelayMs = minRestartDelayMs;
+    auto launchedAt = Clock::now();
+
+    while (! threadShouldExit())
+    {
+        wait(watchdogPollMs);
+
+        {
+            const juce::ScopedLock lock(processLock);
+            if (child == nullptr || child->isRunning())
+                continue;
+
+            // Audio passes through dry until the child is back
+            channel->getHeader().hostState.store(static_cast<uint32_t>(CyderBridgeChannel::HostState::failed));
+        }
+
+        ++numCrashes;
+        if (onCrashed != nullptr)
+            onCrashed();
+
+        // A child that keeps crashing right away is relaunched less and less eagerly
+        if (getNanosSince(launchedAt) > juce::int64(healthyUptimeMs) * 1000000)
+            restartDelayMs = minRestartDelayMs;
+        wait(restartDelayMs);
+        restartDelayMs = std::min(restartDelayMs * 2, maxRestartDelayMs);
+
+        if (threadShouldExit())
+            break;
+
+        {
+            const juce::ScopedLock lock(processLock);
+            child.reset();
+        }
+
+        // Not under processLock, so a host saving in the meantime gets the last known state right away
+        const bool relaunched = launchHost();
+        launchedAt = Clock::now();
+
+        if (relaunched)
+        {
+            const juce::ScopedLock lock(processLock);
+
+            bool shouldRestoreState = false;
+            {
+                const juce::ScopedLock stateScopedLock(stateLock);
+                shouldRestoreState = hasKnownState;
+                if (shouldRestoreState)
+                {
+                    std::memcpy(channel->getPayloadData(), lastKnownState.getData(), lastKnownState.getSize());
+                    channel->getHeader().payloadBytes = lastKnownState.getSize();
+                }
+            }
+
+            if (shouldRestoreState)
+                runCommand(CyderBridgeChannel::Command::setState);
+        }
+
+        if (relaunched && onRestarted != nullptr)
+            onRestarted();
+    }
+}
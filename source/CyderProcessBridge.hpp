@@ -0,0 +1,147 @@
+/******************************************************************************
+ * Cyder — Hot-Reloading Audio Plugin Wrapper
+ *
+ * @file     CyderProcessBridge.hpp
+ *
+ * @author   Adam Shield
+ * @date     2026-10-19
+ *
+ * @copyright (c) 2026 Adam Shield
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * See LICENSE.txt for license terms.
+ ******************************************************************************/
+
+#pragma once
+
+#include <juce_audio_basics/juce_audio_basics.h>
+#include <juce_core/juce_core.h>
+
+#include "CyderBridgeChannel.hpp"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+
+//==============================================================================
+
+/**
+ Hosts the wrapped plugin in a child process (Cyder_PluginHost), so a build that
+ crashes takes down only the child, never the DAW.
+
+ Each block is handed over through CyderBridgeChannel and processed while our
+ own processBlock() waits for it, so hosting out of process adds no latency.
+ A block the child doesn't return in time (a fraction of the block's duration)
+ is left as it was, i.e. dry. If the child dies, audio passes through dry until
+ it has been relaunched, with the last state it was given or saved.
+
+ The child hosts the plugin without an editor, and with its main buses only.
+
+ Linux only for now, see isSupported().
+ */
+class CyderProcessBridge final : private juce::Thread
+{
+public:
+    /** How much of a block's duration the child has to process it, before the block is left dry. */
+    static constexpr double defaultDeadlineFraction = 0.7;
+
+    CyderProcessBridge();
+    /** Stops the child. */
+    ~CyderProcessBridge() override;
+
+    /** */
+    [[nodiscard]] static bool isSupported() noexcept;
+    /**
+     @returns Cyder_PluginHost: as set by the CYDER_PLUGIN_HOST environment variable, otherwise
+     next to our own binary, otherwise next to the bundle our binary is in
+     */
+    [[nodiscard]] static juce::File findHostExecutable();
+
+    /**
+     Launches the child, which loads and prepares the plugin, and waits until it is ready.
+     The plugin must be one the child can open, so not staged in memory (see Utilities::copyPluginToTemp()).
+     Message thread only, never while the audio thread may be processing through this.
+     @returns false if it failed to launch or to load the plugin
+     */
+    bool start(const juce::File& pluginFile, int numChannels, double sampleRate, int maxBlockSize);
+    /** Stops the child, and the watchdog relaunching it. */
+    void stop();
+
+    /**
+     Relaunches the child for new playback settings, keeping the plugin's state.
+     Does nothing if they haven't changed. Never while the audio thread may be processing through this.
+     */
+    bool prepare(double sampleRate, int maxBlockSize);
+
+    /**
+     Has the child process the block, waiting for it until the deadline. Never allocates or locks,
+     unless MIDI coming back overflows midiMessages. Audio thread.
+     @returns false if the block was left as it was: the child missed the deadline, is busy with a
+     block it missed, or is being relaunched
+     */
+    bool process(juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages) noexcept;
+
+    /**
+     Asks the child for the plugin's state. If it isn't up or doesn't answer, e.g. while it is being
+     relaunched, this is the state it was last given or saved with, without waiting for the relaunch.
+     @returns false if there is no such state either
+     */
+    bool getState(juce::MemoryBlock& destData);
+    /** Hands the plugin a state, which is also what it is relaunched with after a crash. */
+    bool setState(const juce::MemoryBlock& state);
+
+    /** @returns true while the child is up and processing */
+    [[nodiscard]] bool isRunning() const noexcept;
+    /** @returns the child's process ID, or 0 if it isn't running */
+    [[nodiscard]] int getHostProcessId() const noexcept;
+    /** */
+    [[nodiscard]] int getNumChannels() const noexcept;
+    /** @returns latency reported by the plugin in the child */
+    [[nodiscard]] int getLatencySamples() const noexcept;
+    /** @returns tail reported by the plugin in the child */
+    [[nodiscard]] double getTailLengthSeconds() const noexcept;
+
+    /** */
+    void setDeadlineFraction(double fractionOfBlock) noexcept;
+    /** */
+    [[nodiscard]] int getNumMissedBlocks() const noexcept;
+    /** */
+    [[nodiscard]] int getNumCrashes() const noexcept;
+
+    /** Called from the watchdog thread whenever the child has died. */
+    std::function<void()> onCrashed;
+    /** Called from the watchdog thread once a child that died has been relaunched. */
+    std::function<void()> onRestarted;
+
+private:
+    std::unique_ptr<CyderBridgeChannel> channel;
+    juce::File pluginFile;
+    int numChannels = 0;
+    double sampleRate = 0.0;
+
+    juce::CriticalSection processLock; // child process and commands, never taken by the audio thread
+    std::unique_ptr<juce::ChildProcess> child;
+
+    juce::CriticalSection stateLock; // never held while waiting on the child, taken after processLock if both are
+    juce::MemoryBlock lastKnownState;
+    bool hasKnownState = false;
+
+    std::atomic<double> deadlineFraction { defaultDeadlineFraction };
+    std::atomic<int> numMissedBlocks { 0 };
+    std::atomic<int> numCrashes { 0 };
+
+    /**
+     Launches the child with the current settings, and waits until it is ready.
+     Only takes processLock to hand the child over, so the watchdog relaunches without blocking commands.
+     */
+    bool launchHost();
+    /** Stops the child, if any. Under processLock. */
+    void stopHost();
+    /** Runs a command in the child, and waits until it is done. Under processLock. */
+    bool runCommand(CyderBridgeChannel::Command command);
+
+    /** Watchdog, relaunching the child whenever it dies. */
+    void run() override;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CyderProcessBridge)
+};
@@ -0,0 +1,157 @@
+/******************************************************************************
+ * Cyder — Hot-Reloading Audio Plugin Wrapper
+ *
+ * @file     CyderRealtimeGuard.cpp
+ *
+ * @author   Adam Shield
+ * @date     2026-10-19
+ *
+ * @copyright (c) 2026 Adam Shield
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * See LICENSE.txt for license terms.
+ ******************************************************************************/
+
+#include "CyderRealtimeGuard.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+#if CYDER_ENABLE_REALTIME_GUARD && JUCE_LINUX
+#include <dlfcn.h>
+#include <execinfo.h>
+#endif
+
+//==============================================================================
+
+CyderRealtimeGuard::CyderRealtimeGuard()
+{
+   #if CYDER_ENABLE_REALTIME_GUARD && JUCE_LINUX
+    // Only present if Cyder_RealtimeGuard was preloaded into the host
+    beginBlockHook = reinterpret_cast<CyderRtGuardBeginBlockFn>(dlsym(RTLD_DEFAULT, CYDER_RT_GUARD_BEGIN_BLOCK_NAME));
+    setScopeHook   = reinterpret_cast<CyderRtGuardSetScopeFn>  (dlsym(RTLD_DEFAULT, CYDER_RT_GUARD_SET_SCOPE_NAME));
+    endBlockHook   = reinterpret_cast<CyderRtGuardEndBlockFn>  (dlsym(RTLD_DEFAULT, CYDER_RT_GUARD_END_BLOCK_NAME));
+
+    if (! isActive())
+    {
+        beginBlockHook = nullptr;
+        setScopeHook   = nullptr;
+        endBlockHook   = nullptr;
+    }
+   #endif
+}
+
+bool CyderRealtimeGuard::isActive() const noexcept
+{
+    return beginBlockHook != nullptr
+        && setScopeHook   != nullptr
+        && endBlockHook   != nullptr;
+}
+
+void CyderRealtimeGuard::beginBlock() noexcept
+{
+    if (beginBlockHook != nullptr)
+        beginBlockHook();
+}
+
+void CyderRealtimeGuard::setScope(Scope scope) noexcept
+{
+    if (setScopeHook != nullptr)
+        setScopeHook(static_cast<int>(scope));
+}
+
+void CyderRealtimeGuard::endBlock() noexcept
+{
+    endBlock(currentBlock);
+}
+
+void CyderRealtimeGuard::endBlock(CyderRtGuardBlock& block) noexcept
+{
+    if (endBlockHook == nullptr)
+        return;
+
+    endBlockHook(&block);
+
+    for (size_t i = 0; i < scopes.size(); ++i)
+    {
+        const auto& counts = block.scopes[i];
+        if (counts.allocations + counts.deallocations + counts.locks == 0)
+            continue;
+
+        auto& scope = scopes[i];
+        scope.allocations   += counts.allocations;
+        scope.deallocations += counts.deallocations;
+        scope.locks         += counts.locks;
+        ++scope.blocksWithViolations;
+
+        // Keep the backtrace unless the message thread has yet to collect the previous one, or another thread is keeping its own
+        auto expected = static_cast<int>(ScopeState::noBacktrace);
+        if (counts.numFrames > 0
+            && scope.backtraceState.compare_exchange_strong(expected, ScopeState::writingBacktrace, std::memory_order_acquire))
+        {
+            scope.numFrames = counts.numFrames;
+            std::memcpy(scope.frames, counts.frames, sizeof(void*) * static_cast<size_t>(counts.numFrames));
+            scope.backtraceState.store(ScopeState::pendingBacktrace, std::memory_order_release);
+        }
+    }
+}
+
+CyderRealtimeGuard::Report CyderRealtimeGuard::getReport(Scope scopeToReport)
+{
+    auto& scope = scopes[static_cast<size_t>(scopeToReport)];
+
+    if (scope.backtraceState.load(std::memory_order_acquire) == ScopeState::pendingBacktrace)
+    {
+       #if CYDER_ENABLE_REALTIME_GUARD && JUCE_LINUX
+        if (auto** symbols = backtrace_symbols(scope.frames, scope.numFrames))
+        {
+            juce::StringArray lines;
+            for (int i = 0; i < scope.numFrames; ++i)
+                lines.add(symbols[i]);
+            std::free(symbols);
+            scope.lastBacktrace = lines.joinIntoString("\n");
+        }
+       #endif
+        scope.backtraceState.store(ScopeState::noBacktrace, std::memory_order_release);
+    }
+
+    Report report;
+    report.allocations          = scope.allocations.load();
+    report.deallocations        = scope.deallocations.load();
+    report.locks                = scope.locks.load();
+    report.blocksWithViolations = scope.blocksWithViolations.load();
+    report.lastBacktrace        = scope.lastBacktrace;
+    return report;
+}
+
+juce::uint64 CyderRealtimeGuard::getTotalViolations() const noexcept
+{
+    juce::uint64 total = 0;
+    for (const auto& scope : scopes)
+        total += scope.allocations.load() + scope.deallocations.load() + scope.locks.load();
+    return total;
+}
+
+juce::String CyderRealtimeGuard::getSummary()
+{
+    auto describe = [](const Report& report)
+    {
+        return juce::String(report.allocations) + " alloc, "
+             + juce::String(report.deallocations) + " free, "
+             + juce::String(report.locks) + " lock";
+    };
+
+    return "Audio thread - plugin: " + describe(getReport(Scope::wrappedPlugin))
+         + " | Cyder: " + describe(getReport(Scope::wrapper));
+}
+
+void CyderRealtimeGuard::reset() noexcept
+{
+    for (auto& scope : scopes)
+    {
+        scope.allocations          = 0;
+        scope.deallocations        = 0;
+        scope.locks                = 0;
+        scope.blocksWithViolations = 0;
+    }
+}
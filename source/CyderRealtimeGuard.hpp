@@ -0,0 +1,128 @@
+/******************************************************************************
+ * Cyder — Hot-Reloading Audio Plugin Wrapper
+ *
+ * @file     CyderRealtimeGuard.hpp
+ *
+ * @author   Adam Shield
+ * @date     2026-10-19
+ *
+ * @copyright (c) 2026 Adam Shield
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * See LICENSE.txt for license terms.
+ ******************************************************************************/
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include "CyderRealtimeGuardHooks.h"
+
+#include <array>
+#include <atomic>
+
+//==============================================================================
+
+/**
+ Counts allocations, deallocations and mutex locks made on the audio thread,
+ separately for Cyder's own code and for the plugins it wraps.
+
+ Only active in builds configured with CYDER_ENABLE_REALTIME_GUARD, running
+ with the Cyder_RealtimeGuard library preloaded (Linux only). Otherwise every
+ call is a cheap no-op and all counts stay at zero.
+ */
+class CyderRealtimeGuard final
+{
+public:
+    enum class Scope
+    {
+        wrapper       = CYDER_RT_GUARD_SCOPE_WRAPPER,
+        wrappedPlugin = CYDER_RT_GUARD_SCOPE_WRAPPED,
+    };
+
+    struct Report
+    {
+        juce::uint64 allocations = 0;
+        juce::uint64 deallocations = 0;
+        juce::uint64 locks = 0;
+        juce::uint64 blocksWithViolations = 0;
+        juce::String lastBacktrace; // of the first violation in the most recent offending block
+
+        [[nodiscard]] juce::uint64 getTotal() const noexcept { return allocations + deallocations + locks; }
+    };
+
+    CyderRealtimeGuard();
+    ~CyderRealtimeGuard() = default;
+
+    /** @returns true if violations are actually being detected */
+    [[nodiscard]] bool isActive() const noexcept;
+
+    //==============================================================================
+
+    /** Audio thread. Marks the calling thread as real-time, counting against the wrapper. */
+    void beginBlock() noexcept;
+    /** Audio thread. Counts further violations against the given scope. */
+    void setScope(Scope scope) noexcept;
+    /** Audio thread. Stops counting and collects this block's violations. */
+    void endBlock() noexcept;
+    /**
+     Same for any other real-time thread working on the audio thread's behalf, e.g. a worker processing
+     plugins in parallel. Several may call this at once, each with storage of its own for the block.
+     */
+    void endBlock(CyderRtGuardBlock& block) noexcept;
+
+    /** Calls beginBlock() and endBlock() for the lifetime of the object. */
+    struct ScopedBlock
+    {
+        explicit ScopedBlock(CyderRealtimeGuard& _guard) noexcept : guard(_guard) { guard.beginBlock(); }
+        ~ScopedBlock() noexcept { guard.endBlock(); }
+        CyderRealtimeGuard& guard;
+        JUCE_DECLARE_NON_COPYABLE (ScopedBlock)
+    };
+
+    /** Counts violations against the given scope, then goes back to the wrapper. */
+    struct ScopedScope
+    {
+        ScopedScope(CyderRealtimeGuard& _guard, Scope scope) noexcept : guard(_guard) { guard.setScope(scope); }
+        ~ScopedScope() noexcept { guard.setScope(Scope::wrapper); }
+        CyderRealtimeGuard& guard;
+        JUCE_DECLARE_NON_COPYABLE (ScopedScope)
+    };
+
+    //==============================================================================
+
+    /** Message thread. Totals since construction or the last reset(). */
+    [[nodiscard]] Report getReport(Scope scope);
+    /** Sum of every violation in every scope. Thread safe. */
+    [[nodiscard]] juce::uint64 getTotalViolations() const noexcept;
+    /** Message thread. One line describing the violations of both scopes, for display. */
+    [[nodiscard]] juce::String getSummary();
+    /** */
+    void reset() noexcept;
+
+private:
+    CyderRtGuardBeginBlockFn beginBlockHook = nullptr;
+    CyderRtGuardSetScopeFn   setScopeHook   = nullptr;
+    CyderRtGuardEndBlockFn   endBlockHook   = nullptr;
+
+    struct ScopeState
+    {
+        std::atomic<juce::uint64> allocations { 0 };
+        std::atomic<juce::uint64> deallocations { 0 };
+        std::atomic<juce::uint64> locks { 0 };
+        std::atomic<juce::uint64> blocksWithViolations { 0 };
+
+        // Handed from a real-time thread to the message thread, which symbolises it
+        enum BacktraceState { noBacktrace, writingBacktrace, pendingBacktrace };
+        std::atomic<int> backtraceState { noBacktrace };
+        int numFrames = 0;
+        void* frames[CYDER_RT_GUARD_MAX_FRAMES] = {};
+        juce::String lastBacktrace;
+    };
+
+    std::array<ScopeState, CYDER_RT_GUARD_NUM_SCOPES> scopes;
+
+    CyderRtGuardBlock currentBlock {}; // audio thread only, kept here to stay off the stack
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CyderRealtimeGuard)
+};
@@ -0,0 +1,66 @@
+/******************************************************************************
+ * Cyder — Hot-Reloading Audio Plugin Wrapper
+ *
+ * @file     CyderRealtimeGuardHooks.h
+ *
+ * @author   Adam Shield
+ * @date     2026-10-19
+ *
+ * @copyright (c) 2026 Adam Shield
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * See LICENSE.txt for license terms.
+ ******************************************************************************/
+
+/*
+ C interface between Cyder and the Cyder_RealtimeGuard preload library, which
+ interposes malloc/free/operator new and pthread_mutex_lock.
+ Cyder looks these functions up at runtime, so it runs unchanged without the library.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CYDER_RT_GUARD_MAX_FRAMES 24
+
+enum
+{
+    CYDER_RT_GUARD_SCOPE_WRAPPER = 0,
+    CYDER_RT_GUARD_SCOPE_WRAPPED = 1,
+    CYDER_RT_GUARD_NUM_SCOPES    = 2
+};
+
+/** Violations attributed to one scope during one block. */
+typedef struct
+{
+    uint64_t allocations;
+    uint64_t deallocations;
+    uint64_t locks;
+    int      numFrames;                          /* backtrace of the first violation */
+    void*    frames[CYDER_RT_GUARD_MAX_FRAMES];
+} CyderRtGuardScopeCounts;
+
+typedef struct
+{
+    CyderRtGuardScopeCounts scopes[CYDER_RT_GUARD_NUM_SCOPES];
+} CyderRtGuardBlock;
+
+/** Marks the calling thread as real-time and starts counting, in the wrapper scope. */
+typedef void (*CyderRtGuardBeginBlockFn)(void);
+/** Attributes further violations on the calling thread to the given scope. */
+typedef void (*CyderRtGuardSetScopeFn)(int scope);
+/** Stops counting on the calling thread and hands back everything counted since begin. */
+typedef void (*CyderRtGuardEndBlockFn)(CyderRtGuardBlock* result);
+
+#define CYDER_RT_GUARD_BEGIN_BLOCK_NAME "cyder_rt_guard_begin_block"
+#define CYDER_RT_GUARD_SET_SCOPE_NAME   "cyder_rt_guard_set_scope"
+#define CYDER_RT_GUARD_END_BLOCK_NAME   "cyder_rt_guard_end_block"
+
+#ifdef __cplusplus
+}
+#endif
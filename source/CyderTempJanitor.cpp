@@ -0,0 +1,552 @@
+/******************************************************************************
+ * Cyder — Hot-Reloading Audio Plugin Wrapper
+ *
+ * @file     CyderTempJanitor.cpp
+ *
+ * @author   Adam Shield
+ * @date     2026-10-19
+ *
+ * @copyright (c) 2026 Adam Shield
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * See LICENSE.txt for license terms.
+ ******************************************************************************/
+
+#include "CyderTempJanitor.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#if JUCE_WINDOWS
+#define WIN32_LEAN_AND_MEAN // speed up compilation, prevent namespace pollution
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if JUCE_LINUX
+#include <sys/statvfs.h>
+#endif
+
+//==============================================================================
+
+static constexpr const char* sessionPrefix    = "session_";
+static constexpr const char* sessionLockName  = "session.lock";
+
+static constexpr int idlePollMs               = 5000;
+static constexpr int retryPollMs              = 250;
+static constexpr int maxRetryDelayMs          = 30000;
+static constexpr int maxDeletionAttempts      = 40;
+static constexpr int orphanSweepIntervalMs    = 10 * 60 * 1000;
+/** How often the running total of usage is checked against what is actually there, e.g. other processes' copies. */
+static constexpr int usageMeasureIntervalMs   = 60 * 1000;
+
+/** Young enough that its owner may still be creating its lock file. */
+static const juce::RelativeTime minimumOrphanAge  = juce::RelativeTime::minutes(1.0);
+/** Copies made by Cyder versions from before session folders existed. */
+static const juce::RelativeTime minimumLegacyAge  = juce::RelativeTime::days(1.0);
+
+[[nodiscard]] static juce::int64 getCurrentProcessId() noexcept
+{
+   #if JUCE_WINDOWS
+    return static_cast<juce::int64>(GetCurrentProcessId());
+   #else
+    return static_cast<juce::int64>(getpid());
+   #endif
+}
+
+/**
+ Process ID plus a token drawn once per process, so a process reusing the ID of one that crashed
+ never mistakes the crashed one's session for its own. Kept for the whole process, so a janitor
+ created again later picks its own session back up.
+ */
+[[nodiscard]] static juce::String getSessionName()
+{
+    static const auto token = juce::Uuid().toString().substring(0, 12);
+    return sessionPrefix + juce::String(getCurrentProcessId()) + "_" + token;
+}
+
+//==============================================================================
+
+/** An exclusive lock on a file, released by the OS if the process dies. */
+class CyderTempJanitor::SessionLockFile final
+{
+public:
+    explicit SessionLockFile(const juce::File& file)
+    {
+       #if JUCE_WINDOWS
+        // No sharing: nobody else can open it while we hold it
+        handle = CreateFileW(file.getFullPathName().toWideCharPointer(),
+                             GENERIC_READ | GENERIC_WRITE,
+                             0,
+                             nullptr,
+                             OPEN_ALWAYS,
+                             FILE_ATTRIBUTE_NORMAL,
+                             nullptr);
+       #else
+        fd = open(file.getFullPathName().toRawUTF8(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd >= 0 && flock(fd, LOCK_EX | LOCK_NB) != 0)
+        {
+            close(fd);
+            fd = -1;
+        }
+       #endif
+    }
+
+    ~SessionLockFile()
+    {
+       #if JUCE_WINDOWS
+        if (handle != INVALID_HANDLE_VALUE)
+            CloseHandle(handle);
+       #else
+        if (fd >= 0)
+            close(fd); // releases the lock
+       #endif
+    }
+
+    [[nodiscard]] bool isLocked() const noexcept
+    {
+       #if JUCE_WINDOWS
+        return handle != INVALID_HANDLE_VALUE;
+       #else
+        return fd >= 0;
+       #endif
+    }
+
+private:
+   #if JUCE_WINDOWS
+    HANDLE handle = INVALID_HANDLE_VALUE;
+   #else
+    int fd = -1;
+   #endif
+
+    JUCE_DECLARE_NON_COPYABLE (SessionLockFile)
+};
+
+//==============================================================================
+
+CyderTempJanitor::CyderTempJanitor()
+: juce::Thread("Cyder Temp Janitor")
+{
+    startThread(juce::Thread::Priority::background);
+}
+
+CyderTempJanitor::~CyderTempJanitor()
+{
+    signalThreadShouldExit();
+    notify();
+    stopThread(5000);
+
+    // Last chance, anything still held by the OS is cleaned up as an orphan by a later session
+    processPendingDeletions(/*ignoreBackoff*/ true);
+    closeFileDescriptors();
+
+    const juce::ScopedLock lock(sessionsLock);
+    for (auto& session : sessions)
+    {
+        session.lock.reset();
+
+        // Leave the session in place if it still holds copies, e.g. a janitor is created again later in this process
+        if (session.directory.getNumberOfChildFiles(juce::File::findFilesAndDirectories) <= 1)
+            session.directory.deleteRecursively();
+    }
+    sessions.clear();
+}
+
+juce::File CyderTempJanitor::getTempRoot()
+{
+    return juce::File::getSpecialLocation(juce::File::tempDirectory).getChildFile("CyderPlugins");
+}
+
+juce::File CyderTempJanitor::getRamRoot()
+{
+   #if JUCE_LINUX
+    return juce::File("/dev/shm/CyderPlugins");
+   #else
+    return {};
+   #endif
+}
+
+juce::Array<juce::File> CyderTempJanitor::getStagingRoots()
+{
+    juce::Array<juce::File> roots { getTempRoot() };
+    if (const auto ramRoot = getRamRoot(); ramRoot != juce::File() && ramRoot.getParentDirectory().isDirectory())
+        roots.add(ramRoot);
+    return roots;
+}
+
+void CyderTempJanitor::setStagingLocation(StagingLocation location) noexcept
+{
+    stagingLocation = location;
+}
+
+CyderTempJanitor::StagingLocation CyderTempJanitor::getStagingLocation() const noexcept
+{
+    return stagingLocation.load();
+}
+
+bool CyderTempJanitor::canStageInRam(juce::int64 numBytes)
+{
+   #if JUCE_LINUX
+    const auto ramVolume = getRamRoot().getParentDirectory();
+    if (! ramVolume.isDirectory() || ! ramVolume.hasWriteAccess())
+        return false;
+
+    struct statvfs info;
+    if (statvfs(ramVolume.getFullPathName().toRawUTF8(), &info) != 0)
+        return false;
+
+    // Modules cannot be mapped executable from a noexec mount
+    if ((info.f_flag & ST_NOEXEC) != 0)
+        return false;
+
+    const auto freeBytes = static_cast<juce::int64>(info.f_bavail) * static_cast<juce::int64>(info.f_frsize);
+    return freeBytes - numBytes >= minimumFreeRamBytes;
+   #else
+    juce::ignoreUnused(numBytes);
+    return false;
+   #endif
+}
+
+juce::File CyderTempJanitor::getStagingDirectory(juce::int64 numBytes) noexcept(false)
+{
+    const auto quota = getQuotaBytes();
+    if (getUsageBytes() + numBytes > quota)
+    {
+        // Reclaim whatever can be reclaimed right now rather than fail the reload, then measure what is really left
+        processPendingDeletions(/*ignoreBackoff*/ true);
+        deleteOrphanedSessions();
+        measureUsage();
+
+        if (getUsageBytes() + numBytes > quota)
+        {
+            notify(); // keep retrying in the background, to make room for next time
+
+            throw std::runtime_error(("Cyder's temp folders are over their quota of "
+                                      + juce::File::descriptionOfSizeInBytes(quota)).toStdString());
+        }
+    }
+
+    // Counted from now on, rather than walking every staging root for each copy
+    usageBytes += numBytes;
+
+    const bool useRam = getStagingLocation() != StagingLocation::disk && canStageInRam(numBytes);
+    return getSessionDirectory(useRam ? getRamRoot() : getTempRoot());
+}
+
+juce::Array<juce::File> CyderTempJanitor::getSessionDirectories() const
+{
+    const juce::ScopedLock lock(sessionsLock);
+
+    juce::Array<juce::File> directories;
+    for (const auto& session : sessions)
+        directories.add(session.directory);
+    return directories;
+}
+
+void CyderTempJanitor::retire(const juce::File& pluginCopy)
+{
+    if (pluginCopy == juce::File())
+        return;
+
+    if (! pluginCopy.exists())
+    {
+        closeFileDescriptors(pluginCopy);
+        return;
+    }
+
+    {
+        const juce::ScopedLock lock(pendingLock);
+        pendingDeletions.push_back({ pluginCopy, 0, 0 });
+    }
+
+    notify();
+}
+
+void CyderTempJanitor::adoptFileDescriptor(const juce::File& stagedCopy, int fileDescriptor)
+{
+    juce::int64 numBytes = 0;
+   #if ! JUCE_WINDOWS
+    struct stat info;
+    if (fstat(fileDescriptor, &info) == 0)
+        numBytes = static_cast<juce::int64>(info.st_size);
+   #endif
+
+    const juce::ScopedLock lock(pendingLock);
+    adoptedFileDescriptors.push_back({ stagedCopy, fileDescriptor, numBytes });
+}
+
+juce::int64 CyderTempJanitor::getStagedSize(const juce::File& stagedCopy) const
+{
+    auto total = getSizeOnDisk(stagedCopy);
+
+    const juce::ScopedLock lock(pendingLock);
+    for (const auto& adopted : adoptedFileDescriptors)
+        if (adopted.stagedCopy == stagedCopy)
+            total += adopted.numBytes;
+    return total;
+}
+
+bool CyderTempJanitor::waitUntilIdle(int timeoutMs)
+{
+    const auto giveUpTime = juce::Time::getMillisecondCounter() + static_cast<juce::uint32>(timeoutMs);
+
+    while (getNumPendingDeletions() > 0)
+    {
+        if (juce::Time::getMillisecondCounter() >= giveUpTime)
+            return false;
+
+        notify();
+        juce::Thread::sleep(10);
+    }
+
+    return true;
+}
+
+int CyderTempJanitor::deleteOrphanedSessions()
+{
+    const juce::ScopedLock lock(sweepLock);
+
+    const auto now = juce::Time::getCurrentTime();
+    int numDeleted = 0;
+
+    for (const auto& root : getStagingRoots())
+    {
+        for (const auto& entry : juce::RangedDirectoryIterator(root, false, "*", juce::File::findFilesAndDirectories))
+        {
+            const auto file = entry.getFile();
+            if (isOwnSession(file))
+                continue;
+
+            if (! file.getFileName().startsWith(sessionPrefix))
+            {
+                // Left over from before sessions existed
+                if (now - file.getLastModificationTime() > minimumLegacyAge && file.deleteRecursively())
+                    ++numDeleted;
+                continue;
+            }
+
+            const auto lockFile = file.getChildFile(sessionLockName);
+            if (! lockFile.existsAsFile())
+            {
+                // Either crashed while being created, or is being created right now
+                if (now - file.getLastModificationTime() > minimumOrphanAge && file.deleteRecursively())
+                    ++numDeleted;
+                continue;
+            }
+
+            bool ownerIsDead = false;
+            {
+                const SessionLockFile probe(lockFile);
+                ownerIsDead = probe.isLocked();
+            } // release it again before deleting
+
+            if (ownerIsDead && file.deleteRecursively())
+                ++numDeleted;
+        }
+    }
+
+    return numDeleted;
+}
+
+void CyderTempJanitor::setQuotaBytes(juce::int64 numBytes) noexcept
+{
+    quotaBytes = std::max(juce::int64(0), numBytes);
+    notify();
+}
+
+juce::int64 CyderTempJanitor::getQuotaBytes() const noexcept
+{
+    return quotaBytes.load();
+}
+
+juce::int64 CyderTempJanitor::getUsageBytes() const noexcept
+{
+    return usageBytes.load();
+}
+
+int CyderTempJanitor::getNumPendingDeletions() const
+{
+    const juce::ScopedLock lock(pendingLock);
+    return static_cast<int>(pendingDeletions.size()) + numDeletionsInProgress.load();
+}
+
+juce::int64 CyderTempJanitor::getSizeOnDisk(const juce::File& file)
+{
+    if (! file.isDirectory())
+        return file.getSize();
+
+    // Staged copies may link back to the original bundle, which takes up no space of ours
+    juce::int64 total = 0;
+    for (const auto& entry : juce::RangedDirectoryIterator(file, true, "*", juce::File::findFiles, juce::File::FollowSymlinks::no))
+        if (! entry.getFile().isSymbolicLink())
+            total += entry.getFileSize();
+    return total;
+}
+
+void CyderTempJanitor::run()
+{
+    deleteOrphanedSessions();
+    measureUsage();
+    auto nextSweepMs   = juce::Time::getMillisecondCounter() + static_cast<juce::uint32>(orphanSweepIntervalMs);
+    auto nextMeasureMs = juce::Time::getMillisecondCounter() + static_cast<juce::uint32>(usageMeasureIntervalMs);
+
+    while (! threadShouldExit())
+    {
+        processPendingDeletions(/*ignoreBackoff*/ false);
+
+        if (juce::Time::getMillisecondCounter() >= nextMeasureMs)
+        {
+            measureUsage();
+            nextMeasureMs = juce::Time::getMillisecondCounter() + static_cast<juce::uint32>(usageMeasureIntervalMs);
+        }
+
+        const bool isOverQuota = getUsageBytes() > getQuotaBytes();
+
+        if (isOverQuota || juce::Time::getMillisecondCounter() >= nextSweepMs)
+        {
+            deleteOrphanedSessions();
+            if (isOverQuota)
+                processPendingDeletions(/*ignoreBackoff*/ true);
+
+            measureUsage();
+            nextSweepMs = juce::Time::getMillisecondCounter() + static_cast<juce::uint32>(orphanSweepIntervalMs);
+        }
+
+        wait(getNumPendingDeletions() > 0 ? retryPollMs : idlePollMs);
+    }
+}
+
+juce::File CyderTempJanitor::getSessionDirectory(const juce::File& root)
+{
+    const juce::ScopedLock lock(sessionsLock);
+
+    for (const auto& session : sessions)
+        if (session.directory.isAChildOf(root))
+            return session.directory;
+
+    Session session;
+    session.directory = root.getChildFile(getSessionName());
+
+    [[maybe_unused]] const auto result = session.directory.createDirectory();
+    jassert(result.wasOk());
+
+    session.lock = std::make_unique<SessionLockFile>(session.directory.getChildFile(sessionLockName));
+    jassert(session.lock->isLocked());
+
+    sessions.push_back(std::move(session));
+    return sessions.back().directory;
+}
+
+bool CyderTempJanitor::isOwnSession(const juce::File& directory) const
+{
+    const juce::ScopedLock lock(sessionsLock);
+
+    return std::any_of(sessions.begin(), sessions.end(),
+                       [&](const Session& session) { return session.directory == directory; });
+}
+
+void CyderTempJanitor::processPendingDeletions(bool ignoreBackoff)
+{
+    const auto now = juce::Time::getMillisecondCounter();
+
+    // Take what is due, so deleting never holds up retire()
+    std::vector<PendingDeletion> due;
+    {
+        const juce::ScopedLock lock(pendingLock);
+        auto notDue = std::stable_partition(pendingDeletions.begin(), pendingDeletions.end(),
+                                            [&](const PendingDeletion& pending)
+                                            {
+                                                return ! ignoreBackoff && pending.nextAttemptMs > now;
+                                            });
+        due.assign(std::make_move_iterator(notDue), std::make_move_iterator(pendingDeletions.end()));
+        pendingDeletions.erase(notDue, pendingDeletions.end());
+        numDeletionsInProgress += static_cast<int>(due.size()); // the janitor thread and an over-quota copy may both be deleting
+    }
+
+    std::vector<PendingDeletion> failed;
+    for (auto& pending : due)
+    {
+        const auto numBytes = getSizeOnDisk(pending.file);
+        if (! pending.file.exists() || pending.file.deleteRecursively())
+        {
+            subtractUsage(numBytes);
+            closeFileDescriptors(pending.file);
+            continue;
+        }
+
+        // Usually the OS still has the module open, try again later
+        if (++pending.numAttempts >= maxDeletionAttempts)
+        {
+            juce::Logger::writeToLog("Cyder: giving up on deleting " + pending.file.getFullPathName());
+            continue;
+        }
+
+        const auto delayMs = std::min(maxRetryDelayMs, retryPollMs << std::min(pending.numAttempts, 7));
+        pending.nextAttemptMs = juce::Time::getMillisecondCounter() + static_cast<juce::uint32>(delayMs);
+        failed.push_back(std::move(pending));
+    }
+
+    {
+        const juce::ScopedLock lock(pendingLock);
+        pendingDeletions.insert(pendingDeletions.end(),
+                                std::make_move_iterator(failed.begin()),
+                                std::make_move_iterator(failed.end()));
+        numDeletionsInProgress -= static_cast<int>(due.size());
+    }
+}
+
+void CyderTempJanitor::closeFileDescriptors(const juce::File& stagedCopy)
+{
+    std::vector<int> toClose;
+    juce::int64 numBytesClosed = 0;
+    {
+        const juce::ScopedLock lock(pendingLock);
+        auto closing = std::stable_partition(adoptedFileDescriptors.begin(), adoptedFileDescriptors.end(),
+                                             [&](const AdoptedFileDescriptor& adopted)
+                                             {
+                                                 return stagedCopy != juce::File() && adopted.stagedCopy != stagedCopy;
+                                             });
+        for (auto it = closing; it != adoptedFileDescriptors.end(); ++it)
+        {
+            toClose.push_back(it->fileDescriptor);
+            numBytesClosed += it->numBytes;
+        }
+        adoptedFileDescriptors.erase(closing, adoptedFileDescriptors.end());
+    }
+
+    subtractUsage(numBytesClosed);
+
+   #if ! JUCE_WINDOWS
+    for (auto fileDescriptor : toClose)
+        close(fileDescriptor);
+   #else
+    jassert(toClose.empty()); // nothing hands us descriptors on Windows
+   #endif
+}
+
+void CyderTempJanitor::subtractUsage(juce::int64 numBytes) noexcept
+{
+    auto usage = usageBytes.load();
+    while (! usageBytes.compare_exchange_weak(usage, std::max(juce::int64(0), usage - numBytes))) {}
+}
+
+void CyderTempJanitor::measureUsage()
+{
+    juce::int64 total = 0;
+    for (const auto& root : getStagingRoots())
+        total += getSizeOnDisk(root);
+
+    // Memfds, only linked to from the staging roots
+    {
+        const juce::ScopedLock lock(pendingLock);
+        for (const auto& adopted : adoptedFileDescriptors)
+            total += adopted.numBytes;
+    }
+
+    usageBytes = total;
+}
@@ -0,0 +1,189 @@
+/******************************************************************************
+ * Cyder — Hot-Reloading Audio Plugin Wrapper
+ *
+ * @file     CyderTempJanitor.hpp
+ *
+ * @author   Adam Shield
+ * @date     2026-10-19
+ *
+ * @copyright (c) 2026 Adam Shield
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * See LICENSE.txt for license terms.
+ ******************************************************************************/
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+//==============================================================================
+
+/**
+ Owns Cyder's temp folders, where plugins are copied before being loaded.
+
+ Copies are staged in RAM (/dev/shm on Linux) when there is room for them, falling
+ back to the temp directory on disk otherwise, or as chosen with setStagingLocation().
+
+ Every process copies into its own session folder, marked with a lock file held
+ for as long as the process lives. Retired copies are deleted on a low priority
+ thread, retrying with backoff while the OS still holds on to them. Session folders
+ whose lock is no longer held, i.e. left behind by a crash, are deleted as orphans.
+ A disk quota stops new copies from piling up without bound.
+
+ Share one instance per process with juce::SharedResourcePointer<CyderTempJanitor>.
+ */
+class CyderTempJanitor final : private juce::Thread
+{
+public:
+    static constexpr juce::int64 defaultQuotaBytes = juce::int64(4) * 1024 * 1024 * 1024;
+    /** RAM staging is skipped if a copy would leave less than this free. */
+    static constexpr juce::int64 minimumFreeRamBytes = juce::int64(512) * 1024 * 1024;
+
+    enum class StagingLocation
+    {
+        memory, // Linux only: module in a memfd, everything else linked from the original bundle, else as ram
+        ram,    // falls back to disk if this platform has no RAM root, or it is short of space
+        disk
+    };
+
+   #if JUCE_LINUX
+    static constexpr StagingLocation defaultStagingLocation = StagingLocation::memory;
+   #else
+    static constexpr StagingLocation defaultStagingLocation = StagingLocation::ram;
+   #endif
+
+    CyderTempJanitor();
+    /** Makes a last attempt at deleting everything retired, then releases the sessions. */
+    ~CyderTempJanitor() override;
+
+    /** @returns folder on disk holding every Cyder process's session folder */
+    [[nodiscard]] static juce::File getTempRoot();
+    /** @returns RAM-backed folder holding session folders, or an invalid File if this platform has none */
+    [[nodiscard]] static juce::File getRamRoot();
+    /** @returns every root this platform may stage copies in */
+    [[nodiscard]] static juce::Array<juce::File> getStagingRoots();
+
+    //==============================================================================
+
+    /** */
+    void setStagingLocation(StagingLocation location) noexcept;
+    /** */
+    [[nodiscard]] StagingLocation getStagingLocation() const noexcept;
+
+    /** @returns true if a copy of the given size could be staged in RAM right now */
+    [[nodiscard]] static bool canStageInRam(juce::int64 numBytes);
+
+    /**
+     Picks where a new copy of the given size should go, creating this process's session there if need be.
+     The size counts towards the quota from then on, until the copy is deleted.
+     If the copy would go over the quota, first deletes whatever retired copies and orphaned sessions it can.
+     @returns session folder to copy into
+     @throws std::runtime_error if the copy would still take the temp folders over their quota
+     */
+    [[nodiscard]] juce::File getStagingDirectory(juce::int64 numBytes) noexcept(false);
+
+    /** @returns every session folder this process has created so far */
+    [[nodiscard]] juce::Array<juce::File> getSessionDirectories() const;
+
+    /** Queues a copy for deletion on the janitor thread. Never blocks. Any thread. */
+    void retire(const juce::File& pluginCopy);
+
+    /**
+     Takes ownership of a file descriptor backing a staged copy, closed once the copy has been deleted.
+     Its size when adopted counts towards the quota until then, since a memfd takes up RAM that no folder shows.
+     Stage it with getStagingDirectory() first, which already counts it.
+     */
+    void adoptFileDescriptor(const juce::File& stagedCopy, int fileDescriptor);
+
+    /** @returns size of a staged copy, including any file descriptor backing it */
+    [[nodiscard]] juce::int64 getStagedSize(const juce::File& stagedCopy) const;
+
+    /**
+     Blocks until nothing is waiting to be deleted, or the timeout passes.
+     @returns true if everything retired has been deleted
+     */
+    bool waitUntilIdle(int timeoutMs);
+
+    /**
+     Deletes session folders left behind by processes that are no longer running.
+     Done periodically on the janitor thread. Any thread.
+     @returns number of orphaned sessions deleted
+     */
+    int deleteOrphanedSessions();
+
+    //==============================================================================
+
+    /** Sets the most the temp folders, across all sessions, may take up. */
+    void setQuotaBytes(juce::int64 numBytes) noexcept;
+    /** */
+    [[nodiscard]] juce::int64 getQuotaBytes() const noexcept;
+    /**
+     @returns size of the temp folders, and of the file descriptors backing copies in them. A running total
+     of copies made and deleted, checked against what is actually there every minute on the janitor thread.
+     */
+    [[nodiscard]] juce::int64 getUsageBytes() const noexcept;
+    /** */
+    [[nodiscard]] int getNumPendingDeletions() const;
+
+    /** @returns total size of a file, or of everything inside a folder */
+    [[nodiscard]] static juce::int64 getSizeOnDisk(const juce::File& file);
+
+private:
+    class SessionLockFile;
+
+    struct PendingDeletion
+    {
+        juce::File file;
+        int numAttempts = 0;
+        juce::uint32 nextAttemptMs = 0;
+    };
+
+    struct AdoptedFileDescriptor
+    {
+        juce::File stagedCopy;
+        int fileDescriptor = -1;
+        juce::int64 numBytes = 0;
+    };
+
+    struct Session
+    {
+        juce::File directory;
+        std::unique_ptr<SessionLockFile> lock;
+    };
+
+    juce::CriticalSection sessionsLock;
+    std::vector<Session> sessions; // at most one per staging root, created on first use
+
+    std::atomic<StagingLocation> stagingLocation { defaultStagingLocation };
+
+    juce::CriticalSection pendingLock;
+    std::vector<PendingDeletion> pendingDeletions;
+    std::vector<AdoptedFileDescriptor> adoptedFileDescriptors; // guarded by pendingLock
+    std::atomic<int> numDeletionsInProgress { 0 };
+
+    juce::CriticalSection sweepLock;
+
+    std::atomic<juce::int64> quotaBytes { defaultQuotaBytes };
+    std::atomic<juce::int64> usageBytes { 0 };
+
+    void run() override;
+
+    /** @returns this process's session folder inside the given root, created if need be */
+    juce::File getSessionDirectory(const juce::File& root);
+    [[nodiscard]] bool isOwnSession(const juce::File& directory) const;
+
+    /** @param ignoreBackoff retry everything now rather than when each is next due */
+    void processPendingDeletions(bool ignoreBackoff);
+    /** Closes the descriptors backing the given copy, or every one if none is given. */
+    void closeFileDescriptors(const juce::File& stagedCopy = {});
+    void subtractUsage(juce::int64 numBytes) noexcept;
+    /** Walks every staging root, so only off the message thread, or when over quota. */
+    void measureUsage();
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CyderTempJanitor)
+};
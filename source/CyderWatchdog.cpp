@@ -0,0 +1,329 @@
+/******************************************************************************
+ * Cyder — Hot-Reloading Audio Plugin Wrapper
+ *
+ * @file     CyderWatchdog.cpp
+ *
+ * @author   Adam Shield
+ * @date     2026-10-19
+ *
+ * @copyright (c) 2026 Adam Shield
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * See LICENSE.txt for license terms.
+ ******************************************************************************/
+
+#include "CyderWatchdog.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#if JUCE_LINUX
+#include <cerrno>
+#include <csignal>
+#include <cstdlib>
+#include <execinfo.h>
+#include <mutex>
+#include <pthread.h>
+#endif
+
+//==============================================================================
+
+/**
+ A call is looked at every half of its overrun threshold, so a hang is noticed well within one more
+ threshold's worth of time. Never finer than the OS is likely to wake us anyway.
+ */
+static constexpr int minPollIntervalMs = 5;
+static constexpr int maxPollIntervalMs = 100;
+static constexpr int stackSampleTimeoutMs = 100;
+
+#if JUCE_LINUX
+/** Frames of the signal handler and the kernel's trampoline, left out of every sample. */
+static constexpr int numHandlerFrames = 2;
+
+/** Filled in by the audio thread's signal handler, one sample at a time in the whole process. */
+struct StackSample
+{
+    std::atomic<bool> isTaken { false };
+    int numFrames = 0;
+    void* frames[CyderWatchdog::maxStackFrames + numHandlerFrames] = {};
+};
+
+static StackSample stackSample;
+static juce::CriticalSection stackSampleLock; // held by whichever watchdog is sampling
+
+/** Real-time signals are left alone by hosts and plugins, unlike SIGPROF and friends. */
+static int getStackSampleSignal() noexcept
+{
+    return SIGRTMIN + 4;
+}
+
+static void takeStackSample(int) noexcept
+{
+    const auto savedErrno = errno;
+    stackSample.numFrames = backtrace(stackSample.frames, CyderWatchdog::maxStackFrames + numHandlerFrames);
+    stackSample.isTaken.store(true, std::memory_order_release);
+    errno = savedErrno;
+}
+
+static void installStackSampleHandler()
+{
+    static std::once_flag installed;
+    std::call_once(installed, []
+    {
+        // backtrace() loads libgcc the first time, which is no business for a signal handler
+        void* frames[1];
+        backtrace(frames, 1);
+
+        struct sigaction action {};
+        action.sa_handler = takeStackSample;
+        action.sa_flags = SA_RESTART; // the plugin's system calls carry on as if nothing happened
+        sigemptyset(&action.sa_mask);
+        sigaction(getStackSampleSignal(), &action, nullptr);
+    });
+}
+#endif
+
+//==============================================================================
+
+juce::String CyderWatchdog::Event::describe() const
+{
+    auto description = hung ? "hung for " + juce::String(callMs, 1) + " ms"
+                            : juce::String(numOverruns) + " overruns in a row, last " + juce::String(callMs, 1) + " ms";
+    return description + " (block " + juce::String(budgetMs, 1) + " ms)";
+}
+
+//==============================================================================
+
+CyderWatchdog::CyderWatchdog()
+: juce::Thread("Cyder Watchdog")
+{
+   #if JUCE_LINUX
+    installStackSampleHandler();
+   #endif
+}
+
+CyderWatchdog::~CyderWatchdog()
+{
+    stop();
+}
+
+bool CyderWatchdog::canSampleStacks() noexcept
+{
+   #if JUCE_LINUX
+    return true;
+   #else
+    return false;
+   #endif
+}
+
+void CyderWatchdog::prepare(double sampleRateToUse, int maxBlockSize)
+{
+    sampleRate.store(sampleRateToUse);
+    blockDurationMs.store(sampleRateToUse > 0.0 ? 1000.0 * maxBlockSize / sampleRateToUse : 0.0);
+
+    if (! isThreadRunning())
+    {
+        tripPending.store(false); // overruns while stopped are nobody's business
+        startThread(juce::Thread::Priority::high); // to notice a hang while the audio thread hogs the CPU
+    }
+    else
+        notify(); // poll at the new interval right away
+}
+
+void CyderWatchdog::stop()
+{
+    stopThread(stackSampleTimeoutMs + 1000);
+}
+
+//==============================================================================
+
+void CyderWatchdog::beginProcess(int numSamples) noexcept
+{
+    const auto rate = sampleRate.load(std::memory_order_relaxed);
+    const auto budgetTicks = rate > 0.0 ? static_cast<juce::int64>(numSamples / rate * static_cast<double>(juce::Time::getHighResolutionTicksPerSecond()))
+                                        : juce::int64(0);
+
+    audioThreadId.store(juce::Thread::getCurrentThreadId(), std::memory_order_relaxed);
+    callBudgetTicks.store(budgetTicks, std::memory_order_relaxed);
+    callSequence.fetch_add(1, std::memory_order_relaxed);
+    callStartTicks.store(std::max(juce::int64(1), juce::Time::getHighResolutionTicks()), std::memory_order_release);
+}
+
+void CyderWatchdog::endProcess() noexcept
+{
+    const auto startTicks = callStartTicks.exchange(0, std::memory_order_acq_rel);
+    const auto budgetTicks = callBudgetTicks.load(std::memory_order_relaxed);
+    if (startTicks == 0 || budgetTicks <= 0)
+        return; // not prepared, nothing to measure against
+
+    // Already tripped us while it was running
+    if (hungSequence.load(std::memory_order_acquire) == callSequence.load(std::memory_order_relaxed))
+    {
+        numOverrunsInARow = 0;
+        return;
+    }
+
+    const auto callTicks = juce::Time::getHighResolutionTicks() - startTicks;
+    if (static_cast<double>(callTicks) <= overrunFactor.load(std::memory_order_relaxed) * static_cast<double>(budgetTicks))
+    {
+        numOverrunsInARow = 0;
+        return;
+    }
+
+    if (++numOverrunsInARow < numOverrunsToTrip.load(std::memory_order_relaxed) || tripPending.load(std::memory_order_acquire))
+        return;
+
+    // Handed to our thread, which does the rest
+    trippingCallTicks.store(callTicks, std::memory_order_relaxed);
+    trippingBudgetTicks.store(budgetTicks, std::memory_order_relaxed);
+    trippingNumOverruns.store(numOverrunsInARow, std::memory_order_relaxed);
+    tripPending.store(true, std::memory_order_release);
+    numOverrunsInARow = 0;
+}
+
+//==============================================================================
+
+void CyderWatchdog::setOverrunFactor(double factor) noexcept
+{
+    overrunFactor.store(std::max(1.0, factor));
+}
+
+double CyderWatchdog::getOverrunFactor() const noexcept
+{
+    return overrunFactor.load();
+}
+
+void CyderWatchdog::setNumOverrunsToTrip(int numOverruns) noexcept
+{
+    numOverrunsToTrip.store(std::max(1, numOverruns));
+}
+
+int CyderWatchdog::getNumOverrunsToTrip() const noexcept
+{
+    return numOverrunsToTrip.load();
+}
+
+int CyderWatchdog::getNumTrips() const noexcept
+{
+    return numTrips.load();
+}
+
+std::optional<CyderWatchdog::Event> CyderWatchdog::getLastEvent() const
+{
+    const juce::ScopedLock lock(eventLock);
+    return lastEvent;
+}
+
+//==============================================================================
+
+void CyderWatchdog::run()
+{
+    while (! threadShouldExit())
+    {
+        wait(getPollIntervalMs());
+
+        // A call in progress: sample it once it overruns, trip once it has hung
+        const auto startTicks = callStartTicks.load(std::memory_order_acquire);
+        const auto sequence = callSequence.load(std::memory_order_relaxed);
+        const auto budgetTicks = callBudgetTicks.load(std::memory_order_relaxed);
+        if (startTicks != 0 && budgetTicks > 0)
+        {
+            const auto callTicks = juce::Time::getHighResolutionTicks() - startTicks;
+            const auto overrunTicks = overrunFactor.load() * static_cast<double>(budgetTicks);
+
+            if (static_cast<double>(callTicks) > overrunTicks && sequence != sampledSequence)
+            {
+                auto stack = sampleStack(audioThreadId.load(std::memory_order_relaxed));
+                if (callSequence.load(std::memory_order_relaxed) == sequence && callStartTicks.load() == startTicks)
+                {
+                    // Still in the same call, so it shows where that call spent its time
+                    lastStackSample = std::move(stack);
+                    sampledSequence = sequence;
+                }
+            }
+
+            const auto numOverruns = numOverrunsToTrip.load();
+            if (static_cast<double>(callTicks) > overrunTicks * numOverruns
+                && sequence != hungSequence.load()
+                && callStartTicks.load() == startTicks)
+            {
+                hungSequence.store(sequence, std::memory_order_release);
+                trip(/*hung*/ true, numOverruns, callTicks, budgetTicks);
+            }
+        }
+
+        if (tripPending.load(std::memory_order_acquire))
+        {
+            trip(/*hung*/ false,
+                 trippingNumOverruns.load(std::memory_order_relaxed),
+                 trippingCallTicks.load(std::memory_order_relaxed),
+                 trippingBudgetTicks.load(std::memory_order_relaxed));
+            tripPending.store(false, std::memory_order_release);
+        }
+    }
+}
+
+int CyderWatchdog::getPollIntervalMs() const noexcept
+{
+    const auto overrunMs = overrunFactor.load() * blockDurationMs.load();
+    return juce::jlimit(minPollIntervalMs, maxPollIntervalMs, juce::roundToInt(overrunMs / 2.0));
+}
+
+void CyderWatchdog::trip(bool hung, int numOverruns, juce::int64 callTicks, juce::int64 budgetTicks)
+{
+    const auto ticksPerMs = static_cast<double>(juce::Time::getHighResolutionTicksPerSecond()) / 1000.0;
+
+    Event event;
+    event.time        = juce::Time::getCurrentTime();
+    event.hung        = hung;
+    event.numOverruns = numOverruns;
+    event.callMs      = static_cast<double>(callTicks) / ticksPerMs;
+    event.budgetMs    = static_cast<double>(budgetTicks) / ticksPerMs;
+
+    // Only a sample from one of the calls that tripped us
+    const auto sequence = callSequence.load();
+    if (sampledSequence != 0 && sequence - sampledSequence <= static_cast<juce::uint32>(numOverruns))
+        event.stackSample = lastStackSample;
+
+    {
+        const juce::ScopedLock lock(eventLock);
+        lastEvent = event;
+    }
+
+    if (onTripped)
+        onTripped(event);
+
+    ++numTrips; // only once it has been acted on
+}
+
+juce::String CyderWatchdog::sampleStack(juce::Thread::ThreadID threadId)
+{
+   #if JUCE_LINUX
+    if (threadId == nullptr)
+        return {};
+
+    const juce::ScopedLock lock(stackSampleLock);
+    stackSample.isTaken.store(false, std::memory_order_release);
+    if (pthread_kill(reinterpret_cast<pthread_t>(threadId), getStackSampleSignal()) != 0)
+        return {};
+
+    for (int waitedMs = 0; ! stackSample.isTaken.load(std::memory_order_acquire); ++waitedMs)
+    {
+        if (waitedMs >= stackSampleTimeoutMs)
+            return {}; // the thread may be gone, or have the signal blocked
+        juce::Thread::sleep(1);
+    }
+
+    juce::StringArray lines;
+    if (auto** symbols = backtrace_symbols(stackSample.frames, stackSample.numFrames))
+    {
+        for (int i = numHandlerFrames; i < stackSample.numFrames; ++i)
+            lines.add(symbols[i]);
+        std::free(symbols);
+    }
+    return lines.joinIntoString("\n");
+   #else
+    juce::ignoreUnused(threadId);
+    return {};
+   #endif
+}
@@ -0,0 +1,152 @@
+/******************************************************************************
+ * Cyder — Hot-Reloading Audio Plugin Wrapper
+ *
+ * @file     CyderWatchdog.hpp
+ *
+ * @author   Adam Shield
+ * @date     2026-10-19
+ *
+ * @copyright (c) 2026 Adam Shield
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * See LICENSE.txt for license terms.
+ ******************************************************************************/
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <atomic>
+#include <functional>
+#include <optional>
+
+//==============================================================================
+
+/**
+ Watches the audio thread's calls into the wrapped plugin, from a thread of its own,
+ for a plugin that overruns or hangs.
+
+ The audio thread marks each call with beginProcess() and endProcess(), which only
+ read the clock and store atomics. A call overruns when it takes longer than the
+ overrun factor times the block's duration. The watchdog trips after as many overruns
+ in a row as set, or as soon as a single call has been running for that many overruns'
+ worth of time without returning (a hung plugin), and calls onTripped.
+
+ On Linux, the audio thread's stack is sampled (with a signal) while a call overruns,
+ so the event tripping the watchdog tells where the plugin was spending its time.
+ */
+class CyderWatchdog final : private juce::Thread
+{
+public:
+    /** How many times a block's duration a call may take before it counts as an overrun. */
+    static constexpr double defaultOverrunFactor = 2.0;
+    /** How many overruns in a row trip the watchdog. */
+    static constexpr int defaultNumOverrunsToTrip = 3;
+    /** Deepest stack sampled. */
+    static constexpr int maxStackFrames = 48;
+
+    /** What tripped the watchdog. */
+    struct Event
+    {
+        juce::Time time;
+        bool hung = false;        // a single call ran for too long, and hadn't returned yet
+        int numOverruns = 0;      // in a row, including the one that tripped it
+        double callMs = 0.0;      // how long the call tripping it took (so far, if hung)
+        double budgetMs = 0.0;    // duration of that call's block
+        juce::String stackSample; // of the audio thread during an overrun, if one was caught
+
+        /** @returns one line, for display and the log */
+        [[nodiscard]] juce::String describe() const;
+    };
+
+    CyderWatchdog();
+    /** Stops watching. */
+    ~CyderWatchdog() override;
+
+    /** @returns false where the audio thread's stack can't be sampled */
+    [[nodiscard]] static bool canSampleStacks() noexcept;
+
+    /**
+     Starts watching, if not already, with block durations measured at the given sample rate.
+     The watchdog's thread polls at an interval derived from the duration of the largest block.
+     Only while there is a plugin to watch, since that thread runs at high priority: stop() it otherwise.
+     */
+    void prepare(double sampleRate, int maxBlockSize);
+    /** Stops watching until the next prepare(), after which onTripped is no longer called. */
+    void stop();
+
+    //==============================================================================
+
+    /** Audio thread. Marks the start of a call into the wrapped plugin. Never allocates or locks. */
+    void beginProcess(int numSamples) noexcept;
+    /** Audio thread. Marks the end of the call, counting it as an overrun if it took too long. */
+    void endProcess() noexcept;
+
+    /** Calls beginProcess() and endProcess() for the lifetime of the object. */
+    struct ScopedProcess
+    {
+        ScopedProcess(CyderWatchdog& _watchdog, int numSamples) noexcept : watchdog(_watchdog) { watchdog.beginProcess(numSamples); }
+        ~ScopedProcess() noexcept { watchdog.endProcess(); }
+        CyderWatchdog& watchdog;
+        JUCE_DECLARE_NON_COPYABLE (ScopedProcess)
+    };
+
+    //==============================================================================
+
+    /** Any thread. Clamped to at least 1. */
+    void setOverrunFactor(double factor) noexcept;
+    /** */
+    [[nodiscard]] double getOverrunFactor() const noexcept;
+    /** Any thread. Clamped to at least 1. */
+    void setNumOverrunsToTrip(int numOverruns) noexcept;
+    /** */
+    [[nodiscard]] int getNumOverrunsToTrip() const noexcept;
+
+    /** @returns how many times the watchdog has tripped since construction, counting each once onTripped has returned */
+    [[nodiscard]] int getNumTrips() const noexcept;
+    /** @returns what tripped the watchdog most recently, if it ever has */
+    [[nodiscard]] std::optional<Event> getLastEvent() const;
+
+    /**
+     Called on the watchdog's thread each time it trips. Overruns in a row are counted
+     from zero again afterwards, and a hung call trips it only once.
+     Set before prepare().
+     */
+    std::function<void(const Event&)> onTripped;
+
+private:
+    std::atomic<double> sampleRate { 0.0 };
+    std::atomic<double> blockDurationMs { 0.0 };
+    std::atomic<double> overrunFactor { defaultOverrunFactor };
+    std::atomic<int> numOverrunsToTrip { defaultNumOverrunsToTrip };
+
+    // Written by the audio thread, read by ours
+    std::atomic<juce::Thread::ThreadID> audioThreadId { nullptr };
+    std::atomic<juce::int64> callStartTicks { 0 }; // 0 while not in a call
+    std::atomic<juce::int64> callBudgetTicks { 0 };
+    std::atomic<juce::uint32> callSequence { 0 };
+    std::atomic<bool> tripPending { false };
+    std::atomic<juce::int64> trippingCallTicks { 0 };
+    std::atomic<juce::int64> trippingBudgetTicks { 0 };
+    std::atomic<int> trippingNumOverruns { 0 };
+    int numOverrunsInARow = 0; // audio thread only
+
+    std::atomic<juce::uint32> hungSequence { 0 }; // call that tripped us by hanging, not counted again once it returns
+
+    // Our thread only
+    juce::uint32 sampledSequence = 0;
+    juce::String lastStackSample; // of the most recent overrun
+
+    std::atomic<int> numTrips { 0 };
+    mutable juce::CriticalSection eventLock;
+    std::optional<Event> lastEvent;
+
+    void run() override;
+    [[nodiscard]] int getPollIntervalMs() const noexcept;
+    void trip(bool hung, int numOverruns, juce::int64 callTicks, juce::int64 budgetTicks);
+
+    /** @returns symbolised stack of the given thread, or an empty string if it couldn't be sampled */
+    [[nodiscard]] static juce::String sampleStack(juce::Thread::ThreadID threadId);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CyderWatchdog)
+};
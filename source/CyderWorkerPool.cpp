@@ -0,0 +1,264 @@
+/******************************************************************************
+ * Cyder — Hot-Reloading Audio Plugin Wrapper
+ *
+ * @file     CyderWorkerPool.cpp
+ *
+ * @author   Adam Shield
+ * @date     2026-10-19
+ *
+ * @copyright (c) 2026 Adam Shield
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * See LICENSE.txt for license terms.
+ ******************************************************************************/
+
+#include "CyderWorkerPool.hpp"
+
+#include "CyderAssert.hpp"
+#include "CyderRealtimeGuard.hpp"
+
+#include <algorithm>
+#include <memory>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h> // for _mm_pause()
+#endif
+
+//==============================================================================
+
+/** Tells the CPU we are busy-waiting, without giving up our time slice. */
+static inline void cpuRelax() noexcept
+{
+   #if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    _mm_pause();
+   #elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+   #endif
+}
+
+static constexpr uint64_t taskIndexMask  = 0xffff;
+static constexpr int      endShift       = 16;
+static constexpr int      batchShift     = 32;
+
+[[nodiscard]] static inline uint32_t getBatch(uint64_t state) noexcept    { return static_cast<uint32_t>(state >> batchShift); }
+[[nodiscard]] static inline int getEndTaskIndex(uint64_t state) noexcept  { return static_cast<int>((state >> endShift) & taskIndexMask); }
+[[nodiscard]] static inline int getNextTaskIndex(uint64_t state) noexcept { return static_cast<int>(state & taskIndexMask); }
+
+[[nodiscard]] static inline uint64_t makeTaskRange(uint32_t batch, int begin, int end) noexcept
+{
+    return (static_cast<uint64_t>(batch) << batchShift)
+         | (static_cast<uint64_t>(end) << endShift)
+         | static_cast<uint64_t>(begin);
+}
+
+//==============================================================================
+
+class CyderWorkerPool::Worker final : public juce::Thread
+{
+public:
+    Worker(CyderWorkerPool& _pool, int index)
+    : juce::Thread("Cyder Worker " + juce::String(index))
+    , pool(_pool)
+    , threadIndex(index + 1) // after the calling thread
+    {
+        // Pin each worker to its own core, leaving the first one to the host
+        const auto numCpus = juce::SystemStats::getNumCpus();
+        if (numCpus > 1)
+            setAffinityMask(static_cast<juce::uint32>(1u << ((index + 1) % std::min(numCpus, 32))));
+
+        if (! startRealtimeThread(juce::Thread::RealtimeOptions{}))
+            startThread(juce::Thread::Priority::highest);
+    }
+
+    ~Worker() override
+    {
+        signalThreadShouldExit();
+        wakeUpEvent.signal();
+        stopThread(1000);
+    }
+
+    void wakeIfSleeping() noexcept
+    {
+        if (sleeping.load(std::memory_order_seq_cst))
+            wakeUpEvent.signal();
+    }
+
+private:
+    CyderWorkerPool& pool;
+    const int threadIndex;
+    CyderRtGuardBlock realtimeGuardBlock {}; // this thread's own, since workers end their blocks at the same time
+    juce::WaitableEvent wakeUpEvent;
+    std::atomic<bool> sleeping { false };
+
+    /** Roughly tens of microseconds of spinning before going to sleep between batches. */
+    static constexpr int maxSpinsBeforeSleeping = 2000;
+    static constexpr int sleepTimeoutMs = 100;
+
+    void run() override
+    {
+        auto lastBatch = pool.currentBatch.load(std::memory_order_acquire);
+        int numSpins = 0;
+
+        while (! threadShouldExit())
+        {
+            const auto batch = pool.currentBatch.load(std::memory_order_acquire);
+            if (batch != lastBatch)
+            {
+                lastBatch = batch;
+                runBatch(batch);
+                numSpins = 0;
+                continue;
+            }
+
+            if (++numSpins < maxSpinsBeforeSleeping)
+            {
+                cpuRelax();
+                continue;
+            }
+
+            // Announce we are going to sleep, then check once more so a new batch can't slip past us
+            sleeping.store(true, std::memory_order_seq_cst);
+            if (pool.currentBatch.load(std::memory_order_seq_cst) == lastBatch && ! threadShouldExit())
+                wakeUpEvent.wait(sleepTimeoutMs);
+            sleeping.store(false, std::memory_order_relaxed);
+            numSpins = 0;
+        }
+    }
+
+    void runBatch(uint32_t batch) noexcept
+    {
+        if (pool.realtimeGuard == nullptr)
+        {
+            pool.runPendingTasks(threadIndex, batch);
+            return;
+        }
+
+        // Real-time for as long as it works on the audio thread's behalf
+        pool.realtimeGuard->beginBlock();
+        pool.runPendingTasks(threadIndex, batch);
+        pool.realtimeGuard->endBlock(realtimeGuardBlock);
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Worker)
+};
+
+//==============================================================================
+
+CyderWorkerPool::CyderWorkerPool(int numWorkers, CyderRealtimeGuard* _realtimeGuard)
+: realtimeGuard(_realtimeGuard)
+{
+    numWorkers = std::max(0, numWorkers);
+    taskRanges = std::make_unique<TaskRange[]>(static_cast<size_t>(numWorkers + 1));
+
+    workers.reserve(static_cast<size_t>(numWorkers));
+    for (int i = 0; i < numWorkers; ++i)
+        workers.push_back(std::make_unique<Worker>(*this, i));
+}
+
+CyderWorkerPool::~CyderWorkerPool()
+{
+    workers.clear(); // stops each thread
+}
+
+void CyderWorkerPool::run(int numTasks, const Task& task) noexcept
+{
+    if (numTasks <= 0)
+        return;
+
+    CYDER_ASSERT(numTasks <= maxNumTasksPerBatch);
+    numTasks = std::min(numTasks, maxNumTasksPerBatch);
+
+    currentTask.store(&task, std::memory_order_relaxed);
+    numTasksRemaining.store(numTasks, std::memory_order_relaxed);
+
+    // Give every thread an even share up front, so none has to contend for its first task
+    const auto batch = currentBatch.load(std::memory_order_relaxed) + 1;
+    const auto numThreads = getNumThreads();
+    for (int i = 0; i < numThreads; ++i)
+    {
+        const auto range = makeTaskRange(batch, numTasks * i / numThreads, numTasks * (i + 1) / numThreads);
+        taskRanges[static_cast<size_t>(i)].state.store(range, std::memory_order_relaxed);
+    }
+
+    // Publishing the new batch also publishes the task and ranges above to whoever claims from it
+    currentBatch.store(batch, std::memory_order_seq_cst);
+
+    for (auto& worker : workers)
+        worker->wakeIfSleeping();
+
+    // Help out rather than wait for workers to be scheduled
+    runPendingTasks(/*threadIndex*/ 0, batch);
+
+    // Join: only tasks already claimed by a worker can still be running
+    while (numTasksRemaining.load(std::memory_order_acquire) > 0)
+        cpuRelax();
+}
+
+int CyderWorkerPool::getNumWorkers() const noexcept
+{
+    return static_cast<int>(workers.size());
+}
+
+int CyderWorkerPool::getDefaultNumWorkers(int maxUsefulWorkers) noexcept
+{
+    return juce::jlimit(0, std::max(0, maxUsefulWorkers), juce::SystemStats::getNumCpus() - 1);
+}
+
+int CyderWorkerPool::getNumThreads() const noexcept
+{
+    return getNumWorkers() + 1;
+}
+
+void CyderWorkerPool::runPendingTasks(int threadIndex, uint32_t batch) noexcept
+{
+    // Only claimed while its batch is running, so the task is still that batch's
+    auto runTask = [this](int taskIndex)
+    {
+        (*currentTask.load(std::memory_order_relaxed))(taskIndex);
+        numTasksRemaining.fetch_sub(1, std::memory_order_release);
+    };
+
+    for (auto taskIndex = claimOwnTask(threadIndex, batch); taskIndex >= 0; taskIndex = claimOwnTask(threadIndex, batch))
+        runTask(taskIndex);
+
+    // Ranges only ever shrink, so one pass over the others leaves nothing unclaimed
+    const auto numThreads = getNumThreads();
+    for (int offset = 1; offset < numThreads; ++offset)
+    {
+        const auto victim = (threadIndex + offset) % numThreads;
+        for (auto taskIndex = stealTask(victim, batch); taskIndex >= 0; taskIndex = stealTask(victim, batch))
+            runTask(taskIndex);
+    }
+}
+
+int CyderWorkerPool::claimOwnTask(int threadIndex, uint32_t batch) noexcept
+{
+    auto& range = taskRanges[static_cast<size_t>(threadIndex)].state;
+    auto state = range.load(std::memory_order_acquire);
+
+    while (getBatch(state) == batch && getNextTaskIndex(state) < getEndTaskIndex(state))
+    {
+        if (range.compare_exchange_weak(state, state + 1,
+                                        std::memory_order_acq_rel,
+                                        std::memory_order_acquire))
+            return getNextTaskIndex(state);
+        // a thief got there first, or a new batch started, state has been reloaded
+    }
+    return -1;
+}
+
+int CyderWorkerPool::stealTask(int threadIndex, uint32_t batch) noexcept
+{
+    auto& range = taskRanges[static_cast<size_t>(threadIndex)].state;
+    auto state = range.load(std::memory_order_acquire);
+
+    while (getBatch(state) == batch && getNextTaskIndex(state) < getEndTaskIndex(state))
+    {
+        if (range.compare_exchange_weak(state, state - (uint64_t(1) << endShift),
+                                        std::memory_order_acq_rel,
+                                        std::memory_order_acquire))
+            return getEndTaskIndex(state) - 1;
+        // its owner or another thief got there first, or a new batch started, state has been reloaded
+    }
+    return -1;
+}
@@ -0,0 +1,104 @@
+/******************************************************************************
+ * Cyder — Hot-Reloading Audio Plugin Wrapper
+ *
+ * @file     CyderWorkerPool.hpp
+ *
+ * @author   Adam Shield
+ * @date     2026-10-19
+ *
+ * @copyright (c) 2026 Adam Shield
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * See LICENSE.txt for license terms.
+ ******************************************************************************/
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+//==============================================================================
+
+class CyderRealtimeGuard;
+
+//==============================================================================
+
+/**
+ A small pool of pinned, real-time priority worker threads that run a batch of
+ tasks on behalf of the audio thread.
+
+ Threads are created up front, and run() neither allocates nor locks. Each
+ batch is split into one contiguous range of tasks per thread, the calling
+ thread included. A thread works through its own range from the front, then
+ steals from the back of the others' until none are left. So a batch always
+ makes progress even if no worker is scheduled in time, and run() only
+ returns once every task in the batch has finished.
+ */
+class CyderWorkerPool final
+{
+public:
+    /** A task receives the index of the task within its batch. */
+    using Task = std::function<void(int taskIndex)>;
+
+    /**
+     Starts the worker threads. Not real-time safe.
+     @param realtimeGuard if given, marks each worker as real-time for as long as it works on a batch
+     */
+    explicit CyderWorkerPool(int numWorkers, CyderRealtimeGuard* realtimeGuard = nullptr);
+    /** Stops the worker threads. Must not be called while run() is in progress. */
+    ~CyderWorkerPool();
+
+    /**
+     Runs task(0) ... task(numTasks - 1) across the calling thread and the workers,
+     then waits for all of them to complete. Real-time safe.
+     The task must stay alive until run() returns.
+     */
+    void run(int numTasks, const Task& task) noexcept;
+
+    /** */
+    [[nodiscard]] int getNumWorkers() const noexcept;
+
+    /** @returns a worker count that leaves one core free for the host's audio thread */
+    [[nodiscard]] static int getDefaultNumWorkers(int maxUsefulWorkers) noexcept;
+
+    /** Largest number of tasks a single call to run() can take. */
+    static constexpr int maxNumTasksPerBatch = 0xffff;
+
+private:
+    class Worker;
+    std::vector<std::unique_ptr<Worker>> workers;
+    CyderRealtimeGuard* const realtimeGuard;
+
+    /**
+     One thread's share of the current batch: batch number, end and next unclaimed
+     task index packed into one word, so a task can only ever be claimed from the
+     batch it belongs to. Each on its own cache line, since its owner and thieves
+     both write to it.
+     */
+    struct alignas(64) TaskRange
+    {
+        std::atomic<uint64_t> state { 0 };
+    };
+    std::unique_ptr<TaskRange[]> taskRanges; // the calling thread's first, then one per worker
+
+    std::atomic<const Task*> currentTask { nullptr };
+    std::atomic<int> numTasksRemaining { 0 };
+    std::atomic<uint32_t> currentBatch { 0 };
+
+    /** @returns number of threads a batch is split across, including the calling thread */
+    [[nodiscard]] int getNumThreads() const noexcept;
+
+    /** Runs the given thread's own tasks from the given batch, then steals from the others until none are left unclaimed. */
+    void runPendingTasks(int threadIndex, uint32_t batch) noexcept;
+    /** @returns index of the task claimed from the front of the range, or -1 if it has none left in the given batch */
+    [[nodiscard]] int claimOwnTask(int threadIndex, uint32_t batch) noexcept;
+    /** @returns index of the task stolen from the back of the range, or -1 if it has none left in the given batch */
+    [[nodiscard]] int stealTask(int threadIndex, uint32_t batch) noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CyderWorkerPool)
+};
@@ -14,12 +14,42 @@
 
 #include "HotReloadThread.hpp"
 
+#include "Utilities.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <utility>
+
+#if ! JUCE_WINDOWS
+#include <cerrno>
+#include <csignal>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
 //==============================================================================
 
+/**
+ On Linux only the module itself is watched, rather than walking the whole bundle on every poll:
+ every rebuild relinks it. Elsewhere the bundle is walked, since signing etc. touch other files last.
+ */
+[[nodiscard]] static juce::File getFileToWatch(const juce::File& plugin)
+{
+   #if JUCE_LINUX
+    if (const auto module = Utilities::getModuleInBundle(plugin); module.existsAsFile())
+        return module;
+   #endif
+    return plugin;
+}
+
 /** Helper to get the latest modification time of a file or any of its children. */
 [[nodiscard]] static juce::Time getLatestModificationTime(const juce::File& file) noexcept
 {
     juce::Time latest = file.getLastModificationTime();
+    if (! file.isDirectory())
+        return latest;
+
     juce::Array<juce::File> children;
     file.findChildFiles (children, juce::File::findFiles, true);
     for (auto& f : children)
@@ -28,38 +58,335 @@
     return latest;
 }
 
-HotReloadThread::HotReloadThread(const juce::File& _pluginToReload)
+/** Latest modification time of any source file, skipping hidden folders and build trees, which the build itself writes to. */
+[[nodiscard]] static juce::Time getLatestSourceModificationTime(const juce::File& directory)
+{
+    juce::Time latest;
+    for (const auto& entry : juce::RangedDirectoryIterator(directory, false, "*",
+                                                           juce::File::findFilesAndDirectories | juce::File::ignoreHiddenFiles))
+    {
+        juce::Time modified;
+        if (! entry.isDirectory())
+            modified = entry.getModificationTime();
+        else if (! entry.getFile().getChildFile("CMakeCache.txt").existsAsFile())
+            modified = getLatestSourceModificationTime(entry.getFile());
+
+        if (modified > latest)
+            latest = modified;
+    }
+    return latest;
+}
+
+juce::File CyderBuildSettings::getLogFileOrDefault() const
+{
+    return logFile != juce::File() ? logFile
+                                   : juce::File::getSpecialLocation(juce::File::tempDirectory).getChildFile("CyderBuild.log");
+}
+
+//==============================================================================
+
+/** A build that ignores SIGTERM for this long is killed. */
+static constexpr int buildTerminateTimeoutMs = 2000;
+/** Once killed, it only has to be reaped. */
+static constexpr int buildReapTimeoutMs = 3000;
+
+static_assert(buildTerminateTimeoutMs + buildReapTimeoutMs < HotReloadThread::stopTimeoutMs,
+              "stop() must wait for a build to be torn down, or the thread is killed and leaks it");
+
+/**
+ Runs the build command on its own thread, streaming its output to the log.
+ On POSIX the command runs in its own process group, so cancelling also stops
+ whatever it spawned (ninja, compilers...). On Windows only the command itself is terminated.
+ */
+class HotReloadThread::BuildProcess final : private juce::Thread
+{
+public:
+    explicit BuildProcess(const CyderBuildSettings& _settings)
+    : juce::Thread("Cyder Build")
+    , settings(_settings)
+    {
+        startThread();
+    }
+    
+    ~BuildProcess() override
+    {
+        cancel();
+        
+       #if ! JUCE_WINDOWS
+        // Not everything gives up on SIGTERM
+        if (! waitForThreadToExit(buildTerminateTimeoutMs))
+            if (const auto group = processGroup.load(); group > 0)
+                kill(-group, SIGKILL);
+       #endif
+        
+        stopThread(buildReapTimeoutMs);
+    }
+    
+    [[nodiscard]] bool isFinished() const noexcept { return finished.load(); }
+    [[nodiscard]] bool succeeded() const noexcept  { return finished.load() && exitCode.load() == 0; }
+    
+    /** Stops the build, if it is still running. Any thread. */
+    void cancel()
+    {
+        signalThreadShouldExit();
+        
+       #if JUCE_WINDOWS
+        const juce::ScopedLock lock(processLock);
+        process.kill();
+       #else
+        if (const auto group = processGroup.load(); group > 0 && ! finished)
+            kill(-group, SIGTERM);
+       #endif
+    }
+    
+private:
+    const CyderBuildSettings settings;
+    std::atomic<bool> finished { false };
+    std::atomic<int> exitCode { -1 };
+    
+   #if JUCE_WINDOWS
+    juce::CriticalSection processLock;
+    juce::ChildProcess process;
+   #else
+    std::atomic<pid_t> processGroup { 0 };
+   #endif
+    
+    void run() override
+    {
+        const auto logFile = settings.getLogFileOrDefault();
+        logFile.deleteFile();
+        juce::FileOutputStream log(logFile);
+        log << "$ " << settings.command << "\n";
+        log.flush();
+        
+       #if JUCE_WINDOWS
+        {
+            const juce::ScopedLock lock(processLock);
+            if (threadShouldExit()
+                || ! process.start("cmd /C cd /d \"" + settings.sourceDirectory.getFullPathName() + "\" && " + settings.command,
+                                   juce::ChildProcess::wantStdOut | juce::ChildProcess::wantStdErr))
+            {
+                finished = true;
+                return;
+            }
+        }
+        
+        char buffer[4096];
+        while (const auto numRead = process.readProcessOutput(buffer, sizeof(buffer)))
+        {
+            log.write(buffer, static_cast<size_t>(numRead));
+            log.flush(); // so it can be followed while building
+        }
+        
+        exitCode = threadShouldExit() ? -1 : static_cast<int>(process.getExitCode());
+       #else
+        // Everything the child needs is prepared up front: between fork() and exec() only
+        // async-signal-safe calls are allowed, since the host may have other threads
+        const std::string directory = settings.sourceDirectory.getFullPathName().toStdString();
+        const std::string command   = settings.command.toStdString();
+        const auto maxFd = static_cast<int>(std::min(sysconf(_SC_OPEN_MAX), 65536L));
+        
+        int outputPipe[2];
+        if (pipe(outputPipe) != 0)
+        {
+            finished = true;
+            return;
+        }
+        
+        const auto pid = fork();
+        if (pid == 0)
+        {
+            setpgid(0, 0);
+            dup2(outputPipe[1], STDOUT_FILENO);
+            dup2(outputPipe[1], STDERR_FILENO);
+            for (int fd = STDERR_FILENO + 1; fd < maxFd; ++fd)
+                close(fd); // leave the host's files, sockets and devices alone
+            if (chdir(directory.c_str()) == 0)
+                execl("/bin/sh", "sh", "-c", command.c_str(), static_cast<char*>(nullptr));
+            _exit(127);
+        }
+        
+        close(outputPipe[1]);
+        
+        if (pid < 0)
+        {
+            close(outputPipe[0]);
+            finished = true;
+            return;
+        }
+        
+        setpgid(pid, pid); // also here, in case we cancel before the child got to it
+        processGroup = pid;
+        if (threadShouldExit())
+            kill(-pid, SIGTERM);
+        
+        char buffer[4096];
+        ssize_t numRead;
+        while ((numRead = read(outputPipe[0], buffer, sizeof(buffer))) != 0)
+        {
+            if (numRead < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                break;
+            }
+            
+            log.write(buffer, static_cast<size_t>(numRead));
+            log.flush(); // so it can be followed while building
+        }
+        close(outputPipe[0]);
+        
+        int status = 0;
+        while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {}
+        exitCode = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+       #endif
+        
+        if (threadShouldExit())
+            log << "\nBuild cancelled\n";
+        else if (exitCode == 0)
+            log << "\nBuild succeeded\n";
+        else
+            log << "\nBuild failed (exit code " << exitCode.load() << ")\n";
+        finished = true;
+    }
+    
+    JUCE_DECLARE_NON_COPYABLE (BuildProcess)
+};
+
+//==============================================================================
+
+HotReloadThread::HotReloadThread(const juce::File& _pluginToReload, const CyderBuildSettings& _buildSettings, bool _keepWatching)
 : juce::Thread("Hot Reload Thread")
 , pluginToReload(_pluginToReload)
-, lastTimePluginWasModified(getLatestModificationTime(pluginToReload))
+, fileToWatch(getFileToWatch(pluginToReload))
+, lastTimePluginWasModified(getLatestModificationTime(fileToWatch))
+, buildSettings(_buildSettings)
+, keepWatching(_keepWatching)
+, lastTimeSourceWasModified(buildSettings.isEnabled() ? getLatestSourceModificationTime(buildSettings.sourceDirectory)
+                                                      : juce::Time())
 {
     startThread();
 }
 
-HotReloadThread::~HotReloadThread() = default;
+HotReloadThread::~HotReloadThread()
+{
+    stop();
+    setBuild(nullptr);
+}
+
+bool HotReloadThread::stop()
+{
+    signalThreadShouldExit();
+    
+    // Starts tearing the build down now, rather than once the thread gets round to it
+    {
+        const juce::ScopedLock lock(buildLock);
+        if (build != nullptr)
+            build->cancel();
+    }
+    
+    return stopThread(stopTimeoutMs);
+}
+
+void HotReloadThread::setBuild(std::unique_ptr<BuildProcess> newBuild)
+{
+    {
+        const juce::ScopedLock lock(buildLock);
+        std::swap(build, newBuild);
+    }
+    
+    newBuild.reset(); // cancels and reaps the old one, if any, outside the lock
+}
 
 void HotReloadThread::run()
 {
     bool reloadPending = false;
     juce::Time pendingDetectedTime;
+    bool buildPending = false;
+    juce::Time buildPendingTime;
     constexpr int debounceMs       = 500; // delay after last change before reloading
     constexpr int pollIntervalMs   = 200; // how often to poll for file changes
+    // The source tree can be far larger than the bundle, so it is walked less often,
+    // and never for more than a small share of the time however large it is
+    constexpr int sourcePollIntervalMs = 1000;
+    constexpr int sourceWalkDutyCycle  = 20;
+    juce::uint32 nextSourcePollMs = 0;
 
     while (true)
     {
         if (threadShouldExit())
+        {
+            setBuild(nullptr); // nobody is waiting for it anymore
             return;
+        }
+
+        const bool isBuilding = build != nullptr;
 
         // Scan for the newest modification time in the bundle
-        juce::Time current = getLatestModificationTime(pluginToReload);
+        juce::Time current = getLatestModificationTime(fileToWatch);
 
-        // If we see a new modification, start (or restart) the debounce timer
+        // If we see a new modification, start (or restart) the debounce timer.
+        // Our own build is about to finish anyway, so leave it to report success.
         if (current > lastTimePluginWasModified)
         {
             lastTimePluginWasModified = current;
-            pendingDetectedTime       = juce::Time::getCurrentTime();
-            reloadPending             = true;
-            DBG("Plugin change detected! Waiting in case other changes are still being made...");
+            if (! isBuilding)
+            {
+                pendingDetectedTime   = juce::Time::getCurrentTime();
+                reloadPending         = true;
+                DBG("Plugin change detected! Waiting in case other changes are still being made...");
+            }
+        }
+
+        if (buildSettings.isEnabled())
+        {
+            // Saves in quick succession are coalesced into one build, and a newer save cancels the build in progress
+            juce::Time sourceModified;
+            if (const auto nowMs = juce::Time::getMillisecondCounter(); nowMs >= nextSourcePollMs)
+            {
+                sourceModified = getLatestSourceModificationTime(buildSettings.sourceDirectory);
+                const auto walkMs = static_cast<int>(juce::Time::getMillisecondCounter() - nowMs);
+                nextSourcePollMs = juce::Time::getMillisecondCounter()
+                                 + static_cast<juce::uint32>(std::max(sourcePollIntervalMs, walkMs * sourceWalkDutyCycle));
+            }
+
+            if (sourceModified > lastTimeSourceWasModified)
+            {
+                lastTimeSourceWasModified = sourceModified;
+                buildPendingTime          = juce::Time::getCurrentTime();
+                buildPending              = true;
+                
+                if (build != nullptr)
+                {
+                    DBG("Source changed again, cancelling build in progress.");
+                    setBuild(nullptr);
+                }
+            }
+            
+            if (buildPending &&
+                juce::Time::getCurrentTime() > (buildPendingTime + juce::RelativeTime::milliseconds(debounceMs)))
+            {
+                DBG("Starting build: " << buildSettings.command);
+                buildPending = false;
+                reloadPending = false; // the build decides when to reload now
+                setBuild(std::make_unique<BuildProcess>(buildSettings));
+                if (onBuildStarted != nullptr)
+                    onBuildStarted();
+            }
+            
+            if (build != nullptr && build->isFinished())
+            {
+                const bool succeeded = build->succeeded();
+                setBuild(nullptr);
+                lastTimePluginWasModified = getLatestModificationTime(fileToWatch);
+                
+                if (onBuildFinished != nullptr)
+                    onBuildFinished(succeeded);
+                
+                // Straight to staging, no need to wait out the debounce
+                if (succeeded && reportPluginChange())
+                    return;
+            }
         }
 
         // If a change was detected and the debounce interval has passed, fire callback once
@@ -67,8 +394,8 @@ void HotReloadThread::run()
             juce::Time::getCurrentTime() > (pendingDetectedTime + juce::RelativeTime::milliseconds(debounceMs)))
         {
             DBG("Triggering plugin reload.");
-            if (auto callback = std::exchange(onPluginChangeDetected, nullptr))
-                return callback();
+            if (reportPluginChange())
+                return;
             reloadPending = false;
         }
 
@@ -77,6 +404,23 @@ void HotReloadThread::run()
     }
 }
 
+bool HotReloadThread::reportPluginChange()
+{
+    if (keepWatching)
+    {
+        if (onPluginChangeDetected != nullptr)
+            onPluginChangeDetected();
+        return false;
+    }
+    
+    if (auto callback = std::exchange(onPluginChangeDetected, nullptr))
+    {
+        callback();
+        return true;
+    }
+    return false;
+}
+
 juce::String HotReloadThread::getFullPluginPath() const noexcept
 {
     return pluginToReload.getFullPathName();
@@ -18,6 +18,23 @@
 #include <juce_core/juce_core.h>
 
 #include <functional>
+#include <memory>
+
+//==============================================================================
+
+/**
+ Optional: rebuild the plugin whenever its source changes, rather than waiting
+ for someone to build it by hand.
+ */
+struct CyderBuildSettings
+{
+    juce::File sourceDirectory; // watched recursively, skipping hidden folders and build trees
+    juce::String command;       // run from sourceDirectory, e.g. "cmake --build build --target MyPlugin_VST3"
+    juce::File logFile;         // build output is streamed here, CyderBuild.log in the temp directory if unset
+    
+    [[nodiscard]] bool isEnabled() const noexcept { return sourceDirectory.isDirectory() && command.isNotEmpty(); }
+    [[nodiscard]] juce::File getLogFileOrDefault() const;
+};
 
 //==============================================================================
 
@@ -25,18 +42,47 @@
 class HotReloadThread final : public juce::Thread
 {
 public:
-    HotReloadThread(const juce::File& pluginToReload);
+    /** @param keepWatching if true, onPluginChangeDetected is called for every change rather than only the first */
+    HotReloadThread(const juce::File& pluginToReload, const CyderBuildSettings& buildSettings = {}, bool keepWatching = false);
+    /** Stops the thread, if still running. */
     ~HotReloadThread();
     
+    /** Longest stop() may block for: a build in progress is given time to stop on SIGTERM, then killed and reaped. */
+    static constexpr int stopTimeoutMs = 6000;
+    
+    /**
+     Cancels a build in progress, then stops the thread, without leaving the build behind.
+     Use instead of stopThread(), whose timeout may be too short for that.
+     @returns true if the thread stopped in time
+     */
+    bool stop();
+    
+    /** Called on this thread when the plugin has changed, once. The thread exits afterwards, unless it keeps watching. */
     std::function<void()> onPluginChangeDetected = nullptr;
+    /** Called on this thread when a save has started a build. */
+    std::function<void()> onBuildStarted = nullptr;
+    /** Called on this thread when a build ran to completion. A build cancelled by a newer save never finishes. */
+    std::function<void(bool succeeded)> onBuildFinished = nullptr;
     
     juce::String getFullPluginPath() const noexcept;
     
 private:
+    class BuildProcess;
+    
     const juce::File pluginToReload;
+    const juce::File fileToWatch; // the module itself on Linux, the whole bundle elsewhere
     juce::Time lastTimePluginWasModified;
     
+    const CyderBuildSettings buildSettings;
+    const bool keepWatching;
+    juce::Time lastTimeSourceWasModified;
+    juce::CriticalSection buildLock; // for stop() to cancel it, only ever replaced on this thread
+    std::unique_ptr<BuildProcess> build;
+    
     void run() override;
+    void setBuild(std::unique_ptr<BuildProcess> newBuild);
+    /** @returns true if the thread should exit now, having reported the change once */
+    bool reportPluginChange();
     
     HotReloadThread(const HotReloadThread&) = delete;
     HotReloadThread& operator=(const HotReloadThread&) = delete;
@@ -15,21 +15,152 @@
 #include "Utilities.hpp"
 
 #include "CyderAssert.hpp"
+#include "CyderTempJanitor.hpp"
 
 #include <memory>
 
 #if JUCE_WINDOWS
 #define WIN32_LEAN_AND_MEAN // speed up compilation, prevent namespace pollution
 #include <Windows.h> // for GetLastError()
+#elif JUCE_LINUX
+#include <elf.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/sendfile.h>
+#include <sys/stat.h>
+#include <sys/utsname.h>
+#include <unistd.h>
+
+#include <cstring>
 #endif
 
 //==============================================================================
 
-juce::File Utilities::copyPluginToTemp(const juce::File& originalFile) noexcept(false)
+#if JUCE_LINUX
+juce::String Utilities::getLinuxArchitectureName()
+{
+    struct utsname info;
+    if (uname(&info) != 0)
+        return "x86_64";
+
+    const juce::String machine(info.machine);
+    if (machine == "arm64")
+        return "aarch64";
+    if (machine.matchesWildcard("i?86", true))
+        return "i386";
+    return machine;
+}
+
+template <typename ElfHeader, typename SectionHeader>
+[[nodiscard]] static juce::String readGnuDebugLink(const char* data, size_t size)
 {
-    // Create or reuse a temp subdirectory for copied plugins
-    auto tempDir = juce::File::getSpecialLocation(juce::File::tempDirectory)
-                       .getChildFile("CyderPlugins");
+    if (size < sizeof(ElfHeader))
+        return {};
+
+    ElfHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    if (header.e_shoff == 0 || header.e_shentsize != sizeof(SectionHeader) || header.e_shstrndx >= header.e_shnum)
+        return {};
+
+    auto readSectionHeader = [&](size_t index, SectionHeader& section)
+    {
+        const auto offset = static_cast<size_t>(header.e_shoff) + index * sizeof(SectionHeader);
+        if (offset + sizeof(SectionHeader) > size)
+            return false;
+        std::memcpy(&section, data + offset, sizeof(section));
+        return true;
+    };
+
+    SectionHeader names;
+    if (! readSectionHeader(header.e_shstrndx, names) || names.sh_offset + names.sh_size > size)
+        return {};
+
+    static constexpr char debugLinkName[] = ".gnu_debuglink";
+
+    for (size_t i = 0; i < header.e_shnum; ++i)
+    {
+        SectionHeader section;
+        if (! readSectionHeader(i, section))
+            return {};
+
+        if (section.sh_name + sizeof(debugLinkName) > names.sh_size
+            || std::memcmp(data + names.sh_offset + section.sh_name, debugLinkName, sizeof(debugLinkName)) != 0)
+            continue;
+
+        if (section.sh_offset + section.sh_size > size)
+            return {};
+
+        // Name, padding, then a CRC we have no use for
+        const auto* linkName = data + section.sh_offset;
+        return juce::String(juce::CharPointer_UTF8(linkName), strnlen(linkName, static_cast<size_t>(section.sh_size)));
+    }
+
+    return {};
+}
+
+/** @returns the file named by a module's .gnu_debuglink section, or empty if it has none */
+[[nodiscard]] static juce::String readGnuDebugLink(const juce::File& module)
+{
+    juce::MemoryMappedFile mapped(module, juce::MemoryMappedFile::readOnly);
+    const auto* data = static_cast<const char*>(mapped.getData());
+    const auto size  = mapped.getSize();
+
+    if (data == nullptr || size < EI_NIDENT || std::memcmp(data, ELFMAG, SELFMAG) != 0)
+        return {};
+
+    return data[EI_CLASS] == ELFCLASS64 ? readGnuDebugLink<Elf64_Ehdr, Elf64_Shdr>(data, size)
+                                        : readGnuDebugLink<Elf32_Ehdr, Elf32_Shdr>(data, size);
+}
+
+/**
+ Finds a module's separate debug info, where gdb would, plus next to the bundle itself
+ since that is where build systems tend to leave it.
+ */
+[[nodiscard]] static juce::File findDebugFile(const juce::File& module)
+{
+    juce::StringArray names;
+    if (const auto debugLink = readGnuDebugLink(module); debugLink.isNotEmpty())
+        names.add(debugLink);
+    names.addIfNotAlreadyThere(module.getFileName() + ".debug");
+
+    const auto moduleDir = module.getParentDirectory();
+    const juce::Array<juce::File> directories { moduleDir,
+                                                moduleDir.getChildFile(".debug"),
+                                                moduleDir.getParentDirectory().getParentDirectory().getParentDirectory(), // next to the bundle
+                                                juce::File("/usr/lib/debug" + moduleDir.getFullPathName()) };
+
+    for (const auto& name : names)
+        for (const auto& directory : directories)
+            if (const auto candidate = directory.getChildFile(name); candidate.existsAsFile())
+                return candidate;
+
+    return {};
+}
+#endif
+
+//==============================================================================
+
+juce::File Utilities::copyPluginToTemp(const juce::File& originalFile, bool forOtherProcesses) noexcept(false)
+{
+    juce::SharedResourcePointer<CyderTempJanitor> janitor;
+
+   #if JUCE_LINUX
+    if (janitor->getStagingLocation() == CyderTempJanitor::StagingLocation::memory && ! forOtherProcesses)
+    {
+        try
+        {
+            return stagePluginInMemory(originalFile);
+        }
+        catch (const std::exception& e)
+        {
+            DBG("Staging in memory failed, copying instead: " << e.what());
+        }
+    }
+   #endif
+
+    // In RAM if there is room, and each process into its own session folder, so orphans can be told apart from live copies.
+    // Throws rather than let the temp folders grow without bound.
+    auto tempDir = janitor->getStagingDirectory(CyderTempJanitor::getSizeOnDisk(originalFile));
     {
         auto result = tempDir.createDirectory();
         CYDER_ASSERT(result);
@@ -97,11 +228,140 @@ juce::File Utilities::copyPluginToTemp(const juce::File& originalFile) noexcept(
             CYDER_ASSERT_FALSE;
         }
     }
+    #elif JUCE_LINUX
+    // gdb looks for the .gnu_debuglink file next to the loaded module, so bring it along
+    // if it was not already inside the bundle
+    const auto originalModule = getModuleInBundle(originalFile);
+    const auto debugFile = originalModule.existsAsFile() ? findDebugFile(originalModule) : juce::File();
+    if (debugFile.existsAsFile() && ! debugFile.isAChildOf(originalFile))
+    {
+        const auto destDir = destFile.getChildFile("Contents")
+                                     .getChildFile(originalModule.getParentDirectory().getFileName());
+        if (! debugFile.copyFileTo(destDir.getChildFile(debugFile.getFileName())))
+            DBG("Failed to copy debug info to temp: " << debugFile.getFullPathName());
+    }
     #endif
 
     return destFile;
 }
 
+juce::File Utilities::getModuleInBundle(const juce::File& bundle)
+{
+    const auto name = bundle.getFileNameWithoutExtension();
+
+   #if JUCE_MAC
+    const auto moduleDir = bundle.getChildFile("Contents").getChildFile("MacOS");
+    const auto module    = moduleDir.getChildFile(name);
+    const auto wildcard  = juce::String("*");
+   #elif JUCE_WINDOWS
+    const auto moduleDir = bundle.getChildFile("Contents").getChildFile("x86_64-win");
+    const auto module    = moduleDir.getChildFile(name + ".vst3");
+    const auto wildcard  = juce::String("*.vst3");
+   #else
+    const auto moduleDir = bundle.getChildFile("Contents").getChildFile(getLinuxArchitectureName() + "-linux");
+    const auto module    = moduleDir.getChildFile(name + ".so");
+    const auto wildcard  = juce::String("*.so");
+   #endif
+
+    if (module.existsAsFile())
+        return module;
+
+    // Renamed bundles, like our copies, keep the original module name
+    for (const auto& entry : juce::RangedDirectoryIterator(moduleDir, false, wildcard, juce::File::findFiles))
+        return entry.getFile();
+
+    return {};
+}
+
+#if JUCE_LINUX
+juce::File Utilities::stagePluginInMemory(const juce::File& originalFile) noexcept(false)
+{
+    const auto originalModule = getModuleInBundle(originalFile);
+    if (! originalModule.existsAsFile())
+        throw std::runtime_error(("No Linux module found in: " + originalFile.getFullPathName()).toStdString());
+
+    juce::SharedResourcePointer<CyderTempJanitor> janitor;
+
+    // Only links are written, into RAM where there is one, but the memfd counts towards the quota
+    const auto stagingDirectory = janitor->getStagingDirectory(originalModule.getSize());
+
+    const int sourceFd = open(originalModule.getFullPathName().toRawUTF8(), O_RDONLY | O_CLOEXEC);
+    if (sourceFd < 0)
+        throw std::runtime_error(("Failed to open: " + originalModule.getFullPathName()).toStdString());
+
+    struct stat sourceInfo;
+    const int memoryFd = fstat(sourceFd, &sourceInfo) == 0
+                       ? memfd_create(originalModule.getFileName().toRawUTF8(), MFD_CLOEXEC | MFD_ALLOW_SEALING)
+                       : -1;
+
+    // Copied in the kernel, straight from the page cache
+    bool copied = memoryFd >= 0;
+    for (off_t offset = 0; copied && offset < sourceInfo.st_size;)
+        copied = sendfile(memoryFd, sourceFd, &offset, static_cast<size_t>(sourceInfo.st_size - offset)) > 0;
+    close(sourceFd);
+
+    if (! copied)
+    {
+        if (memoryFd >= 0)
+            close(memoryFd);
+        throw std::runtime_error(("Failed to copy module into memory: " + originalModule.getFullPathName()).toStdString());
+    }
+
+    // Nothing may change the module once it has been loaded
+    fcntl(memoryFd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL);
+
+    const auto stagedFile = stagingDirectory.getChildFile(originalFile.getFileNameWithoutExtension()
+                                                          + "_" + juce::Uuid().toString()
+                                                          + originalFile.getFileExtension());
+    janitor->adoptFileDescriptor(stagedFile, memoryFd);
+
+    const auto originalContents = originalFile.getChildFile("Contents");
+    const auto stagedContents   = stagedFile.getChildFile("Contents");
+    const auto originalArchDir  = originalModule.getParentDirectory();
+    const auto stagedArchDir    = stagedContents.getChildFile(originalArchDir.getFileName());
+
+    bool linked = stagedArchDir.createDirectory().wasOk();
+
+    // Resources, moduleinfo.json etc. are read from the original
+    for (const auto& entry : juce::RangedDirectoryIterator(originalContents, false, "*", juce::File::findFilesAndDirectories))
+        if (entry.getFile() != originalArchDir)
+            linked = entry.getFile().createSymbolicLink(stagedContents.getChildFile(entry.getFile().getFileName()), true) && linked;
+
+    for (const auto& entry : juce::RangedDirectoryIterator(originalArchDir, false, "*", juce::File::findFilesAndDirectories))
+        if (entry.getFile() != originalModule)
+            linked = entry.getFile().createSymbolicLink(stagedArchDir.getChildFile(entry.getFile().getFileName()), true) && linked;
+
+    // The module is looked up by the bundle's name, which the UUID has changed, so link it under both names.
+    // dlopen() follows the link to the memfd, a distinct file, so the OS loads it as a new module.
+    const auto memoryPath = "/proc/self/fd/" + juce::String(memoryFd);
+    for (const auto& moduleName : { originalModule.getFileName(), stagedFile.getFileNameWithoutExtension() + ".so" })
+        linked = juce::File::createSymbolicLink(stagedArchDir.getChildFile(moduleName), memoryPath, true) && linked;
+
+    // gdb looks for the .gnu_debuglink file next to the loaded module
+    if (const auto debugFile = findDebugFile(originalModule); debugFile.existsAsFile() && ! debugFile.isAChildOf(originalArchDir))
+        debugFile.createSymbolicLink(stagedArchDir.getChildFile(debugFile.getFileName()), true);
+
+    if (! linked)
+    {
+        Utilities::deleteStalePlugin(stagedFile); // closes the memfd once it is gone
+        throw std::runtime_error(("Failed to stage plugin in memory: " + stagedFile.getFullPathName()).toStdString());
+    }
+
+    return stagedFile;
+}
+#endif
+
+bool Utilities::isStagedInMemory(const juce::File& stagedFile)
+{
+   #if JUCE_LINUX
+    const auto module = getModuleInBundle(stagedFile);
+    return module.isSymbolicLink() && module.getNativeLinkedTarget().startsWith("/proc/self/fd/");
+   #else
+    juce::ignoreUnused(stagedFile);
+    return false;
+   #endif
+}
+
 juce::PluginDescription Utilities::findPluginDescription(const juce::File& pluginFile,
                                                          juce::AudioPluginFormatManager& formatManager) noexcept(false)
 {
@@ -158,3 +418,9 @@ std::unique_ptr<juce::DocumentWindow> Utilities::createAndShowEditorWindow(juce:
     
     return window;
 }
+
+void Utilities::deleteStalePlugin(const juce::File& pluginToDelete) noexcept
+{
+    // Deleted on the janitor thread, which retries until the OS has let go of the module
+    juce::SharedResourcePointer<CyderTempJanitor>()->retire(pluginToDelete);
+}
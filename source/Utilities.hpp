@@ -26,12 +26,41 @@ class Utilities final
 {
 public:
     /**
-     * @brief Copies the plugin file to a temporary directory, appending a random UUID to its name.
+     * @brief Copies the plugin file to this process's staging folder (in RAM where possible), appending a random UUID to its name.
+     * Separate debug info (PDB on Windows, .gnu_debuglink target on Linux) is copied along with it.
      * @param originalFile The original plugin File.
+     * @param forOtherProcesses Never stages in memory, whose module only this process can open.
      * @return juce::File pointing to the newly copied plugin.
-     * @throws std::runtime_error if the copy operation fails.
+     * @throws std::runtime_error if the copy operation fails, or the temp folder is over its quota.
      */
-    [[nodiscard]] static juce::File copyPluginToTemp(const juce::File& originalFile) noexcept(false);
+    [[nodiscard]] static juce::File copyPluginToTemp(const juce::File& originalFile, bool forOtherProcesses = false) noexcept(false);
+
+    /**
+     * @brief Finds the binary inside a VST3 bundle: Contents/MacOS/<name>, Contents/x86_64-win/<name>.vst3,
+     *        or Contents/<arch>-linux/<name>.so for the architecture we are running on (x86_64, aarch64...).
+     * @param bundle The VST3 bundle.
+     * @return juce::File pointing to the module, or an invalid File if the bundle has none for this platform.
+     */
+    [[nodiscard]] static juce::File getModuleInBundle(const juce::File& bundle);
+
+   #if JUCE_LINUX
+    /** @returns the CPU part of the VST3 architecture folder name, e.g. "x86_64" in "x86_64-linux", from uname() */
+    [[nodiscard]] static juce::String getLinuxArchitectureName();
+
+    /**
+     * @brief Stages a plugin without copying it to any file system: its module is copied into a memfd,
+     *        and a bundle of symbolic links is built around it, linking everything else to the original.
+     * Separate debug info is linked next to the module, so debuggers still find it.
+     * The memfd is given to CyderTempJanitor, and closed once the staged bundle has been deleted.
+     * @param originalFile The original plugin File.
+     * @return juce::File pointing to the staged bundle, loadable like any other.
+     * @throws std::runtime_error if the bundle has no module, or memfd_create() fails.
+     */
+    [[nodiscard]] static juce::File stagePluginInMemory(const juce::File& originalFile) noexcept(false);
+   #endif
+
+    /** @returns true if the bundle was staged by stagePluginInMemory(), so only this process can load it */
+    [[nodiscard]] static bool isStagedInMemory(const juce::File& stagedFile);
 
     /**
      * @brief Scans the specified file for a plugin description.
@@ -66,6 +95,13 @@ public:
     static std::unique_ptr<juce::DocumentWindow> createAndShowEditorWindow(juce::AudioPluginInstance* instance,
                                                                            const juce::String& windowTitle) noexcept(false);
     
+    /**
+     * @brief Hands a plugin copy previously made by copyPluginToTemp() to CyderTempJanitor.
+     * The deletion happens asynchronously, and is retried while the OS still holds the module.
+     * @param pluginToDelete The copied plugin bundle to delete.
+     */
+    static void deleteStalePlugin(const juce::File& pluginToDelete) noexcept;
+    
 private:
     Utilities() = delete;
 };
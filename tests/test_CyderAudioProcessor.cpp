@@ -14,6 +14,9 @@
 
 #include <gtest/gtest.h>
 
+#include <atomic>
+#include <thread>
+
 //==============================================================================
 
 TEST(CyderAudioProcessorGetAndSetStateInformation, SaveAndRestoreData)
@@ -112,12 +115,160 @@ TEST(CyderAudioProcessorGetAndSetStateInformation, SaveAndRestoreData)
         cyderProcessor.setStateInformation(retreivedState.getData(),
                                            static_cast<int>(retreivedState.getSize()));
         
+        // Wrapped plugin is restored in the background
+        for (int attempt = 0; attempt < 100 && cyderProcessor.isRestoringState(); ++attempt)
+            juce::MessageManager::getInstance()->runDispatchLoopUntil(50);
+        ASSERT_FALSE(cyderProcessor.isRestoringState());
+        
         // Cyder setStateInformation() calls wrapped plugin's setStateInformation()
         ASSERT_EQ(examplePluginGetStateInformation->getNumTimesCalled(), 1);
     #endif
     }
 }
 
+TEST(CyderAudioProcessorSetStateInformation, WrappedPluginRestoredInBackground)
+{
+    CyderAudioProcessor cyderProcessor;
+    
+    juce::File currentFile(__FILE__);
+    // ExamplePlugin.vst3 must have already been built and copied into root directory
+    // so we can use it as a testable VST3
+    juce::File pluginFile = currentFile.getParentDirectory() // "tests"
+                                       .getParentDirectory() // root dir
+                                       .getChildFile("ExamplePlugin")
+                                       .withFileExtension("vst3");
+    
+    {
+        auto result = cyderProcessor.loadPlugin(pluginFile.getFullPathName());
+        ASSERT_TRUE(result);
+    }
+    
+    juce::MemoryBlock savedState;
+    cyderProcessor.getStateInformation(savedState);
+    
+    // Returns right away, passing audio through until the plugin is in
+    cyderProcessor.setStateInformation(savedState.getData(), static_cast<int>(savedState.getSize()));
+    EXPECT_TRUE(cyderProcessor.isRestoringState());
+    EXPECT_TRUE(cyderProcessor.getWrappedPluginProcessor() == nullptr);
+    
+    // Saving in the meantime keeps what was restored
+    {
+        juce::MemoryBlock stateWhileRestoring;
+        cyderProcessor.getStateInformation(stateWhileRestoring);
+        EXPECT_TRUE(stateWhileRestoring == savedState);
+    }
+    
+    for (int attempt = 0; attempt < 100 && cyderProcessor.isRestoringState(); ++attempt)
+        juce::MessageManager::getInstance()->runDispatchLoopUntil(50);
+    
+    ASSERT_FALSE(cyderProcessor.isRestoringState());
+    ASSERT_TRUE(cyderProcessor.getWrappedPluginProcessor() != nullptr);
+    EXPECT_TRUE(cyderProcessor.getCurrentWrappedPluginPathOriginal() == pluginFile);
+}
+
+TEST(CyderAudioProcessorSetStateInformation, RestoredBuildCommandWaitsForConfirmation)
+{
+    CyderAudioProcessor cyderProcessor;
+    
+    const auto sourceDirectory = juce::File::getSpecialLocation(juce::File::tempDirectory);
+    juce::XmlElement xml("Cyder");
+    auto* buildElem = xml.createNewChildElement("Build");
+    buildElem->setAttribute("sourceDirectory", sourceDirectory.getFullPathName());
+    buildElem->setAttribute("command", "echo from a session");
+    const auto state = xml.toString();
+    
+    // Not run, just held on to
+    cyderProcessor.setStateInformation(state.toRawUTF8(), static_cast<int>(state.getNumBytesAsUTF8()));
+    EXPECT_TRUE(cyderProcessor.getBuildSettings().command.isEmpty());
+    ASSERT_TRUE(cyderProcessor.getUnconfirmedBuildSettings().has_value());
+    EXPECT_EQ(cyderProcessor.getUnconfirmedBuildSettings()->command, "echo from a session");
+    
+    cyderProcessor.confirmBuildSettings();
+    EXPECT_FALSE(cyderProcessor.getUnconfirmedBuildSettings().has_value());
+    EXPECT_EQ(cyderProcessor.getBuildSettings().command, "echo from a session");
+    EXPECT_TRUE(cyderProcessor.getBuildSettings().sourceDirectory == sourceDirectory);
+    
+    // The command already in use needs no confirming again
+    cyderProcessor.setStateInformation(state.toRawUTF8(), static_cast<int>(state.getNumBytesAsUTF8()));
+    EXPECT_FALSE(cyderProcessor.getUnconfirmedBuildSettings().has_value());
+    EXPECT_EQ(cyderProcessor.getBuildSettings().command, "echo from a session");
+}
+
+TEST(CyderAudioProcessorSetStateInformation, LoadingPluginDropsRestoreInProgress)
+{
+    CyderAudioProcessor cyderProcessor;
+    
+    juce::File currentFile(__FILE__);
+    juce::File pluginFile = currentFile.getParentDirectory() // "tests"
+                                       .getParentDirectory() // root dir
+                                       .getChildFile("ExamplePlugin")
+                                       .withFileExtension("vst3");
+    
+    {
+        auto result = cyderProcessor.loadPlugin(pluginFile.getFullPathName());
+        ASSERT_TRUE(result);
+    }
+    
+    juce::MemoryBlock savedState;
+    cyderProcessor.getStateInformation(savedState);
+    cyderProcessor.setStateInformation(savedState.getData(), static_cast<int>(savedState.getSize()));
+    ASSERT_TRUE(cyderProcessor.isRestoringState());
+    
+    {
+        auto result = cyderProcessor.loadPlugin(pluginFile.getFullPathName());
+        ASSERT_TRUE(result);
+    }
+    EXPECT_FALSE(cyderProcessor.isRestoringState());
+    
+    auto* loadedProcessor = cyderProcessor.getWrappedPluginProcessor();
+    const auto loadedCopy = cyderProcessor.getCurrentWrappedPluginPathCopy();
+    
+    // The dropped restore arriving later changes nothing
+    juce::MessageManager::getInstance()->runDispatchLoopUntil(1000);
+    EXPECT_EQ(loadedProcessor, cyderProcessor.getWrappedPluginProcessor());
+    EXPECT_TRUE(loadedCopy == cyderProcessor.getCurrentWrappedPluginPathCopy());
+}
+
+TEST(CyderAudioProcessorRollBack, SwapsBackToPreviousBuildAndItsState)
+{
+    CyderAudioProcessor cyderProcessor;
+    
+    juce::File currentFile(__FILE__);
+    juce::File pluginFile = currentFile.getParentDirectory() // "tests"
+                                       .getParentDirectory() // root dir
+                                       .getChildFile("ExamplePlugin")
+                                       .withFileExtension("vst3");
+    
+    ASSERT_TRUE(cyderProcessor.loadPlugin(pluginFile.getFullPathName()));
+    EXPECT_FALSE(cyderProcessor.rollBack()); // nothing to roll back to yet
+    
+    const auto firstCopy = cyderProcessor.getCurrentWrappedPluginPathCopy();
+    
+    // Rebuild
+    ASSERT_TRUE(cyderProcessor.loadPlugin(pluginFile.getFullPathName()));
+    ASSERT_EQ(1, cyderProcessor.getBuildHistory().getNumSnapshots());
+    EXPECT_TRUE(firstCopy.exists()); // kept for rolling back
+    const auto secondCopy = cyderProcessor.getCurrentWrappedPluginPathCopy();
+    const auto firstBuildState = cyderProcessor.getBuildHistory().getSnapshot(0)->getState();
+    
+    ASSERT_TRUE(cyderProcessor.rollBack());
+    EXPECT_EQ(cyderProcessor.getCurrentStatus(), CyderStatus::rolledBack);
+    EXPECT_TRUE(cyderProcessor.getCurrentWrappedPluginPathCopy() == firstCopy);
+    {
+        juce::MemoryBlock restoredState;
+        cyderProcessor.getWrappedPluginProcessor()->getStateInformation(restoredState);
+        EXPECT_TRUE(restoredState == firstBuildState);
+    }
+    
+    // Build rolled away from can be rolled back to in turn
+    ASSERT_EQ(1, cyderProcessor.getBuildHistory().getNumSnapshots());
+    EXPECT_TRUE(cyderProcessor.getBuildHistory().getSnapshot(0)->copiedPlugin == secondCopy);
+    
+    // A different plugin (or none) has no use for them
+    cyderProcessor.unloadPlugin();
+    EXPECT_EQ(0, cyderProcessor.getBuildHistory().getNumSnapshots());
+}
+
 TEST(CyderAudioProcessorUnloadPlugin, HotReloadThreadIsStoppedAfterUnload)
 {
     CyderAudioProcessor cyderProcessor;
@@ -222,6 +373,39 @@ TEST(CyderAudioProcessorLoadPlugin, WrappedPluginMatchesIOStereo)
     EXPECT_EQ(2, wrappedProcessor->getTotalNumOutputChannels());
 }
 
+TEST(CyderAudioProcessorIsBusesLayoutSupported, AcceptsUpTo7point1point4WithSidechain)
+{
+    CyderAudioProcessor cyderProcessor;
+    
+    auto makeLayout = [](const juce::AudioChannelSet& main, const juce::AudioChannelSet& sidechain)
+    {
+        juce::AudioProcessor::BusesLayout layout;
+        layout.inputBuses.add(main);
+        layout.inputBuses.add(sidechain);
+        layout.outputBuses.add(main);
+        return layout;
+    };
+    
+    EXPECT_TRUE(cyderProcessor.checkBusesLayoutSupported(makeLayout(juce::AudioChannelSet::mono(),
+                                                                    juce::AudioChannelSet::disabled())));
+    EXPECT_TRUE(cyderProcessor.checkBusesLayoutSupported(makeLayout(juce::AudioChannelSet::stereo(),
+                                                                    juce::AudioChannelSet::stereo())));
+    EXPECT_TRUE(cyderProcessor.checkBusesLayoutSupported(makeLayout(juce::AudioChannelSet::create7point1point4(),
+                                                                    juce::AudioChannelSet::mono())));
+    
+    // Wider than 7.1.4
+    EXPECT_FALSE(cyderProcessor.checkBusesLayoutSupported(makeLayout(juce::AudioChannelSet::discreteChannels(16),
+                                                                     juce::AudioChannelSet::disabled())));
+    // Sidechain wider than the main bus
+    EXPECT_FALSE(cyderProcessor.checkBusesLayoutSupported(makeLayout(juce::AudioChannelSet::mono(),
+                                                                     juce::AudioChannelSet::stereo())));
+    
+    // Input must still match output
+    auto mismatched = makeLayout(juce::AudioChannelSet::stereo(), juce::AudioChannelSet::disabled());
+    mismatched.outputBuses.getReference(0) = juce::AudioChannelSet::create5point1();
+    EXPECT_FALSE(cyderProcessor.checkBusesLayoutSupported(mismatched));
+}
+
 #if JUCE_MAC // TODO: figure out a way to make cleanup work on PC
 TEST(CyderAudioProcessorUnloadPlugin, DeleteCopiedPluginWhenNoLongerNeeded)
 {
@@ -252,7 +436,8 @@ TEST(CyderAudioProcessorUnloadPlugin, DeleteCopiedPluginWhenNoLongerNeeded)
     EXPECT_TRUE(cyderProcessor.getWrappedPluginEditor() == nullptr);
     EXPECT_TRUE(cyderProcessor.getCurrentStatus() == CyderStatus::idle);
     
-    // Ensure our copied plugin path was deleted
+    // Ensure our copied plugin path was deleted, which happens on the janitor thread
+    EXPECT_TRUE(juce::SharedResourcePointer<CyderTempJanitor>()->waitUntilIdle(5000));
     ASSERT_FALSE(copiedPath.exists());
 }
 
@@ -280,7 +465,7 @@ TEST(CyderAudioProcessorDestructor, DeleteCopiedPluginWhenCyderIsDestroyed)
         // Ensure our copied plugin path exists
         copiedPath = cyderProcessor.getCurrentWrappedPluginPathCopy();
         ASSERT_TRUE(copiedPath.exists());
-    } // Processor deleted
+    } // Processor deleted, taking the janitor with it, which makes a last attempt at deleting
     
     // Ensure our copied plugin path was deleted
     ASSERT_FALSE(copiedPath.exists());
@@ -325,3 +510,243 @@ TEST(CyderAudioProcessorAudioProcessorChanged, LatencySyncedWithWrappedPlugin)
     wrappedPlugin->setLatencySamples(testLatencyAmount);
     EXPECT_EQ(testLatencyAmount, cyderProcessor.getLatencySamples());
 }
+
+TEST(CyderAudioProcessorSetLatencyCeilingSamples, ReportedLatencyFixedAcrossReloads)
+{
+    CyderAudioProcessor cyderProcessor;
+    
+    constexpr auto numChannels = 2;
+    constexpr auto sampleRate  = 44100.0;
+    constexpr auto blocksize   = 1024;
+    cyderProcessor.setPlayConfigDetails(numChannels, numChannels, sampleRate, blocksize);
+    cyderProcessor.prepareToPlay(sampleRate, blocksize);
+    
+    juce::File currentFile(__FILE__);
+    // ExamplePlugin.vst3 must have already been built and copied into root directory
+    // so we can use it as a testable VST3
+    juce::File pluginFile = currentFile.getParentDirectory() // "tests"
+        .getParentDirectory() // root dir
+        .getChildFile("ExamplePlugin")
+        .withFileExtension("vst3");
+    
+    constexpr auto ceiling = 512;
+    cyderProcessor.setLatencyCeilingSamples(ceiling);
+    EXPECT_EQ(ceiling, cyderProcessor.getLatencySamples());
+    
+    ASSERT_TRUE(cyderProcessor.loadPlugin(pluginFile.getFullPathName()));
+    EXPECT_EQ(ceiling, cyderProcessor.getLatencySamples());
+    EXPECT_EQ(ceiling, cyderProcessor.getLatencyPaddingSamples());
+    
+    // Wrapped plugin's latency changes, host's view of it doesn't
+    cyderProcessor.getWrappedPluginProcessor()->setLatencySamples(100);
+    EXPECT_EQ(ceiling, cyderProcessor.getLatencySamples());
+    EXPECT_EQ(ceiling - 100, cyderProcessor.getLatencyPaddingSamples());
+    
+    // Hot reload brings back a build with different latency
+    ASSERT_TRUE(cyderProcessor.loadPlugin(pluginFile.getFullPathName()));
+    EXPECT_EQ(ceiling, cyderProcessor.getLatencySamples());
+    cyderProcessor.getWrappedPluginProcessor()->setLatencySamples(300);
+    EXPECT_EQ(ceiling, cyderProcessor.getLatencySamples());
+    EXPECT_EQ(ceiling - 300, cyderProcessor.getLatencyPaddingSamples());
+    
+    // Disabling reports actual latency again
+    cyderProcessor.setLatencyCeilingSamples(0);
+    EXPECT_EQ(300, cyderProcessor.getLatencySamples());
+    EXPECT_EQ(0, cyderProcessor.getLatencyPaddingSamples());
+    
+    cyderProcessor.releaseResources();
+}
+
+TEST(CyderAudioProcessorLoadPlugin, WrappedEditorCreatedAfterAudioSwap)
+{
+    CyderAudioProcessor cyderProcessor;
+    
+    // Open our window so the wrapped editor is wanted
+    auto* cyderEditor = cyderProcessor.createEditorIfNeeded();
+    ASSERT_TRUE(cyderEditor != nullptr);
+    
+    juce::File currentFile(__FILE__);
+    // ExamplePlugin.vst3 must have already been built and copied into root directory
+    // so we can use it as a testable VST3
+    juce::File pluginFile = currentFile.getParentDirectory() // "tests"
+        .getParentDirectory() // root dir
+        .getChildFile("ExamplePlugin")
+        .withFileExtension("vst3");
+    
+    // Load example plugin
+    {
+        auto result = cyderProcessor.loadPlugin(pluginFile.getFullPathName());
+        ASSERT_TRUE(result);
+    }
+    
+    // Audio side is swapped in immediately, editor is deferred
+    EXPECT_TRUE(cyderProcessor.getWrappedPluginProcessor() != nullptr);
+    EXPECT_TRUE(cyderProcessor.getWrappedPluginEditor() == nullptr);
+    
+    juce::MessageManager::getInstance()->runDispatchLoopUntil(100);
+    EXPECT_TRUE(cyderProcessor.getWrappedPluginEditor() != nullptr);
+    
+    // Close our window
+    cyderProcessor.editorBeingDeleted(cyderEditor);
+    delete cyderEditor;
+}
+
+TEST(CyderAudioProcessorLoadPlugin, WrappedEditorOnlyExistsWhileWindowIsOpen)
+{
+    CyderAudioProcessor cyderProcessor;
+    
+    juce::File currentFile(__FILE__);
+    // ExamplePlugin.vst3 must have already been built and copied into root directory
+    // so we can use it as a testable VST3
+    juce::File pluginFile = currentFile.getParentDirectory() // "tests"
+        .getParentDirectory() // root dir
+        .getChildFile("ExamplePlugin")
+        .withFileExtension("vst3");
+    
+    // Load example plugin with no window open
+    {
+        auto result = cyderProcessor.loadPlugin(pluginFile.getFullPathName());
+        ASSERT_TRUE(result);
+    }
+    juce::MessageManager::getInstance()->runDispatchLoopUntil(100);
+    EXPECT_TRUE(cyderProcessor.getWrappedPluginEditor() == nullptr);
+    
+    // Opening our window creates the wrapped editor
+    auto* cyderEditor = cyderProcessor.createEditorIfNeeded();
+    ASSERT_TRUE(cyderEditor != nullptr);
+    auto* wrappedEditor = cyderProcessor.getWrappedPluginEditor();
+    ASSERT_TRUE(wrappedEditor != nullptr);
+    
+    constexpr int width  = 321;
+    constexpr int height = 123;
+    wrappedEditor->setSize(width, height);
+    
+    // Closing our window destroys the wrapped editor
+    cyderProcessor.editorBeingDeleted(cyderEditor);
+    delete cyderEditor;
+    EXPECT_TRUE(cyderProcessor.getWrappedPluginEditor() == nullptr);
+    
+    // Hot reload while window is closed
+    {
+        auto result = cyderProcessor.loadPlugin(pluginFile.getFullPathName());
+        ASSERT_TRUE(result);
+    }
+    juce::MessageManager::getInstance()->runDispatchLoopUntil(100);
+    EXPECT_TRUE(cyderProcessor.getWrappedPluginEditor() == nullptr);
+    
+    // Reopening restores the previous size
+    cyderEditor = cyderProcessor.createEditorIfNeeded();
+    ASSERT_TRUE(cyderEditor != nullptr);
+    wrappedEditor = cyderProcessor.getWrappedPluginEditor();
+    ASSERT_TRUE(wrappedEditor != nullptr);
+    EXPECT_EQ(width, wrappedEditor->getWidth());
+    EXPECT_EQ(height, wrappedEditor->getHeight());
+    
+    cyderProcessor.editorBeingDeleted(cyderEditor);
+    delete cyderEditor;
+}
+
+TEST(CyderAudioProcessorProcessBlock, DrySignalPassesThroughWhenNothingIsLoaded)
+{
+    CyderAudioProcessor cyderProcessor;
+    
+    constexpr auto sampleRate = 44100.0;
+    constexpr auto blockSize  = 64;
+    constexpr auto ceiling    = 10;
+    
+    cyderProcessor.setPlayConfigDetails(2, 2, sampleRate, blockSize);
+    cyderProcessor.setLatencyCeilingSamples(ceiling);
+    cyderProcessor.prepareToPlay(sampleRate, blockSize);
+    ASSERT_EQ(ceiling, cyderProcessor.getLatencySamples());
+    
+    // Impulse comes out delayed by exactly the latency the host compensates for
+    juce::AudioBuffer<float> buffer(2, blockSize);
+    buffer.clear();
+    buffer.setSample(0, 0, 1.0f);
+    buffer.setSample(1, 0, 1.0f);
+    juce::MidiBuffer midi;
+    cyderProcessor.processBlock(buffer, midi);
+    
+    for (int channel = 0; channel < 2; ++channel)
+    {
+        EXPECT_FLOAT_EQ(0.0f, buffer.getSample(channel, 0));
+        EXPECT_FLOAT_EQ(1.0f, buffer.getSample(channel, ceiling));
+    }
+    
+    // Nothing loaded, nothing left ringing but the delay itself
+    EXPECT_DOUBLE_EQ(ceiling / sampleRate, cyderProcessor.getTailLengthSeconds());
+}
+
+TEST(CyderAudioProcessorGetTailLengthSeconds, SafeWhilePluginIsSwapped)
+{
+    CyderAudioProcessor cyderProcessor;
+    
+    juce::File currentFile(__FILE__);
+    juce::File pluginFile = currentFile.getParentDirectory() // "tests"
+                                       .getParentDirectory() // root dir
+                                       .getChildFile("ExamplePlugin")
+                                       .withFileExtension("vst3");
+    
+    // Hosts may ask from any thread
+    std::atomic<bool> stop { false };
+    std::thread hostThread([&]
+    {
+        while (! stop.load())
+            EXPECT_GE(cyderProcessor.getTailLengthSeconds(), 0.0);
+    });
+    
+    for (int i = 0; i < 3; ++i)
+    {
+        EXPECT_TRUE(cyderProcessor.loadPlugin(pluginFile.getFullPathName()));
+        cyderProcessor.unloadPlugin();
+    }
+    
+    stop = true;
+    hostThread.join();
+}
+
+TEST(CyderAudioProcessorSetBypassed, HostSeesBypassParameter)
+{
+    CyderAudioProcessor cyderProcessor;
+    
+    auto* bypass = cyderProcessor.getBypassParameter();
+    ASSERT_TRUE(bypass != nullptr);
+    EXPECT_TRUE(cyderProcessor.getParameters().contains(bypass));
+    
+    EXPECT_FALSE(cyderProcessor.isBypassed());
+    cyderProcessor.setBypassed(true);
+    EXPECT_TRUE(cyderProcessor.isBypassed());
+    EXPECT_FLOAT_EQ(1.0f, bypass->getValue());
+}
+
+TEST(CyderAudioProcessorLoadPlugin, PreparationDeferredUntilHostPreparesUs)
+{
+    CyderAudioProcessor cyderProcessor;
+    cyderProcessor.setPlayConfigDetails(2, 2, 0.0, 0); // host hasn't started audio yet
+    EXPECT_DOUBLE_EQ(0.0, cyderProcessor.getLastValidSampleRate());
+    EXPECT_EQ(0, cyderProcessor.getLastValidBlockSize());
+    
+    juce::File currentFile(__FILE__);
+    // ExamplePlugin.vst3 must have already been built and copied into root directory
+    // so we can use it as a testable VST3
+    juce::File pluginFile = currentFile.getParentDirectory() // "tests"
+        .getParentDirectory() // root dir
+        .getChildFile("ExamplePlugin")
+        .withFileExtension("vst3");
+    
+    // Loads fine without a sample rate
+    ASSERT_TRUE(cyderProcessor.loadPlugin(pluginFile.getFullPathName()));
+    
+    // Prepared with us, at the host's settings
+    constexpr auto sampleRate = 48000.0;
+    constexpr auto blockSize  = 256;
+    cyderProcessor.setPlayConfigDetails(2, 2, sampleRate, blockSize);
+    cyderProcessor.prepareToPlay(sampleRate, blockSize);
+    EXPECT_DOUBLE_EQ(sampleRate, cyderProcessor.getWrappedPluginProcessor()->getSampleRate());
+    EXPECT_EQ(blockSize, cyderProcessor.getWrappedPluginProcessor()->getBlockSize());
+    
+    // Remembered after the host stops audio
+    cyderProcessor.releaseResources();
+    EXPECT_DOUBLE_EQ(sampleRate, cyderProcessor.getLastValidSampleRate());
+    EXPECT_EQ(blockSize, cyderProcessor.getLastValidBlockSize());
+}
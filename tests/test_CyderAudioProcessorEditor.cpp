@@ -99,36 +99,75 @@ TEST(CyderAudioProcessorEditorIsInterestedInFileDrag, RejectsNonVST3)
 }
 
 TEST(CyderAudioProcessorEditorLoadWrappedEditor, CacheEditorSizeWhenReloadingPlugin)
+{
+    CyderAudioProcessor cyderProcessor;
+    std::unique_ptr<juce::AudioProcessorEditor> editor(cyderProcessor.createEditorIfNeeded());
+    ASSERT_TRUE(editor != nullptr);
+    
+    juce::File currentFile(__FILE__);
+    // ExamplePlugin.vst3 must have already been built and copied into root directory
+    // so we can use it as a testable VST3
+    juce::File pluginFile = currentFile.getParentDirectory() // "tests"
+        .getParentDirectory() // root dir
+        .getChildFile("ExamplePlugin")
+        .withFileExtension("vst3");
+    
+    // Original editor for plugin, resized by the user
+    ASSERT_TRUE(cyderProcessor.loadPlugin(pluginFile.getFullPathName()));
+    juce::MessageManager::getInstance()->runDispatchLoopUntil(100);
+    auto* wrappedEditor0 = cyderProcessor.getWrappedPluginEditor();
+    ASSERT_TRUE(wrappedEditor0 != nullptr);
+    
+    constexpr int width  = 1111;
+    constexpr int height = 222;
+    wrappedEditor0->setSize(width, height);
+    
+    // Hot reload with the window open, the new editor takes over the old one's size
+    ASSERT_TRUE(cyderProcessor.loadPlugin(pluginFile.getFullPathName()));
+    juce::MessageManager::getInstance()->runDispatchLoopUntil(100);
+    auto* wrappedEditor1 = cyderProcessor.getWrappedPluginEditor();
+    ASSERT_TRUE(wrappedEditor1 != nullptr);
+    EXPECT_EQ(width, wrappedEditor1->getWidth());
+    EXPECT_EQ(height, wrappedEditor1->getHeight());
+    
+    // And ours fits around it
+    EXPECT_EQ(width, editor->getWidth());
+    EXPECT_GT(editor->getHeight(), height);
+    
+    cyderProcessor.editorBeingDeleted(editor.get());
+    editor.reset();
+}
+
+TEST(CyderAudioProcessorEditorHoldReloadSnapshot, SnapshotPaintedUntilNewEditorHasDrawn)
 {
     CyderAudioProcessor cyderProcessor;
     std::unique_ptr<CyderAudioProcessorEditor> editor;
     editor.reset(dynamic_cast<CyderAudioProcessorEditor*>(cyderProcessor.createEditor()));
     ASSERT_TRUE(editor != nullptr);
     
-    // Original editor for plugin
     MockProcessor mockProcessor0;
     auto wrappedEditor0 = std::make_unique<MockEditor>(mockProcessor0,
-                                                       /*width*/1080,
-                                                       /*height*/720);
-    
+                                                       /*width*/640,
+                                                       /*height*/480);
     MockProcessor mockProcessor1;
-    // Mocked new editor for plugin after changes were made to the binary
     auto wrappedEditor1 = std::make_unique<MockEditor>(mockProcessor1,
-                                                       /*width*/1111,
-                                                       /*height*/222);
+                                                       /*width*/640,
+                                                       /*height*/480);
     
-    // Load first editor
     editor->loadWrappedEditor(wrappedEditor0.get());
+    EXPECT_FALSE(editor->isShowingReloadSnapshot());
     
-    // Unload first editor but cache its size
-    editor->unloadWrappedEditor(wrappedEditor0.get(), /*shouldCacheSize*/true);
+    // Snapshot old editor before it goes away
+    editor->holdReloadSnapshot(wrappedEditor0.get());
+    editor->unloadWrappedEditor(wrappedEditor0.get());
+    EXPECT_TRUE(editor->isShowingReloadSnapshot());
     
-    // Load second editor which has a different size by default (but should succumb to our size)
+    // New editor has not drawn a frame yet, snapshot stays on top
     editor->loadWrappedEditor(wrappedEditor1.get());
+    EXPECT_TRUE(editor->isShowingReloadSnapshot());
     
-    // Second editor should have been resized to the cached size of the first editor
-    ASSERT_EQ(wrappedEditor1->getWidth(), wrappedEditor0->getWidth());
-    ASSERT_EQ(wrappedEditor1->getHeight(), wrappedEditor0->getHeight());
+    editor->releaseReloadSnapshot();
+    EXPECT_FALSE(editor->isShowingReloadSnapshot());
     
     // Cleanup, creates issues on PC if none performed in the correct order
     editor->unloadWrappedEditor(wrappedEditor1.get());
@@ -0,0 +1,71 @@
+
+#include <gtest/gtest.h>
+
+#include <juce_audio_processors/juce_audio_processors.h>
+
+#include "../source/CyderBuildHistory.hpp"
+#include "../source/CyderTempJanitor.hpp"
+
+//==============================================================================
+
+/** Stands in for a staged copy, so the history has something to retire. */
+static juce::File createFakeCopy(const juce::String& contents)
+{
+    juce::SharedResourcePointer<CyderTempJanitor> janitor;
+    auto fakeCopy = janitor->getStagingDirectory(1024).getChildFile("Fake_" + juce::Uuid().toString() + ".vst3");
+    fakeCopy.replaceWithText(contents);
+    return fakeCopy;
+}
+
+static juce::MemoryBlock makeState(const juce::String& text)
+{
+    return juce::MemoryBlock(text.toRawUTF8(), text.getNumBytesAsUTF8());
+}
+
+//==============================================================================
+
+TEST(CyderBuildHistory, TakingHandsOverCopyAndState)
+{
+    CyderBuildHistory history;
+    const auto original = juce::File::getSpecialLocation(juce::File::tempDirectory).getChildFile("Fake.vst3");
+    const auto firstCopy  = createFakeCopy("first");
+    const auto secondCopy = createFakeCopy("second");
+
+    history.push(original, firstCopy,  {}, makeState("state of the first build"));
+    history.push(original, secondCopy, {}, makeState("state of the second build"));
+    ASSERT_EQ(2, history.getNumSnapshots());
+    EXPECT_TRUE(history.getSnapshot(0)->copiedPlugin == secondCopy); // most recent first
+
+    auto snapshot = history.take(1);
+    ASSERT_TRUE(snapshot.has_value());
+    EXPECT_TRUE(snapshot->copiedPlugin == firstCopy);
+    EXPECT_TRUE(snapshot->getState() == makeState("state of the first build"));
+    EXPECT_EQ(1, history.getNumSnapshots());
+    EXPECT_FALSE(history.take(1).has_value());
+
+    history.clear();
+    EXPECT_TRUE(juce::SharedResourcePointer<CyderTempJanitor>()->waitUntilIdle(5000));
+    EXPECT_FALSE(secondCopy.exists()); // retired with the history
+    EXPECT_TRUE(firstCopy.exists());   // taken, so no longer the history's to retire
+    firstCopy.deleteFile();
+}
+
+TEST(CyderBuildHistory, OldestBuildsAreRetiredToStayWithinLimits)
+{
+    CyderBuildHistory history;
+    const auto original = juce::File::getSpecialLocation(juce::File::tempDirectory).getChildFile("Fake.vst3");
+
+    history.setLimits(/*maxNumSnapshots*/ 2, CyderBuildHistory::defaultMemoryBudgetBytes);
+    const auto oldestCopy = createFakeCopy("oldest");
+    history.push(original, oldestCopy,                {}, makeState("a"));
+    history.push(original, createFakeCopy("middle"), {}, makeState("b"));
+    history.push(original, createFakeCopy("newest"), {}, makeState("c"));
+    EXPECT_EQ(2, history.getNumSnapshots());
+    EXPECT_TRUE(juce::SharedResourcePointer<CyderTempJanitor>()->waitUntilIdle(5000));
+    EXPECT_FALSE(oldestCopy.exists());
+
+    // Over the budget, only the most recent build is kept
+    history.setLimits(CyderBuildHistory::defaultMaxNumSnapshots, /*memoryBudgetBytes*/ 1);
+    EXPECT_EQ(1, history.getNumSnapshots());
+    EXPECT_EQ(history.getSnapshot(0)->sizeBytes, history.getTotalSizeBytes());
+}
@@ -0,0 +1,94 @@
+
+#include <gtest/gtest.h>
+
+#include <juce_audio_processors/juce_audio_processors.h>
+
+#include "../source/CyderChannelMap.hpp"
+
+//==============================================================================
+
+/** Bare processor with a main bus and a sidechain, standing in for the host side or the wrapped plugin. */
+class BusesProcessor final : public juce::AudioProcessor
+{
+public:
+    BusesProcessor(const juce::AudioChannelSet& main, const juce::AudioChannelSet& sidechain)
+    : juce::AudioProcessor(BusesProperties().withInput("Input", main, true)
+                                            .withInput("Sidechain", juce::AudioChannelSet::stereo(), true)
+                                            .withOutput("Output", main, true))
+    {
+        auto layout = getBusesLayout();
+        layout.inputBuses.getReference(1) = sidechain;
+        setBusesLayout(layout);
+    }
+
+    const juce::String getName() const override                    { return "Buses"; }
+    void prepareToPlay(double, int) override                       {}
+    void releaseResources() override                               {}
+    void processBlock(juce::AudioBuffer<float>&, juce::MidiBuffer&) override {}
+    double getTailLengthSeconds() const override                   { return 0.0; }
+    bool acceptsMidi() const override                              { return false; }
+    bool producesMidi() const override                             { return false; }
+    juce::AudioProcessorEditor* createEditor() override            { return nullptr; }
+    bool hasEditor() const override                                { return false; }
+    int getNumPrograms() override                                  { return 1; }
+    int getCurrentProgram() override                               { return 0; }
+    void setCurrentProgram(int) override                           {}
+    const juce::String getProgramName(int) override                { return {}; }
+    void changeProgramName(int, const juce::String&) override      {}
+    void getStateInformation(juce::MemoryBlock&) override          {}
+    void setStateInformation(const void*, int) override            {}
+};
+
+//==============================================================================
+
+TEST(CyderChannelMap, MatchingLayoutsPassHostBufferThrough)
+{
+    BusesProcessor host(juce::AudioChannelSet::create7point1point4(), juce::AudioChannelSet::stereo());
+    BusesProcessor wrapped(juce::AudioChannelSet::create7point1point4(), juce::AudioChannelSet::stereo());
+
+    CyderChannelMap channelMap;
+    channelMap.prepare(host, wrapped, 256);
+    EXPECT_TRUE(channelMap.isIdentity());
+
+    juce::AudioBuffer<float> buffer(14, 256);
+    EXPECT_EQ(&buffer, &channelMap.map(buffer));
+}
+
+TEST(CyderChannelMap, DifferentOrderRefersToHostChannelsWithoutCopying)
+{
+    // 5.1 is L R C LFE Ls Rs, quadraphonic is L R Ls Rs
+    BusesProcessor host(juce::AudioChannelSet::create5point1(), juce::AudioChannelSet::disabled());
+    BusesProcessor wrapped(juce::AudioChannelSet::quadraphonic(), juce::AudioChannelSet::disabled());
+
+    CyderChannelMap channelMap;
+    channelMap.prepare(host, wrapped, 256);
+    ASSERT_FALSE(channelMap.isIdentity());
+    EXPECT_EQ(0, channelMap.getHostChannel(0));
+    EXPECT_EQ(1, channelMap.getHostChannel(1));
+    EXPECT_EQ(4, channelMap.getHostChannel(2));
+    EXPECT_EQ(5, channelMap.getHostChannel(3));
+
+    juce::AudioBuffer<float> buffer(6, 256);
+    auto& mapped = channelMap.map(buffer);
+    ASSERT_EQ(4, mapped.getNumChannels());
+    EXPECT_EQ(buffer.getReadPointer(4), mapped.getReadPointer(2));
+    EXPECT_EQ(buffer.getReadPointer(5), mapped.getReadPointer(3));
+}
+
+TEST(CyderChannelMap, MissingSidechainIsSilent)
+{
+    BusesProcessor host(juce::AudioChannelSet::stereo(), juce::AudioChannelSet::disabled());
+    BusesProcessor wrapped(juce::AudioChannelSet::stereo(), juce::AudioChannelSet::stereo());
+
+    CyderChannelMap channelMap;
+    channelMap.prepare(host, wrapped, 256);
+    EXPECT_EQ(-1, channelMap.getHostChannel(2));
+    EXPECT_EQ(-1, channelMap.getHostChannel(3));
+
+    juce::AudioBuffer<float> buffer(2, 256);
+    auto& mapped = channelMap.map(buffer);
+    ASSERT_EQ(4, mapped.getNumChannels());
+    EXPECT_EQ(buffer.getReadPointer(0), mapped.getReadPointer(0));
+    EXPECT_NE(mapped.getReadPointer(2), mapped.getReadPointer(3)); // each gets its own silence
+    EXPECT_EQ(0.0f, mapped.getMagnitude(2, 0, 256));
+}
@@ -0,0 +1,61 @@
+
+#include <gtest/gtest.h>
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include "../source/CyderAssert.hpp"
+#include "../source/CyderDelayLine.hpp"
+
+#include <vector>
+
+//==============================================================================
+
+TEST(CyderDelayLineProcess, ImpulseIsDelayedAcrossBlocks)
+{
+    constexpr int blockSize = 64;
+    constexpr int delay     = 100; // longer than a block, so the impulse crosses a block boundary
+    
+    CyderDelayLine delayLine;
+    delayLine.prepare(/*numChannels*/2, /*maximumDelaySamples*/256, blockSize);
+    delayLine.setDelay(delay);
+    EXPECT_EQ(delay, delayLine.getDelay());
+    
+    juce::AudioBuffer<float> buffer(2, blockSize);
+    std::vector<float> output;
+    
+    for (int block = 0; block < 4; ++block)
+    {
+        buffer.clear();
+        if (block == 0)
+        {
+            buffer.setSample(0, 0, 1.0f);
+            buffer.setSample(1, 0, -1.0f);
+        }
+        
+        delayLine.process(buffer);
+        
+        for (int i = 0; i < blockSize; ++i)
+        {
+            output.push_back(buffer.getSample(0, i));
+            EXPECT_FLOAT_EQ(-buffer.getSample(0, i), buffer.getSample(1, i));
+        }
+    }
+    
+    for (size_t i = 0; i < output.size(); ++i)
+        EXPECT_FLOAT_EQ(i == static_cast<size_t>(delay) ? 1.0f : 0.0f, output[i]) << "sample " << i;
+}
+
+TEST(CyderDelayLineSetDelay, ClampedToMaximum)
+{
+    CyderDelayLine delayLine;
+    delayLine.prepare(/*numChannels*/1, /*maximumDelaySamples*/32, /*maximumBlockSize*/16);
+    
+    {
+        ScopedDisableCyderAssert disableAssert;
+        delayLine.setDelay(1000);
+    }
+    EXPECT_EQ(32, delayLine.getDelay());
+    
+    delayLine.setDelay(-5);
+    EXPECT_EQ(0, delayLine.getDelay());
+}
@@ -0,0 +1,84 @@
+
+#include <gtest/gtest.h>
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include "../source/CyderMidiState.hpp"
+
+//==============================================================================
+
+TEST(CyderMidiState, TracksHeldNotesAndSustain)
+{
+    CyderMidiState state;
+
+    juce::MidiBuffer midi;
+    midi.addEvent(juce::MidiMessage::noteOn(1, 60, (juce::uint8) 100), 0);
+    midi.addEvent(juce::MidiMessage::noteOn(1, 64, (juce::uint8) 90), 10);
+    midi.addEvent(juce::MidiMessage::controllerEvent(1, 64, 127), 20);
+    midi.addEvent(juce::MidiMessage::noteOff(1, 64), 30);
+    midi.addEvent(juce::MidiMessage::noteOn(2, 40, (juce::uint8) 80), 40);
+    midi.addEvent(juce::MidiMessage::noteOn(2, 40, (juce::uint8) 0), 50); // note-off in disguise
+    state.process(midi);
+
+    EXPECT_TRUE(state.isNoteHeld(1, 60));
+    EXPECT_FALSE(state.isNoteHeld(1, 64));
+    EXPECT_TRUE(state.isNoteSustained(1, 64));
+    EXPECT_TRUE(state.isSustainOn(1));
+    EXPECT_FALSE(state.isNoteHeld(2, 40));
+    EXPECT_EQ(2, state.getNumActiveNotes());
+
+    // Pedal up releases what it was holding
+    state.process(juce::MidiMessage::controllerEvent(1, 64, 0));
+    EXPECT_FALSE(state.isNoteSustained(1, 64));
+    EXPECT_EQ(1, state.getNumActiveNotes());
+
+    state.process(juce::MidiMessage::allNotesOff(1));
+    EXPECT_EQ(0, state.getNumActiveNotes());
+}
+
+TEST(CyderMidiState, SeedsFreshInstanceWithSameState)
+{
+    CyderMidiState state;
+    state.process(juce::MidiMessage::controllerEvent(3, 64, 127));
+    state.process(juce::MidiMessage::noteOn(3, 48, (juce::uint8) 70));
+    state.process(juce::MidiMessage::noteOn(3, 52, (juce::uint8) 60));
+    state.process(juce::MidiMessage::noteOff(3, 52));
+
+    juce::MidiBuffer seed;
+    seed.ensureSize(CyderMidiState::maxStateBytes);
+    state.addStateTo(seed, /*samplePosition*/ 0);
+
+    // A second tracker fed only the seed ends up in the same state
+    CyderMidiState fresh;
+    fresh.process(seed);
+    EXPECT_TRUE(fresh.isSustainOn(3));
+    EXPECT_TRUE(fresh.isNoteHeld(3, 48));
+    EXPECT_TRUE(fresh.isNoteSustained(3, 52));
+    EXPECT_EQ(state.getNumActiveNotes(), fresh.getNumActiveNotes());
+
+    for (const auto metadata : seed)
+        EXPECT_EQ(0, metadata.samplePosition);
+}
+
+TEST(CyderMidiState, WorstCaseSeedFitsPreallocatedSize)
+{
+    CyderMidiState state;
+    for (int channel = 1; channel <= 16; ++channel)
+    {
+        state.process(juce::MidiMessage::controllerEvent(channel, 64, 127));
+        for (int note = 0; note < 128; ++note)
+        {
+            state.process(juce::MidiMessage::noteOn(channel, note, (juce::uint8) 100));
+            if (note % 2 == 0)
+                state.process(juce::MidiMessage::noteOff(channel, note)); // sustained, costs a note-off too
+        }
+    }
+
+    juce::MidiBuffer seed;
+    seed.ensureSize(CyderMidiState::maxStateBytes);
+    const auto* storageBefore = seed.data.begin();
+    state.addStateTo(seed, 0);
+
+    EXPECT_EQ(storageBefore, seed.data.begin()); // never reallocated
+    EXPECT_LE(seed.getNumEvents(), CyderMidiState::maxNumStateEvents);
+}
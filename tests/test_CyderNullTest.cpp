@@ -0,0 +1,79 @@
+
+#include <gtest/gtest.h>
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_processors/juce_audio_processors.h>
+
+#include "../source/CyderAudioProcessor.hpp"
+#include "../source/CyderNullTest.hpp"
+
+//==============================================================================
+
+TEST(CyderNullTestCompare, ReportsDifferences)
+{
+    const auto signal = CyderNullTest::createTestSignal(/*numChannels*/2, /*sampleRate*/44100.0);
+    ASSERT_EQ(44100, signal.getNumSamples());
+    
+    // Identical signal is bit-exact
+    {
+        const auto result = CyderNullTest::compare(signal, signal);
+        EXPECT_TRUE(result.isBitExact);
+        EXPECT_EQ(0.0f, result.maxAbsDifference);
+        EXPECT_EQ(0.0f, result.rmsDifference);
+        EXPECT_EQ(2 * 44100, result.numSamplesCompared);
+    }
+    
+    // A single changed sample is caught
+    {
+        auto changed = signal;
+        changed.setSample(1, 1000, changed.getSample(1, 1000) + 0.125f);
+        
+        const auto result = CyderNullTest::compare(signal, changed);
+        EXPECT_FALSE(result.isBitExact);
+        EXPECT_FLOAT_EQ(0.125f, result.maxAbsDifference);
+        EXPECT_GT(result.rmsDifference, 0.0f);
+    }
+    
+    // Test signal is the same every time
+    EXPECT_TRUE(CyderNullTest::compare(signal, CyderNullTest::createTestSignal(2, 44100.0)).isBitExact);
+}
+
+TEST(CyderNullTestOnReload, SameBuildIsBitExact)
+{
+    CyderAudioProcessor cyderProcessor;
+    
+    constexpr auto numChannels = 2;
+    constexpr auto sampleRate  = 44100.0;
+    constexpr auto blocksize   = 1024;
+    cyderProcessor.setPlayConfigDetails(numChannels, numChannels, sampleRate, blocksize);
+    
+    juce::File currentFile(__FILE__);
+    // ExamplePlugin.vst3 must have already been built and copied into root directory
+    // so we can use it as a testable VST3
+    juce::File pluginFile = currentFile.getParentDirectory() // "tests"
+        .getParentDirectory() // root dir
+        .getChildFile("ExamplePlugin")
+        .withFileExtension("vst3");
+    
+    cyderProcessor.setNullTestOnReload(true);
+    
+    ASSERT_TRUE(cyderProcessor.loadPlugin(pluginFile.getFullPathName()));
+    EXPECT_FALSE(cyderProcessor.isNullTestRunning()); // nothing to compare against yet
+    
+    const auto previousCopy = cyderProcessor.getCurrentWrappedPluginPathCopy();
+    
+    // Reload
+    ASSERT_TRUE(cyderProcessor.loadPlugin(pluginFile.getFullPathName()));
+    EXPECT_TRUE(cyderProcessor.isNullTestRunning());
+    EXPECT_TRUE(previousCopy.exists()); // previous build still in use by the test
+    
+    for (int i = 0; i < 50 && cyderProcessor.isNullTestRunning(); ++i)
+        juce::MessageManager::getInstance()->runDispatchLoopUntil(100);
+    
+    ASSERT_FALSE(cyderProcessor.isNullTestRunning());
+    const auto result = cyderProcessor.getLastNullTestResult();
+    ASSERT_TRUE(result.has_value());
+    EXPECT_TRUE(result->isBitExact);
+    EXPECT_EQ(0.0f, result->maxAbsDifference);
+    EXPECT_EQ(cyderProcessor.getCurrentStatus(), CyderStatus::nullTestBitExact);
+}
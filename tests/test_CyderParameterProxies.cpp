@@ -0,0 +1,171 @@
+
+#include <gtest/gtest.h>
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <juce_core/juce_core.h>
+
+#include "../source/CyderParameterProxies.hpp"
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+//==============================================================================
+
+/** Bare processor with a few parameters, standing in for a wrapped plugin (or for Cyder, publishing the proxies). */
+class FakeProcessor final : public juce::AudioProcessor
+{
+public:
+    explicit FakeProcessor(const juce::StringArray& parameterIDs = {})
+    {
+        for (const auto& parameterID : parameterIDs)
+            addParameter(new juce::AudioParameterFloat(juce::ParameterID(parameterID, 1), parameterID, 0.0f, 1.0f, 0.5f));
+    }
+
+    juce::AudioProcessorParameter* getParameterWithID(const juce::String& parameterID) const
+    {
+        for (auto* parameter : getParameters())
+            if (CyderParameterProxies::getParameterID(*parameter) == parameterID)
+                return parameter;
+        return nullptr;
+    }
+
+    const juce::String getName() const override                    { return "Fake"; }
+    void prepareToPlay(double, int) override                       {}
+    void releaseResources() override                               {}
+    void processBlock(juce::AudioBuffer<float>&, juce::MidiBuffer&) override {}
+    double getTailLengthSeconds() const override                   { return 0.0; }
+    bool acceptsMidi() const override                              { return false; }
+    bool producesMidi() const override                             { return false; }
+    juce::AudioProcessorEditor* createEditor() override            { return nullptr; }
+    bool hasEditor() const override                                { return false; }
+    int getNumPrograms() override                                  { return 1; }
+    int getCurrentProgram() override                               { return 0; }
+    void setCurrentProgram(int) override                           {}
+    const juce::String getProgramName(int) override                { return {}; }
+    void changeProgramName(int, const juce::String&) override      {}
+    void getStateInformation(juce::MemoryBlock&) override          {}
+    void setStateInformation(const void*, int) override            {}
+};
+
+//==============================================================================
+
+TEST(CyderParameterProxies, PublishesFixedPoolToOwner)
+{
+    FakeProcessor owner;
+    CyderParameterProxies proxies(owner, owner.getCallbackLock());
+
+    EXPECT_EQ(CyderParameterProxies::numProxies, owner.getParameters().size());
+    EXPECT_EQ("Proxy 1", proxies.getProxy(0)->getName(32));
+}
+
+TEST(CyderParameterProxies, MapsFirstParametersOfNewPlugin)
+{
+    FakeProcessor owner;
+    CyderParameterProxies proxies(owner, owner.getCallbackLock());
+    FakeProcessor plugin({ "gain", "mix" });
+
+    proxies.setWrappedPlugin(&plugin);
+
+    EXPECT_EQ("gain", proxies.getMappedParameterID(0));
+    EXPECT_EQ("mix", proxies.getMappedParameterID(1));
+    EXPECT_TRUE(proxies.getMappedParameterID(2).isEmpty());
+    EXPECT_EQ("gain", proxies.getProxy(0)->getName(32));
+    EXPECT_FLOAT_EQ(0.5f, proxies.getProxy(0)->getValue()); // takes on the plugin's value
+}
+
+TEST(CyderParameterProxies, HostChangesReachPluginOnAudioThreadOnly)
+{
+    FakeProcessor owner;
+    CyderParameterProxies proxies(owner, owner.getCallbackLock());
+    FakeProcessor plugin({ "gain", "mix" });
+    proxies.setWrappedPlugin(&plugin);
+
+    proxies.getProxy(1)->setValue(0.1f);
+    proxies.getProxy(1)->setValue(0.2f); // coalesced, only the latest counts
+    EXPECT_FLOAT_EQ(0.5f, plugin.getParameterWithID("mix")->getValue());
+
+    proxies.processPendingHostChanges();
+    EXPECT_FLOAT_EQ(0.2f, plugin.getParameterWithID("mix")->getValue());
+    EXPECT_FLOAT_EQ(0.5f, plugin.getParameterWithID("gain")->getValue());
+}
+
+TEST(CyderParameterProxies, PluginChangesReachHostOnDispatchOnly)
+{
+    FakeProcessor owner;
+    CyderParameterProxies proxies(owner, owner.getCallbackLock());
+    FakeProcessor plugin({ "gain", "mix" });
+    proxies.setWrappedPlugin(&plugin);
+
+    proxies.parameterChangedByPlugin(/*parameterIndex*/ 0, 0.75f);
+    EXPECT_FLOAT_EQ(0.5f, proxies.getProxy(0)->getValue());
+
+    proxies.dispatchPendingPluginChanges();
+    EXPECT_FLOAT_EQ(0.75f, proxies.getProxy(0)->getValue());
+
+    // Not sent back to the plugin it came from
+    proxies.processPendingHostChanges();
+    EXPECT_FLOAT_EQ(0.5f, plugin.getParameterWithID("gain")->getValue());
+}
+
+TEST(CyderParameterProxies, PluginChangesFromOtherThreadsSurviveRemapping)
+{
+    FakeProcessor owner;
+    CyderParameterProxies proxies(owner, owner.getCallbackLock());
+    FakeProcessor plugin({ "gain", "mix", "drive" });
+    proxies.setWrappedPlugin(&plugin);
+    proxies.unmap(1);
+    proxies.unmap(2);
+
+    // The plugin reports from its own thread while the mapping keeps changing under it
+    std::atomic<bool> stop { false };
+    std::thread pluginThread([&]
+    {
+        for (int i = 0; ! stop.load(); ++i)
+        {
+            proxies.parameterChangedByPlugin(i % 3, static_cast<float>(i % 100) / 100.0f);
+            proxies.gestureChangedByPlugin(i % 3, (i & 1) == 0);
+        }
+    });
+
+    for (int i = 0; i < 500; ++i)
+        proxies.map(0, (i & 1) == 0 ? "mix" : "drive");
+
+    stop = true;
+    pluginThread.join();
+    proxies.dispatchPendingPluginChanges();
+
+    // Settles on the last mapping
+    proxies.parameterChangedByPlugin(/*parameterIndex*/ 2, 0.25f);
+    proxies.dispatchPendingPluginChanges();
+    EXPECT_EQ("drive", proxies.getMappedParameterID(0));
+    EXPECT_FLOAT_EQ(0.25f, proxies.getProxy(0)->getValue());
+}
+
+TEST(CyderParameterProxies, MappingFollowsParameterIDAcrossReloads)
+{
+    FakeProcessor owner;
+    CyderParameterProxies proxies(owner, owner.getCallbackLock());
+
+    auto firstBuild = std::make_unique<FakeProcessor>(juce::StringArray { "gain", "mix" });
+    proxies.setWrappedPlugin(firstBuild.get());
+    proxies.map(0, "mix");
+    proxies.unmap(1);
+
+    juce::XmlElement state("Cyder");
+    proxies.saveState(state);
+
+    // Next build adds a parameter in front, the mapping still finds "mix"
+    auto secondBuild = std::make_unique<FakeProcessor>(juce::StringArray { "drive", "gain", "mix" });
+    proxies.setWrappedPlugin(nullptr);
+    firstBuild.reset();
+    proxies.restoreState(state);
+    proxies.setWrappedPlugin(secondBuild.get());
+
+    EXPECT_EQ("mix", proxies.getMappedParameterID(0));
+    EXPECT_TRUE(proxies.getMappedParameterID(1).isEmpty());
+
+    proxies.getProxy(0)->setValue(0.9f);
+    proxies.processPendingHostChanges();
+    EXPECT_FLOAT_EQ(0.9f, secondBuild->getParameterWithID("mix")->getValue());
+}
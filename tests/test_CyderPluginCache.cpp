@@ -0,0 +1,90 @@
+
+#include <gtest/gtest.h>
+
+#include <juce_audio_processors/juce_audio_processors.h>
+
+#include "../source/CyderPluginCache.hpp"
+
+//==============================================================================
+
+/** A module file and a cache file of their own, deleted afterwards. */
+struct ScopedCacheFiles
+{
+    const juce::File directory = juce::File::getSpecialLocation(juce::File::tempDirectory)
+                                     .getChildFile("CyderPluginCacheTest_" + juce::Uuid().toString());
+    const juce::File module    = directory.getChildFile("Fake.so");
+    const juce::File cacheFile = directory.getChildFile("PluginCache.xml");
+
+    ScopedCacheFiles()  { directory.createDirectory(); module.replaceWithText("first build"); }
+    ~ScopedCacheFiles() { directory.deleteRecursively(); }
+};
+
+static juce::PluginDescription makeDescription(const juce::String& name, int uniqueId)
+{
+    juce::PluginDescription description;
+    description.name             = name;
+    description.pluginFormatName = "VST3";
+    description.fileOrIdentifier = "/somewhere/else/" + name + ".vst3";
+    description.uniqueId         = uniqueId;
+    description.deprecatedUid    = uniqueId;
+    return description;
+}
+
+//==============================================================================
+
+TEST(CyderPluginCache, StoredDescriptionIsFoundByLaterProcesses)
+{
+    ScopedCacheFiles files;
+    const auto key = CyderPluginCache::makeKey(files.module);
+    ASSERT_GT(key.moduleSize, 0);
+
+    {
+        CyderPluginCache cache(files.cacheFile);
+        EXPECT_FALSE(cache.find(key).has_value());
+        cache.store(key, makeDescription("Fake", 1234));
+    }
+    ASSERT_TRUE(files.cacheFile.existsAsFile());
+
+    // A fresh cache stands in for the next process
+    CyderPluginCache cache(files.cacheFile);
+    const auto found = cache.find(key);
+    ASSERT_TRUE(found.has_value());
+    EXPECT_EQ(juce::String("Fake"), found->name);
+    EXPECT_EQ(1234, found->uniqueId);
+}
+
+TEST(CyderPluginCache, RebuiltModuleIsNotFound)
+{
+    ScopedCacheFiles files;
+    const auto firstKey = CyderPluginCache::makeKey(files.module);
+
+    CyderPluginCache cache(files.cacheFile);
+    cache.store(firstKey, makeDescription("Fake", 1));
+
+    // Same size and timestamp, only the contents tell the builds apart
+    const auto modificationTime = files.module.getLastModificationTime();
+    files.module.replaceWithText("other build");
+    files.module.setLastModificationTime(modificationTime);
+
+    const auto secondKey = CyderPluginCache::makeKey(files.module);
+    EXPECT_EQ(firstKey.moduleSize, secondKey.moduleSize);
+    EXPECT_NE(firstKey.moduleHash, secondKey.moduleHash);
+    EXPECT_FALSE(cache.find(secondKey).has_value());
+}
+
+TEST(CyderPluginCache, WhatOthersStoredIsKeptWhenSaving)
+{
+    ScopedCacheFiles files;
+    const auto otherModule = files.directory.getChildFile("Other.so");
+    otherModule.replaceWithText("another plugin");
+
+    CyderPluginCache first(files.cacheFile);
+    CyderPluginCache second(files.cacheFile);
+    first.store(CyderPluginCache::makeKey(files.module), makeDescription("Fake", 1));
+    second.store(CyderPluginCache::makeKey(otherModule), makeDescription("Other", 2));
+
+    CyderPluginCache third(files.cacheFile);
+    EXPECT_TRUE(third.find(CyderPluginCache::makeKey(files.module)).has_value());
+    EXPECT_TRUE(third.find(CyderPluginCache::makeKey(otherModule)).has_value());
+    EXPECT_EQ(2, third.getNumEntries());
+}
@@ -0,0 +1,182 @@
+
+#include <gtest/gtest.h>
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_processors/juce_audio_processors.h>
+
+#include "../source/CyderAudioProcessor.hpp"
+#include "../source/CyderPluginChain.hpp"
+
+#include <gtest/gtest.h>
+
+//==============================================================================
+
+TEST(CyderPluginChainAppendPlugin, PluginsAreAppendedInOrder)
+{
+    juce::CriticalSection callbackLock;
+    CyderPluginChain chain(callbackLock);
+    chain.prepareToPlay(/*numChannels*/2, /*sampleRate*/44100.0, /*samplesPerBlock*/512);
+    
+    juce::File currentFile(__FILE__);
+    // ExamplePlugin.vst3 must have already been built and copied into root directory
+    // so we can use it as a testable VST3
+    juce::File pluginFile = currentFile.getParentDirectory() // "tests"
+                                       .getParentDirectory() // root dir
+                                       .getChildFile("ExamplePlugin")
+                                       .withFileExtension("vst3");
+    
+    ASSERT_TRUE(chain.isEmpty());
+    ASSERT_TRUE(chain.appendPlugin(pluginFile));
+    ASSERT_TRUE(chain.appendPlugin(pluginFile));
+    ASSERT_EQ(2, chain.getNumPlugins());
+    
+    // Every plugin gets its own copy and its own watcher
+    EXPECT_NE(chain.getPluginFileCopy(0), chain.getPluginFileCopy(1));
+    EXPECT_TRUE(chain.getHotReloadThread(0) != nullptr);
+    EXPECT_TRUE(chain.getHotReloadThread(1) != nullptr);
+    EXPECT_NE(chain.getHotReloadThread(0), chain.getHotReloadThread(1));
+    
+    // Processing happens in place on the given buffer
+    juce::AudioBuffer<float> buffer(2, 512);
+    buffer.clear();
+    juce::MidiBuffer midi;
+    chain.processBlock(buffer, midi);
+    EXPECT_EQ(2, buffer.getNumChannels());
+    
+    chain.removePlugin(0);
+    EXPECT_EQ(1, chain.getNumPlugins());
+    
+    chain.clear();
+    EXPECT_TRUE(chain.isEmpty());
+}
+
+TEST(CyderPluginChainReloadPlugin, StateSurvivesReload)
+{
+    juce::CriticalSection callbackLock;
+    CyderPluginChain chain(callbackLock);
+    
+    juce::File currentFile(__FILE__);
+    // ExamplePlugin.vst3 must have already been built and copied into root directory
+    // so we can use it as a testable VST3
+    juce::File pluginFile = currentFile.getParentDirectory() // "tests"
+                                       .getParentDirectory() // root dir
+                                       .getChildFile("ExamplePlugin")
+                                       .withFileExtension("vst3");
+    
+    ASSERT_TRUE(chain.appendPlugin(pluginFile));
+    
+    juce::MemoryBlock stateBeforeReload;
+    {
+        juce::XmlElement pluginStateXml("ExamplePluginState");
+        pluginStateXml.setAttribute("gain", 0.25f);
+        juce::MemoryBlock rawState;
+        juce::AudioProcessor::copyXmlToBinary(pluginStateXml, rawState);
+        chain.getPlugin(0)->setStateInformation(rawState.getData(), static_cast<int>(rawState.getSize()));
+        chain.getPlugin(0)->getStateInformation(stateBeforeReload);
+    }
+    
+    const auto copyBeforeReload = chain.getPluginFileCopy(0);
+    ASSERT_TRUE(chain.reloadPlugin(0));
+    EXPECT_NE(copyBeforeReload, chain.getPluginFileCopy(0));
+    
+    juce::MemoryBlock stateAfterReload;
+    chain.getPlugin(0)->getStateInformation(stateAfterReload);
+    EXPECT_TRUE(stateBeforeReload == stateAfterReload);
+}
+
+TEST(CyderPluginChainGetTotalLatencySamples, LatencySummedIntoCyder)
+{
+    CyderAudioProcessor cyderProcessor;
+    
+    constexpr auto numChannels = 2;
+    constexpr auto sampleRate  = 44100.0;
+    constexpr auto blocksize   = 1024;
+    cyderProcessor.setPlayConfigDetails(numChannels, numChannels, sampleRate, blocksize);
+    
+    juce::File currentFile(__FILE__);
+    // ExamplePlugin.vst3 must have already been built and copied into root directory
+    // so we can use it as a testable VST3
+    juce::File pluginFile = currentFile.getParentDirectory() // "tests"
+                                       .getParentDirectory() // root dir
+                                       .getChildFile("ExamplePlugin")
+                                       .withFileExtension("vst3");
+    
+    ASSERT_TRUE(cyderProcessor.loadPlugin(pluginFile.getFullPathName()));
+    
+    auto& chain = cyderProcessor.getPluginChain();
+    ASSERT_TRUE(chain.appendPlugin(pluginFile));
+    ASSERT_TRUE(chain.appendPlugin(pluginFile));
+    
+    cyderProcessor.getWrappedPluginProcessor()->setLatencySamples(100);
+    chain.getPlugin(0)->setLatencySamples(20);
+    chain.getPlugin(1)->setLatencySamples(3);
+    
+    EXPECT_EQ(23, chain.getTotalLatencySamples());
+    EXPECT_EQ(123, cyderProcessor.getLatencySamples());
+    
+    chain.removePlugin(1);
+    EXPECT_EQ(120, cyderProcessor.getLatencySamples());
+}
+
+TEST(CyderPluginChainAppendPlugin, ScansSharedWithPluginLoader)
+{
+    juce::CriticalSection callbackLock;
+    CyderPluginChain chain(callbackLock);
+    juce::SharedResourcePointer<CyderPluginLoader> pluginLoader;
+    
+    juce::File currentFile(__FILE__);
+    // ExamplePlugin.vst3 must have already been built and copied into root directory
+    // so we can use it as a testable VST3
+    juce::File pluginFile = currentFile.getParentDirectory() // "tests"
+                                       .getParentDirectory() // root dir
+                                       .getChildFile("ExamplePlugin")
+                                       .withFileExtension("vst3");
+    
+    const auto numScansBefore = pluginLoader->getNumScansPerformed();
+    ASSERT_TRUE(chain.appendPlugin(pluginFile));
+    ASSERT_TRUE(chain.appendPlugin(pluginFile));
+    ASSERT_TRUE(chain.reloadPlugin(0));
+    
+    // Same build every time, so scanned once at most (not at all if it was cached already)
+    EXPECT_LE(pluginLoader->getNumScansPerformed() - numScansBefore, 1);
+}
+
+TEST(CyderPluginChainRestoreState, PluginsRestoredInBackground)
+{
+    juce::CriticalSection callbackLock;
+    CyderPluginChain chain(callbackLock);
+    
+    juce::File currentFile(__FILE__);
+    // ExamplePlugin.vst3 must have already been built and copied into root directory
+    // so we can use it as a testable VST3
+    juce::File pluginFile = currentFile.getParentDirectory() // "tests"
+                                       .getParentDirectory() // root dir
+                                       .getChildFile("ExamplePlugin")
+                                       .withFileExtension("vst3");
+    
+    ASSERT_TRUE(chain.appendPlugin(pluginFile));
+    ASSERT_TRUE(chain.appendPlugin(pluginFile));
+    
+    juce::XmlElement savedState("Cyder");
+    chain.saveState(savedState);
+    
+    // Returns right away, passing audio through until every plugin is in
+    chain.restoreState(savedState);
+    EXPECT_TRUE(chain.isRestoringState());
+    EXPECT_TRUE(chain.isEmpty());
+    
+    // Saving in the meantime keeps what was restored
+    {
+        juce::XmlElement stateWhileRestoring("Cyder");
+        chain.saveState(stateWhileRestoring);
+        EXPECT_TRUE(stateWhileRestoring.isEquivalentTo(&savedState, false));
+    }
+    
+    for (int attempt = 0; attempt < 100 && chain.isRestoringState(); ++attempt)
+        juce::MessageManager::getInstance()->runDispatchLoopUntil(50);
+    
+    ASSERT_FALSE(chain.isRestoringState());
+    ASSERT_EQ(2, chain.getNumPlugins());
+    EXPECT_TRUE(chain.getPluginFileOriginal(0) == pluginFile);
+    EXPECT_TRUE(chain.getPluginFileOriginal(1) == pluginFile);
+}
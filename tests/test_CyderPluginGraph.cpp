@@ -0,0 +1,150 @@
+
+#include <gtest/gtest.h>
+
+#include <juce_core/juce_core.h>
+#include <juce_audio_processors/juce_audio_processors.h>
+
+#include "../source/CyderAudioProcessor.hpp"
+#include "../source/CyderPluginGraph.hpp"
+
+//==============================================================================
+
+TEST(CyderPluginGraphProcessBlock, BranchesAreLatencyCompensatedAndMixed)
+{
+    constexpr int numChannels = 2;
+    constexpr int blockSize   = 128;
+    constexpr int latency     = 64;
+    
+    juce::CriticalSection callbackLock;
+    CyderPluginGraph graph(callbackLock);
+    graph.prepareToPlay(numChannels, /*sampleRate*/44100.0, blockSize);
+    
+    juce::File currentFile(__FILE__);
+    // ExamplePlugin.vst3 must have already been built and copied into root directory
+    // so we can use it as a testable VST3
+    juce::File pluginFile = currentFile.getParentDirectory() // "tests"
+                                       .getParentDirectory() // root dir
+                                       .getChildFile("ExamplePlugin")
+                                       .withFileExtension("vst3");
+    
+    // Dry branch alongside a branch hosting a (pass-through) plugin that reports latency
+    const auto dryBranch = graph.addBranch();
+    const auto wetBranch = graph.addBranch();
+    ASSERT_EQ(0, dryBranch);
+    ASSERT_EQ(1, wetBranch);
+    ASSERT_TRUE(graph.getBranch(wetBranch).appendPlugin(pluginFile));
+    graph.getBranch(wetBranch).getPlugin(0)->setLatencySamples(latency);
+    
+    graph.setBranchGain(dryBranch, 0.5f);
+    graph.setBranchGain(wetBranch, 0.5f);
+    
+    EXPECT_EQ(latency, graph.getLatencySamples());
+    EXPECT_EQ(latency, graph.getCompensationDelaySamples(dryBranch));
+    EXPECT_EQ(0, graph.getCompensationDelaySamples(wetBranch));
+    
+    juce::AudioBuffer<float> buffer(numChannels, blockSize);
+    buffer.clear();
+    buffer.setSample(0, 0, 1.0f);
+    buffer.setSample(1, 0, 1.0f);
+    juce::MidiBuffer midi;
+    graph.processBlock(buffer, midi);
+    
+    // Both halves of the impulse arrive together, delayed by the slowest branch
+    for (int channel = 0; channel < numChannels; ++channel)
+        for (int i = 0; i < blockSize; ++i)
+            EXPECT_FLOAT_EQ(i == latency ? 1.0f : 0.0f, buffer.getSample(channel, i)) << "sample " << i;
+}
+
+TEST(CyderPluginGraphProcessBlock, BlocksLargerThanPreparedAreProcessedInChunks)
+{
+    constexpr int numChannels = 2;
+    constexpr int blockSize   = 128;
+    
+    juce::CriticalSection callbackLock;
+    CyderPluginGraph graph(callbackLock);
+    graph.prepareToPlay(numChannels, /*sampleRate*/44100.0, blockSize);
+    ASSERT_EQ(0, graph.addBranch());
+    ASSERT_EQ(1, graph.addBranch());
+    graph.setBranchGain(0, 0.25f);
+    graph.setBranchGain(1, 0.25f);
+    
+    // Two and a half times what the host prepared us for
+    constexpr int numSamples = blockSize * 5 / 2;
+    juce::AudioBuffer<float> buffer(numChannels, numSamples);
+    for (int channel = 0; channel < numChannels; ++channel)
+        for (int i = 0; i < numSamples; ++i)
+            buffer.setSample(channel, i, 1.0f);
+    juce::MidiBuffer midi;
+    
+    graph.processBlock(buffer, midi);
+    
+    // Every sample mixed, not only those of the first block
+    for (int channel = 0; channel < numChannels; ++channel)
+        for (int i = 0; i < numSamples; ++i)
+            EXPECT_FLOAT_EQ(0.5f, buffer.getSample(channel, i)) << "sample " << i;
+}
+
+TEST(CyderPluginGraphProcessBlock, MidiBeyondBranchReserveIsDropped)
+{
+    constexpr int numChannels = 2;
+    constexpr int blockSize   = 128;
+    
+    juce::CriticalSection callbackLock;
+    CyderPluginGraph graph(callbackLock);
+    graph.prepareToPlay(numChannels, /*sampleRate*/44100.0, blockSize);
+    ASSERT_EQ(0, graph.addBranch());
+    ASSERT_EQ(1, graph.addBranch());
+    
+    juce::AudioBuffer<float> buffer(numChannels, blockSize);
+    buffer.clear();
+    
+    // A sparse block fits
+    juce::MidiBuffer midi;
+    midi.addEvent(juce::MidiMessage::noteOn(1, 60, 0.5f), 0);
+    graph.processBlock(buffer, midi);
+    EXPECT_EQ(0u, graph.getNumDroppedMidiEvents());
+    
+    // Far more than a branch has room for, 9 bytes each
+    for (int i = 0; i < 1000; ++i)
+        midi.addEvent(juce::MidiMessage::controllerEvent(1, 1, i % 128), i % blockSize);
+    graph.processBlock(buffer, midi);
+    EXPECT_GT(graph.getNumDroppedMidiEvents(), 0u);
+    EXPECT_LT(graph.getNumDroppedMidiEvents(), 2u * 1001u); // whatever fit was kept
+}
+
+TEST(CyderPluginGraphGetLatencySamples, LatencyAddedToCyder)
+{
+    CyderAudioProcessor cyderProcessor;
+    
+    constexpr auto numChannels = 2;
+    constexpr auto sampleRate  = 44100.0;
+    constexpr auto blocksize   = 1024;
+    cyderProcessor.setPlayConfigDetails(numChannels, numChannels, sampleRate, blocksize);
+    cyderProcessor.prepareToPlay(sampleRate, blocksize);
+    
+    juce::File currentFile(__FILE__);
+    // ExamplePlugin.vst3 must have already been built and copied into root directory
+    // so we can use it as a testable VST3
+    juce::File pluginFile = currentFile.getParentDirectory() // "tests"
+                                       .getParentDirectory() // root dir
+                                       .getChildFile("ExamplePlugin")
+                                       .withFileExtension("vst3");
+    
+    auto& graph = cyderProcessor.getPluginGraph();
+    const auto branchA = graph.addBranch();
+    const auto branchB = graph.addBranch();
+    ASSERT_TRUE(graph.getBranch(branchA).appendPlugin(pluginFile));
+    ASSERT_TRUE(graph.getBranch(branchB).appendPlugin(pluginFile));
+    
+    graph.getBranch(branchA).getPlugin(0)->setLatencySamples(10);
+    graph.getBranch(branchB).getPlugin(0)->setLatencySamples(30);
+    
+    // Parallel branches cost only the slowest of them
+    EXPECT_EQ(30, cyderProcessor.getLatencySamples());
+    EXPECT_EQ(20, graph.getCompensationDelaySamples(branchA));
+    
+    graph.removeBranch(branchB);
+    EXPECT_EQ(10, cyderProcessor.getLatencySamples());
+    
+    cyderProcessor.releaseResources();
+}
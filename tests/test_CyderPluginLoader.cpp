@@ -0,0 +1,85 @@
+
+#include <gtest/gtest.h>
+
+#include <juce_audio_processors/juce_audio_processors.h>
+
+#include "../source/CyderAssert.hpp"
+#include "../source/CyderPluginLoader.hpp"
+#include "../source/Utilities.hpp"
+
+#include <optional>
+#include <vector>
+
+//==============================================================================
+
+static juce::File getExamplePluginFile()
+{
+    // ExamplePlugin.vst3 must have already been built and copied into root directory
+    // so we can use it as a testable VST3
+    return juce::File(__FILE__).getParentDirectory() // "tests"
+                               .getParentDirectory() // root dir
+                               .getChildFile("ExamplePlugin")
+                               .withFileExtension("vst3");
+}
+
+//==============================================================================
+
+TEST(CyderPluginLoader, SamePluginIsScannedOnceButCopiedForEach)
+{
+    juce::SharedResourcePointer<CyderPluginLoader> loader;
+    const auto pluginFile = getExamplePluginFile();
+
+    std::vector<CyderPluginLoader::PreparedPlugin> results;
+    for (int i = 0; i < 3; ++i)
+        loader->prepareAsync(pluginFile, [&results](CyderPluginLoader::PreparedPlugin prepared)
+        {
+            EXPECT_TRUE(juce::MessageManager::getInstance()->isThisTheMessageThread());
+            results.push_back(std::move(prepared));
+        });
+
+    for (int attempt = 0; attempt < 100 && results.size() < 3; ++attempt)
+        juce::MessageManager::getInstance()->runDispatchLoopUntil(50);
+    ASSERT_EQ(3u, results.size());
+
+    // A later load of the same build shares the scan too
+    const auto scansBefore = loader->getNumScansPerformed();
+    results.push_back(loader->prepare(pluginFile));
+    EXPECT_EQ(scansBefore, loader->getNumScansPerformed());
+
+    for (const auto& prepared : results)
+    {
+        ASSERT_TRUE(prepared.wasSuccessful());
+        EXPECT_TRUE(prepared.originalFile == pluginFile);
+        EXPECT_TRUE(prepared.copiedPlugin.exists());
+        EXPECT_EQ(prepared.copiedPlugin.getFullPathName(), prepared.description.fileOrIdentifier);
+        EXPECT_EQ(results.front().description.uniqueId, prepared.description.uniqueId);
+    }
+    EXPECT_NE(results[0].copiedPlugin, results[1].copiedPlugin);
+    EXPECT_NE(results[1].copiedPlugin, results[2].copiedPlugin);
+
+    for (const auto& prepared : results)
+        Utilities::deleteStalePlugin(prepared.copiedPlugin);
+}
+
+TEST(CyderPluginLoader, FailureIsReportedOnMessageThread)
+{
+    ScopedDisableCyderAssert disableAsserts;
+    juce::SharedResourcePointer<CyderPluginLoader> loader;
+    const auto missingFile = getExamplePluginFile().getSiblingFile("DoesNotExist.vst3");
+
+    std::optional<CyderPluginLoader::PreparedPlugin> result;
+    loader->prepareAsync(missingFile, [&result](CyderPluginLoader::PreparedPlugin prepared)
+    {
+        result = std::move(prepared);
+    });
+
+    for (int attempt = 0; attempt < 100 && ! result.has_value(); ++attempt)
+        juce::MessageManager::getInstance()->runDispatchLoopUntil(50);
+    ASSERT_TRUE(result.has_value());
+
+    EXPECT_FALSE(result->wasSuccessful());
+    EXPECT_TRUE(result->originalFile == missingFile);
+    EXPECT_TRUE(result->copiedPlugin == juce::File());
+
+    EXPECT_THROW((void) loader->prepare(missingFile), std::runtime_error);
+}
@@ -0,0 +1,202 @@
+
+#include <gtest/gtest.h>
+
+#include <juce_audio_processors/juce_audio_processors.h>
+
+#include "../source/CyderAudioProcessor.hpp"
+#include "../source/CyderProcessBridge.hpp"
+#include "../source/CyderTempJanitor.hpp"
+#include "../source/Utilities.hpp"
+
+#include <cmath>
+
+#if JUCE_LINUX
+#include <csignal>
+#endif
+
+//==============================================================================
+
+static juce::File getExamplePlugin()
+{
+    // ExamplePlugin.vst3 must have already been built and copied into root directory
+    return juce::File(__FILE__).getParentDirectory() // "tests"
+                               .getParentDirectory() // root dir
+                               .getChildFile("ExamplePlugin")
+                               .withFileExtension("vst3");
+}
+
+static void fillWithSine(juce::AudioBuffer<float>& buffer)
+{
+    for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+        for (int i = 0; i < buffer.getNumSamples(); ++i)
+            buffer.setSample(ch, i, std::sin(0.01f * static_cast<float>(i + ch)));
+}
+
+/** Gives a freshly (re)launched child a few tries, it is given a whole block's worth of time only once warm. */
+static bool processWithinTries(CyderProcessBridge& bridge, juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midi)
+{
+    for (int attempt = 0; attempt < 100; ++attempt)
+    {
+        if (bridge.process(buffer, midi))
+            return true;
+        juce::Thread::sleep(10);
+    }
+    return false;
+}
+
+//==============================================================================
+
+TEST(CyderProcessBridge, ProcessesInChildProcess)
+{
+    if (! CyderProcessBridge::isSupported())
+        GTEST_SKIP() << "Out-of-process hosting is not supported on this platform";
+
+    CyderProcessBridge bridge;
+    bridge.setDeadlineFraction(100.0); // a loaded CI machine shouldn't fail us
+    ASSERT_TRUE(bridge.start(getExamplePlugin(), /*numChannels*/ 2, /*sampleRate*/ 44100.0, /*maxBlockSize*/ 512));
+    EXPECT_TRUE(bridge.isRunning());
+    EXPECT_GT(bridge.getHostProcessId(), 0);
+
+    juce::AudioBuffer<float> buffer(2, 512);
+    fillWithSine(buffer);
+    juce::AudioBuffer<float> expected(buffer);
+    juce::MidiBuffer midi;
+
+    ASSERT_TRUE(processWithinTries(bridge, buffer, midi));
+    for (int ch = 0; ch < 2; ++ch)
+        for (int i = 0; i < 512; ++i)
+            ASSERT_EQ(expected.getSample(ch, i), buffer.getSample(ch, i)); // ExamplePlugin passes audio through
+
+    // State comes out of the child and goes back in
+    juce::MemoryBlock state;
+    ASSERT_TRUE(bridge.getState(state));
+    ASSERT_TRUE(bridge.setState(state));
+    juce::MemoryBlock roundTripped;
+    ASSERT_TRUE(bridge.getState(roundTripped));
+    EXPECT_TRUE(roundTripped == state);
+
+    // Blocks larger than the child was prepared for are left as they are
+    juce::AudioBuffer<float> tooLarge(2, 1024);
+    EXPECT_FALSE(bridge.process(tooLarge, midi));
+}
+
+TEST(CyderProcessBridge, RelaunchesChildAfterCrash)
+{
+    if (! CyderProcessBridge::isSupported())
+        GTEST_SKIP() << "Out-of-process hosting is not supported on this platform";
+
+   #if JUCE_LINUX
+    CyderProcessBridge bridge;
+    bridge.setDeadlineFraction(100.0);
+    ASSERT_TRUE(bridge.start(getExamplePlugin(), /*numChannels*/ 2, /*sampleRate*/ 44100.0, /*maxBlockSize*/ 512));
+
+    juce::MemoryBlock state;
+    ASSERT_TRUE(bridge.getState(state)); // what it is relaunched with
+
+    const auto crashedProcessId = bridge.getHostProcessId();
+    ASSERT_GT(crashedProcessId, 0);
+    ::kill(crashedProcessId, SIGKILL);
+
+    // Audio is left dry until the child is back
+    juce::AudioBuffer<float> buffer(2, 512);
+    juce::MidiBuffer midi;
+    EXPECT_FALSE(bridge.process(buffer, midi));
+    for (int i = 0; i < 500 && bridge.getNumCrashes() == 0; ++i)
+        juce::Thread::sleep(10);
+
+    // A host saving while the child is relaunched gets the state it is relaunched with, without waiting for it
+    {
+        juce::MemoryBlock stateWhileRelaunching;
+        const auto startMs = juce::Time::getMillisecondCounter();
+        ASSERT_TRUE(bridge.getState(stateWhileRelaunching));
+        EXPECT_LT(juce::Time::getMillisecondCounter() - startMs, 1000u);
+        EXPECT_TRUE(stateWhileRelaunching == state);
+    }
+
+    for (int i = 0; i < 500 && ! bridge.isRunning(); ++i)
+        juce::Thread::sleep(10);
+
+    EXPECT_EQ(1, bridge.getNumCrashes());
+    ASSERT_TRUE(bridge.isRunning());
+    EXPECT_NE(crashedProcessId, bridge.getHostProcessId());
+    EXPECT_TRUE(processWithinTries(bridge, buffer, midi));
+
+    // Relaunched with the state it had
+    juce::MemoryBlock restored;
+    ASSERT_TRUE(bridge.getState(restored));
+    EXPECT_TRUE(restored == state);
+   #endif
+}
+
+TEST(CyderAudioProcessorOutOfProcess, HostsWrappedPluginInChildProcess)
+{
+    if (! CyderProcessBridge::isSupported())
+        GTEST_SKIP() << "Out-of-process hosting is not supported on this platform";
+
+    CyderAudioProcessor cyderProcessor;
+    ASSERT_TRUE(cyderProcessor.setOutOfProcessHosting(true));
+    ASSERT_TRUE(cyderProcessor.loadPlugin(getExamplePlugin().getFullPathName()));
+
+    EXPECT_TRUE(cyderProcessor.getWrappedPluginProcessor() == nullptr);
+    ASSERT_TRUE(cyderProcessor.getProcessBridge() != nullptr);
+    EXPECT_TRUE(cyderProcessor.getProcessBridge()->isRunning());
+
+    // Switching back reloads it in process
+    ASSERT_TRUE(cyderProcessor.setOutOfProcessHosting(false));
+    EXPECT_TRUE(cyderProcessor.getProcessBridge() == nullptr);
+    EXPECT_TRUE(cyderProcessor.getWrappedPluginProcessor() != nullptr);
+
+    // The mode is saved with our state
+    ASSERT_TRUE(cyderProcessor.setOutOfProcessHosting(true));
+    juce::MemoryBlock saved;
+    cyderProcessor.getStateInformation(saved);
+    EXPECT_TRUE(saved.toString().contains("outOfProcessHosting"));
+}
+
+TEST(CyderAudioProcessorOutOfProcess, HostsPluginStagedInDefaultLocation)
+{
+    if (! CyderProcessBridge::isSupported())
+        GTEST_SKIP() << "Out-of-process hosting is not supported on this platform";
+
+    // Memory on Linux, where a staged module is only a /proc/self/fd link the child can't follow
+    juce::SharedResourcePointer<CyderTempJanitor> janitor;
+    const auto previousLocation = janitor->getStagingLocation();
+    janitor->setStagingLocation(CyderTempJanitor::defaultStagingLocation);
+
+    CyderAudioProcessor cyderProcessor;
+    ASSERT_TRUE(cyderProcessor.setOutOfProcessHosting(true));
+    ASSERT_TRUE(cyderProcessor.loadPlugin(getExamplePlugin().getFullPathName()));
+    ASSERT_TRUE(cyderProcessor.getProcessBridge() != nullptr);
+    EXPECT_TRUE(cyderProcessor.getProcessBridge()->isRunning());
+    EXPECT_FALSE(Utilities::isStagedInMemory(cyderProcessor.getCurrentWrappedPluginPathCopy()));
+
+    cyderProcessor.getProcessBridge()->setDeadlineFraction(100.0);
+    juce::AudioBuffer<float> buffer(2, 512);
+    fillWithSine(buffer);
+    juce::MidiBuffer midi;
+    EXPECT_TRUE(processWithinTries(*cyderProcessor.getProcessBridge(), buffer, midi));
+
+    // Switching from a copy loaded in process, which may well be staged in memory
+    ASSERT_TRUE(cyderProcessor.setOutOfProcessHosting(false));
+    ASSERT_TRUE(cyderProcessor.setOutOfProcessHosting(true));
+    ASSERT_TRUE(cyderProcessor.getProcessBridge() != nullptr);
+    EXPECT_TRUE(cyderProcessor.getProcessBridge()->isRunning());
+    EXPECT_FALSE(Utilities::isStagedInMemory(cyderProcessor.getCurrentWrappedPluginPathCopy()));
+
+   #if JUCE_LINUX
+    // A copy already staged in memory, e.g. one kept for rolling back to, is staged again for the child
+    const auto stagedInMemory = Utilities::stagePluginInMemory(getExamplePlugin());
+    EXPECT_TRUE(Utilities::isStagedInMemory(stagedInMemory));
+    const auto restaged = Utilities::copyPluginToTemp(stagedInMemory, /*forOtherProcesses*/ true);
+    EXPECT_FALSE(Utilities::isStagedInMemory(restaged));
+
+    CyderProcessBridge bridge;
+    EXPECT_TRUE(bridge.start(restaged, /*numChannels*/ 2, /*sampleRate*/ 44100.0, /*maxBlockSize*/ 512));
+    bridge.stop();
+
+    Utilities::deleteStalePlugin(stagedInMemory);
+    Utilities::deleteStalePlugin(restaged);
+   #endif
+
+    janitor->setStagingLocation(previousLocation);
+}
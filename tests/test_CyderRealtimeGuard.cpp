@@ -0,0 +1,88 @@
+
+#include <gtest/gtest.h>
+
+#include <juce_core/juce_core.h>
+
+#include "../source/CyderRealtimeGuard.hpp"
+#include "../source/CyderWorkerPool.hpp"
+
+#include <cstdlib>
+#include <mutex>
+
+//==============================================================================
+
+TEST(CyderRealtimeGuardEndBlock, ViolationsCountedAgainstCurrentScope)
+{
+    CyderRealtimeGuard guard;
+    std::mutex mutex;
+    
+    {
+        const CyderRealtimeGuard::ScopedBlock block(guard);
+        
+        // Wrapper is clean
+        
+        const CyderRealtimeGuard::ScopedScope scope(guard, CyderRealtimeGuard::Scope::wrappedPlugin);
+        void* volatile allocation = std::malloc(64); // volatile so the pair can't be optimised out
+        std::free(allocation);
+        const std::lock_guard<std::mutex> lock(mutex);
+    }
+    
+    // Outside of a block, nothing counts
+    void* volatile allocation = std::malloc(64);
+    std::free(allocation);
+    
+    const auto wrappedReport = guard.getReport(CyderRealtimeGuard::Scope::wrappedPlugin);
+    const auto wrapperReport = guard.getReport(CyderRealtimeGuard::Scope::wrapper);
+    
+    EXPECT_EQ(0u, wrapperReport.getTotal());
+    
+    if (! guard.isActive()) // Cyder_RealtimeGuard not preloaded, or not enabled in this build
+    {
+        EXPECT_EQ(0u, wrappedReport.getTotal());
+        EXPECT_EQ(0u, guard.getTotalViolations());
+        return;
+    }
+    
+    EXPECT_EQ(1u, wrappedReport.allocations);
+    EXPECT_EQ(1u, wrappedReport.deallocations);
+    EXPECT_EQ(1u, wrappedReport.locks);
+    EXPECT_EQ(1u, wrappedReport.blocksWithViolations);
+    EXPECT_TRUE(wrappedReport.lastBacktrace.isNotEmpty());
+    EXPECT_EQ(3u, guard.getTotalViolations());
+    
+    guard.reset();
+    EXPECT_EQ(0u, guard.getTotalViolations());
+}
+
+TEST(CyderRealtimeGuardEndBlock, WorkerThreadViolationsCounted)
+{
+    CyderRealtimeGuard guard;
+    CyderWorkerPool pool(/*numWorkers*/3, &guard);
+    
+    // Each task allocates once, on whichever thread ends up running it
+    constexpr int numTasks = 8;
+    const CyderWorkerPool::Task task = [&guard](int)
+    {
+        const CyderRealtimeGuard::ScopedScope scope(guard, CyderRealtimeGuard::Scope::wrappedPlugin);
+        void* volatile allocation = std::malloc(64);
+        std::free(allocation);
+    };
+    
+    {
+        const CyderRealtimeGuard::ScopedBlock block(guard);
+        pool.run(numTasks, task);
+    }
+    
+    if (! guard.isActive()) // Cyder_RealtimeGuard not preloaded, or not enabled in this build
+    {
+        EXPECT_EQ(0u, guard.getTotalViolations());
+        return;
+    }
+    
+    // Workers finish their own blocks just after the batch, and may not have reported yet
+    for (int i = 0; i < 100 && guard.getReport(CyderRealtimeGuard::Scope::wrappedPlugin).allocations < juce::uint64(numTasks); ++i)
+        juce::Thread::sleep(10);
+    
+    EXPECT_EQ(juce::uint64(numTasks), guard.getReport(CyderRealtimeGuard::Scope::wrappedPlugin).allocations);
+    EXPECT_EQ(juce::uint64(numTasks), guard.getReport(CyderRealtimeGuard::Scope::wrappedPlugin).deallocations);
+}
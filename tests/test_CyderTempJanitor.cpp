@@ -0,0 +1,117 @@
+
+#include <gtest/gtest.h>
+
+#include <juce_core/juce_core.h>
+
+#include "../source/CyderTempJanitor.hpp"
+
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+//==============================================================================
+
+TEST(CyderTempJanitor, StagingDirectoryIsInsideAStagingRoot)
+{
+    juce::SharedResourcePointer<CyderTempJanitor> janitor;
+
+    const auto staging = janitor->getStagingDirectory(1024);
+    EXPECT_TRUE(staging.isDirectory());
+    EXPECT_TRUE(janitor->getSessionDirectories().contains(staging));
+
+    const auto roots = CyderTempJanitor::getStagingRoots();
+    EXPECT_TRUE(std::any_of(roots.begin(), roots.end(), [&](const juce::File& root) { return staging.isAChildOf(root); }));
+}
+
+TEST(CyderTempJanitor, StagesInRamOnlyWhenThereIsRoom)
+{
+    juce::SharedResourcePointer<CyderTempJanitor> janitor;
+    const auto originalLocation = janitor->getStagingLocation();
+
+    janitor->setStagingLocation(CyderTempJanitor::StagingLocation::disk);
+    EXPECT_TRUE(janitor->getStagingDirectory(1024).isAChildOf(CyderTempJanitor::getTempRoot()));
+
+    janitor->setStagingLocation(CyderTempJanitor::StagingLocation::ram);
+    const auto expectedRoot = CyderTempJanitor::canStageInRam(1024) ? CyderTempJanitor::getRamRoot()
+                                                                     : CyderTempJanitor::getTempRoot();
+    EXPECT_TRUE(janitor->getStagingDirectory(1024).isAChildOf(expectedRoot));
+
+    // Far more than any machine has free
+    EXPECT_FALSE(CyderTempJanitor::canStageInRam(std::numeric_limits<juce::int64>::max() / 2));
+
+    janitor->setStagingLocation(originalLocation);
+}
+
+TEST(CyderTempJanitor, RetiredCopyIsDeletedAsynchronously)
+{
+    juce::SharedResourcePointer<CyderTempJanitor> janitor;
+
+    auto fakeCopy = janitor->getStagingDirectory(1024).getChildFile("Fake_" + juce::Uuid().toString() + ".vst3");
+    ASSERT_TRUE(fakeCopy.getChildFile("Contents").createDirectory());
+    ASSERT_TRUE(fakeCopy.getChildFile("Contents").getChildFile("binary").replaceWithText("not really a plugin"));
+
+    janitor->retire(fakeCopy);
+
+    EXPECT_TRUE(janitor->waitUntilIdle(5000));
+    EXPECT_FALSE(fakeCopy.exists());
+    EXPECT_EQ(janitor->getNumPendingDeletions(), 0);
+}
+
+TEST(CyderTempJanitor, DeletesSessionsOfDeadProcesses)
+{
+    juce::SharedResourcePointer<CyderTempJanitor> janitor;
+
+    // Nobody holds its lock, as if its process had crashed
+    auto orphan = CyderTempJanitor::getTempRoot().getChildFile("session_orphan_" + juce::Uuid().toString());
+    ASSERT_TRUE(orphan.getChildFile("Fake.vst3").createDirectory());
+    ASSERT_TRUE(orphan.getChildFile("session.lock").create());
+
+    [[maybe_unused]] const auto ownSession = janitor->getStagingDirectory(1024);
+    EXPECT_GE(janitor->deleteOrphanedSessions(), 1);
+    EXPECT_FALSE(orphan.exists());
+
+    // Never our own
+    for (const auto& session : janitor->getSessionDirectories())
+        EXPECT_TRUE(session.isDirectory());
+}
+
+TEST(CyderTempJanitor, StagingThrowsWhenOverQuota)
+{
+    juce::SharedResourcePointer<CyderTempJanitor> janitor;
+
+    const auto originalQuota = janitor->getQuotaBytes();
+
+    janitor->setQuotaBytes(0);
+    EXPECT_THROW((void) janitor->getStagingDirectory(1024), std::runtime_error);
+
+    janitor->setQuotaBytes(originalQuota);
+    EXPECT_NO_THROW((void) janitor->getStagingDirectory(1024));
+}
+
+TEST(CyderTempJanitor, OverQuotaSweepsOrphansBeforeThrowing)
+{
+    juce::SharedResourcePointer<CyderTempJanitor> janitor;
+
+    auto orphan = CyderTempJanitor::getTempRoot().getChildFile("session_orphan_" + juce::Uuid().toString());
+    ASSERT_TRUE(orphan.getChildFile("Fake.vst3").createDirectory());
+    ASSERT_TRUE(orphan.getChildFile("session.lock").create());
+
+    const auto originalQuota = janitor->getQuotaBytes();
+
+    // Nothing frees enough room for a quota of 0, but the orphan is gone by the time it gives up
+    janitor->setQuotaBytes(0);
+    EXPECT_THROW((void) janitor->getStagingDirectory(1024), std::runtime_error);
+    EXPECT_FALSE(orphan.exists());
+
+    janitor->setQuotaBytes(originalQuota);
+}
+
+TEST(CyderTempJanitor, SessionIsNotNamedAfterProcessIdAlone)
+{
+    juce::SharedResourcePointer<CyderTempJanitor> janitor;
+
+    // A later process given the same ID must not take a crashed session for its own
+    const auto sessionName = janitor->getStagingDirectory(1024).getFileName();
+    EXPECT_TRUE(sessionName.startsWith("session_"));
+    EXPECT_TRUE(sessionName.fromFirstOccurrenceOf("session_", false, false).containsChar('_'));
+}
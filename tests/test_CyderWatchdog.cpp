@@ -0,0 +1,171 @@
+
+#include <gtest/gtest.h>
+
+#include "../source/CyderAudioProcessor.hpp"
+#include "../source/CyderWatchdog.hpp"
+
+#include <atomic>
+
+//==============================================================================
+
+static constexpr double sampleRate = 48000.0;
+static constexpr int blockSize = 48; // 1 ms
+
+/** Spins rather than sleeps, so there is something on the stack to sample. */
+static void burn(int milliseconds)
+{
+    const auto end = juce::Time::getMillisecondCounterHiRes() + milliseconds;
+    volatile double sink = 0.0;
+    while (juce::Time::getMillisecondCounterHiRes() < end)
+        sink = sink + 1.0;
+}
+
+static juce::File getExamplePlugin()
+{
+    // ExamplePlugin.vst3 must have already been built and copied into root directory
+    return juce::File(__FILE__).getParentDirectory() // "tests"
+                               .getParentDirectory() // root dir
+                               .getChildFile("ExamplePlugin")
+                               .withFileExtension("vst3");
+}
+
+static bool waitForTrips(const CyderWatchdog& watchdog, int numTrips)
+{
+    for (int i = 0; i < 500 && watchdog.getNumTrips() < numTrips; ++i)
+        juce::Thread::sleep(2);
+    return watchdog.getNumTrips() >= numTrips;
+}
+
+//==============================================================================
+
+TEST(CyderWatchdog, CallsWithinBudgetNeverTrip)
+{
+    CyderWatchdog watchdog;
+    watchdog.setOverrunFactor(50.0); // a loaded CI machine shouldn't trip us
+    watchdog.prepare(sampleRate, blockSize);
+
+    for (int i = 0; i < 20; ++i)
+    {
+        const CyderWatchdog::ScopedProcess process(watchdog, blockSize);
+    }
+
+    juce::Thread::sleep(20);
+    EXPECT_EQ(0, watchdog.getNumTrips());
+    EXPECT_FALSE(watchdog.getLastEvent().has_value());
+}
+
+TEST(CyderWatchdog, TripsAfterOverrunsInARow)
+{
+    CyderWatchdog watchdog;
+    watchdog.setOverrunFactor(2.0);
+    watchdog.setNumOverrunsToTrip(3);
+
+    std::atomic<int> numCalls { 0 };
+    watchdog.onTripped = [&](const CyderWatchdog::Event&) { ++numCalls; };
+    watchdog.prepare(sampleRate, blockSize);
+
+    // Two overruns, then a call in time, starts counting over
+    for (int i = 0; i < 2; ++i)
+    {
+        const CyderWatchdog::ScopedProcess process(watchdog, blockSize);
+        burn(3);
+    }
+    {
+        const CyderWatchdog::ScopedProcess process(watchdog, blockSize * 1000);
+    }
+    juce::Thread::sleep(20);
+    EXPECT_EQ(0, watchdog.getNumTrips());
+
+    for (int i = 0; i < 3; ++i)
+    {
+        const CyderWatchdog::ScopedProcess process(watchdog, blockSize);
+        burn(3);
+    }
+    ASSERT_TRUE(waitForTrips(watchdog, 1));
+    EXPECT_EQ(1, numCalls.load());
+
+    const auto event = watchdog.getLastEvent();
+    ASSERT_TRUE(event.has_value());
+    EXPECT_FALSE(event->hung);
+    EXPECT_EQ(3, event->numOverruns);
+    EXPECT_GE(event->callMs, 2.0);
+    EXPECT_NEAR(1.0, event->budgetMs, 0.01);
+}
+
+TEST(CyderWatchdog, TripsOnceWhileCallHangs)
+{
+    CyderWatchdog watchdog;
+    watchdog.setOverrunFactor(2.0);
+    watchdog.setNumOverrunsToTrip(3);
+    watchdog.prepare(sampleRate, blockSize);
+
+    {
+        const CyderWatchdog::ScopedProcess process(watchdog, blockSize);
+
+        // Trips without waiting for the call to return
+        const auto start = juce::Time::getMillisecondCounterHiRes();
+        while (watchdog.getNumTrips() == 0 && juce::Time::getMillisecondCounterHiRes() - start < 1000.0)
+            burn(1);
+        EXPECT_EQ(1, watchdog.getNumTrips());
+        burn(20);
+    }
+
+    // Returning doesn't count it again
+    juce::Thread::sleep(20);
+    EXPECT_EQ(1, watchdog.getNumTrips());
+
+    const auto event = watchdog.getLastEvent();
+    ASSERT_TRUE(event.has_value());
+    EXPECT_TRUE(event->hung);
+    EXPECT_GE(event->callMs, 6.0);
+    if (CyderWatchdog::canSampleStacks())
+        EXPECT_TRUE(event->stackSample.isNotEmpty());
+}
+
+TEST(CyderAudioProcessorWatchdog, BypassesWhenTripped)
+{
+    CyderAudioProcessor cyderProcessor;
+    cyderProcessor.prepareToPlay(sampleRate, blockSize);
+    ASSERT_TRUE(cyderProcessor.loadPlugin(getExamplePlugin().getFullPathName())); // only watched while hosting a plugin
+    ASSERT_FALSE(cyderProcessor.isBypassed());
+
+    auto& watchdog = cyderProcessor.getWatchdog();
+    watchdog.setNumOverrunsToTrip(1);
+    {
+        const CyderWatchdog::ScopedProcess process(watchdog, blockSize);
+        burn(3);
+    }
+
+    ASSERT_TRUE(waitForTrips(watchdog, 1));
+    EXPECT_TRUE(cyderProcessor.isBypassed());
+}
+
+TEST(CyderAudioProcessorWatchdog, RunsOnlyWhileHostingPreparedPlugin)
+{
+    CyderAudioProcessor cyderProcessor;
+    auto& watchdog = cyderProcessor.getWatchdog();
+    watchdog.setNumOverrunsToTrip(1);
+    
+    const auto overrun = [&]
+    {
+        const CyderWatchdog::ScopedProcess process(watchdog, blockSize);
+        burn(3);
+    };
+    
+    // Nothing hosted yet
+    cyderProcessor.prepareToPlay(sampleRate, blockSize);
+    overrun();
+    juce::Thread::sleep(50);
+    EXPECT_EQ(0, watchdog.getNumTrips());
+    
+    // Hosted, but released by the host
+    ASSERT_TRUE(cyderProcessor.loadPlugin(getExamplePlugin().getFullPathName()));
+    cyderProcessor.releaseResources();
+    overrun();
+    juce::Thread::sleep(50);
+    EXPECT_EQ(0, watchdog.getNumTrips());
+    
+    cyderProcessor.prepareToPlay(sampleRate, blockSize);
+    overrun();
+    EXPECT_TRUE(waitForTrips(watchdog, 1));
+}
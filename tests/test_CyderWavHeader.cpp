@@ -0,0 +1,89 @@
+
+#include <gtest/gtest.h>
+
+#include <juce_audio_formats/juce_audio_formats.h>
+
+#include "../tools/render/source/CyderWavHeader.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+
+//==============================================================================
+
+static uint64_t readLittleEndian(const uint8_t* source, int numBytes)
+{
+    uint64_t value = 0;
+    for (int i = 0; i < numBytes; ++i)
+        value |= static_cast<uint64_t>(source[i]) << (8 * i);
+    return value;
+}
+
+//==============================================================================
+
+TEST(CyderWavHeader, WritesReadableFloatWav)
+{
+    constexpr int numChannels = 2;
+    constexpr int numFrames   = 100;
+    constexpr double sampleRate = 48000.0;
+    
+    ASSERT_FALSE(CyderWavHeader::needsRf64(numChannels, numFrames));
+    const auto headerSize = CyderWavHeader::getSize(numChannels, numFrames);
+    ASSERT_EQ(CyderWavHeader::riffSize, headerSize);
+    
+    // Header, then interleaved ramps
+    juce::MemoryBlock file(static_cast<size_t>(headerSize) + numFrames * numChannels * sizeof(float), true);
+    CyderWavHeader::write(file.getData(), numChannels, sampleRate, numFrames);
+    auto* frames = reinterpret_cast<float*>(static_cast<char*>(file.getData()) + headerSize);
+    for (int i = 0; i < numFrames; ++i)
+        for (int ch = 0; ch < numChannels; ++ch)
+            frames[i * numChannels + ch] = (ch == 0 ? 1.0f : -1.0f) * static_cast<float>(i) / numFrames;
+    
+    juce::WavAudioFormat wavFormat;
+    std::unique_ptr<juce::AudioFormatReader> reader(wavFormat.createReaderFor(new juce::MemoryInputStream(file, false), true));
+    ASSERT_TRUE(reader != nullptr);
+    EXPECT_EQ(numChannels, static_cast<int>(reader->numChannels));
+    EXPECT_EQ(sampleRate, reader->sampleRate);
+    EXPECT_EQ(numFrames, reader->lengthInSamples);
+    EXPECT_EQ(32, static_cast<int>(reader->bitsPerSample));
+    EXPECT_TRUE(reader->usesFloatingPointData);
+    
+    juce::AudioBuffer<float> buffer(numChannels, numFrames);
+    ASSERT_TRUE(reader->read(&buffer, 0, numFrames, 0, true, true));
+    for (int i = 0; i < numFrames; ++i)
+    {
+        EXPECT_FLOAT_EQ( static_cast<float>(i) / numFrames, buffer.getSample(0, i));
+        EXPECT_FLOAT_EQ(-static_cast<float>(i) / numFrames, buffer.getSample(1, i));
+    }
+}
+
+TEST(CyderWavHeader, SwitchesToRf64PastFourGigabytes)
+{
+    constexpr int numChannels = 2;
+    constexpr juce::int64 numFrames = 600000000; // 4.8 GB of stereo float
+    const auto dataSize = static_cast<uint64_t>(numFrames) * numChannels * sizeof(float);
+    
+    // The largest RIFF still fits, one more frame doesn't
+    constexpr juce::int64 maxRiffFrames = (0xffffffffLL - 36 - 1) / 8;
+    EXPECT_FALSE(CyderWavHeader::needsRf64(numChannels, maxRiffFrames));
+    EXPECT_TRUE(CyderWavHeader::needsRf64(numChannels, maxRiffFrames + 1));
+    
+    ASSERT_TRUE(CyderWavHeader::needsRf64(numChannels, numFrames));
+    ASSERT_EQ(CyderWavHeader::rf64Size, CyderWavHeader::getSize(numChannels, numFrames));
+    
+    uint8_t header[CyderWavHeader::rf64Size] = {};
+    CyderWavHeader::write(header, numChannels, 48000.0, numFrames);
+    
+    // Sizes that don't fit in 32 bits are in the ds64 chunk, in 64 bits
+    EXPECT_EQ(0, std::memcmp(header, "RF64", 4));
+    EXPECT_EQ(0xffffffffu, readLittleEndian(header + 4, 4));
+    EXPECT_EQ(0, std::memcmp(header + 8, "WAVE", 4));
+    EXPECT_EQ(0, std::memcmp(header + 12, "ds64", 4));
+    EXPECT_EQ(28u, readLittleEndian(header + 16, 4));
+    EXPECT_EQ(dataSize + CyderWavHeader::rf64Size - 8, readLittleEndian(header + 20, 8));
+    EXPECT_EQ(dataSize, readLittleEndian(header + 28, 8));
+    EXPECT_EQ(static_cast<uint64_t>(numFrames), readLittleEndian(header + 36, 8));
+    EXPECT_EQ(0, std::memcmp(header + 48, "fmt ", 4));
+    EXPECT_EQ(0, std::memcmp(header + 72, "data", 4));
+    EXPECT_EQ(0xffffffffu, readLittleEndian(header + 76, 4));
+}
@@ -0,0 +1,46 @@
+
+#include <gtest/gtest.h>
+
+#include <juce_core/juce_core.h>
+
+#include "../source/CyderWorkerPool.hpp"
+
+#include <atomic>
+#include <vector>
+
+//==============================================================================
+
+TEST(CyderWorkerPoolRun, EveryTaskRunsExactlyOncePerBatch)
+{
+    CyderWorkerPool pool(/*numWorkers*/3);
+    EXPECT_EQ(3, pool.getNumWorkers());
+    
+    constexpr int numTasks   = 8;
+    constexpr int numBatches = 2000;
+    
+    std::vector<std::atomic<int>> counts(numTasks);
+    for (auto& count : counts)
+        count = 0;
+    
+    const CyderWorkerPool::Task task = [&](int index) { counts[static_cast<size_t>(index)].fetch_add(1); };
+    
+    for (int batch = 1; batch <= numBatches; ++batch)
+    {
+        pool.run(numTasks, task);
+        
+        // run() must not return before the whole batch is done
+        for (auto& count : counts)
+            ASSERT_EQ(batch, count.load());
+    }
+}
+
+TEST(CyderWorkerPoolRun, WorksWithoutWorkers)
+{
+    CyderWorkerPool pool(/*numWorkers*/0);
+    
+    int sum = 0;
+    const CyderWorkerPool::Task task = [&](int index) { sum += index; };
+    pool.run(4, task);
+    
+    EXPECT_EQ(0 + 1 + 2 + 3, sum);
+}
@@ -6,7 +6,9 @@
 #endif
 
 #include "../source/HotReloadThread.hpp"
+#include "../source/Utilities.hpp"
 
+#include <algorithm>
 #include <atomic>
 
 //==============================================================================
@@ -41,10 +43,14 @@ TEST(HotReloadThreadRun, DetectsChangedBinary)
                                           #if JUCE_MAC
                                           .getChildFile("MacOS")
                                           .getChildFile("ExamplePlugin");
-                                          #else // JUCE_WINDOWS
+                                          #elif JUCE_WINDOWS
                                           .getChildFile("x86_64-win")
                                           .getChildFile("ExamplePlugin")
                                           .withFileExtension(".vst3");
+                                          #else // JUCE_LINUX
+                                          .getChildFile(Utilities::getModuleInBundle(pluginFile).getParentDirectory().getFileName())
+                                          .getChildFile("ExamplePlugin")
+                                          .withFileExtension(".so");
                                           #endif
         ASSERT_TRUE(binaryFile.existsAsFile());
         bool modificationTimeChanged = binaryFile.setLastModificationTime(juce::Time::getCurrentTime());
@@ -76,6 +82,7 @@ TEST(HotReloadThreadRun, DetectsChangedBinary)
 #endif
 }
 
+#if ! JUCE_LINUX // on Linux only the module is watched
 TEST(HotReloadThreadRun, DetectsAddedFile)
 {
     juce::File currentFile(__FILE__);
@@ -117,3 +124,189 @@ TEST(HotReloadThreadRun, DetectsAddedFile)
     jassert(fileDeleted);
     jassert(resourceFile.deleteFile()); // ensure we delete the garbage file we created!
 }
+#endif // ! JUCE_LINUX
+
+TEST(HotReloadThreadRun, KeepsWatchingAfterChange)
+{
+    juce::File currentFile(__FILE__);
+    juce::File pluginFile = currentFile.getParentDirectory() // "tests"
+                                       .getParentDirectory() // root dir
+                                       .getChildFile("ExamplePlugin")
+                                       .withFileExtension("vst3");
+    const auto binaryFile = Utilities::getModuleInBundle(pluginFile);
+    ASSERT_TRUE(binaryFile.existsAsFile());
+
+    std::atomic<int> numChangesDetected = 0;
+
+    HotReloadThread thread(pluginFile, {}, /*keepWatching*/ true);
+    thread.onPluginChangeDetected = [&numChangesDetected] { ++numChangesDetected; };
+    juce::Thread::sleep(50);
+
+    // Two rebuilds, each well past the debounce of the one before
+    auto modificationTime = juce::Time::getCurrentTime();
+    for (int change = 1; change <= 2; ++change)
+    {
+        modificationTime = modificationTime + juce::RelativeTime::seconds(1.0);
+        ASSERT_TRUE(binaryFile.setLastModificationTime(modificationTime));
+
+        for (int i = 0; i < 100 && numChangesDetected < change; ++i)
+            juce::Thread::sleep(100);
+        ASSERT_EQ(change, numChangesDetected.load());
+    }
+
+    // Still running, unlike a thread reporting only the first change
+    EXPECT_TRUE(thread.isThreadRunning());
+    thread.stopThread(2000);
+}
+
+//==============================================================================
+
+/** Source directory with one file in it, and a stand-in for the built plugin. */
+struct BuildFixture
+{
+    BuildFixture()
+    {
+        [[maybe_unused]] auto result = sourceDirectory.createDirectory();
+        jassert(result.wasOk());
+        [[maybe_unused]] auto written = sourceFile.replaceWithText("int main() {}");
+        jassert(written);
+    }
+    
+    ~BuildFixture()
+    {
+        sourceDirectory.deleteRecursively();
+        logFile.deleteFile();
+    }
+    
+    /** Saves the source file again, with a modification time the watcher cannot miss. */
+    void save()
+    {
+        saveTime = std::max(saveTime, juce::Time::getCurrentTime()) + juce::RelativeTime::seconds(1.0);
+        [[maybe_unused]] auto written = sourceFile.replaceWithText("int main() { return 0; }");
+        [[maybe_unused]] auto touched = sourceFile.setLastModificationTime(saveTime);
+        jassert(written && touched);
+    }
+    
+    CyderBuildSettings makeSettings(const juce::String& command) const
+    {
+        CyderBuildSettings settings;
+        settings.sourceDirectory = sourceDirectory;
+        settings.command = command;
+        settings.logFile = logFile;
+        return settings;
+    }
+    
+    juce::File sourceDirectory = juce::File::createTempFile("CyderSource");
+    juce::File sourceFile      = sourceDirectory.getChildFile("main.cpp");
+    juce::File plugin          = sourceDirectory.getChildFile("build").getChildFile("Fake.vst3");
+    juce::File logFile         = juce::File::createTempFile("CyderBuild.log");
+    juce::Time saveTime;
+};
+
+/** Polls for up to 10 seconds. */
+template <typename Condition>
+static bool waitFor(Condition condition)
+{
+    for (int i = 0; i < 100; ++i)
+    {
+        if (condition())
+            return true;
+        juce::Thread::sleep(100);
+    }
+    return condition();
+}
+
+TEST(HotReloadThreadBuild, SuccessfulBuildReloadsAndLogsOutput)
+{
+    BuildFixture fixture;
+    
+    std::atomic<int> numBuildsStarted = 0;
+    std::atomic<int> numBuildsSucceeded = 0;
+    std::atomic<bool> reloadRequested = false;
+    
+    HotReloadThread thread(fixture.plugin, fixture.makeSettings("echo compiling main.cpp"));
+    thread.onBuildStarted = [&] { ++numBuildsStarted; };
+    thread.onBuildFinished = [&](bool succeeded) { if (succeeded) ++numBuildsSucceeded; };
+    thread.onPluginChangeDetected = [&] { reloadRequested = true; };
+    
+    // Two saves in quick succession make one build
+    fixture.save();
+    juce::Thread::sleep(50);
+    fixture.save();
+    
+    EXPECT_TRUE(waitFor([&] { return reloadRequested.load(); }));
+    EXPECT_EQ(numBuildsStarted, 1);
+    EXPECT_EQ(numBuildsSucceeded, 1);
+    EXPECT_TRUE(fixture.logFile.loadFileAsString().contains("compiling main.cpp"));
+    
+    thread.stopThread(2000);
+}
+
+TEST(HotReloadThreadBuild, FailedBuildDoesNotReload)
+{
+    BuildFixture fixture;
+    
+    std::atomic<bool> buildFinished = false;
+    std::atomic<bool> buildSucceeded = true;
+    std::atomic<bool> reloadRequested = false;
+    
+    HotReloadThread thread(fixture.plugin, fixture.makeSettings("echo main.cpp:1: error && exit 3"));
+    thread.onBuildFinished = [&](bool succeeded) { buildSucceeded = succeeded; buildFinished = true; };
+    thread.onPluginChangeDetected = [&] { reloadRequested = true; };
+    
+    fixture.save();
+    
+    EXPECT_TRUE(waitFor([&] { return buildFinished.load(); }));
+    EXPECT_FALSE(buildSucceeded);
+    EXPECT_FALSE(reloadRequested);
+    EXPECT_TRUE(fixture.logFile.loadFileAsString().contains("main.cpp:1: error"));
+    
+    thread.stopThread(2000);
+}
+
+#if ! JUCE_WINDOWS
+TEST(HotReloadThreadBuild, NewerSaveCancelsBuildInProgress)
+{
+    BuildFixture fixture;
+    
+    std::atomic<int> numBuildsStarted = 0;
+    std::atomic<int> numBuildsFinished = 0;
+    
+    HotReloadThread thread(fixture.plugin, fixture.makeSettings("sleep 30"));
+    thread.onBuildStarted = [&] { ++numBuildsStarted; };
+    thread.onBuildFinished = [&](bool) { ++numBuildsFinished; };
+    
+    fixture.save();
+    ASSERT_TRUE(waitFor([&] { return numBuildsStarted == 1; }));
+    
+    // Cancels the first build, then starts another
+    fixture.save();
+    EXPECT_TRUE(waitFor([&] { return numBuildsStarted == 2; }));
+    EXPECT_EQ(numBuildsFinished, 0);
+    EXPECT_TRUE(waitFor([&] { return fixture.logFile.loadFileAsString().startsWith("$ sleep 30"); }));
+    
+    // Stopping the thread cancels the second one
+    const auto stopStart = juce::Time::getMillisecondCounter();
+    EXPECT_TRUE(thread.stopThread(5000));
+    EXPECT_LT(juce::Time::getMillisecondCounter() - stopStart, 5000u);
+}
+
+TEST(HotReloadThreadBuild, StopWaitsForBuildIgnoringTerminateToBeKilled)
+{
+    BuildFixture fixture;
+
+    std::atomic<int> numBuildsStarted = 0;
+
+    HotReloadThread thread(fixture.plugin, fixture.makeSettings("trap '' TERM; echo started; sleep 30"));
+    thread.onBuildStarted = [&] { ++numBuildsStarted; };
+
+    fixture.save();
+    ASSERT_TRUE(waitFor([&] { return numBuildsStarted == 1; }));
+    ASSERT_TRUE(waitFor([&] { return fixture.logFile.loadFileAsString().contains("started"); }));
+
+    // Killed once it has ignored SIGTERM for long enough, and reaped, rather than the thread being killed instead
+    EXPECT_TRUE(thread.stop());
+    EXPECT_FALSE(thread.isThreadRunning());
+    EXPECT_TRUE(fixture.logFile.loadFileAsString().contains("Build cancelled"));
+}
+#endif
@@ -5,6 +5,7 @@
 #include <juce_core/juce_core.h>
 
 #include "../source/CyderAssert.hpp"
+#include "../source/CyderTempJanitor.hpp"
 #include "../source/Utilities.hpp"
 
 //==============================================================================
@@ -152,3 +153,109 @@ TEST(UtilitiesCopyPluginToTemp, ThrowsWhenCopyFails)
     }
     , std::runtime_error);
 }
+
+TEST(UtilitiesGetModuleInBundle, FindsModuleForThisPlatform)
+{
+    juce::File currentFile(__FILE__);
+    // ExamplePlugin.vst3 must have already been built and copied into root directory
+    // so we can use it as a testable VST3
+    juce::File pluginFile = currentFile.getParentDirectory() // "tests"
+                                       .getParentDirectory() // root dir
+                                       .getChildFile("ExamplePlugin")
+                                       .withFileExtension("vst3");
+
+    const auto module = Utilities::getModuleInBundle(pluginFile);
+    ASSERT_TRUE(module.existsAsFile());
+    EXPECT_TRUE(module.isAChildOf(pluginFile.getChildFile("Contents")));
+
+   #if JUCE_LINUX
+    const auto architectureDir = module.getParentDirectory().getFileName();
+    EXPECT_TRUE(architectureDir == "x86_64-linux" || architectureDir == "aarch64-linux") << architectureDir;
+    EXPECT_EQ(module.getFileExtension(), ".so");
+   #endif
+}
+
+#if JUCE_LINUX
+TEST(UtilitiesCopyPluginToTemp, CopiesSeparateDebugInfoNextToModule)
+{
+    juce::SharedResourcePointer<CyderTempJanitor> janitor;
+    const auto originalLocation = janitor->getStagingLocation();
+    janitor->setStagingLocation(CyderTempJanitor::StagingLocation::disk);
+
+    // Create mock vst3 with modules for both Linux architectures, and debug info left next to the bundle
+    auto tempSource = juce::File::createTempFile("testPlugin.vst3");
+    for (const auto* architecture : { "x86_64-linux", "aarch64-linux" })
+        ASSERT_TRUE(tempSource.getChildFile("Contents").getChildFile(architecture).getChildFile("testPlugin.so").create());
+
+    const auto module = Utilities::getModuleInBundle(tempSource);
+    ASSERT_TRUE(module.existsAsFile());
+    auto debugFile = tempSource.getSiblingFile("testPlugin.so.debug");
+    ASSERT_TRUE(debugFile.replaceWithText("symbols"));
+
+    juce::File copiedFile;
+    EXPECT_NO_THROW(
+    {
+        copiedFile = Utilities::copyPluginToTemp(tempSource);
+    });
+
+    auto copiedDebugFile = copiedFile.getChildFile("Contents")
+                                     .getChildFile(module.getParentDirectory().getFileName())
+                                     .getChildFile("testPlugin.so.debug");
+    EXPECT_TRUE(copiedDebugFile.existsAsFile());
+
+    Utilities::deleteStalePlugin(copiedFile);
+    EXPECT_TRUE(janitor->waitUntilIdle(5000));
+    janitor->setStagingLocation(originalLocation);
+    tempSource.deleteRecursively();
+    debugFile.deleteFile();
+}
+
+TEST(UtilitiesStagePluginInMemory, ModuleIsServedFromMemoryAndResourcesFromOriginal)
+{
+    // Keeps the memfd open for as long as the staged bundle is in use
+    juce::SharedResourcePointer<CyderTempJanitor> janitor;
+
+    // Create mock vst3 (which is a directory/bundle) with a Linux module and a resource
+    auto tempSource = juce::File::createTempFile("testPlugin.vst3");
+    const auto architectureDir = Utilities::getLinuxArchitectureName() + "-linux";
+    auto originalModule = tempSource.getChildFile("Contents")
+                                    .getChildFile(architectureDir)
+                                    .getChildFile("testPlugin.so");
+    auto originalResource = tempSource.getChildFile("Contents")
+                                      .getChildFile("Resources")
+                                      .getChildFile("moduleinfo.json");
+    ASSERT_TRUE(originalModule.create());
+    ASSERT_TRUE(originalModule.replaceWithText("not really a module"));
+    ASSERT_TRUE(originalResource.create());
+
+    juce::File stagedFile;
+    EXPECT_NO_THROW(
+    {
+        stagedFile = Utilities::stagePluginInMemory(tempSource);
+    });
+    ASSERT_TRUE(stagedFile.isDirectory());
+    EXPECT_EQ(stagedFile.getFileExtension(), tempSource.getFileExtension());
+
+    auto stagedModule = stagedFile.getChildFile("Contents")
+                                  .getChildFile(architectureDir)
+                                  .getChildFile(stagedFile.getFileNameWithoutExtension() + ".so");
+    ASSERT_TRUE(stagedModule.isSymbolicLink());
+    EXPECT_TRUE(stagedModule.getNativeLinkedTarget().startsWith("/proc/self/fd/"));
+    EXPECT_EQ(stagedModule.loadFileAsString(), "not really a module");
+
+    // The memfd counts, though only links to it are on any file system
+    EXPECT_GE(janitor->getStagedSize(stagedFile), originalModule.getSize());
+    EXPECT_LT(CyderTempJanitor::getSizeOnDisk(stagedFile), originalModule.getSize());
+
+    EXPECT_TRUE(stagedFile.getChildFile("Contents").getChildFile("Resources").getLinkedTarget()
+                    == originalResource.getParentDirectory());
+
+    // Deleting the staged bundle must leave the original alone
+    Utilities::deleteStalePlugin(stagedFile);
+    EXPECT_TRUE(janitor->waitUntilIdle(5000));
+    EXPECT_FALSE(stagedFile.exists());
+    EXPECT_TRUE(originalResource.existsAsFile());
+
+    tempSource.deleteRecursively();
+}
+#endif // JUCE_LINUX
@@ -0,0 +1,272 @@
+/******************************************************************************
+ * Cyder — Hot-Reloading Audio Plugin Wrapper
+ *
+ * @file     CyderPluginHost.cpp
+ *
+ * @author   Adam Shield
+ * @date     2026-10-19
+ *
+ * @copyright (c) 2026 Adam Shield
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * See LICENSE.txt for license terms.
+ ******************************************************************************/
+
+// Child process hosting a plugin for Cyder, so that a plugin crashing takes down
+// only this process. Launched by CyderProcessBridge, never by hand.
+//
+// Usage:
+//   Cyder_PluginHost --channel=<shared memory name> --plugin=<plugin.vst3> [--parent=<pid>]
+//
+// Audio, MIDI and commands come in through the shared memory (see CyderBridgeChannel),
+// and are handled on a real-time thread of our own. The main thread runs the message
+// loop plugins expect. We exit when told to, or when the parent process is gone.
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <juce_core/juce_core.h>
+#include <juce_events/juce_events.h>
+
+#include "CyderBridgeChannel.hpp"
+#include "Utilities.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+
+#if JUCE_LINUX
+#include <csignal>
+#include <sys/prctl.h>
+#include <unistd.h>
+#endif
+
+//==============================================================================
+
+/** How long to sleep between checks for commands and for the parent, when no audio comes in. */
+static constexpr juce::int64 idleWaitNanos = 10 * 1000000;
+
+//==============================================================================
+
+/** Handles blocks and commands from Cyder until told to exit. */
+class HostThread final : public juce::Thread
+{
+public:
+    HostThread(CyderBridgeChannel& channelToUse, juce::AudioPluginInstance& pluginToHost, int parentProcessId)
+    : juce::Thread("Cyder Plugin Host")
+    , channel(channelToUse)
+    , plugin(pluginToHost)
+    , parentId(parentProcessId)
+    {
+        const auto& header = channel.getHeader();
+        const auto numBufferChannels = std::max(plugin.getTotalNumInputChannels(), plugin.getTotalNumOutputChannels());
+        numChannels = juce::jlimit(1, CyderBridgeChannel::maxNumChannels, std::max(header.numChannels, numBufferChannels));
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            channelPointers[ch] = channel.getChannel(ch);
+
+        midi.ensureSize(static_cast<size_t>(CyderBridgeChannel::maxMidiBytes) * 2);
+    }
+
+    void run() override
+    {
+        auto& header = channel.getHeader();
+
+        // Whatever a previous host left unfinished is dropped
+        header.responseSequence.store(header.requestSequence.load());
+        header.commandDoneSequence.store(header.commandSequence.load());
+        reportLatencyAndTail();
+       #if JUCE_LINUX
+        header.hostProcessId.store(static_cast<int32_t>(getpid()));
+       #endif
+
+        header.hostState.store(static_cast<uint32_t>(CyderBridgeChannel::HostState::ready), std::memory_order_release);
+        CyderBridgeChannel::wake(header.hostState);
+
+        auto handled = header.responseSequence.load();
+        while (! threadShouldExit() && header.shouldExit.load() == 0 && isParentAlive())
+        {
+            if (const auto requested = header.requestSequence.load(std::memory_order_acquire); requested != handled)
+            {
+                processBlock();
+                handled = requested;
+                header.responseSequence.store(requested, std::memory_order_release);
+                CyderBridgeChannel::wake(header.responseSequence);
+                continue;
+            }
+
+            if (header.commandSequence.load(std::memory_order_acquire) != header.commandDoneSequence.load())
+            {
+                runCommand();
+                continue;
+            }
+
+            CyderBridgeChannel::wait(header.requestSequence, handled, idleWaitNanos);
+        }
+
+        juce::MessageManager::getInstance()->stopDispatchLoop();
+    }
+
+private:
+    CyderBridgeChannel& channel;
+    juce::AudioPluginInstance& plugin;
+    const int parentId;
+
+    int numChannels = 0;
+    float* channelPointers[CyderBridgeChannel::maxNumChannels] {};
+    juce::MidiBuffer midi;
+
+    void processBlock()
+    {
+        auto& header = channel.getHeader();
+        const auto numSamples = juce::jlimit(0, header.maxBlockSize, header.numSamples);
+
+        // Processed in place, in the shared memory
+        for (int ch = header.numChannels; ch < numChannels; ++ch)
+            std::memset(channelPointers[ch], 0, static_cast<size_t>(numSamples) * sizeof(float));
+        juce::AudioBuffer<float> buffer(channelPointers, numChannels, numSamples);
+
+        midi.clear();
+        CyderBridgeChannel::readMidi(channel.getMidiData(), header.numMidiBytes, midi);
+
+        plugin.processBlock(buffer, midi);
+
+        header.numMidiBytes = CyderBridgeChannel::writeMidi(midi, channel.getMidiData(), CyderBridgeChannel::maxMidiBytes);
+    }
+
+    void runCommand()
+    {
+        auto& header = channel.getHeader();
+        const auto sequence = header.commandSequence.load(std::memory_order_acquire);
+        bool succeeded = false;
+
+        switch (static_cast<CyderBridgeChannel::Command>(header.command))
+        {
+            case CyderBridgeChannel::Command::getState:
+            {
+                juce::MemoryBlock state;
+                plugin.getStateInformation(state);
+                if (state.getSize() <= static_cast<size_t>(CyderBridgeChannel::maxPayloadBytes))
+                {
+                    std::memcpy(channel.getPayloadData(), state.getData(), state.getSize());
+                    header.payloadBytes = state.getSize();
+                    succeeded = true;
+                }
+                break;
+            }
+            case CyderBridgeChannel::Command::setState:
+            {
+                const auto numBytes = std::min(header.payloadBytes, static_cast<uint64_t>(CyderBridgeChannel::maxPayloadBytes));
+                plugin.setStateInformation(channel.getPayloadData(), static_cast<int>(numBytes));
+                succeeded = true;
+                break;
+            }
+            case CyderBridgeChannel::Command::none:
+                break;
+        }
+
+        reportLatencyAndTail();
+
+        header.commandSucceeded = succeeded ? 1 : 0;
+        header.commandDoneSequence.store(sequence, std::memory_order_release);
+        CyderBridgeChannel::wake(header.commandDoneSequence);
+    }
+
+    void reportLatencyAndTail()
+    {
+        auto& header = channel.getHeader();
+        header.latencySamples.store(plugin.getLatencySamples());
+        header.tailLengthSeconds.store(plugin.getTailLengthSeconds());
+    }
+
+    bool isParentAlive() const noexcept
+    {
+       #if JUCE_LINUX
+        return parentId <= 0 || getppid() == parentId;
+       #else
+        return true;
+       #endif
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (HostThread)
+};
+
+//==============================================================================
+
+/** Main buses only, as wide as Cyder's. */
+static void setUpBuses(juce::AudioPluginInstance& plugin, int numChannels, double sampleRate, int blockSize)
+{
+    auto layout = plugin.getBusesLayout();
+    const auto channelSet = juce::AudioChannelSet::canonicalChannelSet(numChannels);
+    for (int i = 0; i < layout.inputBuses.size(); ++i)
+        layout.inputBuses.getReference(i) = i == 0 ? channelSet : juce::AudioChannelSet::disabled();
+    for (int i = 0; i < layout.outputBuses.size(); ++i)
+        layout.outputBuses.getReference(i) = i == 0 ? channelSet : juce::AudioChannelSet::disabled();
+
+    if (plugin.getBusesLayout() == layout || plugin.setBusesLayout(layout))
+        plugin.setRateAndBufferSizeDetails(sampleRate, blockSize);
+    else
+        plugin.setPlayConfigDetails(numChannels, numChannels, sampleRate, blockSize);
+}
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser; // plugins expect a message thread
+
+    juce::ArgumentList args("Cyder_PluginHost", argc, argv);
+    const auto channelName = args.getValueForOption("--channel");
+    const auto pluginPath  = args.getValueForOption("--plugin");
+    const auto parentId    = args.getValueForOption("--parent").getIntValue();
+
+   #if JUCE_LINUX
+    prctl(PR_SET_PDEATHSIG, SIGKILL); // nobody left to listen to us
+    if (parentId > 0 && getppid() != parentId)
+        return 1; // parent died before we got this far
+   #endif
+
+    auto channel = CyderBridgeChannel::open(channelName);
+    if (channel == nullptr)
+    {
+        std::cerr << "Cyder_PluginHost: failed to open channel " << channelName << std::endl;
+        return 1;
+    }
+
+    auto& header = channel->getHeader();
+    const auto numChannels = juce::jlimit(1, CyderBridgeChannel::maxNumChannels, header.numChannels);
+
+    std::unique_ptr<juce::AudioPluginInstance> plugin;
+    try
+    {
+        juce::AudioPluginFormatManager formatManager;
+        formatManager.addDefaultFormats();
+
+        juce::AudioProcessor::setTypeOfNextNewPlugin(juce::AudioProcessor::wrapperType_VST3);
+
+        auto description = Utilities::findPluginDescription(juce::File(pluginPath), formatManager);
+        description.numInputChannels  = numChannels;
+        description.numOutputChannels = numChannels;
+
+        plugin = Utilities::createInstance(description, formatManager, header.sampleRate, header.maxBlockSize);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Cyder_PluginHost: " << e.what() << std::endl;
+        header.hostState.store(static_cast<uint32_t>(CyderBridgeChannel::HostState::failed));
+        CyderBridgeChannel::wake(header.hostState);
+        return 1;
+    }
+
+    setUpBuses(*plugin, numChannels, header.sampleRate, header.maxBlockSize);
+    plugin->prepareToPlay(header.sampleRate, header.maxBlockSize);
+
+    HostThread hostThread(*channel, *plugin, parentId);
+    if (! hostThread.startRealtimeThread(juce::Thread::RealtimeOptions{}.withApproximateAudioProcessingTime(header.maxBlockSize, header.sampleRate)))
+        hostThread.startThread(juce::Thread::Priority::highest); // not allowed real-time scheduling
+
+    juce::MessageManager::getInstance()->runDispatchLoop(); // until the host thread is done
+
+    hostThread.stopThread(5000);
+    plugin->releaseResources();
+    plugin.reset();
+    return 0;
+}
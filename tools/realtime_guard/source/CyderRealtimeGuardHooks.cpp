@@ -0,0 +1,321 @@
+/******************************************************************************
+ * Cyder — Hot-Reloading Audio Plugin Wrapper
+ *
+ * @file     CyderRealtimeGuardHooks.cpp
+ *
+ * @author   Adam Shield
+ * @date     2026-10-19
+ *
+ * @copyright (c) 2026 Adam Shield
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * See LICENSE.txt for license terms.
+ ******************************************************************************/
+
+// Preload library (Linux) that counts allocations, deallocations and mutex locks
+// made by threads Cyder has marked as real-time. Load it into the host with e.g.
+//
+//   LD_PRELOAD=/path/to/libCyder_RealtimeGuard.so reaper
+//
+// Nothing in here may allocate or lock while counting, and nothing may use
+// lazily-initialised TLS, since that would re-enter the hooks.
+
+#include "CyderRealtimeGuardHooks.h"
+
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <pthread.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <utility>
+
+//==============================================================================
+
+namespace
+{
+
+using MallocFn        = void* (*)(size_t);
+using CallocFn        = void* (*)(size_t, size_t);
+using ReallocFn       = void* (*)(void*, size_t);
+using FreeFn          = void  (*)(void*);
+using PosixMemalignFn = int   (*)(void**, size_t, size_t);
+using AlignedAllocFn  = void* (*)(size_t, size_t);
+using MutexLockFn     = int   (*)(pthread_mutex_t*);
+
+MallocFn        realMalloc        = nullptr;
+CallocFn        realCalloc        = nullptr;
+ReallocFn       realRealloc       = nullptr;
+FreeFn          realFree          = nullptr;
+PosixMemalignFn realPosixMemalign = nullptr;
+AlignedAllocFn  realAlignedAlloc  = nullptr;
+MutexLockFn     realMutexLock     = nullptr;
+
+bool isResolving = false;
+
+// dlsym() itself may allocate before we know where the real allocator is.
+// Each block is preceded by its size, for realloc() to copy out of it.
+alignas(std::max_align_t) char bootstrapHeap[16384];
+size_t bootstrapHeapUsed = 0;
+constexpr size_t bootstrapHeaderSize = alignof(std::max_align_t);
+
+struct ThreadState
+{
+    bool isRealtime;
+    bool isInsideHook;
+    int scope;
+    CyderRtGuardBlock block;
+};
+
+// initial-exec: TLS is reserved at load time, so touching it never allocates
+__attribute__((tls_model("initial-exec"))) thread_local ThreadState threadState;
+
+constexpr size_t alignUp(size_t value, size_t alignment) noexcept
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+void* allocateFromBootstrapHeap(size_t size, size_t alignment = alignof(std::max_align_t)) noexcept
+{
+    alignment = std::max(alignment, alignof(std::max_align_t));
+    const auto heapStart = reinterpret_cast<uintptr_t>(bootstrapHeap);
+    const auto blockStart = alignUp(heapStart + bootstrapHeapUsed + bootstrapHeaderSize, alignment);
+    if (size > sizeof(bootstrapHeap)
+        || blockStart + alignUp(size, alignof(std::max_align_t)) > heapStart + sizeof(bootstrapHeap))
+        return nullptr;
+
+    auto* result = reinterpret_cast<char*>(blockStart);
+    std::memcpy(result - sizeof(size_t), &size, sizeof(size_t));
+    bootstrapHeapUsed = blockStart + alignUp(size, alignof(std::max_align_t)) - heapStart;
+    return result;
+}
+
+size_t getBootstrapBlockSize(const void* ptr) noexcept
+{
+    size_t size;
+    std::memcpy(&size, static_cast<const char*>(ptr) - sizeof(size_t), sizeof(size_t));
+    return size;
+}
+
+bool isFromBootstrapHeap(const void* ptr) noexcept
+{
+    const auto* bytes = static_cast<const char*>(ptr);
+    return bytes >= bootstrapHeap && bytes < bootstrapHeap + sizeof(bootstrapHeap);
+}
+
+void resolveRealFunctions() noexcept
+{
+    if (realMalloc != nullptr || isResolving)
+        return;
+
+    isResolving = true;
+    realCalloc        = reinterpret_cast<CallocFn>       (dlsym(RTLD_NEXT, "calloc"));
+    realMalloc        = reinterpret_cast<MallocFn>       (dlsym(RTLD_NEXT, "malloc"));
+    realRealloc       = reinterpret_cast<ReallocFn>      (dlsym(RTLD_NEXT, "realloc"));
+    realFree          = reinterpret_cast<FreeFn>         (dlsym(RTLD_NEXT, "free"));
+    realPosixMemalign = reinterpret_cast<PosixMemalignFn>(dlsym(RTLD_NEXT, "posix_memalign"));
+    realAlignedAlloc  = reinterpret_cast<AlignedAllocFn> (dlsym(RTLD_NEXT, "aligned_alloc"));
+    realMutexLock     = reinterpret_cast<MutexLockFn>    (dlsym(RTLD_NEXT, "pthread_mutex_lock"));
+    isResolving = false;
+}
+
+enum class Violation { allocation, deallocation, lock };
+
+void recordViolation(Violation violation) noexcept
+{
+    auto& state = threadState;
+    if (! state.isRealtime || state.isInsideHook)
+        return;
+
+    state.isInsideHook = true;
+
+    auto& counts = state.block.scopes[state.scope];
+    switch (violation)
+    {
+        case Violation::allocation   : ++counts.allocations;   break;
+        case Violation::deallocation : ++counts.deallocations; break;
+        case Violation::lock         : ++counts.locks;         break;
+    }
+
+    // Only the first violation per block: backtrace() is slow, and the first is usually the interesting one
+    if (counts.numFrames == 0)
+        counts.numFrames = backtrace(counts.frames, CYDER_RT_GUARD_MAX_FRAMES);
+
+    state.isInsideHook = false;
+}
+
+__attribute__((constructor)) void initialise() noexcept
+{
+    resolveRealFunctions();
+
+    // backtrace() loads libgcc on first use, which allocates, so get that out of the way now
+    void* frames[1];
+    backtrace(frames, 1);
+}
+
+} // namespace
+
+//==============================================================================
+// Control interface, looked up by Cyder with dlsym(RTLD_DEFAULT, ...)
+
+extern "C" __attribute__((visibility("default"))) void cyder_rt_guard_begin_block(void)
+{
+    auto& state = threadState;
+    std::memset(&state.block, 0, sizeof(state.block));
+    state.scope = CYDER_RT_GUARD_SCOPE_WRAPPER;
+    state.isRealtime = true;
+}
+
+extern "C" __attribute__((visibility("default"))) void cyder_rt_guard_set_scope(int scope)
+{
+    if (scope >= 0 && scope < CYDER_RT_GUARD_NUM_SCOPES)
+        threadState.scope = scope;
+}
+
+extern "C" __attribute__((visibility("default"))) void cyder_rt_guard_end_block(CyderRtGuardBlock* result)
+{
+    auto& state = threadState;
+    state.isRealtime = false;
+    if (result != nullptr)
+        std::memcpy(result, &state.block, sizeof(state.block));
+}
+
+//==============================================================================
+// Interposed C allocator and pthread functions
+
+extern "C" __attribute__((visibility("default"))) void* malloc(size_t size)
+{
+    resolveRealFunctions();
+    if (realMalloc == nullptr)
+        return allocateFromBootstrapHeap(size);
+
+    recordViolation(Violation::allocation);
+    return realMalloc(size);
+}
+
+extern "C" __attribute__((visibility("default"))) void* calloc(size_t count, size_t size)
+{
+    resolveRealFunctions();
+    if (realCalloc == nullptr)
+        return allocateFromBootstrapHeap(count * size); // static storage is already zeroed
+
+    recordViolation(Violation::allocation);
+    return realCalloc(count, size);
+}
+
+extern "C" __attribute__((visibility("default"))) void* realloc(void* ptr, size_t size)
+{
+    resolveRealFunctions();
+
+    // Move out of the bootstrap heap, which is never freed (or into it, while resolving)
+    if (isFromBootstrapHeap(ptr) || realRealloc == nullptr)
+    {
+        auto* moved = malloc(size);
+        if (moved != nullptr && isFromBootstrapHeap(ptr))
+            std::memcpy(moved, ptr, std::min(size, getBootstrapBlockSize(ptr)));
+        return moved;
+    }
+
+    recordViolation(Violation::allocation);
+    return realRealloc(ptr, size);
+}
+
+extern "C" __attribute__((visibility("default"))) void free(void* ptr)
+{
+    if (ptr == nullptr || isFromBootstrapHeap(ptr))
+        return;
+
+    recordViolation(Violation::deallocation);
+    realFree(ptr);
+}
+
+extern "C" __attribute__((visibility("default"))) int posix_memalign(void** result, size_t alignment, size_t size)
+{
+    resolveRealFunctions();
+    if (realPosixMemalign == nullptr)
+    {
+        if (alignment < sizeof(void*) || (alignment & (alignment - 1)) != 0)
+            return EINVAL;
+        *result = allocateFromBootstrapHeap(size, alignment);
+        return *result != nullptr ? 0 : ENOMEM;
+    }
+
+    recordViolation(Violation::allocation);
+    return realPosixMemalign(result, alignment, size);
+}
+
+extern "C" __attribute__((visibility("default"))) void* aligned_alloc(size_t alignment, size_t size)
+{
+    resolveRealFunctions();
+    if (realAlignedAlloc == nullptr)
+        return (alignment & (alignment - 1)) == 0 ? allocateFromBootstrapHeap(size, alignment) : nullptr;
+
+    recordViolation(Violation::allocation);
+    return realAlignedAlloc(alignment, size);
+}
+
+extern "C" __attribute__((visibility("default"))) int pthread_mutex_lock(pthread_mutex_t* mutex)
+{
+    resolveRealFunctions();
+    if (realMutexLock == nullptr)
+        return 0; // only while resolving, before any other thread can exist
+
+    recordViolation(Violation::lock);
+    return realMutexLock(mutex);
+}
+
+//==============================================================================
+// Interposed C++ allocation, counted once rather than again in malloc
+
+static void* allocateForNew(size_t size)
+{
+    resolveRealFunctions();
+    recordViolation(Violation::allocation);
+
+    const auto wasInsideHook = std::exchange(threadState.isInsideHook, true);
+    auto* result = malloc(size == 0 ? 1 : size);
+    threadState.isInsideHook = wasInsideHook;
+
+    return result;
+}
+
+static void deallocateForDelete(void* ptr) noexcept
+{
+    if (ptr == nullptr)
+        return;
+
+    recordViolation(Violation::deallocation);
+
+    const auto wasInsideHook = std::exchange(threadState.isInsideHook, true);
+    free(ptr);
+    threadState.isInsideHook = wasInsideHook;
+}
+
+void* operator new(size_t size)
+{
+    if (auto* result = allocateForNew(size))
+        return result;
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size)
+{
+    if (auto* result = allocateForNew(size))
+        return result;
+    throw std::bad_alloc();
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept   { return allocateForNew(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return allocateForNew(size); }
+
+void operator delete(void* ptr) noexcept                          { deallocateForDelete(ptr); }
+void operator delete[](void* ptr) noexcept                        { deallocateForDelete(ptr); }
+void operator delete(void* ptr, size_t) noexcept                  { deallocateForDelete(ptr); }
+void operator delete[](void* ptr, size_t) noexcept                { deallocateForDelete(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept   { deallocateForDelete(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { deallocateForDelete(ptr); }
@@ -0,0 +1,303 @@
+/******************************************************************************
+ * Cyder — Hot-Reloading Audio Plugin Wrapper
+ *
+ * @file     CyderRender.cpp
+ *
+ * @author   Adam Shield
+ * @date     2026-10-19
+ *
+ * @copyright (c) 2026 Adam Shield
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * See LICENSE.txt for license terms.
+ ******************************************************************************/
+
+// Headless offline renderer: streams a WAV file through a VST3 as fast as possible.
+//
+// Usage:
+//   Cyder_Render <plugin.vst3> <input.wav> <output.wav> [--block-size=512] [--watch]
+//
+// With --watch, the plugin is watched for rebuilds and the file is rendered again
+// after each one, until the process is interrupted.
+
+#include <juce_audio_formats/juce_audio_formats.h>
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <juce_core/juce_core.h>
+#include <juce_events/juce_events.h>
+
+#include "CyderTempJanitor.hpp"
+#include "CyderWavHeader.hpp"
+#include "HotReloadThread.hpp"
+#include "Utilities.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+
+//==============================================================================
+
+static constexpr int defaultBlockSize = 512;
+
+struct RenderOptions
+{
+    juce::File pluginFile;
+    juce::File inputFile;
+    juce::File outputFile;
+    int blockSize = defaultBlockSize;
+    bool watch = false;
+};
+
+struct RenderReport
+{
+    juce::int64 numFrames = 0;
+    double sampleRate = 0.0;
+    int latencySamples = 0;
+    double renderSeconds = 0.0;
+
+    [[nodiscard]] double getAudioSeconds() const noexcept { return static_cast<double>(numFrames) / sampleRate; }
+    [[nodiscard]] double getRealtimeFactor() const noexcept { return getAudioSeconds() / std::max(renderSeconds, 1.0e-9); }
+};
+
+//==============================================================================
+
+/** Loads a fresh instance from a temp copy of the plugin, so the original can be rebuilt while we render. */
+static std::unique_ptr<juce::AudioPluginInstance> createPluginInstance(const juce::File& pluginCopy,
+                                                                       int numChannels,
+                                                                       double sampleRate,
+                                                                       int blockSize) noexcept(false)
+{
+    juce::AudioPluginFormatManager formatManager;
+    formatManager.addDefaultFormats();
+
+    auto description = Utilities::findPluginDescription(pluginCopy, formatManager);
+    description.numInputChannels  = numChannels;
+    description.numOutputChannels = numChannels;
+
+    auto instance = Utilities::createInstance(description, formatManager, sampleRate, blockSize);
+    instance->setPlayConfigDetails(numChannels, numChannels, sampleRate, blockSize);
+    instance->prepareToPlay(sampleRate, blockSize);
+    return instance;
+}
+
+/**
+ Renders the input file through the plugin into the output file.
+ Both files are memory-mapped, and the plugin's latency is compensated so that
+ the output lines up with the input.
+ */
+static RenderReport render(const RenderOptions& options) noexcept(false)
+{
+    juce::WavAudioFormat wavFormat;
+    std::unique_ptr<juce::MemoryMappedAudioFormatReader> reader(wavFormat.createMemoryMappedReader(options.inputFile));
+    if (reader == nullptr || ! reader->mapEntireFile())
+        throw std::runtime_error(("Could not map input WAV: " + options.inputFile.getFullPathName()).toStdString());
+
+    const auto numChannels = static_cast<int>(reader->numChannels);
+    const auto sampleRate  = reader->sampleRate;
+    const auto numFrames   = reader->lengthInSamples;
+    const auto blockSize   = options.blockSize;
+
+    if (numChannels != 1 && numChannels != 2)
+        throw std::runtime_error("Only mono or stereo input is supported");
+
+    // Pre-size the output file, then map it so rendering writes straight to the page cache.
+    // Anything past 4 GiB is written as RF64.
+    const auto headerSize    = CyderWavHeader::getSize(numChannels, numFrames);
+    const auto bytesPerFrame = static_cast<juce::int64>(numChannels) * static_cast<juce::int64>(sizeof(float));
+    const auto outputSize    = headerSize + numFrames * bytesPerFrame;
+    {
+        options.outputFile.deleteFile();
+        if (! options.outputFile.create())
+            throw std::runtime_error(("Could not create output: " + options.outputFile.getFullPathName()).toStdString());
+        std::filesystem::resize_file(options.outputFile.getFullPathName().toStdString(),
+                                     static_cast<std::uintmax_t>(outputSize));
+    }
+
+    juce::MemoryMappedFile mappedOutput(options.outputFile, juce::MemoryMappedFile::readWrite);
+    if (mappedOutput.getData() == nullptr || static_cast<juce::int64>(mappedOutput.getSize()) < outputSize)
+        throw std::runtime_error(("Could not map output: " + options.outputFile.getFullPathName()).toStdString());
+
+    CyderWavHeader::write(mappedOutput.getData(), numChannels, sampleRate, numFrames);
+    auto* outputFrames = reinterpret_cast<float*>(static_cast<char*>(mappedOutput.getData()) + headerSize);
+
+    // Load plugin
+    const auto pluginCopy = Utilities::copyPluginToTemp(options.pluginFile);
+    std::unique_ptr<juce::AudioPluginInstance> instance;
+    try
+    {
+        instance = createPluginInstance(pluginCopy, numChannels, sampleRate, blockSize);
+    }
+    catch (const std::exception&) // e.g. build is only half written
+    {
+        Utilities::deleteStalePlugin(pluginCopy);
+        throw;
+    }
+    const auto latency = instance->getLatencySamples();
+
+    juce::AudioBuffer<float> buffer(numChannels, blockSize);
+    juce::MidiBuffer midi;
+
+    RenderReport report;
+    report.numFrames      = numFrames;
+    report.sampleRate     = sampleRate;
+    report.latencySamples = latency;
+
+    // Feed latency's worth of silence past the end of the input, and drop the first latency samples of output
+    const auto totalFramesToProcess = numFrames + latency;
+    juce::int64 framesWritten = 0;
+
+    const auto startTime = juce::Time::getMillisecondCounterHiRes();
+
+    for (juce::int64 position = 0; position < totalFramesToProcess; position += blockSize)
+    {
+        const auto numSamples = static_cast<int>(std::min<juce::int64>(blockSize, totalFramesToProcess - position));
+
+        buffer.clear();
+        if (position < numFrames)
+            reader->read(&buffer, 0, static_cast<int>(std::min<juce::int64>(numSamples, numFrames - position)), position, true, true);
+
+        juce::AudioBuffer<float> block(buffer.getArrayOfWritePointers(), numChannels, numSamples);
+        instance->processBlock(block, midi);
+        midi.clear();
+
+        // Skip output that only exists because of the plugin's latency
+        const auto skip = static_cast<int>(juce::jlimit<juce::int64>(0, numSamples, latency - position));
+        const auto numToWrite = static_cast<int>(std::min<juce::int64>(numSamples - skip, numFrames - framesWritten));
+        if (numToWrite <= 0)
+            continue;
+
+        using Source = juce::AudioData::NonInterleavedSource<juce::AudioData::Float32, juce::AudioData::NativeEndian>;
+        using Dest   = juce::AudioData::InterleavedDest<juce::AudioData::Float32, juce::AudioData::LittleEndian>;
+
+        const float* sourceChannels[2] = { block.getReadPointer(0) + skip,
+                                           block.getReadPointer(numChannels - 1) + skip };
+
+        juce::AudioData::interleaveSamples(Source { sourceChannels, numChannels },
+                                           Dest { outputFrames + framesWritten * numChannels, numChannels },
+                                           numToWrite);
+        framesWritten += numToWrite;
+    }
+
+    report.renderSeconds = (juce::Time::getMillisecondCounterHiRes() - startTime) / 1000.0;
+
+    instance->releaseResources();
+    instance.reset();
+    Utilities::deleteStalePlugin(pluginCopy);
+
+    return report;
+}
+
+static bool renderAndReport(const RenderOptions& options)
+{
+    try
+    {
+        const auto report = render(options);
+        std::cout << "Rendered " << report.getAudioSeconds() << " s"
+                  << " (" << report.numFrames << " frames @ " << report.sampleRate << " Hz"
+                  << ", latency " << report.latencySamples << " samples)"
+                  << " in " << report.renderSeconds << " s: "
+                  << report.getRealtimeFactor() << "x realtime" << std::endl;
+        return true;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Render failed: " << e.what() << std::endl;
+        return false;
+    }
+}
+
+/**
+ Watches the plugin for the whole --watch session, so a rebuild landing while we render
+ is picked up as soon as that render is done.
+ */
+class RebuildWatcher final
+{
+public:
+    explicit RebuildWatcher(const juce::File& pluginFile)
+    : hotReloadThread(pluginFile, {}, /*keepWatching*/ true)
+    {
+        hotReloadThread.onPluginChangeDetected = [this] { rebuilt = true; };
+        std::cout << "Watching " << pluginFile.getFullPathName() << " for changes..." << std::endl;
+    }
+
+    ~RebuildWatcher()
+    {
+        hotReloadThread.stop(); // waits for a build it started to be torn down
+    }
+
+    /** Blocks (while keeping the message loop alive) until the plugin has been rebuilt since the last call. */
+    void waitForRebuild()
+    {
+        while (! rebuilt.exchange(false))
+            juce::MessageManager::getInstance()->runDispatchLoopUntil(100);
+    }
+
+private:
+    std::atomic<bool> rebuilt { false };
+    HotReloadThread hotReloadThread; // auto starts thread
+};
+
+static void printUsage()
+{
+    std::cout << "Usage: Cyder_Render <plugin.vst3> <input.wav> <output.wav> [--block-size=" << defaultBlockSize << "] [--watch]" << std::endl;
+}
+
+//==============================================================================
+
+int main(int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser; // plugins expect a message thread
+    juce::SharedResourcePointer<CyderTempJanitor> tempJanitor; // one for the whole run, rather than one per render
+
+    juce::ArgumentList args(argc, argv);
+
+    juce::StringArray positional;
+    for (const auto& arg : args.arguments)
+        if (! arg.isOption())
+            positional.add(arg.text);
+
+    if (args.containsOption("--help|-h"))
+    {
+        printUsage();
+        return 0;
+    }
+
+    if (positional.size() != 3)
+    {
+        printUsage();
+        return 1;
+    }
+
+    RenderOptions options;
+    options.pluginFile = juce::File::getCurrentWorkingDirectory().getChildFile(positional[0]);
+    options.inputFile  = juce::File::getCurrentWorkingDirectory().getChildFile(positional[1]);
+    options.outputFile = juce::File::getCurrentWorkingDirectory().getChildFile(positional[2]);
+    options.watch      = args.containsOption("--watch");
+
+    if (args.containsOption("--block-size"))
+        options.blockSize = juce::jlimit(1, 65536, args.getValueForOption("--block-size").getIntValue());
+
+    if (! options.pluginFile.exists())
+    {
+        std::cerr << "Plugin not found: " << options.pluginFile.getFullPathName() << std::endl;
+        return 1;
+    }
+
+    // Watching starts before the first render, so no rebuild slips by while rendering
+    std::unique_ptr<RebuildWatcher> watcher;
+    if (options.watch)
+        watcher = std::make_unique<RebuildWatcher>(options.pluginFile);
+
+    auto succeeded = renderAndReport(options);
+
+    while (watcher != nullptr)
+    {
+        watcher->waitForRebuild();
+        succeeded = renderAndReport(options); // keep watching even if this build fails to load
+    }
+
+    return succeeded ? 0 : 1;
+}
@@ -0,0 +1,88 @@
+/******************************************************************************
+ * Cyder — Hot-Reloading Audio Plugin Wrapper
+ *
+ * @file     CyderWavHeader.cpp
+ *
+ * @author   Adam Shield
+ * @date     2026-10-19
+ *
+ * @copyright (c) 2026 Adam Shield
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * See LICENSE.txt for license terms.
+ ******************************************************************************/
+
+#include "CyderWavHeader.hpp"
+
+#include <cstdint>
+#include <cstring>
+
+//==============================================================================
+
+/** Size fields that don't fit in 32 bits hold this, and the actual size is in the ds64 chunk. */
+static constexpr uint32_t rf64Placeholder = 0xffffffff;
+
+static void writeLittleEndian(uint8_t*& dest, uint64_t value, int numBytes) noexcept
+{
+    for (int i = 0; i < numBytes; ++i)
+        *dest++ = static_cast<uint8_t>((value >> (8 * i)) & 0xff);
+}
+
+static void writeFourCC(uint8_t*& dest, const char* fourCC) noexcept
+{
+    std::memcpy(dest, fourCC, 4);
+    dest += 4;
+}
+
+[[nodiscard]] static uint64_t getDataSize(int numChannels, juce::int64 numFrames) noexcept
+{
+    return static_cast<uint64_t>(numFrames) * static_cast<uint64_t>(numChannels) * sizeof(float);
+}
+
+//==============================================================================
+
+bool CyderWavHeader::needsRf64(int numChannels, juce::int64 numFrames) noexcept
+{
+    // The RIFF chunk's size covers everything after its first 8 bytes
+    return getDataSize(numChannels, numFrames) + (riffSize - 8) >= rf64Placeholder;
+}
+
+int CyderWavHeader::getSize(int numChannels, juce::int64 numFrames) noexcept
+{
+    return needsRf64(numChannels, numFrames) ? rf64Size : riffSize;
+}
+
+void CyderWavHeader::write(void* destination, int numChannels, double sampleRate, juce::int64 numFrames) noexcept
+{
+    const auto bytesPerFrame = static_cast<uint64_t>(numChannels) * sizeof(float);
+    const auto dataSize      = getDataSize(numChannels, numFrames);
+    const auto isRf64        = needsRf64(numChannels, numFrames);
+    const auto fileSize      = static_cast<uint64_t>(getSize(numChannels, numFrames)) + dataSize;
+
+    auto* dest = static_cast<uint8_t*>(destination);
+    writeFourCC(dest, isRf64 ? "RF64" : "RIFF");
+    writeLittleEndian(dest, isRf64 ? rf64Placeholder : fileSize - 8, 4);
+    writeFourCC(dest, "WAVE");
+
+    if (isRf64)
+    {
+        writeFourCC(dest, "ds64");
+        writeLittleEndian(dest, 28, 4);                                  // chunk size
+        writeLittleEndian(dest, fileSize - 8, 8);                        // RIFF size
+        writeLittleEndian(dest, dataSize, 8);
+        writeLittleEndian(dest, static_cast<uint64_t>(numFrames), 8);   // sample count
+        writeLittleEndian(dest, 0, 4);                                   // table length
+    }
+
+    writeFourCC(dest, "fmt ");
+    writeLittleEndian(dest, 16, 4);                                                    // chunk size
+    writeLittleEndian(dest, 3, 2);                                                     // WAVE_FORMAT_IEEE_FLOAT
+    writeLittleEndian(dest, static_cast<uint64_t>(numChannels), 2);
+    writeLittleEndian(dest, static_cast<uint64_t>(sampleRate), 4);
+    writeLittleEndian(dest, static_cast<uint64_t>(sampleRate) * bytesPerFrame, 4);     // byte rate
+    writeLittleEndian(dest, bytesPerFrame, 2);                                         // block align
+    writeLittleEndian(dest, 32, 2);                                                    // bits per sample
+
+    writeFourCC(dest, "data");
+    writeLittleEndian(dest, isRf64 ? rf64Placeholder : dataSize, 4);
+}
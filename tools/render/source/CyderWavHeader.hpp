@@ -0,0 +1,43 @@
+/******************************************************************************
+ * Cyder — Hot-Reloading Audio Plugin Wrapper
+ *
+ * @file     CyderWavHeader.hpp
+ *
+ * @author   Adam Shield
+ * @date     2026-10-19
+ *
+ * @copyright (c) 2026 Adam Shield
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * See LICENSE.txt for license terms.
+ ******************************************************************************/
+
+#pragma once
+
+#include <juce_core/juce_core.h>
+
+//==============================================================================
+
+/**
+ Header of the 32-bit float WAV files Cyder_Render writes straight into a mapped file.
+ Renders whose data outgrows the 32-bit sizes of RIFF are written as RF64 (EBU Tech 3306).
+ */
+class CyderWavHeader final
+{
+public:
+    /** Size of the canonical RIFF/WAVE header, keeping sample data 4-byte aligned. */
+    static constexpr int riffSize = 44;
+    /** Size of the RF64 header, i.e. RIFF's plus a ds64 chunk, also keeping sample data 4-byte aligned. */
+    static constexpr int rf64Size = 80;
+
+    /** @returns true if numFrames of numChannels need RF64 */
+    [[nodiscard]] static bool needsRf64(int numChannels, juce::int64 numFrames) noexcept;
+    /** @returns bytes the header takes, ahead of the sample data */
+    [[nodiscard]] static int getSize(int numChannels, juce::int64 numFrames) noexcept;
+
+    /** Writes getSize() bytes describing numFrames of interleaved 32-bit float audio. */
+    static void write(void* destination, int numChannels, double sampleRate, juce::int64 numFrames) noexcept;
+
+private:
+    CyderWavHeader() = delete;
+};